@@ -16,6 +16,15 @@ struct ArenaAllocator : public llvm::AllocatorBase<ArenaAllocator> {
     void Reset() const { }
     void PrintStats() const { }
     struct arena_block *head, *cur;
+    // allocations larger than CC_ARENA_BLOCK_SIZE(e.g., huge string literals) get their own blocks
+    struct arena_block *large = nullptr;
+    // objects in the arena which own heap memory(e.g., a DenseMap), their destructors run when the arena is destroyed
+    struct Cleanup {
+        void (*destroy)(void *);
+        void *object;
+        Cleanup *next;
+    };
+    Cleanup *cleanups = nullptr;
 #if CC_DEBUG
     size_t allocated_bytes = 0, num_blocks = 1;
 #endif
@@ -25,6 +34,14 @@ struct ArenaAllocator : public llvm::AllocatorBase<ArenaAllocator> {
 #if CC_DEBUG
         allocated_bytes += Size;
 #endif
+        if (LLVM_UNLIKELY(Size > CC_ARENA_BLOCK_SIZE)) {
+            auto it = reinterpret_cast<struct arena_block *>(
+                llvm::safe_malloc(offsetof(struct arena_block, heap) + Size));
+            it->offset = Size;
+            it->next = large;
+            large = it;
+            return it->heap;
+        }
         if (cur->offset + Size > CC_ARENA_BLOCK_SIZE) {
 #if CC_DEBUG
             ++num_blocks;
@@ -41,8 +58,26 @@ struct ArenaAllocator : public llvm::AllocatorBase<ArenaAllocator> {
 
     using AllocatorBase<ArenaAllocator>::Allocate;
 
+    // bytes handed out so far(without the unused tail of each block)
+    size_t getBytesAllocated() const {
+        size_t n = 0;
+        for (const struct arena_block *p = head; p; p = p->next)
+            n += p->offset;
+        for (const struct arena_block *p = large; p; p = p->next)
+            n += p->offset;
+        return n;
+    }
+
     void Deallocate(const void *, size_t, size_t) { }
 
+    // construct a T in the arena, and destroy it with the arena
+    template <typename T, typename... Args> T *createWithDestructor(Args &&...args) {
+        T *object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        cleanups = new (Allocate(sizeof(Cleanup), alignof(Cleanup)))
+            Cleanup{[](void *p) { static_cast<T *>(p)->~T(); }, object, cleanups};
+        return object;
+    }
+
     using AllocatorBase<ArenaAllocator>::Deallocate;
 
     ~ArenaAllocator() {
@@ -52,6 +87,8 @@ struct ArenaAllocator : public llvm::AllocatorBase<ArenaAllocator> {
         statics("  - Total bytes allocated: %zu\n", num_blocks * CC_ARENA_BLOCK_SIZE + allocated_bytes);
         endStatics();
 #endif
+        for (Cleanup *C = cleanups; C; C = C->next)
+            C->destroy(C->object);
         struct arena_block *p = head;
         do {
             struct arena_block *tmp = p;
@@ -59,6 +96,11 @@ struct ArenaAllocator : public llvm::AllocatorBase<ArenaAllocator> {
             // dbgprint("  block %p(size = %zu)\n", tmp, tmp->offset);
             free(tmp);
         } while (p);
+        for (p = large; p;) {
+            struct arena_block *tmp = p;
+            p = p->next;
+            free(tmp);
+        }
     }
     ArenaAllocator() { head = cur = new_arena_block(); }
 };
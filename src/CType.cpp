@@ -370,7 +370,22 @@ struct OpaqueCType {
             return hassize ? arrsize : unsigned(-1);
         return getRecord()->fields.size();
     }
-    CType getFieldIndex(IdentRef Name, xvector<unsigned> &idxs) const {
+    // the type of the member at `path`
+    CType getMemberType(ArrayRef<unsigned> path) const {
+        CType ty = getRecord()->fields[path.front()].ty;
+        for (unsigned i : path.drop_front(1))
+            ty = ty->getRecord()->fields[i].ty;
+        return ty;
+    }
+    CType getFieldIndex(IdentRef Name, SmallVectorImpl<unsigned> &idxs) const {
+        if (const auto *members = getRecord()->members) {
+            auto it = members->find(Name);
+            if (it == members->end())
+                return nullptr;
+            for (unsigned i : it->second)
+                idxs.push_back(i);
+            return getMemberType(it->second);
+        }
         const SmallVectorImpl<FieldDecl> &fields = getRecord()->fields;
         for (unsigned i = 0;i < fields.size();++i) {
             if (!fields[i].name) {
@@ -393,6 +408,14 @@ struct OpaqueCType {
         return nullptr;
     }
     CType getFieldIndex(IdentRef Name, SmallVectorImpl<Designator> &idxs) const {
+        if (const auto *members = getRecord()->members) {
+            auto it = members->find(Name);
+            if (it == members->end())
+                return nullptr;
+            for (unsigned i : it->second)
+                idxs.push_back(Designator(i));
+            return getMemberType(it->second);
+        }
         const SmallVectorImpl<FieldDecl> &fields = getRecord()->fields;
         for (unsigned i = 0;i < fields.size();++i) {
             if (!fields[i].name) {
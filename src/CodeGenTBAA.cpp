@@ -0,0 +1,141 @@
+/*
+ * CodeGenTBAA.cpp - type-based alias analysis metadata
+ *
+ * The C strict aliasing rules(C11 6.5p7) as a TBAA type tree, mirrors clang's CodeGenTBAA:
+ * every scalar type is a child of "omnipotent char", which aliases everything, signed and unsigned integers share a node,
+ * and structs are described by their members and offsets so that a member access is tagged with its access path.
+ * https://llvm.org/docs/LangRef.html#tbaa-metadata
+ */
+
+struct CodeGenTBAA {
+    LLVMTypeConsumer &types;
+    llvm::MDBuilder MDB;
+    llvm::MDNode *Root = nullptr, *Char = nullptr;
+    llvm::StringMap<llvm::MDNode *> scalarNodes;
+    DenseMap<const RecordDecl *, llvm::MDNode *> structNodes; // nullptr if the record cannot be described
+    CodeGenTBAA(LLVMContext &ctx, LLVMTypeConsumer &types) : types{types}, MDB{ctx} {}
+
+    llvm::MDNode *getRoot() {
+        if (!Root)
+            Root = MDB.createTBAARoot("Simple C/C++ TBAA");
+        return Root;
+    }
+    llvm::MDNode *getChar() {
+        if (!Char)
+            Char = MDB.createTBAAScalarTypeNode("omnipotent char", getRoot());
+        return Char;
+    }
+    llvm::MDNode *getScalarNode(StringRef Name) {
+        llvm::MDNode *&N = scalarNodes[Name];
+        if (!N)
+            N = MDB.createTBAAScalarTypeNode(Name, getChar());
+        return N;
+    }
+    static StringRef getFloatName(FloatKind k) {
+        switch (k.asEnum()) {
+        case F_Half: return "_Float16";
+        case F_BFloat: return "__bf16";
+        case F_Float: return "float";
+        case F_Double: return "double";
+        case F_Quadruple: return "__float128";
+        default: return "long double";
+        }
+    }
+    // signed and unsigned variants of an integer type share a node
+    llvm::MDNode *getIntegerInfo(IntegerKind k) {
+        switch (k.asLog2()) {
+        case 0: return getScalarNode("_Bool");
+        case 3: return getChar(); // character types alias everything
+        default: return getScalarNode(k.show(true));
+        }
+    }
+    // the type node of a scalar type, nullptr if accesses of the type are not described
+    llvm::MDNode *getTypeInfo(CType ty) {
+        switch (ty->getKind()) {
+        case TYPOINTER: return getScalarNode("any pointer");
+        case TYPRIM:
+            if (ty->isVoid())
+                return nullptr;
+            if (ty->isComplex())
+                return getChar();
+            if (ty->isFloating())
+                return getScalarNode(getFloatName(ty->getFloatKind()));
+            return getIntegerInfo(ty->getIntegerKind());
+        case TYTAG:
+            // an enum is accessed as its compatible integer type
+            if (ty->isEnum())
+                return getIntegerInfo(IntegerKind::fromBytes(types.getsizeof(ty)));
+            return nullptr;
+        case TYBITINT: {
+            SmallString<16> Name;
+            (Twine("_BitInt(") + Twine(ty->getBitIntBits()) + ")").toVector(Name);
+            return getScalarNode(Name);
+        }
+        default: return nullptr;
+        }
+    }
+    // the type node of a member in a struct type node
+    llvm::MDNode *getFieldTypeInfo(CType ty) {
+        while (ty->getKind() == TYARRAY)
+            ty = ty->arrtype;
+        if (ty->getKind() == TYTAG && ty->isStruct())
+            if (llvm::MDNode *N = getBaseTypeInfo(ty))
+                return N;
+        if (llvm::MDNode *N = getTypeInfo(ty))
+            return N;
+        return getChar();
+    }
+    // the type node of a struct, nullptr for unions, incomplete structs and structs with bit-fields
+    llvm::MDNode *getBaseTypeInfo(CType ty) {
+        assert(ty->getKind() == TYTAG && !ty->isEnum());
+        const RecordDecl *RD = ty->getRecord();
+        if (!RD || !ty->isStruct())
+            return nullptr;
+        auto it = structNodes.find(RD);
+        if (it != structNodes.end())
+            return it->second;
+        structNodes[RD] = nullptr;
+        SmallVector<std::pair<llvm::MDNode *, uint64_t>, 8> Fields;
+        for (unsigned i = 0; i < RD->fields.size(); ++i) {
+            CType fieldTy = RD->fields[i].ty;
+            if (fieldTy->getKind() == TYBITFIELD || fieldTy->getKind() == TYVLA)
+                return nullptr;
+            Fields.emplace_back(getFieldTypeInfo(fieldTy), types.getFieldOffset(ty, i));
+        }
+        StringRef Name = ty->hasTagName() ? ty->getTagName()->getKey() : StringRef();
+        return structNodes[RD] = MDB.createTBAAStructTypeNode(Name, Fields);
+    }
+    // the access tag of a scalar object that is not a struct member
+    llvm::MDNode *getAccessTag(CType ty) {
+        llvm::MDNode *N = getTypeInfo(ty);
+        return N ? MDB.createTBAAStructTagNode(N, N, 0) : nullptr;
+    }
+    // the access tag of an lvalue: a member is tagged with the outermost struct accessed by `.` and its offset in it
+    llvm::MDNode *getAccessTag(Expr e) {
+        if (e->k != EMemberAccess)
+            return getAccessTag(e->ty);
+        llvm::MDNode *Access = getTypeInfo(e->ty);
+        if (!Access)
+            return nullptr;
+        uint64_t Offset = 0;
+        CType Base;
+        for (;;) {
+            Expr obj = e->obj;
+            Base = obj->ty->getKind() == TYPOINTER ? obj->ty->p : obj->ty;
+            CType ty = Base;
+            for (unsigned i : e->idxs) {
+                // type punning through a union is allowed
+                if (ty->isUnion())
+                    return MDB.createTBAAStructTagNode(getChar(), getChar(), 0);
+                Offset += types.getFieldOffset(ty, i);
+                ty = ty->getRecord()->fields[i].ty;
+            }
+            if (obj->k != EMemberAccess || obj->ty->getKind() == TYPOINTER)
+                break;
+            e = obj;
+        }
+        if (llvm::MDNode *BaseNode = getBaseTypeInfo(Base))
+            return MDB.createTBAAStructTagNode(BaseNode, Access, Offset);
+        return MDB.createTBAAStructTagNode(Access, Access, 0);
+    }
+};
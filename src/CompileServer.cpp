@@ -0,0 +1,334 @@
+/*
+ * CompileServer.cpp - a warm xcc process that compiles on behalf of thin clients over a Unix domain socket
+ *
+ * The server initializes the LLVM targets once and keeps file contents(validated by modification time and size) between requests.
+ * Requests are handled one by one, since the working directory and the environment of the process are switched to the client's.
+ * Only clients running as the owner of the server are served, and clients only talk to a server of their own user(both checked
+ * with SO_PEERCRED). The default socket is in $XDG_RUNTIME_DIR, or else in a directory of mode 0700 created in /tmp.
+ *
+ * request:  argc, argv[0..argc), cwd, envc, env[0..envc)  (counts are uint32_t, strings are an uint32_t length and the bytes)
+ * response: frames of {char kind, uint32_t length, bytes}:
+ *   'E' - diagnostics output(the client writes them to stderr)
+ *   'X' - the last frame, the bytes are the exit status as an int32_t
+ */
+
+struct CompileServer : public DiagnosticHelper {
+    // compile `argv` as xcc's main() would, diagnostics are written to `ErrOS`, returns the exit status
+    using CompileFn = llvm::function_ref<int(ArrayRef<const char *> argv, llvm::raw_ostream &ErrOS, SharedFileCache &cache)>;
+
+    std::string path;
+    int fd = -1;
+    SharedFileCache cache;
+    unsigned numRequests = 0;
+    double totalTime = 0; // milliseconds
+
+    // the limits of a request: more strings than ARG_MAX allows, or a string longer than it, is not a command line
+    static constexpr uint32_t maxStrings = 1 << 20, maxStringLength = 1 << 24;
+
+    // the directory of the default socket when $XDG_RUNTIME_DIR is not set
+    static std::string getPrivateDirectory() { return "/tmp/xcc-" + std::to_string(::getuid()); }
+    static std::string getDefaultSocketPath() {
+        if (const char *path = ::getenv("XCC_SERVER_SOCKET"))
+            return path;
+        if (const char *dir = ::getenv("XDG_RUNTIME_DIR"); dir && *dir)
+            return std::string(dir) + "/xcc-server.sock";
+        return getPrivateDirectory() + "/server.sock";
+    }
+    // the socket path of --server/--client in `arg`, or nullptr if `arg` is not `option`
+    static const char *matchSocketOption(StringRef arg, StringRef option, std::string &result) {
+        if (!arg.consume_front(option))
+            return nullptr;
+        if (arg.empty())
+            result = getDefaultSocketPath();
+        else if (arg.consume_front("="))
+            result = arg.str();
+        else
+            return nullptr;
+        return result.c_str();
+    }
+
+    static bool writeAll(int fd, const void *buf, size_t len) {
+        const char *p = static_cast<const char *>(buf);
+        while (len) {
+            ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            p += n;
+            len -= n;
+        }
+        return true;
+    }
+    static bool readAll(int fd, void *buf, size_t len) {
+        char *p = static_cast<char *>(buf);
+        while (len) {
+            ssize_t n = ::read(fd, p, len);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            len -= n;
+        }
+        return true;
+    }
+    static bool writeString(int fd, StringRef s) {
+        const uint32_t len = s.size();
+        return writeAll(fd, &len, sizeof(len)) && writeAll(fd, s.data(), len);
+    }
+    static bool readString(int fd, std::string &s) {
+        uint32_t len;
+        if (!readAll(fd, &len, sizeof(len)) || len > maxStringLength)
+            return false;
+        s.resize(len);
+        return readAll(fd, &s[0], len);
+    }
+    static bool writeFrame(int fd, char kind, StringRef data) {
+        return writeAll(fd, &kind, 1) && writeString(fd, data);
+    }
+    static bool writeStrings(int fd, ArrayRef<const char *> strings) {
+        const uint32_t count = strings.size();
+        if (!writeAll(fd, &count, sizeof(count)))
+            return false;
+        for (const char *s : strings)
+            if (!writeString(fd, s))
+                return false;
+        return true;
+    }
+    static bool readStrings(int fd, std::vector<std::string> &strings) {
+        uint32_t count;
+        if (!readAll(fd, &count, sizeof(count)) || count > maxStrings)
+            return false;
+        strings.resize(count);
+        for (std::string &s : strings)
+            if (!readString(fd, s))
+                return false;
+        return true;
+    }
+    static bool makeAddress(StringRef path, struct sockaddr_un &addr) {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            return false;
+        memcpy(addr.sun_path, path.data(), path.size());
+        return true;
+    }
+    // the user of the process at the other end of the connection `fd`
+    static bool getPeerUid(int fd, uid_t &uid) {
+        struct ucred cred;
+        socklen_t len = sizeof(cred);
+        if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+            return false;
+        uid = cred.uid;
+        return true;
+    }
+
+    // sends everything written to it to the client as 'E' frames
+    struct FrameOStream : public llvm::raw_ostream {
+        int fd;
+        uint64_t pos = 0;
+        bool failed = false; // the client went away, the rest of the output is dropped
+        FrameOStream(int fd) : fd{fd} { SetBufferSize(64 * 1024); }
+        ~FrameOStream() override { flush(); }
+        void write_impl(const char *Ptr, size_t Size) override {
+            pos += Size;
+            if (!failed)
+                failed = !writeFrame(fd, 'E', StringRef(Ptr, Size));
+        }
+        uint64_t current_pos() const override { return pos; }
+    };
+
+    CompileServer(DiagnosticsEngine &engine, StringRef path) : DiagnosticHelper{engine}, path{path.str()} {
+        cache.setValidateFiles(true);
+    }
+    ~CompileServer() {
+        if (fd >= 0) {
+            ::close(fd);
+            ::unlink(path.c_str());
+        }
+    }
+    // create the directory of the default socket, or check that nobody else can create files in it
+    bool makePrivateDirectory(const std::string &dir) {
+        if (::mkdir(dir.c_str(), 0700) == 0)
+            return true;
+        struct stat st;
+        if (errno != EEXIST || ::lstat(dir.c_str(), &st))
+            return error("cannot create %R: %o", dir, errno), false;
+        if (!S_ISDIR(st.st_mode) || st.st_uid != ::geteuid() || (st.st_mode & 077))
+            return error("%R is not a directory of mode 0700 owned by the current user", dir), false;
+        return true;
+    }
+    // remove a socket left by a server that was killed: the path must be a socket that refuses connections
+    bool removeStaleSocket(const struct sockaddr_un &addr) {
+        struct stat st;
+        if (::lstat(path.c_str(), &st)) {
+            if (errno == ENOENT)
+                return true;
+            return error("cannot stat %R: %o", path, errno), false;
+        }
+        if (!S_ISSOCK(st.st_mode))
+            return error("%R exists and is not a socket", path), false;
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0)
+            return error("socket: %o", errno), false;
+        const int ret = ::connect(probe, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
+        const int err = errno;
+        ::close(probe);
+        if (ret == 0)
+            return error("another server is listening on %R", path), false;
+        if (err != ECONNREFUSED)
+            return error("cannot connect to the existing socket %R: %o", path, err), false;
+        if (::unlink(path.c_str()))
+            return error("cannot remove %R: %o", path, errno), false;
+        return true;
+    }
+    bool listen() {
+        struct sockaddr_un addr;
+        if (!makeAddress(path, addr))
+            return error("socket path is too long: %R", path), false;
+        const std::string dir = llvm::sys::path::parent_path(path).str();
+        if (dir == getPrivateDirectory() && !makePrivateDirectory(dir))
+            return false;
+        if (!removeStaleSocket(addr))
+            return false;
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return error("socket: %o", errno), false;
+        // connecting needs write permission on the socket: only the owner gets it
+        const mode_t oldMask = ::umask(0177);
+        const int ret = ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        ::umask(oldMask);
+        if (ret || ::listen(fd, 64)) {
+            error("cannot listen on %R: %o", path, errno);
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+    }
+    // accept clients until the process is killed
+    int run(CompileFn compile) {
+        if (!listen())
+            return CC_EXIT_FAILURE;
+        llvm::errs() << "xcc server: listening on " << path << '\n';
+        for (;;) {
+            int client = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                error("accept: %o", errno);
+                return CC_EXIT_FAILURE;
+            }
+            if (isOwner(client))
+                handle(client, compile);
+            ::close(client);
+        }
+    }
+    // the compiles run with the server's privileges, so other local users are refused
+    bool isOwner(int client) {
+        uid_t uid;
+        if (!getPeerUid(client, uid)) {
+            warning("xcc server: cannot get the credentials of a client: %o", errno);
+            return false;
+        }
+        if (uid != ::geteuid()) {
+            warning("xcc server: refused a client with uid %u", unsigned(uid));
+            return false;
+        }
+        return true;
+    }
+    void handle(int client, CompileFn compile) {
+        std::vector<std::string> args, env;
+        std::string cwd;
+        if (!readStrings(client, args) || args.empty() || !readString(client, cwd) || !readStrings(client, env)) {
+            warning("xcc server: ignored a malformed request");
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        int status = CC_EXIT_FAILURE;
+        SmallString<256> savedCwd;
+        if (std::error_code EC = llvm::sys::fs::current_path(savedCwd)) {
+            warning("xcc server: cannot get the working directory: %R", StringRef(EC.message()));
+            return;
+        }
+        {
+            FrameOStream OS(client);
+            if (::chdir(cwd.c_str())) {
+                OS << "xcc server: cannot change directory to " << cwd << ": " << std::strerror(errno) << '\n';
+            } else {
+                // the client's environment is installed for this request only, the server's own is restored after it
+                SmallVector<char *, 64> envp;
+                for (std::string &s : env)
+                    envp.push_back(&s[0]);
+                envp.push_back(nullptr);
+                char **savedEnviron = environ;
+                environ = envp.data();
+                SmallVector<const char *, 32> argv;
+                for (const std::string &s : args)
+                    argv.push_back(s.c_str());
+                cache.beginRequest();
+                status = compile(argv, OS, cache);
+                environ = savedEnviron; // `env` is freed below
+                // the next request may name a directory relative to the server's, or the client's may be removed
+                if (::chdir(savedCwd.c_str()))
+                    warning("xcc server: cannot change directory back to %R: %o", StringRef(savedCwd), errno);
+            }
+        }
+        const int32_t exitStatus = status;
+        writeFrame(client, 'X', StringRef(reinterpret_cast<const char *>(&exitStatus), sizeof(exitStatus)));
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalTime += ms;
+        ++numRequests;
+        llvm::errs() << llvm::format("xcc server: request %u: exit %d, %.3f ms (average %.3f ms)\n",
+                                     numRequests, status, ms, totalTime / numRequests);
+    }
+};
+
+// forward the command line, the working directory and the environment to the server at `path`, and print its diagnostics.
+// returns the exit status of the compilation.
+static int runCompileClient(DiagnosticHelper &Diags, StringRef path, ArrayRef<const char *> argv) {
+    struct sockaddr_un addr;
+    if (!CompileServer::makeAddress(path, addr))
+        return Diags.error("socket path is too long: %R", path), CC_EXIT_FAILURE;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return Diags.error("socket: %o", errno), CC_EXIT_FAILURE;
+    if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr))) {
+        Diags.error("cannot connect to the compile server at %R: %o (start one with 'xcc --server')", path, errno);
+        ::close(fd);
+        return CC_EXIT_FAILURE;
+    }
+    // the request carries the environment: send it only to a server of the same user
+    uid_t uid;
+    if (!CompileServer::getPeerUid(fd, uid) || uid != ::geteuid()) {
+        Diags.error("the compile server at %R is not run by the current user", path);
+        ::close(fd);
+        return CC_EXIT_FAILURE;
+    }
+    SmallString<256> cwd;
+    llvm::sys::fs::current_path(cwd);
+    SmallVector<const char *, 64> env;
+    for (char **p = environ; *p; ++p)
+        env.push_back(*p);
+    if (!CompileServer::writeStrings(fd, argv) || !CompileServer::writeString(fd, cwd) || !CompileServer::writeStrings(fd, env)) {
+        Diags.error("cannot send the request to the compile server: %o", errno);
+        ::close(fd);
+        return CC_EXIT_FAILURE;
+    }
+    std::string data;
+    for (char kind; CompileServer::readAll(fd, &kind, 1) && CompileServer::readString(fd, data);) {
+        if (kind == 'X' && data.size() == sizeof(int32_t)) {
+            int32_t status;
+            memcpy(&status, data.data(), sizeof(status));
+            ::close(fd);
+            return status;
+        }
+        if (kind == 'E')
+            llvm::errs() << data;
+    }
+    ::close(fd);
+    Diags.error("the compile server closed the connection without an exit status");
+    return CC_EXIT_FAILURE;
+}
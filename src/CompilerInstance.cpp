@@ -13,7 +13,8 @@ struct CompilerInstance
         delete Target;
 #endif
         delete codegen;
-        delete engine;
+        if (ownsDiags)
+            delete engine;
         delete llvm_context;
         delete options;
     }
@@ -28,6 +29,7 @@ struct CompilerInstance
     struct IRGen *codegen = nullptr;
     LLVMContext *llvm_context = nullptr;
     Options *options = nullptr;
+    bool ownsDiags = true;
 
     void addPrinter(struct DiagnosticConsumer *C) {
         createDiags().addConsumer(C);
@@ -101,6 +103,18 @@ struct CompilerInstance
     std::unique_ptr<llvm::Module> CodeGen(const TranslationUnit &TU) {
         return codegen->run(TU);
     }
+    // Delete the parser, the code generator and the LLVMContext(with all its modules).
+    // The SourceMgr and xcc_context are kept, so diagnostics of this instance can still be printed.
+    void releaseCodeGen() {
+        delete parser;
+        delete codegen;
+        delete type_cache;
+        delete llvm_context;
+        parser = nullptr;
+        codegen = nullptr;
+        type_cache = nullptr;
+        llvm_context = nullptr;
+    }
     // Parse a TranslationUnit and emit LLVM IR.
     std::unique_ptr<llvm::Module> ParseAndCodeGen() {
         TranslationUnit TU;
@@ -216,8 +230,14 @@ struct CompilerInstance
         return *engine;
     }
     void setDiags(struct DiagnosticsEngine &TheEngine) {
-        if (engine) delete engine;
+        if (engine && ownsDiags) delete engine;
         engine = &TheEngine;
+        ownsDiags = true;
+    }
+    // use an engine shared with other CompilerInstances, it is not deleted by this instance
+    void setSharedDiags(struct DiagnosticsEngine &TheEngine) {
+        setDiags(TheEngine);
+        ownsDiags = false;
     }
 
     bool hasLLVMContext() const {
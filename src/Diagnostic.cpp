@@ -186,6 +186,8 @@ struct DiagnosticConsumer {
     unsigned getNumWarnings() const { return NumWarnings; }
     virtual void clear() { NumWarnings = NumErrors = 0; }
     virtual void finalize() {}
+    // the SourceMgr that resolves the locations of the following diagnostics
+    virtual void setSourceMgr(struct SourceMgr *SM) {}
     virtual void HandleDiagnostic(const Diagnostic &Diag) {
         if (Diag.level == Warning)
             ++NumWarnings;
@@ -206,7 +208,10 @@ struct TextDiagnosticPrinter : public DiagnosticConsumer {
         :OS{OS}, ShowColors{OS.has_colors()}, SM{SM} { }
     void HandleDiagnostic(const Diagnostic &Info) override;
     bool hasSourceMgr() const { return SM != nullptr; }
-    void setSourceMgr(struct SourceMgr *SM) { this->SM = SM; }
+    void setSourceMgr(struct SourceMgr *SM) override { this->SM = SM; }
+    // write diagnostics to `OS` in large chunks instead of one write per piece.
+    // the buffer is flushed after fatal errors and in finalize().
+    void setBuffered(size_t Size = 64 * 1024) { OS.SetBufferSize(Size); }
     virtual void finalize() override {
         if (NumWarnings)
             OS << NumWarnings << (NumWarnings == 1 ? " warning" : " warnings");
@@ -217,6 +222,7 @@ struct TextDiagnosticPrinter : public DiagnosticConsumer {
         if (NumWarnings || NumErrors) {
             OS << " generated.\n";
         }
+        OS.flush();
     }
     void printSource(source_location &loc, const ArrayRef<FixItHint> FixItHints);
     void write_loc(const source_location &loc, const struct IncludeFile *file);
@@ -299,39 +305,280 @@ struct DiagnosticsStore: public DiagnosticConsumer {
     void FlushDiagnostics(struct DiagnosticsEngine &) const;
     void FlushDiagnostics(DiagnosticConsumer &) const;
 };
+// how repeated diagnostics are merged
+enum DiagnosticDedupKind : uint8_t {
+    Dedup_None,
+    Dedup_Location, // drop a diagnostic with the same message format and location as an earlier one
+    Dedup_Message   // also drop a diagnostic whose formatted message was already emitted at another location
+};
+// The diagnostics of one job in concurrent mode(see DiagnosticsEngine::JobScope).
+// Only the thread running the job writes to its queue, so emitting a diagnostic takes no lock.
+struct DiagnosticQueue {
+    struct Entry {
+        Diagnostic Diag; // the arguments may not outlive the job, so they are formatted into `message`
+        std::string message;
+        const char *fmt; // the format of the original diagnostic, the key of deduplication and of the summary
+        uint32_t group; // the index of the diagnostic that this note belongs to(or its own index)
+    };
+    const struct DiagnosticsEngine *owner = nullptr;
+    unsigned job = 0;
+    struct SourceMgr *SM = nullptr; // the SourceMgr of the job, must be alive until the queue is flushed
+    std::vector<Entry> entries;
+    Diagnostic CurrentDiagnostic;
+    unsigned NumErrors = 0, NumWarnings = 0;
+    void push(const Diagnostic &Diag) {
+        SmallString<128> Str;
+        Diag.FormatDiagnostic(Str);
+        const uint32_t index = entries.size();
+        entries.push_back(Entry{.Diag = Diagnostic("%r", Diag.loc),
+                                .message = std::string(Str.str()),
+                                .fmt = Diag.fmt,
+                                .group = (Diag.level == Note && index) ? entries.back().group : index});
+        Diagnostic &D = entries.back().Diag;
+        D.level = Diag.level;
+        D.ranges = Diag.ranges;
+        D.FixItHints = Diag.FixItHints;
+        if (Diag.level == Warning)
+            ++NumWarnings;
+        else if (Diag.level >= Error)
+            ++NumErrors;
+    }
+};
+static thread_local DiagnosticQueue *CurrentDiagnosticQueue = nullptr;
 struct DiagnosticsEngine {
-    unsigned ErrorLimit = 0;
+    unsigned ErrorLimit = 0; // stop emitting errors after this many errors, 0 means no limit
+    unsigned WarningLimit = 0; // stop emitting warnings after this many warnings, 0 means no limit
+    enum DiagnosticDedupKind Dedup = Dedup_Location;
+    bool SummaryMode = false; // emit each kind of warning once, and the number of repeats in finalize()
     Diagnostic CurrentDiagnostic;
     SmallVector<DiagnosticConsumer *, 2> consumers;
+private:
+    unsigned NumEmittedErrors = 0, NumEmittedWarnings = 0;
+    unsigned NumSuppressedErrors = 0, NumSuppressedWarnings = 0;
+    bool ErrorLimitReached = false, WarningLimitReached = false;
+    bool LastSuppressed = false; // notes are emitted(or suppressed) with the diagnostic they belong to
+    static constexpr unsigned NoJob = ~0U; // diagnostics emitted outside of a job
+    // (format, job) and location: jobs may have their own SourceMgr, so equal locations of different jobs are unrelated
+    llvm::DenseSet<std::pair<std::pair<const char *, unsigned>, location_t>> SeenLocations;
+    llvm::StringSet<> SeenMessages;
+    struct RepeatedWarning {
+        std::string message; // the first one
+        unsigned repeats;
+    };
+    DenseMap<const char *, unsigned> SummaryIndex; // format string => index in Summary
+    SmallVector<RepeatedWarning, 0> Summary;
+    std::mutex QueueLock; // guards `queues`: taken when a job starts and when the queues are flushed
+    std::deque<DiagnosticQueue> queues;
+    std::atomic<unsigned> NumQueuedErrors{0}, NumQueuedWarnings{0};
+
+    DiagnosticQueue *getQueue() const {
+        DiagnosticQueue *Q = CurrentDiagnosticQueue;
+        return (Q && Q->owner == this) ? Q : nullptr;
+    }
+
+    // `fmt` is the format of the diagnostic as it was emitted(queued diagnostics are re-formatted with "%r")
+    bool isSuppressed(const Diagnostic &Diag, const char *fmt, unsigned job) {
+        const bool isError = Diag.level >= Error && Diag.level != Fatal;
+        const bool isWarning = Diag.level == Warning;
+        if ((isError && ErrorLimitReached) || (isWarning && WarningLimitReached))
+            return true;
+        if (Dedup != Dedup_None && Diag.loc && !SeenLocations.insert({{fmt, job}, Diag.loc}).second)
+            return true;
+        if (Dedup == Dedup_Message) {
+            SmallString<128> Str;
+            Diag.FormatDiagnostic(Str);
+            if (!SeenMessages.insert(Str).second)
+                return true;
+        }
+        if (SummaryMode && isWarning) {
+            auto it = SummaryIndex.try_emplace(fmt, Summary.size());
+            if (!it.second)
+                return ++Summary[it.first->second].repeats, true;
+            SmallString<128> Str;
+            Diag.FormatDiagnostic(Str);
+            Summary.push_back(RepeatedWarning{.message = std::string(Str.str()), .repeats = 0});
+        }
+        return false;
+    }
+    // diagnostics from the engine itself are not filtered
+    void EmitUnfiltered(enum DiagnosticLevel level, const char *fmt) {
+        Diagnostic Diag(fmt);
+        Diag.level = level;
+        for (const auto C : consumers)
+            C->HandleDiagnostic(Diag);
+    }
+public:
+    // while alive, diagnostics from the current thread go to a queue of job `job` instead of the consumers.
+    // flushJobs() emits the queues ordered by job and then by location, so the output does not depend on scheduling.
+    struct JobScope {
+        DiagnosticQueue *saved;
+        JobScope(DiagnosticsEngine &engine, unsigned job, struct SourceMgr *SM = nullptr) : saved{CurrentDiagnosticQueue} {
+            std::lock_guard<std::mutex> lock(engine.QueueLock);
+            DiagnosticQueue &Q = engine.queues.emplace_back();
+            Q.owner = &engine;
+            Q.job = job;
+            Q.SM = SM;
+            CurrentDiagnosticQueue = &Q;
+        }
+        JobScope(const JobScope &) = delete;
+        ~JobScope() { CurrentDiagnosticQueue = saved; }
+    };
+    // the diagnostic being built by the current thread
+    Diagnostic &getCurrentDiagnostic() {
+        if (DiagnosticQueue *Q = getQueue())
+            return Q->CurrentDiagnostic;
+        return CurrentDiagnostic;
+    }
+    // emit the queued diagnostics of all jobs, must not run concurrently with any job
+    void flushJobs() {
+        assert(!getQueue() && "flushJobs() called inside a job");
+        std::lock_guard<std::mutex> lock(QueueLock);
+        // a diagnostic and its notes
+        struct Group {
+            const DiagnosticQueue *Q;
+            uint32_t first, last;
+            const Diagnostic &getDiag() const { return Q->entries[first].Diag; }
+            StringRef getMessage() const { return Q->entries[first].message; }
+        };
+        SmallVector<Group, 0> groups;
+        for (DiagnosticQueue &Q : queues) {
+            for (uint32_t i = 0; i < Q.entries.size(); ++i) {
+                DiagnosticQueue::Entry &E = Q.entries[i];
+                E.Diag.write(StringRef(E.message));
+                if (E.group == i)
+                    groups.push_back(Group{.Q = &Q, .first = i, .last = i + 1});
+                else
+                    groups.back().last = i + 1;
+            }
+        }
+        // a job may have several queues(one per JobScope), so equal locations are ordered by content
+        llvm::sort(groups, [](const Group &a, const Group &b) {
+            if (a.Q->job != b.Q->job)
+                return a.Q->job < b.Q->job;
+            if (a.getDiag().loc != b.getDiag().loc)
+                return a.getDiag().loc < b.getDiag().loc;
+            if (a.getDiag().level != b.getDiag().level)
+                return a.getDiag().level < b.getDiag().level;
+            return a.getMessage() < b.getMessage();
+        });
+        // jobs with their own SourceMgr switch the consumers to it
+        struct SourceMgr *SM = nullptr;
+        for (const Group &G : groups) {
+            if (G.Q->SM && G.Q->SM != SM) {
+                SM = G.Q->SM;
+                for (DiagnosticConsumer *C : consumers)
+                    C->setSourceMgr(SM);
+            }
+            for (uint32_t i = G.first; i < G.last; ++i)
+                EmitFiltered(G.Q->entries[i].Diag, G.Q->entries[i].fmt, G.Q->job);
+        }
+        queues.clear();
+        NumQueuedErrors.store(0, std::memory_order_relaxed);
+        NumQueuedWarnings.store(0, std::memory_order_relaxed);
+    }
     void addConsumer(DiagnosticConsumer *C) { consumers.push_back(C); }
     unsigned getNumConsumers() { return consumers.size(); }
     DiagnosticConsumer *getFirstConsumer() { return consumers.front(); }
     DiagnosticConsumer *getLastConsumer() { return consumers.back(); }
+    // checked by the Lexer, which stops reading tokens then
+    bool hasErrorLimitReached() const { return ErrorLimitReached; }
     void Emit(const Diagnostic &Diag) {
+        if (DiagnosticQueue *Q = getQueue()) {
+            Q->push(Diag);
+            if (Diag.level == Warning)
+                NumQueuedWarnings.fetch_add(1, std::memory_order_relaxed);
+            else if (Diag.level >= Error)
+                NumQueuedErrors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EmitFiltered(Diag, Diag.fmt, NoJob);
+    }
+    // send `Diag` to the consumers unless the limits, the deduplication or the summary mode suppress it
+    void EmitFiltered(const Diagnostic &Diag, const char *fmt, unsigned job) {
+        if (Diag.level == Note) {
+            if (LastSuppressed)
+                return;
+        } else if ((LastSuppressed = isSuppressed(Diag, fmt, job))) {
+            if (Diag.level == Warning)
+                ++NumSuppressedWarnings;
+            else if (Diag.level >= Error)
+                ++NumSuppressedErrors;
+            return;
+        }
         for (const auto C : consumers)
             C->HandleDiagnostic(Diag);
+        if (Diag.level == Warning) {
+            if (WarningLimit && ++NumEmittedWarnings == WarningLimit) {
+                WarningLimitReached = true;
+                EmitUnfiltered(Note, "too many warnings emitted, suppressing the rest [-fwarning-limit=]");
+            }
+        } else if (Diag.level >= Error && Diag.level != Fatal) {
+            if (ErrorLimit && ++NumEmittedErrors == ErrorLimit) {
+                ErrorLimitReached = true;
+                EmitUnfiltered(Fatal, "too many errors emitted, stopping now [-ferror-limit=]");
+            }
+        }
     }
     void EmitCurrentDiagnostic() {
-        return Emit(CurrentDiagnostic);
+        return Emit(getCurrentDiagnostic());
     }
     void operator <<(const Diagnostic &Diag) {
         Emit(Diag);
     }
+    // inside a job: the warnings of the job, otherwise: all warnings(including queued ones)
     unsigned getNumWarnings() const {
-        unsigned total = 0;
+        if (const DiagnosticQueue *Q = getQueue())
+            return Q->NumWarnings;
+        unsigned total = NumQueuedWarnings.load(std::memory_order_relaxed);
         for (const DiagnosticConsumer *C : consumers)
             total += C->getNumWarnings();
         return total;
     }
+    // inside a job: the errors of the job, otherwise: all errors(including queued ones)
     unsigned getNumErrors() const {
-        unsigned total = 0;
+        if (const DiagnosticQueue *Q = getQueue())
+            return Q->NumErrors;
+        unsigned total = NumQueuedErrors.load(std::memory_order_relaxed);
         for (const DiagnosticConsumer *C : consumers)
             total += C->getNumErrors();
         return total;
     }
+    unsigned getNumSuppressedWarnings() const { return NumSuppressedWarnings; }
+    unsigned getNumSuppressedErrors() const { return NumSuppressedErrors; }
+    // report the repeated and suppressed diagnostics, then finalize the consumers
+    void finalize() {
+        if (!queues.empty())
+            flushJobs();
+        for (const RepeatedWarning &W : Summary) {
+            if (W.repeats) {
+                CurrentDiagnostic.reset("warning %R repeated %u more times", Note);
+                CurrentDiagnostic.write(StringRef(W.message), W.repeats);
+                for (const auto C : consumers)
+                    C->HandleDiagnostic(CurrentDiagnostic);
+            }
+        }
+        if (NumSuppressedWarnings || NumSuppressedErrors) {
+            CurrentDiagnostic.reset("%u warnings and %u errors were not shown", Note);
+            CurrentDiagnostic.write(NumSuppressedWarnings, NumSuppressedErrors);
+            for (const auto C : consumers)
+                C->HandleDiagnostic(CurrentDiagnostic);
+        }
+        for (DiagnosticConsumer *C : consumers)
+            C->finalize();
+    }
     void reset() {
         for (DiagnosticConsumer *C : consumers)
             C->clear();
+        NumEmittedErrors = NumEmittedWarnings = NumSuppressedErrors = NumSuppressedWarnings = 0;
+        ErrorLimitReached = WarningLimitReached = LastSuppressed = false;
+        SeenLocations.clear();
+        SeenMessages.clear();
+        SummaryIndex.clear();
+        Summary.clear();
+        std::lock_guard<std::mutex> lock(QueueLock);
+        queues.clear();
+        NumQueuedErrors.store(0, std::memory_order_relaxed);
+        NumQueuedWarnings.store(0, std::memory_order_relaxed);
     }
 };
 struct DiagnosticBuilder {
@@ -350,11 +597,11 @@ struct DiagnosticBuilder {
         }
     }
     template <typename T> const DiagnosticBuilder &operator<<(const T &V) const {
-        engine.CurrentDiagnostic.write_impl(V);
+        engine.getCurrentDiagnostic().write_impl(V);
         return *this;
     }
     void setLoc(location_t loc) {
-        engine.CurrentDiagnostic.loc = loc;
+        engine.getCurrentDiagnostic().loc = loc;
     }
 };
 // A helper class to emit Diagnostics
@@ -367,22 +614,22 @@ struct DiagnosticHelper {
     unsigned getNumWarnings() const { return engine.getNumWarnings(); }
 #define DIAGNOSTIC_HANDLER(HANDLER, LEVEL)                                                                             \
     template <typename... Args> [[maybe_unused]] DiagnosticBuilder HANDLER(const char *msg, const Args &...args) {     \
-        engine.CurrentDiagnostic.reset(msg, LEVEL);                                                                    \
-        engine.CurrentDiagnostic.write(args...);                                                                       \
+        engine.getCurrentDiagnostic().reset(msg, LEVEL);                                                               \
+        engine.getCurrentDiagnostic().write(args...);                                                                  \
         return DiagnosticBuilder(engine);                                                                              \
     }                                                                                                                  \
     [[maybe_unused]] DiagnosticBuilder HANDLER(const char *msg) {                                                      \
-        engine.CurrentDiagnostic.reset(msg, LEVEL);                                                                    \
+        engine.getCurrentDiagnostic().reset(msg, LEVEL);                                                               \
         return DiagnosticBuilder(engine);                                                                              \
     }                                                                                                                  \
     template <typename... Args>                                                                                        \
     [[maybe_unused]] DiagnosticBuilder HANDLER(location_t loc, const char *msg, const Args &...args) {                 \
-        engine.CurrentDiagnostic.reset(msg, LEVEL, loc);                                                               \
-        engine.CurrentDiagnostic.write(args...);                                                                       \
+        engine.getCurrentDiagnostic().reset(msg, LEVEL, loc);                                                          \
+        engine.getCurrentDiagnostic().write(args...);                                                                  \
         return DiagnosticBuilder(engine);                                                                              \
     }                                                                                                                  \
     template <typename... Args> [[maybe_unused]] DiagnosticBuilder HANDLER(location_t loc, const char *msg) {          \
-        engine.CurrentDiagnostic.reset(msg, LEVEL, loc);                                                               \
+        engine.getCurrentDiagnostic().reset(msg, LEVEL, loc);                                                          \
         return DiagnosticBuilder(engine);                                                                              \
     }
     DIAGNOSTIC_HANDLER(note, Note)
@@ -403,40 +650,42 @@ struct DiagnosticHelper {
 struct EvalHelper : public DiagnosticHelper {
     EvalHelper(DiagnosticsEngine &engine) : DiagnosticHelper{engine} { }
     EvalHelper(const DiagnosticHelper &other): DiagnosticHelper{other} {}
+    // return the value of an integer constant expression, or nullptr if `e` is not an integer constant
+    [[nodiscard]] static const APInt *getIntegerConstant(const_Expr e) {
+        if (e->k != EConstant)
+            return nullptr;
+        if (const auto CI = dyn_cast<IntConstant>(e->C))
+            return &CI->getValue();
+        return nullptr;
+    }
+    [[nodiscard]] uint64_t getLimitedValue(Expr e, const APInt &V) {
+        if (V.getActiveBits() > 64)
+            warning(e->getBeginLoc(), "integer constant expression larger exceeds 64 bit, the result is truncated")
+                << e->getSourceRange();
+        return V.getLimitedValue();
+    }
     [[nodiscard]] uint64_t force_eval(Expr e) {
         if (e->k != EConstant) {
             type_error(e->getBeginLoc(), "not a constant expression: %E", e) << e->getSourceRange();
             return 0;
         }
-        if (const auto CI = dyn_cast<ConstantInt>(e->C)) {
-            if (CI->getValue().getActiveBits() > 64)
-                warning(e->getBeginLoc(), "integer constant expression larger exceeds 64 bit, the result is truncated")
-                    << e->getSourceRange();
-            return CI->getValue().getLimitedValue();
-        }
+        if (const APInt *V = getIntegerConstant(e))
+            return getLimitedValue(e, *V);
         type_error(e->getBeginLoc(), "expect integer constant expression") << e->getSourceRange();
         return 0;
     }
     [[nodiscard]] uint64_t try_eval(Expr e, bool &ok) {
-        if (e->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(e->C)) {
-                if (CI->getValue().getActiveBits() > 64)
-                    warning(e->getBeginLoc(),
-                            "integer constant expression larger exceeds 64 bit, the result is truncated")
-                        << e->getSourceRange();
-                ok = true;
-                return CI->getValue().getLimitedValue();
-            }
+        if (const APInt *V = getIntegerConstant(e)) {
+            ok = true;
+            return getLimitedValue(e, *V);
         }
         ok = false;
         return 0;
     }
     [[nodiscard]] bool try_eval_as_bool(Expr e, bool &res) {
-        if (e->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(e->C)) {
-                res = !CI->isZero();
-                return true;
-            }
+        if (const APInt *V = getIntegerConstant(e)) {
+            res = !V->isZero();
+            return true;
         }
         return false;
     }
@@ -454,7 +703,7 @@ void DiagnosticsStore::FlushDiagnostics(DiagnosticConsumer &C) const {
 void
 TextDiagnosticBuffer::FlushDiagnostics(struct DiagnosticsEngine &engine) const {
     for (const auto &I: All) {
-        engine.CurrentDiagnostic.reset("%R", I.first);
+        engine.getCurrentDiagnostic().reset("%R", I.first);
         DiagnosticBuilder Diag = DiagnosticBuilder(engine);
         switch (I.second) {
             default:
@@ -285,6 +285,7 @@ bool HandleImmediateArgs() {
   }
 
   if (getArgs().hasArg(options::OPT_print_targets)) {
+    initializeLLVMTargetInfos();
     llvm::TargetRegistry::printRegisteredTargetsForVersion(llvm::outs());
     return false;
   }
@@ -293,17 +294,23 @@ bool HandleImmediateArgs() {
 }
 bool BuildInputs(SourceMgr &SM, Options &opts) {
   for (Arg *A : getArgs()) {
-    if (A->getOption().getKind() == Option::InputClass) { 
-      const char *Value = A->getValue();
-      if (Value[0] == '-' && Value[1] == '\0') {
-        SM.addStdin();
-      } else {
-        SM.addFile(Value);
-      }
-    }
+    if (A->getOption().getKind() == Option::InputClass)
+      opts.inputFiles.push_back(A->getValue());
   }
-  if (SM.empty())
+  if (opts.inputFiles.empty())
     return fatal("no input files"), true;
+  // each input of a multi-file compilation gets its own SourceMgr(see ParallelCompilation)
+  if (opts.inputFiles.size() > 1) {
+    if (llvm::is_contained(opts.inputFiles, "-"))
+      return fatal("'-' (stdin) cannot be combined with other input files"), true;
+    return false;
+  }
+  if (opts.inputFiles.front() == "-")
+    SM.addStdin();
+  else
+    SM.addFile(opts.inputFiles.front());
+  if (SM.empty())
+    return true;
   opts.mainFileName = SM.getMainFileName();
   return false;
 }
@@ -378,6 +385,36 @@ unsigned getOptimizationLevelSize() {
   }
   return 0;
 }
+// clang::driver::tools::shouldEnableVectorizerAtOLevel
+bool shouldEnableVectorizerAtOLevel(bool isSlpVec) {
+  if (Arg *A = getArgs().getLastArg(options::OPT_O_Group)) {
+    if (A->getOption().matches(options::OPT_O4) ||
+        A->getOption().matches(options::OPT_Ofast))
+      return true;
+
+    if (A->getOption().matches(options::OPT_O0))
+      return false;
+
+    assert(A->getOption().matches(options::OPT_O));
+
+    // Vectorize -Os.
+    StringRef S(A->getValue());
+    if (S == "s")
+      return true;
+
+    // Don't vectorize -Oz, unless it's the slp vectorizer.
+    if (S == "z")
+      return isSlpVec;
+
+    unsigned OptLevel = 0;
+    if (S.getAsInteger(10, OptLevel))
+      return false;
+
+    return OptLevel > 1;
+  }
+
+  return false;
+}
 llvm::Optional<llvm::CodeModel::Model>
 getCodeModel() {
   if (Arg *A = getArgs().getLastArg(OPT_mcmodel_EQ)) {
@@ -399,6 +436,31 @@ getCodeModel() {
     }
   return llvm::None;
 }
+// -target-cpu, -mcpu=, or -march= on x86
+Arg *getTargetCPUArg(const llvm::Triple &T) {
+  const ArgList &Args = getArgs();
+  return T.isX86() ? Args.getLastArg(OPT_target_cpu, OPT_mcpu_EQ, OPT_march_EQ)
+                   : Args.getLastArg(OPT_target_cpu, OPT_mcpu_EQ);
+}
+// "native" is the CPU of the host
+std::string getCPUName(Arg *A, StringRef Default) {
+  if (!A)
+    return Default.str();
+  StringRef CPU = A->getValue();
+  return CPU == "native" ? llvm::sys::getHostCPUName().str() : CPU.str();
+}
+// the features of the host CPU for -march=native, then -target-feature +avx2 ...
+std::string getTargetFeatures(const llvm::Triple &T) {
+  std::vector<std::string> Features;
+  llvm::StringMap<bool> HostFeatures;
+  Arg *A = getTargetCPUArg(T);
+  if (A && StringRef(A->getValue()) == "native" && llvm::sys::getHostCPUFeatures(HostFeatures))
+    for (const auto &it : HostFeatures)
+      Features.push_back((it.second ? "+" : "-") + it.first().str());
+  for (const std::string &F : getArgs().getAllArgValues(OPT_target_feature))
+    Features.push_back(F);
+  return llvm::join(Features, ",");
+}
 bool BuildCompilation(ArrayRef<const char *> Args, Options &opts, SourceMgr &SM, int &ret) {
   bool should_exit = false;
   ParseArgStrings(Args.slice(1), should_exit);
@@ -410,21 +472,47 @@ bool BuildCompilation(ArrayRef<const char *> Args, Options &opts, SourceMgr &SM,
   opts.trigraphs = getArgs().hasArg(OPT_ftrigraphs);
   opts.triple = computeTargetTriple(*this, TargetTriple, getArgs());
 
-  opts.VectorizeLoop = getArgs().hasArg(OPT_vectorize_loops);
-  opts.VectorizeSLP = getArgs().hasArg(OPT_vectorize_slp);
+  // like the clang driver: -fvectorize and -fslp-vectorize default on from -O2 (and -Os)
+  opts.VectorizeLoop = getArgs().hasArg(OPT_vectorize_loops) ||
+                       getArgs().hasFlag(OPT_fvectorize, OPT_fno_vectorize, shouldEnableVectorizerAtOLevel(false));
+  opts.VectorizeSLP = getArgs().hasArg(OPT_vectorize_slp) ||
+                      getArgs().hasFlag(OPT_fslp_vectorize, OPT_fno_slp_vectorize, shouldEnableVectorizerAtOLevel(true));
   opts.OptimizationLevel = getOptimizationLevel();
   opts.DisableIntegratedAS = getArgs().hasArg(OPT_fno_integrated_as);
   opts.UnrollLoops = getArgs().hasFlag(OPT_funroll_loops, OPT_fno_unroll_loops, (opts.OptimizationLevel > 1));
   opts.RerollLoops = getArgs().hasArg(OPT_freroll_loops);
+  opts.StrictAliasing = getArgs().hasFlag(OPT_fstrict_aliasing, OPT_fno_strict_aliasing, true);
   opts.OptimizeSize = getOptimizationLevelSize();
   opts.CodeModel = getCodeModel();
+  opts.CPU = getCPUName(getTargetCPUArg(opts.triple), "generic");
+  opts.TuneCPU = getCPUName(getArgs().getLastArg(OPT_tune_cpu, OPT_mtune_EQ), "");
+  opts.Features = getTargetFeatures(opts.triple);
   opts.g = getArgs().hasArg(OPT_g_Flag);
   opts.RelocationModel = getRelocModel();
   opts.PassPlugins = getArgs().getAllArgValues(OPT_fpass_plugin_EQ);
   opts.mainFileName = getArgs().getLastArgValue(OPT_main_file_name);
   opts.VerifyModule = !getArgs().hasArg(OPT_disable_llvm_verifier);
+  opts.DisableLifetimeMarkers = getArgs().hasArg(OPT_disable_lifetimemarkers);
   opts.TimeTrace = getArgs().hasArg(OPT_ftime_trace);
   opts.TimeTraceGranularity = getLastArgIntValue(getArgs(), OPT_ftime_trace_granularity_EQ, 500);
+  opts.SpellCheckingLimit = getArgs().hasFlag(OPT_fspell_checking, OPT_fno_spell_checking, true) ? getLastArgIntValue(getArgs(), OPT_fspell_checking_limit_EQ, 50) : 0;
+  opts.Jobs = getLastArgIntValue(getArgs(), OPT_j, 1u);
+  opts.outputFile = getArgs().getLastArgValue(OPT_o).str();
+  engine.ErrorLimit = getLastArgIntValue(getArgs(), OPT_ferror_limit_EQ, 0);
+  engine.WarningLimit = getLastArgIntValue(getArgs(), OPT_fwarning_limit_EQ, 0);
+  engine.SummaryMode = getArgs().hasArg(OPT_fdiagnostics_summary);
+  if (const Arg *A = getArgs().getLastArg(OPT_fdiagnostics_dedup_EQ)) {
+    StringRef Value = A->getValue();
+    auto Dedup = llvm::StringSwitch<llvm::Optional<DiagnosticDedupKind>>(Value)
+      .Case("none", Dedup_None)
+      .Case("location", Dedup_Location)
+      .Case("message", Dedup_Message)
+      .Default(llvm::None);
+    if (Dedup)
+      engine.Dedup = *Dedup;
+    else
+      error("invalid value %R in %R", Value, A->getAsString(getArgs()));
+  }
   should_exit |= BuildInputs(SM, opts);
   ret = should_exit ? 1 : 0;
   return should_exit;
@@ -433,7 +521,8 @@ void ParseArgStrings(llvm::ArrayRef<const char *> ArgStrings, bool &ContainsErro
   // clang/include/clang/Basic/DiagnosticDriverKinds.td
   ContainsError = false;
   unsigned IncludedFlagsBitmask = 0;
-  unsigned ExcludedFlagsBitmask = 0;
+  // like clang outside of the cl and dxc modes: `-O2` is clang's -O, not an alias of cl's /O2
+  unsigned ExcludedFlagsBitmask = options::CLOption | options::DXCOption | options::CLDXCOption | options::FlangOnlyOption;
   unsigned MissingArgIndex, MissingArgCount;
   inputArgs = std::make_unique<InputArgList>(getOpts().ParseArgs(ArgStrings, MissingArgIndex, MissingArgCount, IncludedFlagsBitmask, ExcludedFlagsBitmask));
   if (MissingArgCount) {
@@ -0,0 +1,148 @@
+/*
+ * InlineAsm.cpp - target knowledge for GNU extended asm
+ *
+ * The constraint letters and register names accepted by each target(mirrors clang's TargetInfo::validateAsmConstraint and
+ * getGCCRegNames), and the classification of constraints used to lower asm operands.
+ * https://gcc.gnu.org/onlinedocs/gcc/Constraints.html
+ */
+
+struct GCCAsmTarget {
+    llvm::Triple::ArchType arch;
+    GCCAsmTarget(const llvm::Triple &triple) : arch{triple.getArch()} {}
+
+    bool isX86() const { return arch == llvm::Triple::x86 || arch == llvm::Triple::x86_64; }
+    bool isAArch64() const { return arch == llvm::Triple::aarch64 || arch == llvm::Triple::aarch64_be; }
+    bool isRISCV() const { return arch == llvm::Triple::riscv32 || arch == llvm::Triple::riscv64; }
+    bool isARM() const {
+        return arch == llvm::Triple::arm || arch == llvm::Triple::armeb || arch == llvm::Triple::thumb ||
+               arch == llvm::Triple::thumbeb;
+    }
+    // the clobbers added to every asm statement(clang's TargetInfo::getClobbers)
+    StringRef getClobbers() const { return isX86() ? "~{dirflag},~{fpsr},~{flags}" : ""; }
+
+    // the target-specific constraint code at C[i], `i` is advanced past multi-letter codes.
+    // returns false if it is not a valid constraint
+    bool validateConstraintCode(StringRef C, size_t &i) const {
+        const char c = C[i];
+        if (isX86()) {
+            if (c == 'Y') {
+                // Yz, Yi, Ym, Yt, Y2, Y0, Yk: a second letter follows
+                if (i + 1 >= C.size() || !StringRef("zimt20k").contains(C[i + 1]))
+                    return false;
+                ++i;
+                return true;
+            }
+            return StringRef("abcdSDAfQqRltuxyvkIJKLMNOGCeZ").contains(c);
+        }
+        if (isAArch64()) {
+            if (c == 'U') {
+                // Upa, Upl, Uph: SVE predicate registers
+                if (i + 2 >= C.size() || C[i + 1] != 'p' || !StringRef("alh").contains(C[i + 2]))
+                    return false;
+                i += 2;
+                return true;
+            }
+            return StringRef("wxyzIJKLMNQSYZ").contains(c);
+        }
+        if (isRISCV()) {
+            if (c == 'v') {
+                // vr, vm: vector registers
+                if (i + 1 >= C.size() || !StringRef("rmd").contains(C[i + 1]))
+                    return false;
+                ++i;
+                return true;
+            }
+            return StringRef("fIJKAS").contains(c);
+        }
+        if (isARM()) {
+            if (c == 'U') {
+                if (i + 1 >= C.size() || !llvm::isAlpha(C[i + 1]))
+                    return false;
+                ++i;
+                return true;
+            }
+            return StringRef("lhtwxIJKLMNOPQTZ").contains(c);
+        }
+        // no table for other targets, any letter is accepted
+        return llvm::isAlpha(c);
+    }
+
+    // a register name in a clobber list or a `{reg}` constraint, without the '%' or '#' prefix
+    static StringRef normalizeRegisterName(StringRef Name) {
+        if (!Name.empty() && (Name.front() == '%' || Name.front() == '#'))
+            Name = Name.drop_front();
+        return Name;
+    }
+    // `Name` is `Prefix` followed by a decimal number less than `N`
+    static bool isNumberedRegister(StringRef Name, StringRef Prefix, unsigned N) {
+        unsigned i;
+        return Name.consume_front(Prefix) && !Name.empty() && !Name.getAsInteger(10, i) && i < N;
+    }
+    bool isValidRegisterName(StringRef Name) const {
+        Name = normalizeRegisterName(Name);
+        if (Name.empty())
+            return false;
+        if (isX86()) {
+            const bool known = llvm::StringSwitch<bool>(Name)
+                                   .Cases("ax", "bx", "cx", "dx", "si", "di", "bp", "sp", true)
+                                   .Cases("eax", "ebx", "ecx", "edx", "esi", "edi", "ebp", "esp", true)
+                                   .Cases("rax", "rbx", "rcx", "rdx", "rsi", "rdi", "rbp", "rsp", true)
+                                   .Cases("al", "ah", "bl", "bh", "cl", "ch", "dl", "dh", true)
+                                   .Cases("sil", "dil", "bpl", "spl", "st", "flags", "fpsr", "fpcr", "dirflag", true)
+                                   .Cases("cs", "ds", "es", "fs", "gs", "ss", "rip", "eip", true)
+                                   .Default(false);
+            if (known)
+                return true;
+            if (Name.startswith("st(") && Name.endswith(")"))
+                return isNumberedRegister(Name.drop_back(), "st(", 8);
+            if (Name.consume_front("r")) {
+                // r8-r15, with the b/w/d suffixes
+                if (!Name.empty() && StringRef("bwd").contains(Name.back()))
+                    Name = Name.drop_back();
+                unsigned i;
+                return !Name.getAsInteger(10, i) && i >= 8 && i < 16;
+            }
+            return isNumberedRegister(Name, "xmm", 32) || isNumberedRegister(Name, "ymm", 32) ||
+                   isNumberedRegister(Name, "zmm", 32) || isNumberedRegister(Name, "mm", 8) ||
+                   isNumberedRegister(Name, "k", 8) || isNumberedRegister(Name, "cr", 16) ||
+                   isNumberedRegister(Name, "dr", 8);
+        }
+        if (isAArch64()) {
+            if (Name == "sp" || Name == "wsp" || Name == "xzr" || Name == "wzr" || Name == "lr" || Name == "fp" ||
+                Name == "nzcv" || Name == "fpsr" || Name == "fpcr" || Name == "ffr")
+                return true;
+            for (StringRef Prefix : {"x", "w"})
+                if (isNumberedRegister(Name, Prefix, 31))
+                    return true;
+            for (StringRef Prefix : {"v", "q", "d", "s", "h", "b", "z"})
+                if (isNumberedRegister(Name, Prefix, 32))
+                    return true;
+            return isNumberedRegister(Name, "p", 16);
+        }
+        if (isRISCV()) {
+            const bool known = llvm::StringSwitch<bool>(Name)
+                                   .Cases("zero", "ra", "sp", "gp", "tp", "fp", true)
+                                   .Cases("vl", "vtype", "vxsat", "vxrm", true)
+                                   .Default(false);
+            return known || isNumberedRegister(Name, "x", 32) || isNumberedRegister(Name, "f", 32) ||
+                   isNumberedRegister(Name, "v", 32) || isNumberedRegister(Name, "t", 7) ||
+                   isNumberedRegister(Name, "s", 12) || isNumberedRegister(Name, "a", 8) ||
+                   isNumberedRegister(Name, "ft", 12) || isNumberedRegister(Name, "fs", 12) ||
+                   isNumberedRegister(Name, "fa", 8);
+        }
+        return true;
+    }
+
+    // the constraint letters of `C` without the modifiers
+    static StringRef getConstraintCodes(StringRef C) { return C.ltrim("=+&%*"); }
+    // the operand can only be in memory, it is passed by address(an indirect operand in LLVM)
+    static bool isMemoryOnly(StringRef C) {
+        C = getConstraintCodes(C);
+        if (C.empty())
+            return false;
+        for (char c : C)
+            if (!StringRef("moV<>").contains(c) && c != ',')
+                return false;
+        return true;
+    }
+};
@@ -45,14 +45,44 @@ struct LLVMTypeConsumer
     llvm::ConstantInt *i1_0, *i1_1;
     llvm::PointerType *AllocaTy;
     const Options &options;
-    
+    // lowered type, size and alignment of records and arrays.
+    // `sizeof`, `_Alignof`, pointer arithmetic and initializers ask for the same types over and over,
+    // and each DataLayout query (or llvm::ArrayType::get()) is a hash table lookup in LLVM.
+    struct TypeLayout {
+        llvm::Type *type;
+        uint64_t size;
+        uint64_t align;
+        // the alignment every object of the type has, without the preferred alignment of declarations
+        uint64_t abi_align;
+        // the array size this entry is computed for: incomplete arrays are completed in place
+        uint64_t arrsize;
+        // for records, computed on the first getFieldOffset()
+        const llvm::StructLayout *SL;
+    };
+    SmallVector<TypeLayout, 0> tag_layouts; // indexed by tag idx, like `tags`
+    // field index => element index of records with padding before over-aligned members(see handleDecl),
+    // other records have one element per field
+    DenseMap<llvm::Type *, SmallVector<unsigned, 0>> element_indexes;
+    DenseMap<const_CType, TypeLayout> array_layouts;
+    uint64_t pointerSize, pointerAlign;
+
     uint64_t getsizeof(llvm::Type *ty) { return options.DL.getTypeStoreSize(ty); }
     uint64_t getsizeof(CType ty) {
         assert((!ty->isVLA()) && "VLA should handled in other case");
         type_tag_t Align = ty->getAlignLog2Value();
         if (Align)
             return uint64_t(1) << Align;
-        if (ty->isVoid() || ty->getKind() == TYFUNCTION)
+        switch (ty->getKind()) {
+        case TYPOINTER: return pointerSize;
+        case TYARRAY: return getArrayLayout(ty).size;
+        case TYTAG:
+            if (!ty->isEnum())
+                return getTagLayout(ty).size;
+            break;
+        case TYFUNCTION: return 1;
+        default: break;
+        }
+        if (ty->isVoid())
             return 1;
         return getsizeof(wrap(ty));
     }
@@ -62,8 +92,80 @@ struct LLVMTypeConsumer
         type_tag_t Align = ty->getAlignLog2Value();
         if (Align)
             return uint64_t(1) << Align;
+        switch (ty->getKind()) {
+        case TYPOINTER: return pointerAlign;
+        case TYARRAY: return getArrayLayout(ty).align;
+        case TYTAG:
+            if (!ty->isEnum())
+                return getTagLayout(ty).align;
+            break;
+        default: break;
+        }
         return getAlignof(wrap(ty));
     }
+    // the alignment that a pointer to `ty` can assume: getAlignof() is the alignment xcc gives to its own declarations
+    uint64_t getABIAlignof(CType ty) {
+        type_tag_t Align = ty->getAlignLog2Value();
+        if (Align)
+            return uint64_t(1) << Align;
+        switch (ty->getKind()) {
+        case TYARRAY: return getArrayLayout(ty).abi_align;
+        case TYTAG:
+            if (!ty->isEnum())
+                return getTagLayout(ty).abi_align;
+            break;
+        default: break;
+        }
+        return options.DL.getABITypeAlign(wrap(ty)).value();
+    }
+    // the offset in bytes of the idx-th field of a struct
+    uint64_t getFieldOffset(CType ty, unsigned idx) {
+        assert(ty->getKind() == TYTAG && !ty->isEnum());
+        TypeLayout &L = getTagLayout(ty);
+        if (!L.SL)
+            L.SL = options.DL.getStructLayout(cast<llvm::StructType>(L.type));
+        return L.SL->getElementOffset(getElementIndex(L.type, idx));
+    }
+    // the element of the struct type `T` that holds the idx-th field
+    unsigned getElementIndex(llvm::Type *T, unsigned idx) {
+        auto it = element_indexes.find(T);
+        return it == element_indexes.end() ? idx : it->second[idx];
+    }
+    // map a path of field(and array) indexes starting at `T` to element indexes, in place
+    void getElementIndexes(llvm::Type *T, MutableArrayRef<unsigned> idxs) {
+        for (unsigned &idx : idxs) {
+            if (T->isStructTy()) {
+                idx = getElementIndex(T, idx);
+                T = T->getStructElementType(idx);
+            } else {
+                T = T->getArrayElementType();
+            }
+        }
+    }
+    TypeLayout &getTagLayout(const_CType ty) {
+        TypeLayout &L = tag_layouts[ty->idx];
+        if (LLVM_UNLIKELY(!L.type)) {
+            llvm::Type *T = tags[ty->idx];
+            assert(T->isSized() && "layout of an incomplete record");
+            // handleDecl() stores the alignment from aligned(N) and over-aligned members
+            const uint64_t align = std::max(getAlignof(T), L.align);
+            const uint64_t abi_align = std::max<uint64_t>(options.DL.getABITypeAlign(T).value(), L.align);
+            L = TypeLayout{.type = T, .size = getsizeof(T), .align = align, .abi_align = abi_align, .arrsize = 0, .SL = nullptr};
+        }
+        return L;
+    }
+    TypeLayout &getArrayLayout(CType ty) {
+        assert(ty->getKind() == TYARRAY);
+        auto it = array_layouts.find(ty);
+        if (it != array_layouts.end() && it->second.arrsize == ty->arrsize)
+            return it->second;
+        // wrap() of a nested array computes its layout too, which may grow `array_layouts`: insert after it
+        llvm::Type *T = llvm::ArrayType::get(wrap(ty->arrtype), ty->arrsize);
+        const uint64_t abi_align = getABIAlignof(ty->arrtype);
+        TypeLayout &L = array_layouts[ty];
+        L = TypeLayout{.type = T, .size = getsizeof(T), .align = std::max(getAlignof(T), getAlignof(ty->arrtype)), .abi_align = abi_align, .arrsize = ty->arrsize, .SL = nullptr};
+        return L;
+    }
     uint64_t getAlignof(Expr e) { return getAlignof(e->ty); }
     LLVMContext &getLLVMContext() {
         return ctx;
@@ -138,16 +240,52 @@ struct LLVMTypeConsumer
         }
         else
             str.assign("struct.anon");
+        tag_layouts[s->decl_idx] = TypeLayout{};
         if (!RD) {
             tags[s->decl_idx] = llvm::StructType::create(ctx, str.str());
             return;
         }
         const auto &fields = RD->fields;
-        size_t l = fields.size();
-        llvm::Type **buf = alloc.Allocate<llvm::Type *>(l);
-        for (size_t i = 0; i < l; ++i)
-            buf[i] = wrap(fields[i].ty);
-        tags[s->decl_idx] = llvm::StructType::create(ctx, llvm::makeArrayRef(buf, l), str.str());
+        SmallVector<llvm::Type *, 8> buf;
+        SmallVector<unsigned, 0> indexes;
+        uint64_t offset = 0, align = RD->align;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            llvm::Type *T = wrap(fields[i].ty);
+            if (!RD->isPacked) {
+                // the LLVM type of a member may be less aligned than the member(e.g. a struct with aligned(N)):
+                // place it with explicit padding
+                const uint64_t A = getAlignof(fields[i].ty);
+                if (A > getAlignof(T)) {
+                    align = std::max(align, A);
+                    if (offset % A) {
+                        if (indexes.empty()) {
+                            indexes.resize_for_overwrite(fields.size());
+                            for (size_t j = 0; j < i; ++j)
+                                indexes[j] = j;
+                        }
+                        buf.push_back(llvm::ArrayType::get(integer_types[3], llvm::alignTo(offset, A) - offset));
+                        offset = llvm::alignTo(offset, A);
+                    }
+                }
+                offset = llvm::alignTo(offset, options.DL.getABITypeAlign(T));
+            }
+            if (!indexes.empty())
+                indexes[i] = buf.size();
+            buf.push_back(T);
+            offset += options.DL.getTypeAllocSize(T);
+        }
+        if (align) {
+            // __attribute__((aligned(N))) or an over-aligned member: the size is padded to a multiple of the alignment
+            const uint64_t size = getsizeof(llvm::StructType::get(ctx, buf, RD->isPacked));
+            const uint64_t padded = llvm::alignTo(size, align);
+            if (padded != size)
+                buf.push_back(llvm::ArrayType::get(integer_types[3], padded - size));
+        }
+        llvm::StructType *ST = llvm::StructType::create(ctx, buf, str.str(), RD->isPacked);
+        if (!indexes.empty())
+            element_indexes[ST] = std::move(indexes);
+        tags[s->decl_idx] = ST;
+        tag_layouts[s->decl_idx].align = align;
     }
     llvm::Type *wrap(CType ty) {
         assert(ty && "wrap a nullptr");
@@ -174,8 +312,9 @@ struct LLVMTypeConsumer
             function_type_cache[ty] = T; // add to cache
             return T;
         }
-        case TYARRAY: return llvm::ArrayType::get(wrap(ty->arrtype), ty->arrsize);
+        case TYARRAY: return getArrayLayout(ty).type;
         case TYBITINT: return llvm::IntegerType::get(ctx, ty->getBitIntBits());
+        case TYVECTOR: return llvm::FixedVectorType::get(wrap(ty->vec_ty), ty->vec_num_elems);
         case TYBITFIELD: llvm_unreachable("bit field should handled other case!");
         case TYVLA: llvm_unreachable("VLA should handled other case!");
         default: llvm_unreachable("unexpected type!");
@@ -195,6 +334,11 @@ struct LLVMTypeConsumer
     }
     void reset(unsigned num_tags) {
         tags.resize_for_overwrite(num_tags);
+        // tag indices and type nodes are not shared between translation units
+        tag_layouts.clear();
+        tag_layouts.resize(num_tags);
+        array_layouts.clear();
+        element_indexes.clear();
     }
     LLVMTypeConsumer(LLVMContext &ctx, const Options &options): ctx{ctx}, alloc{}, options{options} {
         pointer_type = llvm::PointerType::get(ctx, 0);
@@ -219,6 +363,8 @@ struct LLVMTypeConsumer
         _complex_float = llvm::StructType::get(float_types[F_Float], float_types[F_Float]);
         intptrTy = options.DL.getIntPtrType(getLLVMContext());
         pointerSizeInBits = intptrTy->getBitWidth();
+        pointerSize = getsizeof(pointer_type);
+        pointerAlign = getAlignof(pointer_type);
         implict_func_ty = llvm::FunctionType::get(integer_types[5], {}, true);
 
         llvm::IntegerType *i32Ty = cast<llvm::IntegerType>(integer_types[5]);
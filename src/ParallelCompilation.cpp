@@ -0,0 +1,156 @@
+/*
+ * ParallelCompilation.cpp - compile many input files in one process
+ *
+ * Each input file gets its own CompilerInstance(SourceMgr, xcc_context, LLVMContext and TargetMachine), the jobs run on a pool of threads.
+ * They share the DiagnosticsEngine(in concurrent mode, see DiagnosticsEngine::JobScope), the looked up llvm::Target and
+ * a SharedFileCache, so headers included by many inputs are read and searched only once.
+ */
+
+struct ParallelCompilation {
+    enum OutputKind {
+        Output_None, // -fsyntax-only
+        Output_Object,
+        Output_Assembly,
+        Output_LLVM,
+        Output_Bitcode
+    };
+    DiagnosticsEngine &engine;
+    Options &options;
+    const SourceMgr &baseSM; // the include paths are copied from this
+    SharedFileCache ownCache;
+    SharedFileCache &cache; // ownCache, or a cache that outlives the compilation
+    std::vector<std::unique_ptr<CompilerInstance>> instances; // one per input file, alive until diagnostics are flushed
+    std::vector<std::string> outputFiles;
+    ParallelCompilation(DiagnosticsEngine &engine, Options &options, const SourceMgr &baseSM, SharedFileCache *shared = nullptr)
+        : engine{engine}, options{options}, baseSM{baseSM}, ownCache{}, cache{shared ? *shared : ownCache} {}
+    ParallelCompilation(const ParallelCompilation &) = delete;
+    unsigned getNumThreads() const {
+        unsigned N = options.Jobs ? options.Jobs : std::thread::hardware_concurrency();
+        return std::max(1U, std::min<unsigned>(N, options.inputFiles.size()));
+    }
+    // compile all input files, returns true on success
+    bool run(OutputKind kind) {
+        const size_t numInputs = options.inputFiles.size();
+        instances.resize(numInputs);
+        outputFiles.resize(numInputs);
+        if (kind != Output_None && !assignOutputFiles(kind))
+            return false;
+        // make sure the target is looked up once, every job creates its own TargetMachine from it
+        options.createTarget(engine);
+        if (kind == Output_Object || kind == Output_Assembly)
+            options.initializeEmitter();
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        auto worker = [&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < numInputs;) {
+                if (!compile(i, kind))
+                    failed.store(true, std::memory_order_relaxed);
+            }
+        };
+        const unsigned numThreads = getNumThreads();
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (unsigned i = 1; i < numThreads; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (std::thread &T : threads)
+            T.join();
+        engine.flushJobs();
+        for (DiagnosticConsumer *C : engine.consumers)
+            C->setSourceMgr(nullptr);
+        instances.clear();
+        return !failed.load(std::memory_order_relaxed);
+    }
+    // name the output of every input, two jobs writing the same file(e.g. `a/x.c b/x.c`, both x.o) are an error
+    bool assignOutputFiles(OutputKind kind) {
+        llvm::StringMap<size_t> seen;
+        for (size_t i = 0; i < options.inputFiles.size(); ++i) {
+            outputFiles[i] = options.getOutputFileName(options.inputFiles[i], getSuffix(kind));
+            auto it = seen.try_emplace(outputFiles[i], i);
+            if (!it.second) {
+                DiagnosticHelper helper{engine};
+                helper.error("%R and %R would both be compiled to %R", StringRef(options.inputFiles[it.first->second]),
+                             StringRef(options.inputFiles[i]), StringRef(outputFiles[i]));
+                return false;
+            }
+        }
+        return true;
+    }
+    // compile one input file, called from a worker thread
+    bool compile(size_t i, OutputKind kind) {
+        instances[i] = std::make_unique<CompilerInstance>();
+        CompilerInstance &CI = *instances[i];
+        CI.setSharedDiags(engine);
+        Options &opts = CI.createOptions();
+        opts = options;
+        opts.machine = nullptr;
+        opts.mainFileName = options.inputFiles[i];
+        SourceMgr &SM = CI.createSourceManager();
+        SM.setSharedFileCache(&cache);
+        SM.setTrigraphsEnabled(opts.trigraphs);
+        SM.sysPaths = baseSM.sysPaths;
+        SM.userPaths = baseSM.userPaths;
+        DiagnosticsEngine::JobScope scope(engine, i, &SM);
+        if (!SM.addFile(opts.mainFileName))
+            return false;
+        LLVMContext &llvmcontext = CI.createLLVMContext();
+        llvmcontext.setDiscardValueNames(true);
+        llvmcontext.setOpaquePointers(true);
+        llvmcontext.setDiagnosticHandler(std::make_unique<XCCDiagnosticHandler>());
+        CI.createParser();
+        CI.createCodeGen();
+        const std::unique_ptr<llvm::TargetMachine> machine{opts.machine};
+        bool ok = false;
+        {
+            TranslationUnit TU;
+            CI.Parse(TU);
+            if (!engine.getNumErrors() && kind != Output_None) {
+                std::unique_ptr<llvm::Module> M = CI.CodeGen(TU);
+                ok = !engine.getNumErrors() && emit(SM, *M, *machine, kind, outputFiles[i]);
+            } else {
+                ok = !engine.getNumErrors();
+            }
+        }
+        CI.releaseCodeGen();
+        opts.machine = nullptr;
+        return ok;
+    }
+    static StringRef getSuffix(OutputKind kind) {
+        switch (kind) {
+        case Output_Object: return ".o";
+        case Output_Assembly: return ".s";
+        case Output_LLVM: return ".ll";
+        case Output_Bitcode: return ".bc";
+        case Output_None: break;
+        }
+        llvm_unreachable("nothing to emit");
+    }
+    // write `M` to `outputFileName`
+    bool emit(SourceMgr &SM, llvm::Module &M, llvm::TargetMachine &machine, OutputKind kind, const std::string &outputFileName) {
+        std::error_code EC;
+        llvm::raw_fd_ostream OS(outputFileName, EC, llvm::sys::fs::CD_CreateAlways, llvm::sys::fs::FA_Write, llvm::sys::fs::OF_None);
+        if (EC) {
+            SM.error("cannot open output %R for writting: %R", outputFileName, EC.message());
+            return false;
+        }
+        switch (kind) {
+        case Output_LLVM:
+            M.print(OS, nullptr);
+            break;
+        case Output_Bitcode:
+            llvm::WriteBitcodeToFile(M, OS);
+            break;
+        default:
+        {
+            llvm::legacy::PassManager pass;
+            if (machine.addPassesToEmitFile(pass, OS, nullptr, kind == Output_Assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile)) {
+                SM.error("the target cannot emit a file of this type");
+                return false;
+            }
+            pass.run(M);
+        }
+        }
+        OS.close();
+        return !OS.has_error();
+    }
+};
@@ -119,6 +119,81 @@ struct IncludeFile {
         return offset >= getFileSize();
     }
 };
+// File contents and #include search results shared by the SourceMgrs of a multi-file compilation(see ParallelCompilation).
+// A file is read at most once per process; the buffers are never modified, so every SourceMgr wraps them without copying.
+// A long-lived cache(see CompileServer) validates files by their modification time and size, and is cleaned up between requests.
+struct SharedFileCache {
+private:
+    struct Entry {
+        std::unique_ptr<llvm::MemoryBuffer> Buffer; // nullptr if the file cannot be read
+        std::error_code EC;
+        llvm::sys::TimePoint<> mtime;
+        uint64_t size = 0;
+        bool isUpToDate(const llvm::sys::fs::file_status &Status) const {
+            return Buffer && Status.getLastModificationTime() == mtime && Status.getSize() == size;
+        }
+    };
+    std::mutex lock;
+    llvm::StringMap<Entry> files;
+    llvm::StringMap<std::string> includes; // search key => the path found, or empty if not found
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> outdated; // replaced buffers, SourceMgrs may still use them
+    bool validate = false;
+public:
+    // check every file for modifications before using the cached contents
+    void setValidateFiles(bool enable) { validate = enable; }
+    // must not be called while any SourceMgr uses the cache: frees outdated buffers and forgets the #include search results
+    void beginRequest() {
+        std::lock_guard<std::mutex> guard(lock);
+        outdated.clear();
+        includes.clear();
+    }
+    // get the contents of a file, or nullptr(and the reason in `EC`) if it cannot be read
+    const llvm::MemoryBuffer *getFile(StringRef path, std::error_code &EC) {
+        llvm::sys::fs::file_status Status;
+        const bool hasStatus = validate && !llvm::sys::fs::status(path, Status);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = files.find(path);
+            if (it != files.end() && (!validate || (hasStatus && it->second.isUpToDate(Status)))) {
+                EC = it->second.EC;
+                return it->second.Buffer.get();
+            }
+        }
+        // read without holding the lock, if two threads race for a file the first one wins
+        Entry E;
+        auto BufferOrErr = llvm::MemoryBuffer::getFile(path);
+        if (BufferOrErr)
+            E.Buffer = std::move(*BufferOrErr);
+        else
+            E.EC = BufferOrErr.getError();
+        if (hasStatus) {
+            E.mtime = Status.getLastModificationTime();
+            E.size = Status.getSize();
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        auto Result = files.try_emplace(path);
+        Entry &R = Result.first->second;
+        if (Result.second || (validate && !(hasStatus && R.isUpToDate(Status)))) {
+            if (R.Buffer)
+                outdated.push_back(std::move(R.Buffer));
+            R = std::move(E);
+        }
+        EC = R.EC;
+        return R.Buffer.get();
+    }
+    bool lookupInclude(StringRef key, std::string &found) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = includes.find(key);
+        if (it == includes.end())
+            return false;
+        found = it->second;
+        return true;
+    }
+    void addInclude(StringRef key, StringRef found) {
+        std::lock_guard<std::mutex> guard(lock);
+        includes.try_emplace(key, found.str());
+    }
+};
 struct SourceMgr : public DiagnosticHelper {
     char buf[STREAM_BUFFER_SIZE];
     SmallVector<xstring, 16> sysPaths;
@@ -128,6 +203,7 @@ struct SourceMgr : public DiagnosticHelper {
     llvm::StringMap<ContentCache *> cached_files;
     SmallVector<ContentCache *, 0> cached_strings;
     LocTree *tree = nullptr;
+    SharedFileCache *shared = nullptr;
     std::map<location_t, LocTree * /*, std::less<location_t>*/> location_map;
     StringRef lastDir = StringRef();
     bool trigraphs = false;
@@ -156,6 +232,8 @@ struct SourceMgr : public DiagnosticHelper {
     void endTree() { location_map[getLoc()] = (tree = tree->getParent()); }
     SourceMgr(DiagnosticsEngine &Diag) : DiagnosticHelper{Diag}, buf{}, trigraphs{false} {}
     void setTrigraphsEnabled(bool enable) { trigraphs = enable; }
+    // read files and resolve #include through a cache shared with other SourceMgrs
+    void setSharedFileCache(SharedFileCache *cache) { shared = cache; }
     void addUsernIcludeDir(xstring path) { userPaths.push_back(path); }
     void addSysIncludeDir(xstring path) { sysPaths.push_back(path); }
     void addUsernIcludeDir(StringRef path) { userPaths.push_back(xstring::get(path)); }
@@ -165,6 +243,11 @@ struct SourceMgr : public DiagnosticHelper {
             return 0;
         return includeStack.back().getEndLoc();
     }
+    void setLastDir(StringRef path) {
+        lastDir = llvm::sys::path::parent_path(path, llvm::sys::path::Style::native);
+        if (lastDir.empty())
+            lastDir = ".";
+    }
     bool addFile(StringRef path, bool verbose = true, location_t includePos = 0) {
         auto it = cached_files.insert({path, static_cast<ContentCache *>(nullptr)});
         if (!it.second) {
@@ -173,6 +256,19 @@ PUSH:
             addBuffer();
             return true;
         }
+        if (shared) {
+            std::error_code EC;
+            const llvm::MemoryBuffer *Buffer = shared->getFile(path, EC);
+            if (!Buffer) {
+                cached_files.erase(it.first);
+                if (verbose)
+                    error("cannot open %R: %R", path, EC.message());
+                return false;
+            }
+            it.first->second = new ContentCache(llvm::MemoryBuffer::getMemBuffer(Buffer->getMemBufferRef()).release(), it.first->getKey());
+            setLastDir(it.first->getKey());
+            goto PUSH;
+        }
         location_t fileSize;
 #if WINDOWS
         llvm::SmallVector<WCHAR, 128> convertBuffer;
@@ -220,11 +316,8 @@ PUSH:
             error("error reading file contents %R: %R", path, msg);
             return false;
         }
-        ContentCache *cache = new ContentCache(MemberBufferOrErr->release(), it.first->getKey());
-        it.first->second = cache;
-        lastDir = llvm::sys::path::parent_path(path, llvm::sys::path::Style::native);
-        if (lastDir.empty())
-            lastDir = ".";
+        it.first->second = new ContentCache(MemberBufferOrErr->release(), it.first->getKey());
+        setLastDir(it.first->getKey());
         goto PUSH;
     }
     const IncludeFile *searchIncludeFile(location_t loc, location_t &offset) const {
@@ -362,11 +455,7 @@ private:
         }
         return false;
     }
-public:
-    bool addIncludeFile(StringRef path, bool isAngled, location_t loc) {
-        // https://stackoverflow.com/q/21593/15886008
-        // path must be null terminated
-        xstring result = xstring::get_with_capacity(256);
+    bool searchIncludeFile(xstring &result, StringRef path, bool isAngled, location_t loc) {
         if (!isAngled && (!lastDir.empty())) {
             result += lastDir;
             result += '/';
@@ -377,9 +466,39 @@ public:
         }
         if (searchFileInDir(result, path, userPaths.data(), userPaths.size(), loc))
             return true;
-        if (searchFileInDir(result, path, sysPaths.data(), sysPaths.size(), loc))
-            return true;
-        result.free();
+        return searchFileInDir(result, path, sysPaths.data(), sysPaths.size(), loc);
+    }
+public:
+    bool addIncludeFile(StringRef path, bool isAngled, location_t loc) {
+        // https://stackoverflow.com/q/21593/15886008
+        // path must be null terminated
+        if (shared) {
+            // the result only depends on the including directory and the search paths, which are the same for all SourceMgrs sharing the cache
+            SmallString<256> key;
+            key.push_back(isAngled ? '<' : '"');
+            if (!isAngled)
+                key += lastDir;
+            key.push_back('\0');
+            key += path;
+            std::string found;
+            if (shared->lookupInclude(key, found)) {
+                if (!found.empty() && addFile(found, false, loc))
+                    return true;
+            } else {
+                xstring result = xstring::get_with_capacity(256);
+                const bool ok = searchIncludeFile(result, path, isAngled, loc);
+                shared->addInclude(key, ok ? StringRef(result.data()) : StringRef());
+                result.free();
+                if (ok)
+                    return true;
+            }
+        } else {
+            xstring result = xstring::get_with_capacity(256);
+            const bool ok = searchIncludeFile(result, path, isAngled, loc);
+            result.free();
+            if (ok)
+                return true;
+        }
         pp_error(loc, "#include file not found: %r", StringRef(path.data(), path.size() - 1));
         return suggestPath(path, isAngled), false;
     }
@@ -84,10 +84,21 @@ struct StmtVisitor {
     void VisitExpr(Expr e) {
         assert(enableExpr);
         switch (e->k) {
-            case EBin:
-                VisitExpr(e->lhs);
-                VisitExpr(e->rhs);
-                break;
+            case EBin: {
+                // visit left-leaning binary chains(e.g., a0 + a1 + ... + a100000) iteratively
+                SmallVector<Expr, 16> spine;
+                Expr it = e;
+                do {
+                    spine.push_back(it);
+                    it = it->lhs;
+                } while (it->k == EBin);
+                VisitExpr(it);
+                for (size_t i = spine.size(); i--;) {
+                    VisitExpr(spine[i]->rhs);
+                    if (i)
+                        static_cast<T*>(this)->ActOnExpr(spine[i]);
+                }
+            } break;
             case EUnary:
                 VisitExpr(e->uoperand);
                 break;
@@ -123,6 +134,18 @@ struct StmtVisitor {
             case EPostFix:
                 VisitExpr(e->poperand);
                 break;
+            case EBuiltinCall:
+                for (const auto it: e->buitin_call_args)
+                    VisitExpr(it);
+                break;
+            case ECallCompilerBuiltinCall:
+                for (const auto it: e->cbc_args)
+                    VisitExpr(it);
+                break;
+            case ECallImplictFunction:
+                for (const auto it: e->imt_args)
+                    VisitExpr(it);
+                break;
             default: break;
         }
         static_cast<T*>(this)->ActOnExpr(e);
@@ -164,6 +187,12 @@ struct StmtVisitor {
                         case SIndirectBr:
                             VisitExpr(s->jump_addr);
                             break;
+                        case SGCCAsm:
+                            for (const AsmOperand &op : s->asm_outputs)
+                                VisitExpr(op.e);
+                            for (const AsmOperand &op : s->asm_inputs)
+                                VisitExpr(op.e);
+                            break;
                         default: break;
                     }
                 }
@@ -197,3 +226,191 @@ struct StmtReleaser: public StmtVisitor<StmtReleaser, true> {
         }
     }
 };
+// The restrict-qualified pointers of a function that keep the value they are initialized with: the candidates assigned or
+// having their address taken in the function are removed.
+struct RestrictPointerFilter: public StmtVisitor<RestrictPointerFilter, true> {
+    SmallVectorImpl<unsigned> &candidates; // variable indexes
+    RestrictPointerFilter(SmallVectorImpl<unsigned> &candidates): candidates{candidates} {}
+    void remove(Expr e) {
+        if (e->k == EVar)
+            llvm::erase_value(candidates, e->sval);
+    }
+    void ActOnExpr(Expr e) {
+        switch (e->k) {
+        case EBin:
+            switch (e->bop) {
+            case Assign:
+            case AtomicrmwAdd:
+            case AtomicrmwSub:
+            case AtomicrmwAnd:
+            case AtomicrmwOr:
+            case AtomicrmwXor: remove(e->lhs); break;
+            default: break;
+            }
+            break;
+        case EUnary:
+            if (e->uop == AddressOf)
+                remove(e->uoperand);
+            break;
+        case EPostFix: remove(e->poperand); break;
+        default: break;
+        }
+    }
+    void ActOnStmt(Stmt s) {
+        switch (s->k) {
+        case SVarDecl:
+            for (const VarDecl &it: s->vars)
+                if (it.init)
+                    VisitExpr(it.init);
+            break;
+        case SGCCAsm:
+            // outputs are written, and memory operands are passed by address
+            for (const AsmOperand &op : s->asm_outputs)
+                remove(op.e);
+            for (const AsmOperand &op : s->asm_inputs)
+                remove(op.e);
+            break;
+        default: break;
+        }
+    }
+};
+// Whether an expression reads a restrict-qualified pointer variable.
+struct RestrictPointerUseFinder: public StmtVisitor<RestrictPointerUseFinder, true> {
+    bool found = false;
+    void ActOnExpr(Expr e) {
+        if (e->k == EVar && e->ty->getKind() == TYPOINTER && e->ty->hasTag(TYRESTRICT))
+            found = true;
+    }
+};
+// Whether evaluating an expression may have side effects: it assigns, increments or decrements, calls a function or
+// a builtin, or accesses a volatile object.
+struct SideEffectFinder: public StmtVisitor<SideEffectFinder, true> {
+    bool found = false;
+    void ActOnExpr(Expr e) {
+        switch (e->k) {
+        case EBin:
+            switch (e->bop) {
+            case Assign:
+            case AtomicrmwAdd:
+            case AtomicrmwSub:
+            case AtomicrmwAnd:
+            case AtomicrmwOr:
+            case AtomicrmwXor: found = true; break;
+            default: break;
+            }
+            break;
+        case EPostFix:
+        case ECall:
+        case EBuiltinCall:
+        case ECallCompilerBuiltinCall:
+        case ECallImplictFunction: found = true; break;
+        case EUnary:
+            if (e->uop == Dereference && e->ty->hasTag(TYVOLATILE))
+                found = true;
+            break;
+        case EVar:
+        case EMemberAccess:
+        case ESubscript:
+            if (e->ty->hasTag(TYVOLATILE))
+                found = true;
+            break;
+        default: break;
+        }
+    }
+};
+// The local variables whose declaration can be jumped over into their scope(by goto, switch, computed goto or asm goto),
+// mirrors clang's VarBypassDetector. The lifetime of such a variable cannot start at its declaration.
+struct VarBypassDetector {
+    // a compound statement or a variable declaration starts a scope: (parent scope, variable index or -1)
+    SmallVector<std::pair<unsigned, unsigned>, 32> scopes;
+    DenseMap<label_t, unsigned> labelScopes;
+    DenseMap<Stmt, unsigned> compoundScopes;
+    SmallVector<std::pair<unsigned, label_t>, 32> jumps; // (scope of the jump, target)
+    llvm::SmallSet<unsigned, 8> bypassed; // variable indexes
+    bool alwaysBypassed = false; // a jump to an unknown label
+    VarBypassDetector(Stmt s) {
+        assert(s->k == SFunction);
+        scopes.emplace_back(0, unsigned(-1));
+        unsigned scope = 0;
+        for (Stmt ptr = s->funcbody->next; ptr; ptr = ptr->next)
+            Visit(ptr, scope, s->indirectBrs);
+        for (const auto &it : jumps) {
+            auto L = labelScopes.find(it.second);
+            if (L == labelScopes.end()) {
+                alwaysBypassed = true;
+                break;
+            }
+            Detect(it.first, L->second);
+        }
+    }
+    bool isBypassed(unsigned idx) const { return alwaysBypassed || bypassed.count(idx); }
+    // the scope of a label, -1 if unknown
+    unsigned getLabelScope(label_t L) const {
+        auto it = labelScopes.find(L);
+        return it == labelScopes.end() ? unsigned(-1) : it->second;
+    }
+    unsigned getCompoundScope(Stmt s) const { return compoundScopes.lookup(s); }
+    // `A` is `S` or a parent of `S`
+    bool isAncestor(unsigned A, unsigned S) const {
+        while (S > A)
+            S = scopes[S].first;
+        return S == A;
+    }
+    void Visit(Stmt s, unsigned &scope, const label_t *indirectBrs) {
+        switch (s->k) {
+        case SCompound: {
+            unsigned inner = scopes.size();
+            scopes.emplace_back(scope, unsigned(-1));
+            compoundScopes[s] = inner;
+            for (Stmt ptr = s->inner; ptr; ptr = ptr->next)
+                Visit(ptr, inner, indirectBrs);
+        } break;
+        case SVarDecl:
+            for (const VarDecl &it : s->vars) {
+                if (it.ty->hasTag(TYTYPEDEF) || it.ty->isGlobalStorage() || it.ty->getKind() == TYFUNCTION)
+                    continue;
+                scopes.emplace_back(scope, it.idx);
+                scope = scopes.size() - 1;
+            }
+            break;
+        case SLabel:
+        case SNamedLabel: labelScopes[s->label] = scope; break;
+        case SGotoWithLocName:
+        case SGotoWithLoc:
+        case SGoto: jumps.emplace_back(scope, s->location); break;
+        case SCondJump:
+            jumps.emplace_back(scope, s->T);
+            jumps.emplace_back(scope, s->F);
+            break;
+        case SSwitch:
+            jumps.emplace_back(scope, s->sw_default);
+            for (const auto &it : s->switchs)
+                jumps.emplace_back(scope, it.label);
+            for (const auto &it : s->gnu_switchs)
+                jumps.emplace_back(scope, it.label);
+            break;
+        case SIndirectBr:
+            assert(indirectBrs && "indirect goto in function with no address-of-label expressions");
+            for (unsigned i = 1; i <= indirectBrs[0]; ++i)
+                jumps.emplace_back(scope, indirectBrs[i]);
+            break;
+        case SGCCAsm:
+            for (label_t L : s->asm_labels)
+                jumps.emplace_back(scope, L);
+            break;
+        default: break;
+        }
+    }
+    // a jump from scope `From` to scope `To` bypasses the declarations between their common ancestor and `To`
+    void Detect(unsigned From, unsigned To) {
+        while (From != To) {
+            if (From < To) {
+                if (scopes[To].second != unsigned(-1))
+                    bypassed.insert(scopes[To].second);
+                To = scopes[To].first;
+            } else {
+                From = scopes[From].first;
+            }
+        }
+    }
+};
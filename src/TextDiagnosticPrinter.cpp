@@ -108,4 +108,6 @@ NO_LOC:
             printSource(loc); // print where the macro is defined
         }
     }
+    if (Diag.level == Fatal)
+        OS.flush();
 }
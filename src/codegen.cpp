@@ -16,9 +16,10 @@ struct IRGen : public DiagnosticHelper {
                           DLLImportStorageClass = llvm::GlobalValue::DLLImportStorageClass,
                           DLLExportStorageClass = llvm::GlobalValue::DLLExportStorageClass;
 
+    // string literals are uniqued by their encoded bytes, which are owned by the xcc_context's arena
     DenseMap<StringRef, llvm::GlobalVariable *> str8Map;
-    DenseMap<ArrayRef<uint16_t>, llvm::GlobalVariable *> str16Map;
-    DenseMap<ArrayRef<uint32_t>, llvm::GlobalVariable *> str32Map;
+    DenseMap<StringRef, llvm::GlobalVariable *> str16Map;
+    DenseMap<StringRef, llvm::GlobalVariable *> str32Map;
 
     LLVMTypeConsumer &type_cache;
     xcc_context &context;
@@ -39,6 +40,17 @@ struct IRGen : public DiagnosticHelper {
     llvm::Value **vars = nullptr; // llvm::GlobalValue* or llvm::AllocaInst*
     Stmt currentfunctionAST = nullptr;
     llvm::BasicBlock *insertBB = nullptr;
+    bool flattenCalls = false; // the current function has __attribute__((flatten))
+    llvm::SmallSetVector<llvm::GlobalObject *, 4> usedGlobals; // __attribute__((used))
+    llvm::MapVector<llvm::GlobalObject *, const DeclAttributes *> aliases; // __attribute__((alias("target")))
+    Optional<CodeGenTBAA> tbaa; // with -fstrict-aliasing when optimizing
+    Optional<VarBypassDetector> bypasses; // when lifetime markers are emitted for the current function
+    struct LifetimeScope {
+        unsigned scope; // in `bypasses`
+        SmallVector<std::pair<llvm::AllocaInst *, llvm::Constant *>, 2> started; // the alloca and its size
+    };
+    SmallVector<LifetimeScope, 8> lifetimeScopes; // the compound statements being generated
+    SmallVector<std::pair<unsigned, llvm::MDNode *>, 4> restrictScopes; // the restrict pointers of the current function and their alias scopes
     
     location_t last_location_t = -1;
     unsigned current_line = 0;
@@ -54,15 +66,135 @@ struct IRGen : public DiagnosticHelper {
         return type_cache.getLLVMContext();
     }
 
+    // the operations a memory order is used for, they decide which orders are valid
+    enum AtomicOrderKind { AtomicOrder_Load, AtomicOrder_Store, AtomicOrder_RMW };
+
 private:
     llvm::Value *GenBuiltinCall(Expr);
-    auto &getMapFor(const StringRef &) { return str8Map; }
-    auto &getMapFor(const ArrayRef<uint16_t> &) { return str16Map; }
-    auto &getMapFor(const ArrayRef<uint32_t> &) { return str32Map; }
-    template <typename T>
-    llvm::GlobalVariable *createString(llvm::Constant *init, T str) {
-        auto it = getMapFor(str).insert({str, nullptr});
+    llvm::Value *GenOverflowBuiltin(Expr);
+    llvm::Value *GenAtomicBuiltin(Expr);
+    llvm::Value *GenWithMemoryOrder(Expr OrderExpr, AtomicOrderKind Kind, llvm::function_ref<llvm::Value *(llvm::AtomicOrdering)> Emit);
+    // [[likely]]/[[unlikely]] branch weights, the same as what LowerExpectIntrinsic uses for __builtin_expect
+    llvm::MDNode *createBranchHintWeights(enum BranchHint hint) {
+        const uint32_t LikelyBranchWeight = 2000, UnlikelyBranchWeight = 1;
+        llvm::MDBuilder MDHelper(getLLVMContext());
+        return hint == BH_Likely ? MDHelper.createBranchWeights(LikelyBranchWeight, UnlikelyBranchWeight)
+                                 : MDHelper.createBranchWeights(UnlikelyBranchWeight, LikelyBranchWeight);
+    }
+    // the alignment of the object that `e` points to(pointer arguments of builtins keep their type, see compiler_builtin_call)
+    llvm::Align getPointeeAlign(Expr e) {
+        if (e->ty->getKind() != TYPOINTER)
+            return llvm::Align(1);
+        CType ty = e->ty->p;
+        if (ty->isIncomplete() || ty->getKind() == TYFUNCTION)
+            return llvm::Align(1);
+        return llvm::Align(type_cache.getABIAlignof(ty));
+    }
+    // the ABI alignment of an object of type `ty`: a packed record is aligned to 1 unless aligned(N) raises it,
+    // a record with an over-aligned member is as aligned as the member
+    llvm::Align getObjectAlign(CType ty) {
+        return llvm::Align(type_cache.getABIAlignof(ty));
+    }
+    // a member is only as aligned as its offset in the enclosing object, e.g. an int at offset 1 of a packed struct
+    llvm::Align getMemberAlign(Expr e) {
+        assert(e->k == EMemberAccess);
+        const bool isArrow = e->obj->ty->getKind() == TYPOINTER;
+        CType Base = isArrow ? e->obj->ty->p : e->obj->ty;
+        const llvm::Align BaseAlign = !isArrow && e->obj->k == EMemberAccess ? getMemberAlign(e->obj) : getObjectAlign(Base);
+        uint64_t Offset = 0;
+        CType ty = Base;
+        for (unsigned i : e->idxs) {
+            Offset += type_cache.getFieldOffset(ty, i); // the offset that getAddress() computes with structGEP
+            ty = ty->getRecord()->fields[i].ty;
+        }
+        return std::min(getObjectAlign(e->ty), llvm::commonAlignment(BaseAlign, Offset));
+    }
+    // the alignment of a load or store of the lvalue `e`
+    llvm::MaybeAlign getLValueAlign(Expr e) {
+        if (e->k == EMemberAccess && e->ty->getKind() != TYBITFIELD)
+            return getMemberAlign(e);
+        return e->ty->getAlignAsMaybeAlign();
+    }
+    // the only place where front-end string literals become LLVM constants
+    llvm::Constant *getStringConstant(const StringLiteralData *S) {
+        switch (S->charSizeInBits) {
+        case 8: return llvm::ConstantDataArray::getString(getLLVMContext(), S->getBytes(), false);
+        case 16: return llvm::ConstantDataArray::get(getLLVMContext(), S->getElements<uint16_t>());
+        case 32: return llvm::ConstantDataArray::get(getLLVMContext(), S->getElements<uint32_t>());
+        default: llvm_unreachable("unhandled character size");
+        }
+    }
+    // the only place where front-end constants(see ConstantValue) become LLVM constants
+    llvm::Constant *getConstant(const ConstantValue *C, llvm::Type *T) {
+        switch (C->kind) {
+        case ConstantValue::CK_Int: return llvm::ConstantInt::get(getLLVMContext(), cast<IntConstant>(C)->getValue());
+        case ConstantValue::CK_Float: return llvm::ConstantFP::get(getLLVMContext(), cast<FloatConstant>(C)->getValue());
+        case ConstantValue::CK_Pointer: {
+            const APInt &address = cast<PointerConstant>(C)->address;
+            if (address.isZero())
+                return type_cache.null_ptr;
+            return llvm::ConstantExpr::getIntToPtr(llvm::ConstantInt::get(getLLVMContext(), address),
+                                                   type_cache.pointer_type);
+        }
+        case ConstantValue::CK_Complex: {
+            const auto CC = cast<ComplexConstant>(C);
+            llvm::Type *ET = cast<llvm::StructType>(T)->getElementType(0);
+            return llvm::ConstantStruct::get(cast<llvm::StructType>(T), {getConstant(CC->real, ET), getConstant(CC->imag, ET)});
+        }
+        case ConstantValue::CK_Vector: {
+            llvm::Type *ET = cast<llvm::FixedVectorType>(T)->getElementType();
+            SmallVector<llvm::Constant *, 16> elements;
+            for (const ConstantValue *E : cast<VectorConstant>(C)->getElements())
+                elements.push_back(getConstant(E, ET));
+            return llvm::ConstantVector::get(elements);
+        }
+        case ConstantValue::CK_Undef:
+            if (cast<UndefConstant>(C)->isPoison)
+                return llvm::PoisonValue::get(T);
+            return llvm::UndefValue::get(T);
+        }
+        llvm_unreachable("bad constant kind");
+    }
+    // local arrays: small ones and ones with at least a quarter of their elements initialized are copied from one
+    // ConstantDataArray, other ones are cleared and stored run by run(see buildPackedLocalInit)
+    static bool isDensePackedArray(const PackedArrayData *P, uint64_t numElements) {
+        return numElements <= 64 || P->getNumInitialized() * 4 >= numElements;
+    }
+    // the only place where packed array initializers become LLVM constants: the runs are copied into one buffer of
+    // the size of `T`, so the constant keeps the declared array type(redeclarations and other modules refer to it)
+    llvm::Constant *getPackedArrayConstant(const PackedArrayData *P, llvm::ArrayType *T) {
+        llvm::Type *elemTy = T->getElementType();
+        const uint64_t numElements = T->getNumElements();
+        ArrayRef<PackedArrayData::Run> runs = P->getRuns();
+        if (runs.empty())
+            return llvm::ConstantAggregateZero::get(T);
+        if (runs.size() == 1 && runs.front().start == 0 && runs.front().length == numElements)
+            return llvm::ConstantDataArray::getRaw(P->getBytes(runs.front()), numElements, elemTy);
+        SmallVector<char, 0> buf(numElements * P->elementSize, 0);
+        for (const PackedArrayData::Run &R : runs) {
+            const StringRef bytes = P->getBytes(R);
+            memcpy(buf.data() + size_t(R.start) * P->elementSize, bytes.data(), bytes.size());
+        }
+        return llvm::ConstantDataArray::getRaw(StringRef(buf.data(), buf.size()), numElements, elemTy);
+    }
+    llvm::GlobalVariable *createPrivateConstant(llvm::Constant *init, llvm::Align A) {
+        llvm::GlobalVariable *GV = new llvm::GlobalVariable(*module, init->getType(), true, llvm::GlobalValue::PrivateLinkage, init, ".init");
+        GV->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        GV->setAlignment(A);
+        return GV;
+    }
+    auto &getMapFor(unsigned charSizeInBits) {
+        switch (charSizeInBits) {
+        case 8: return str8Map;
+        case 16: return str16Map;
+        case 32: return str32Map;
+        default: llvm_unreachable("unhandled character size");
+        }
+    }
+    llvm::GlobalVariable *createString(const StringLiteralData *S) {
+        auto it = getMapFor(S->charSizeInBits).insert({S->getBytes(), nullptr});
         if (it.second) {
+            llvm::Constant *init = getStringConstant(S);
             llvm::GlobalVariable *GV = new llvm::GlobalVariable(*module, init->getType(), true, llvm::GlobalValue::PrivateLinkage, init, ".cstr");
             GV->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
             // GV->setAlignment(options.DL.getPreferredAlign(GV));
@@ -71,53 +203,10 @@ private:
         }
         return it.first->second;
     }
-    llvm::GlobalVariable * createString(llvm::Constant *C) {
-        llvm::IntegerType *T = cast<llvm::IntegerType>(cast<llvm::ArrayType>(C->getType())->getElementType());
-        switch (T->getBitWidth()) {
-        case 8: 
-        {
-            if (auto CA = dyn_cast<llvm::ConstantDataArray>(C)) {
-                return createString(C, CA->getRawDataValues());
-            }
-            assert(isa<llvm::ConstantAggregateZero>(C));
-            return createString(C, StringRef());
-        }
-        case 16:
-        {
-            if (auto CA = dyn_cast<llvm::ConstantDataArray>(C)) {
-                const uint16_t *Data = reinterpret_cast<const uint16_t*>(CA->getRawDataValues().data());
-                unsigned numElements = CA->getNumElements();
-                return createString(
-                    C,
-                    llvm::makeArrayRef(
-                        Data + numElements,
-                        numElements
-                    )
-                );
-            }
-            assert(isa<llvm::ConstantAggregateZero>(C));
-            return createString(C, ArrayRef<uint16_t>());
-        }
-        case 32:
-        {
-            if (auto CA = dyn_cast<llvm::ConstantDataArray>(C)) {
-                const uint32_t *Data = reinterpret_cast<const uint32_t*>(CA->getRawDataValues().data());
-                unsigned numElements = CA->getNumElements();
-                return createString(
-                    C,
-                    llvm::makeArrayRef(
-                        Data + numElements,
-                        numElements
-                    )
-                );
-            }
-            assert(isa<llvm::ConstantAggregateZero>(C));
-            return createString(C, ArrayRef<uint32_t>());
-        }
-        default: llvm_unreachable("unhandled character size");
-        }
-    }
-    llvm::GlobalVariable *createString(Expr e) {
+    llvm::Value *createString(Expr e) {
+        // char s[] = "abc"; the string literal is the initializer of an array
+        if (e->ty->getKind() == TYARRAY)
+            return getStringConstant(e->string);
         return createString(e->string);
     }
     void setDebugLoc(location_t loc) {
@@ -168,6 +257,13 @@ private:
     [[nodiscard]] llvm::CastInst *createCast(llvm::Instruction::CastOps Op, llvm::Value *V, llvm::Type *DestTy) {
         return Insert(llvm::CastInst::Create(Op, V, DestTy, "", insertBB));
     }
+    // truncate or extend `V` to `DestTy`, `V` is returned if the types are same
+    [[nodiscard]] llvm::Value *createIntCast(llvm::Value *V, llvm::Type *DestTy, bool isSigned = false) {
+        const unsigned SrcBits = V->getType()->getIntegerBitWidth(), DstBits = DestTy->getIntegerBitWidth();
+        if (SrcBits == DstBits)
+            return V;
+        return createCast(SrcBits > DstBits ? llvm::Instruction::Trunc : isSigned ? llvm::Instruction::SExt : llvm::Instruction::ZExt, V, DestTy);
+    }
     [[nodiscard]] llvm::CastInst *ptrtoint(llvm::Value *V, llvm::Type *DestTy) {
         return createCast(llvm::Instruction::PtrToInt, V, DestTy);
     }
@@ -236,8 +332,10 @@ GEP: ;
         llvm::Value **vals = type_cache.alloc.Allocate<llvm::Value*>(idxs.size() + 1);
         vals[0] = ConstantInt::get(type_cache.intptrTy, 0);
         llvm::IntegerType *i32Ty = cast<llvm::IntegerType>(type_cache.integer_types[5]);
+        SmallVector<unsigned, 4> elems(idxs.begin(), idxs.end());
+        type_cache.getElementIndexes(StructTy, elems);
         for (size_t i = 0;i < idxs.size();++i)
-            vals[i+1] = llvm::ConstantInt::get(i32Ty, idxs[i]);
+            vals[i+1] = llvm::ConstantInt::get(i32Ty, elems[i]);
         return gep(StructTy, Ptr, llvm::makeArrayRef(vals, idxs.size() + 1));
     }
     [[nodiscard]] llvm::PHINode *phi(llvm::Type *Ty, unsigned NumReservedValues) {
@@ -305,9 +403,38 @@ GEP: ;
     llvm::CallInst *call(unsigned ID, ArrayRef<llvm::Value*> Args = {}, ArrayRef<llvm::Type*> Tys = {}) {
         return call(llvm::Intrinsic::getDeclaration(&*module, ID, Tys), Args);
     }
+    llvm::CallInst *createMemCpy(llvm::Value *Dst, llvm::Value *Src, uint64_t Size, llvm::Align A) {
+        llvm::CallInst *CI = call(llvm::Intrinsic::memcpy, {Dst, Src, ConstantInt::get(type_cache.intptrTy, Size), ConstantInt::getFalse(getLLVMContext())},
+                                  {Dst->getType(), Src->getType(), type_cache.intptrTy});
+        CI->addParamAttr(0, llvm::Attribute::getWithAlignment(getLLVMContext(), A));
+        CI->addParamAttr(1, llvm::Attribute::getWithAlignment(getLLVMContext(), A));
+        return CI;
+    }
+    llvm::CallInst *createMemSet(llvm::Value *Dst, uint8_t Val, uint64_t Size, llvm::Align A) {
+        llvm::CallInst *CI = call(llvm::Intrinsic::memset, {Dst, ConstantInt::get(type_cache.integer_types[3], Val), ConstantInt::get(type_cache.intptrTy, Size), ConstantInt::getFalse(getLLVMContext())},
+                                  {Dst->getType(), type_cache.intptrTy});
+        CI->addParamAttr(0, llvm::Attribute::getWithAlignment(getLLVMContext(), A));
+        return CI;
+    }
     [[nodiscard]] llvm::ExtractValueInst* extractValue(llvm::Value *Agg, ArrayRef<unsigned> idxs) {
         return Insert(llvm::ExtractValueInst::Create(Agg, idxs, "", insertBB));
     }
+    [[nodiscard]] llvm::Value *extractElement(llvm::Value *Vec, llvm::Value *Idx) {
+        return Insert(llvm::ExtractElementInst::Create(Vec, Idx, "", insertBB));
+    }
+    [[nodiscard]] llvm::Value *insertElement(llvm::Value *Vec, llvm::Value *Elt, llvm::Value *Idx) {
+        return Insert(llvm::InsertElementInst::Create(Vec, Elt, Idx, "", insertBB));
+    }
+    [[nodiscard]] llvm::Value *shuffleVector(llvm::Value *V1, llvm::Value *V2, ArrayRef<int> Mask) {
+        return Insert(new llvm::ShuffleVectorInst(V1, V2, Mask, "", insertBB));
+    }
+    // a vector of `n` copies of `V`: insertelement into lane 0 and a zero shuffle mask
+    [[nodiscard]] llvm::Value *vectorSplat(llvm::Value *V, unsigned n) {
+        llvm::Type *VT = llvm::FixedVectorType::get(V->getType(), n);
+        llvm::Value *Lane0 = insertElement(llvm::PoisonValue::get(VT), V, type_cache.i32_0);
+        SmallVector<int, 16> Mask(n, 0);
+        return shuffleVector(Lane0, llvm::PoisonValue::get(VT), Mask);
+    }
     llvm::StoreInst* store(llvm::Value *p, llvm::Value *v) { 
         assert(p->getType()->isPointerTy() && "Store operand must be a pointer");
         return Insert(new llvm::StoreInst(v, p, insertBB));
@@ -339,6 +466,17 @@ GEP: ;
             i->setAlignment(*align);
         return i;
     }
+    // attach the TBAA access tag of the lvalue `e` to a load or store of it
+    void setTBAA(llvm::Instruction *I, Expr e) {
+        if (tbaa)
+            if (llvm::MDNode *Tag = tbaa->getAccessTag(e))
+                I->setMetadata(LLVMContext::MD_tbaa, Tag);
+    }
+    void setTBAA(llvm::Instruction *I, CType ty) {
+        if (tbaa)
+            if (llvm::MDNode *Tag = tbaa->getAccessTag(ty))
+                I->setMetadata(LLVMContext::MD_tbaa, Tag);
+    }
     [[nodiscard]] const llvm::Instruction *getTerminator() { return insertBB->getTerminator(); }
     [[nodiscard]] llvm::ValueAsMetadata *mdNum(uint64_t num) {
         llvm::Value *v = llvm::ConstantInt::get(llvm::Type::getInt32Ty(getLLVMContext()), num);
@@ -358,15 +496,163 @@ GEP: ;
     llvm::BasicBlock *addBB(StringRef Name = "") {
         return llvm::BasicBlock::Create(getLLVMContext(), "", currentfunction);
     }
+    // basic asm: module level asm at file scope, a volatile asm call without operands in a function
     void handle_asm(StringRef s) {
-        if (currentfunction)
-            // module level asm
-            module->appendModuleInlineAsm(s);
-        else {
-            auto ty = llvm::FunctionType::get(type_cache.void_type, false);
-            auto f = llvm::InlineAsm::get(ty, s, StringRef(), true);
-            call(ty, f);
+        if (!currentfunction)
+            return module->appendModuleInlineAsm(s);
+        SmallString<64> Template;
+        for (char c : s) {
+            // '$' starts an operand in LLVM's asm template
+            if (c == '$')
+                Template.push_back('$');
+            Template.push_back(c);
+        }
+        auto ty = llvm::FunctionType::get(type_cache.void_type, false);
+        auto f = llvm::InlineAsm::get(ty, Template, GCCAsmTarget(options.triple).getClobbers(), true);
+        call(ty, f)->addFnAttr(llvm::Attribute::NoUnwind);
+    }
+    // lower a GNU extended asm statement(clang's CodeGenFunction::EmitAsmStmt).
+    // the LLVM operands are: outputs(register outputs are returned, memory outputs are indirect), inputs,
+    // the tied inputs of '+' outputs, then the labels of asm goto(blockaddress operands with an 'i' constraint, as LLVM 15
+    // requires), the clobbers are at the end of the constraint string.
+    void gen_asm(Stmt s) {
+        struct AsmResult {
+            llvm::Value *addr;
+            llvm::Type *ty;
+            llvm::MaybeAlign align;
+        };
+        const GCCAsmTarget target(options.triple);
+        std::string Constraints, TiedConstraints;
+        SmallVector<llvm::Value *, 8> args, tiedArgs;
+        SmallVector<llvm::Type *, 8> argTypes, resultTypes, outputTypes;
+        SmallVector<llvm::Type *, 8> elementTypes, tiedElementTypes; // the pointee type of indirect operands, or nullptr
+        SmallVector<AsmResult, 4> results;
+        bool readOnly = true, readNone = true;
+        auto addConstraint = [](std::string &Str, const Twine &C) {
+            if (!Str.empty())
+                Str += ',';
+            Str += C.str();
+        };
+        for (unsigned i = 0; i < s->asm_outputs.size(); ++i) {
+            const AsmOperand &op = s->asm_outputs[i];
+            const StringRef C = op.constraint.str();
+            const bool isReadWrite = C.front() == '+';
+            llvm::Value *addr = getAddress(op.e);
+            llvm::Type *ty = wrap(op.e->ty);
+            if (GCCAsmTarget::isMemoryOnly(C)) {
+                addConstraint(Constraints, "=*" + C.drop_front());
+                args.push_back(addr);
+                argTypes.push_back(addr->getType());
+                elementTypes.push_back(ty);
+                outputTypes.push_back(ty);
+                readOnly = readNone = false;
+                if (isReadWrite) {
+                    addConstraint(TiedConstraints, "*" + C.drop_front().ltrim('&'));
+                    tiedArgs.push_back(addr);
+                    tiedElementTypes.push_back(ty);
+                }
+                continue;
+            }
+            llvm::Type *resultTy = ty->isIntegerTy(1) ? type_cache.integer_types[3] : ty;
+            addConstraint(Constraints, "=" + C.drop_front());
+            resultTypes.push_back(resultTy);
+            outputTypes.push_back(resultTy);
+            results.push_back(AsmResult{addr, ty, getLValueAlign(op.e)});
+            if (isReadWrite) {
+                llvm::Value *V = load(addr, ty, getLValueAlign(op.e));
+                if (resultTy != ty)
+                    V = createIntCast(V, resultTy);
+                addConstraint(TiedConstraints, Twine(i));
+                tiedArgs.push_back(V);
+                tiedElementTypes.push_back(nullptr);
+            }
+        }
+        for (const AsmOperand &op : s->asm_inputs) {
+            const StringRef C = op.constraint.str();
+            if (GCCAsmTarget::isMemoryOnly(C)) {
+                llvm::Value *addr = getAddress(op.e);
+                addConstraint(Constraints, "*" + C);
+                args.push_back(addr);
+                argTypes.push_back(addr->getType());
+                elementTypes.push_back(wrap(op.e->ty));
+                readNone = false;
+                continue;
+            }
+            llvm::Value *V = gen(op.e);
+            unsigned N;
+            if (llvm::isDigit(C.front()) && !C.getAsInteger(10, N)) {
+                // a matching constraint, the value must have the type of the output
+                llvm::Type *outTy = outputTypes[N];
+                if (V->getType()->isIntegerTy() && outTy->isIntegerTy())
+                    V = createIntCast(V, outTy, op.e->ty->isSigned());
+            }
+            addConstraint(Constraints, C);
+            args.push_back(V);
+            argTypes.push_back(V->getType());
+            elementTypes.push_back(nullptr);
+        }
+        if (!TiedConstraints.empty()) {
+            addConstraint(Constraints, TiedConstraints);
+            for (llvm::Value *V : tiedArgs) {
+                args.push_back(V);
+                argTypes.push_back(V->getType());
+            }
+            elementTypes.append(tiedElementTypes);
+        }
+        for (label_t L : s->asm_labels) {
+            llvm::BlockAddress *BA = llvm::BlockAddress::get(currentfunction, labels[L]);
+            addConstraint(Constraints, "i");
+            args.push_back(BA);
+            argTypes.push_back(BA->getType());
+            elementTypes.push_back(nullptr);
+        }
+        for (const xstring &Clobber : s->asm_clobbers) {
+            if (Clobber.str() == "memory")
+                readOnly = readNone = false;
+            addConstraint(Constraints, "~{" + Clobber.str() + "}");
+        }
+        const StringRef TargetClobbers = target.getClobbers();
+        if (!TargetClobbers.empty())
+            addConstraint(Constraints, TargetClobbers);
+        llvm::Type *resultTy = resultTypes.empty()       ? type_cache.void_type
+                               : resultTypes.size() == 1 ? resultTypes.front()
+                                                         : llvm::StructType::get(getLLVMContext(), resultTypes);
+        llvm::FunctionType *FTy = llvm::FunctionType::get(resultTy, argTypes, false);
+        llvm::InlineAsm *IA = llvm::InlineAsm::get(FTy, s->asm_template.str(), Constraints, s->asm_volatile);
+        llvm::CallBase *Result;
+        llvm::BasicBlock *fallthrough = nullptr;
+        SmallVector<llvm::BasicBlock *, 4> indirectDests;
+        if (s->asm_labels.empty()) {
+            Result = call(FTy, IA, args);
+        } else {
+            // asm goto: the results of a callbr are only defined on the fallthrough edge in LLVM 15, so the outputs are
+            // stored there and the indirect destinations are the labels
+            fallthrough = addBB();
+            for (label_t L : s->asm_labels)
+                indirectDests.push_back(labels[L]);
+            Result = Insert(llvm::CallBrInst::Create(FTy, IA, fallthrough, indirectDests, args, "", insertBB));
         }
+        Result->addFnAttr(llvm::Attribute::NoUnwind);
+        for (unsigned i = 0; i < elementTypes.size(); ++i)
+            if (elementTypes[i])
+                Result->addParamAttr(i, llvm::Attribute::get(getLLVMContext(), llvm::Attribute::ElementType, elementTypes[i]));
+        if (!s->asm_volatile) {
+            if (readNone)
+                Result->setDoesNotAccessMemory();
+            else if (readOnly)
+                Result->setOnlyReadsMemory();
+        }
+        auto storeResults = [&] {
+            for (unsigned i = 0; i < results.size(); ++i) {
+                llvm::Value *V = results.size() == 1 ? static_cast<llvm::Value *>(Result) : extractValue(Result, i);
+                if (V->getType() != results[i].ty)
+                    V = createIntCast(V, results[i].ty);
+                store(results[i].addr, V, results[i].align);
+            }
+        };
+        if (fallthrough)
+            after(fallthrough);
+        storeResults();
     }
     uint64_t getSizeInBits(llvm::Type *ty) { return options.DL.getTypeSizeInBits(ty); }
     uint64_t getSizeInBits(CType ty) { return getSizeInBits(wrap(ty)); }
@@ -539,21 +825,289 @@ GEP: ;
         Phi->addIncoming(L, rightBB);
         return Phi;
     }
+    // attributes of both functions and global variables
+    void addGlobalAttributes(llvm::GlobalObject *GO, const DeclAttributes &A, bool isDefinition) {
+        if (!A.section.empty())
+            GO->setSection(A.section);
+        if (A.has(DeclAttributes::Used))
+            usedGlobals.insert(GO);
+        if (A.has(DeclAttributes::Weak) && !GO->hasLocalLinkage())
+            GO->setLinkage(isDefinition || !GO->isDeclaration() ? llvm::GlobalValue::WeakAnyLinkage
+                                                                : llvm::GlobalValue::ExternalWeakLinkage);
+        if (A.visibility != DeclAttributes::VisibilityUnspecified && !GO->hasLocalLinkage())
+            GO->setVisibility(static_cast<llvm::GlobalValue::VisibilityTypes>(A.visibility - 1));
+        if (!A.alias.empty())
+            aliases[GO] = &A;
+    }
+    void addGlobalVarAttributes(llvm::GlobalVariable *GV, const DeclAttributes &A) {
+        // common symbols cannot be placed in a section, or be weak
+        if (GV->hasCommonLinkage() && (!A.section.empty() || A.has(DeclAttributes::Weak)))
+            GV->setLinkage(ExternalLinkage);
+        addGlobalAttributes(GV, A, false);
+    }
+    void addFunctionAttributes(llvm::Function *F, const DeclAttributes &A, bool isDefinition) {
+        if (A.has(DeclAttributes::AlwaysInline)) {
+            // inlined even at -O0, see setOptimizationAttributes()
+            F->removeFnAttr(llvm::Attribute::OptimizeNone);
+            F->removeFnAttr(llvm::Attribute::NoInline);
+            F->addFnAttr(llvm::Attribute::AlwaysInline);
+        } else if (A.has(DeclAttributes::NoInline)) {
+            F->removeFnAttr(llvm::Attribute::InlineHint);
+            F->addFnAttr(llvm::Attribute::NoInline);
+        }
+        if (A.has(DeclAttributes::Hot))
+            F->addFnAttr(llvm::Attribute::Hot);
+        if (A.has(DeclAttributes::Cold))
+            F->addFnAttr(llvm::Attribute::Cold);
+        if (A.has(DeclAttributes::Const))
+            F->setDoesNotAccessMemory();
+        else if (A.has(DeclAttributes::Pure))
+            F->setOnlyReadsMemory();
+        if (A.has(DeclAttributes::Malloc) && F->getReturnType()->isPointerTy())
+            F->addRetAttr(llvm::Attribute::NoAlias);
+        if (A.has(DeclAttributes::NoReturn))
+            F->setDoesNotReturn();
+        if (A.nonnull) {
+            for (unsigned i = 0, e = std::min<unsigned>(F->arg_size(), 64); i < e; ++i)
+                if ((A.nonnull >> i & 1) && F->getArg(i)->getType()->isPointerTy())
+                    F->addParamAttr(i, llvm::Attribute::NonNull);
+        }
+        if (A.align)
+            F->setAlignment(llvm::Align(A.align));
+        addGlobalAttributes(F, A, isDefinition);
+    }
+    // the optimization attributes of a function definition, from -O/-Os/-Oz and the optimize, hot and cold attributes.
+    // LLVM has no per-function -O1/-O2/-O3, they only turn off optimizing for size.
+    void setOptimizationAttributes(llvm::Function *F, const DeclAttributes *A) {
+        unsigned level = options.OptimizationLevel, size = options.OptimizeSize;
+        switch (A ? A->optimize : DeclAttributes::OptimizeUnspecified) {
+        case DeclAttributes::OptimizeUnspecified:
+            // a hot function is optimized for speed even at -Os, a cold function for size even at -O3
+            if (A && A->has(DeclAttributes::Hot))
+                size = 0;
+            else if (A && A->has(DeclAttributes::Cold))
+                size = 2;
+            break;
+        case DeclAttributes::OptimizeO0: level = 0; break;
+        case DeclAttributes::OptimizeO1: level = 1, size = 0; break;
+        case DeclAttributes::OptimizeO2: level = 2, size = 0; break;
+        case DeclAttributes::OptimizeO3: level = 3, size = 0; break;
+        case DeclAttributes::OptimizeOs: level = 2, size = 1; break;
+        case DeclAttributes::OptimizeOz: level = 2, size = 2; break;
+        }
+        F->removeFnAttr(llvm::Attribute::OptimizeNone);
+        F->removeFnAttr(llvm::Attribute::OptimizeForSize);
+        F->removeFnAttr(llvm::Attribute::MinSize);
+        if (level == 0) {
+            // always_inline functions are inlined even at -O0
+            if (!(A && A->has(DeclAttributes::AlwaysInline))) {
+                F->addFnAttr(llvm::Attribute::NoInline);
+                F->addFnAttr(llvm::Attribute::OptimizeNone);
+            }
+            return;
+        }
+        if (size)
+            F->addFnAttr(llvm::Attribute::OptimizeForSize);
+        if (size == 2)
+            F->addFnAttr(llvm::Attribute::MinSize);
+    }
+    // the explicit alignment of a variable: `_Alignas`, and the aligned attribute of the variable or its struct type
+    llvm::MaybeAlign getDeclAlign(const VarDecl &D) {
+        llvm::MaybeAlign align = D.ty->getAlignAsMaybeAlign();
+        uint64_t attrAlign = D.attrs ? D.attrs->align : 0;
+        // aligned(N) on the record, or an over-aligned member
+        if (D.ty->getKind() == TYTAG && !D.ty->isEnum() && D.ty->getRecord())
+            attrAlign = std::max(attrAlign, type_cache.getAlignof(D.ty));
+        if (attrAlign)
+            align = std::max(align.valueOrOne(), llvm::Align(attrAlign));
+        return align;
+    }
+    static bool isRestrictPointer(CType ty) { return ty->getKind() == TYPOINTER && ty->hasTag(TYRESTRICT); }
+    // a restrict-qualified parameter is the only way to access the objects it points to in the function(C11 6.7.3.1),
+    // and these objects are never modified if it points to const.
+    // like clang, only definitions get these attributes: a caller cannot rely on the qualifiers of a prototype
+    void addParamAttributes(llvm::Function *F, CType functy) {
+        const auto &params = functy->params;
+        for (unsigned i = 0, e = std::min<unsigned>(params.size(), F->arg_size()); i < e; ++i) {
+            CType ty = params[i].ty;
+            if (!isRestrictPointer(ty))
+                continue;
+            F->addParamAttr(i, llvm::Attribute::NoAlias);
+            if (ty->p->hasTag(TYCONST))
+                F->addParamAttr(i, llvm::Attribute::ReadOnly);
+        }
+    }
+    // Give an alias scope to each restrict pointer of the function that always has the value it is initialized with: the
+    // restrict parameters, and the restrict locals at the top level of the body that are not based on another restrict pointer.
+    // `llvm.experimental.noalias.scope.decl` keeps the scopes distinct after the function is inlined.
+    void declareRestrictScopes(Stmt s) {
+        SmallVector<unsigned, 4> candidates;
+        const auto &params = s->functy->params;
+        for (unsigned i = 0; i < params.size(); ++i)
+            if (isRestrictPointer(params[i].ty))
+                candidates.push_back(s->localStart + i);
+        for (Stmt ptr = s->funcbody->next; ptr; ptr = ptr->next) {
+            if (ptr->k != SVarDecl)
+                continue;
+            for (const VarDecl &it : ptr->vars) {
+                if (!isRestrictPointer(it.ty) || it.ty->isGlobalStorage() || it.ty->hasTag(TYTYPEDEF))
+                    continue;
+                if (it.init) {
+                    RestrictPointerUseFinder finder;
+                    finder.VisitExpr(it.init);
+                    if (finder.found)
+                        continue;
+                }
+                candidates.push_back(it.idx);
+            }
+        }
+        if (candidates.size() < 2)
+            return;
+        RestrictPointerFilter(candidates).Visit(s);
+        if (candidates.size() < 2)
+            return;
+        llvm::MDBuilder MDB(getLLVMContext());
+        llvm::MDNode *Domain = MDB.createAnonymousAliasScopeDomain(currentfunction->getName());
+        for (unsigned idx : candidates) {
+            llvm::MDNode *Scope = MDB.createAnonymousAliasScope(Domain);
+            restrictScopes.emplace_back(idx, Scope);
+            call(llvm::Intrinsic::experimental_noalias_scope_decl, {llvm::MetadataAsValue::get(getLLVMContext(), llvm::MDNode::get(getLLVMContext(), Scope))});
+        }
+    }
+    // a load or a store through a restrict pointer is in the scope of the pointer, and does not alias the accesses through the others
+    void addRestrictMetadata() {
+        DenseMap<llvm::Value *, unsigned> scopeOf; // the alloca of a restrict pointer => its index in restrictScopes
+        for (unsigned i = 0; i < restrictScopes.size(); ++i)
+            scopeOf[vars[restrictScopes[i].first]] = i;
+        SmallVector<llvm::Metadata *, 4> others;
+        for (llvm::BasicBlock &BB : *currentfunction) {
+            for (llvm::Instruction &I : BB) {
+                if (!isa<llvm::LoadInst>(I) && !isa<llvm::StoreInst>(I))
+                    continue;
+                const llvm::Value *Obj = llvm::getUnderlyingObject(llvm::getLoadStorePointerOperand(&I));
+                const auto *Load = dyn_cast<llvm::LoadInst>(Obj);
+                if (!Load)
+                    continue;
+                auto it = scopeOf.find(Load->getPointerOperand());
+                if (it == scopeOf.end())
+                    continue;
+                others.clear();
+                for (unsigned i = 0; i < restrictScopes.size(); ++i)
+                    if (i != it->second)
+                        others.push_back(restrictScopes[i].second);
+                I.setMetadata(LLVMContext::MD_alias_scope, llvm::MDNode::get(getLLVMContext(), restrictScopes[it->second].second));
+                I.setMetadata(LLVMContext::MD_noalias, llvm::MDNode::get(getLLVMContext(), others));
+            }
+        }
+        restrictScopes.clear();
+    }
+    // llvm.lifetime.start for a block-scoped local whose declaration cannot be jumped over, the lifetime ends when the
+    // compound statement is left, so that StackColoring can overlap the locals of disjoint scopes
+    void startLifetime(llvm::AllocaInst *AI, CType ty, unsigned idx) {
+        if (!bypasses || lifetimeScopes.empty() || bypasses->isBypassed(idx))
+            return;
+        const uint64_t size = type_cache.getsizeof(ty);
+        if (size < CC_LIFETIME_MIN_SIZE)
+            return;
+        llvm::Constant *Size = ConstantInt::get(type_cache.integer_types[6], size);
+        call(llvm::Intrinsic::lifetime_start, {Size, AI}, {AI->getType()});
+        lifetimeScopes.back().started.emplace_back(AI, Size);
+    }
+    void endLifetimes(const LifetimeScope &LS) {
+        for (const auto &it : llvm::reverse(LS.started))
+            call(llvm::Intrinsic::lifetime_end, {it.second, it.first}, {it.first->getType()});
+    }
+    void leaveLifetimeScope() {
+        const LifetimeScope LS = lifetimeScopes.pop_back_val();
+        if (!getTerminator())
+            endLifetimes(LS);
+    }
+    // a jump to `L` leaves the compound statements that do not contain `L`, their lifetimes end before the jump
+    bool leavesLifetimeScopes(label_t L) {
+        if (!bypasses)
+            return false;
+        const unsigned To = bypasses->getLabelScope(L);
+        for (const LifetimeScope &LS : llvm::reverse(lifetimeScopes)) {
+            if (To == unsigned(-1) || bypasses->isAncestor(LS.scope, To))
+                return false;
+            if (!LS.started.empty())
+                return true;
+        }
+        return false;
+    }
+    void endLifetimesForJump(label_t L) {
+        const unsigned To = bypasses->getLabelScope(L);
+        for (const LifetimeScope &LS : llvm::reverse(lifetimeScopes)) {
+            if (bypasses->isAncestor(LS.scope, To))
+                break;
+            endLifetimes(LS);
+        }
+    }
+    // the destination of a conditional jump to `L`: a block ending the lifetimes left by the jump if there are any
+    llvm::BasicBlock *getJumpDest(label_t L) {
+        if (!leavesLifetimeScopes(L))
+            return labels[L];
+        llvm::BasicBlock *Saved = insertBB, *BB = addBB();
+        after(BB);
+        endLifetimesForJump(L);
+        br(labels[L]);
+        after(Saved);
+        return BB;
+    }
+    // replace the declarations with `alias("target")` by aliases of the targets, which must be defined in this translation unit
+    void emitAliases() {
+        for (const auto &it : aliases) {
+            llvm::GlobalObject *GO = it.first;
+            const DeclAttributes &A = *it.second;
+            if (!GO->isDeclaration()) {
+                error(A.aliasLoc, "%R is defined, it cannot be an alias", GO->getName());
+                continue;
+            }
+            llvm::GlobalValue *Target = module->getNamedValue(A.alias);
+            if (!Target || Target->isDeclaration()) {
+                error(A.aliasLoc, "alias must point to a defined variable or function");
+                continue;
+            }
+            llvm::GlobalValue::LinkageTypes L = GO->hasLocalLinkage()          ? InternalLinkage
+                                                : GO->hasExternalWeakLinkage() ? llvm::GlobalValue::WeakAnyLinkage
+                                                                               : ExternalLinkage;
+            llvm::GlobalAlias *GA =
+                llvm::GlobalAlias::create(GO->getValueType(), GO->getAddressSpace(), L, "", Target, module.get());
+            GA->setVisibility(GO->getVisibility());
+            GO->replaceAllUsesWith(GA);
+            GA->takeName(GO);
+            usedGlobals.remove(GO);
+            GO->eraseFromParent();
+        }
+        aliases.clear();
+    }
+    void emitUsedGlobals() {
+        SmallVector<llvm::GlobalValue *, 4> used;
+        for (llvm::GlobalObject *GO : usedGlobals)
+            if (!GO->isDeclaration())
+                used.push_back(GO);
+        if (!used.empty())
+            llvm::appendToUsed(*module, used);
+        usedGlobals.clear();
+    }
     llvm::Function *newFunction(llvm::FunctionType *fty, IdentRef name, type_tag_t tags, size_t idx,
-                                bool isDefinition = false) {
+                                bool isDefinition = false, const DeclAttributes *attrs = nullptr) {
         auto old = module->getFunction(name->getKey());
-        if (old)
+        if (old) {
+            if (attrs)
+                addFunctionAttributes(old, *attrs, isDefinition);
             return old;
+        }
         auto F = addFunction(fty, name->getKey());
         F->setDSOLocal(true);
         llvm::AttrBuilder builder(getLLVMContext());
         builder.addAttribute(llvm::Attribute::NoUnwind);
-        if (options.OptimizationLevel == 0) {
-            builder.addAttribute(llvm::Attribute::NoInline);
-            builder.addAttribute(llvm::Attribute::OptimizeNone);
-        } else if (isDefinition) {
-            builder.addAttribute(llvm::Attribute::OptimizeForSize);
-        }
+        // the same tuning in every function, LTO and the JIT otherwise fall back to the defaults of the target
+        builder.addAttribute("target-cpu", options.machine->getTargetCPU());
+        if (!options.TuneCPU.empty())
+            builder.addAttribute("tune-cpu", options.TuneCPU);
+        if (!options.machine->getTargetFeatureString().empty())
+            builder.addAttribute("target-features", options.machine->getTargetFeatureString());
         if (tags & TYSTATIC)
             F->setLinkage(InternalLinkage);
         if (tags & TYNORETURN)
@@ -561,6 +1115,8 @@ GEP: ;
         if (tags & TYINLINE)
             builder.addAttribute(llvm::Attribute::InlineHint);
         F->setAttributes(llvm::AttributeList::get(getLLVMContext(), llvm::AttributeList::FunctionIndex, builder));
+        if (attrs)
+            addFunctionAttributes(F, *attrs, isDefinition);
         vars[idx] = F;
         return F;
     }
@@ -622,8 +1178,12 @@ GEP: ;
         case SCompound: {
             if (options.g)
                 di_lex_scopes.push_back(di->createLexicalBlock(getLexScope(), getFile(), getLine(), getColumn()));
+            if (bypasses)
+                lifetimeScopes.push_back(LifetimeScope{bypasses->getCompoundScope(s), {}});
             for (Stmt ptr = s->inner; ptr; ptr = ptr->next)
                 gen(ptr);
+            if (bypasses)
+                leaveLifetimeScope();
             if (options.g)
                 di_lex_scopes.pop_back();
         } break;
@@ -641,7 +1201,10 @@ GEP: ;
             auto ty = cast<llvm::FunctionType>(wrap(s->functy));
             currentfunctionAST = s;
             currentfunction =
-                newFunction(ty, s->funcname, s->functy->getFunctionAttrTy()->getTags(), s->func_idx, true);
+                newFunction(ty, s->funcname, s->functy->getFunctionAttrTy()->getTags(), s->func_idx, true, s->funcattrs);
+            addParamAttributes(currentfunction, s->functy);
+            setOptimizationAttributes(currentfunction, s->funcattrs);
+            flattenCalls = s->funcattrs && s->funcattrs->has(DeclAttributes::Flatten);
             if (options.g) {
                 llvm::DISubroutineType *SubTy = cast<llvm::DISubroutineType>(wrapDIType(s->functy));
                 SP = di->createFunction(getLexScope(), s->funcname->getKey(), getLinkageName(s->functy->getFunctionAttrTy()->getTags()), getFile(), getLine(), SubTy, getLine(), llvm::DINode::FlagZero, llvm::DISubprogram::SPFlagDefinition);
@@ -668,6 +1231,11 @@ GEP: ;
                 vars[s->localStart + arg_no++] = p;
             }
             allocaInsertPt = entry->begin();
+            if (options.OptimizationLevel) {
+                declareRestrictScopes(s);
+                if (!options.DisableLifetimeMarkers)
+                    bypasses.emplace(s);
+            }
             for (Stmt ptr = s->funcbody->next; ptr; ptr = ptr->next)
                 gen(ptr);
             if (!getTerminator()) {
@@ -678,12 +1246,16 @@ GEP: ;
                     ret(llvm::UndefValue::get(retTy));
                 }
             }
+            if (!restrictScopes.empty())
+                addRestrictMetadata();
+            bypasses.reset();
             if (options.g) {
                 di->finalizeSubprogram(SP);
                 di_lex_scopes.pop_back();
             }
             this->labels.clear();
             this->currentfunction = nullptr;
+            flattenCalls = false;
         } break;
         case SReturn: 
         {
@@ -713,23 +1285,22 @@ GEP: ;
         case SGotoWithLoc:
         case SGotoWithLocName:
         case SGoto:
-            if (!getTerminator())
+            if (!getTerminator()) {
+                if (leavesLifetimeScopes(s->location))
+                    endLifetimesForJump(s->location);
                 br(labels[s->location]);
+            }
             break;
         case SCondJump: {
             auto cond = gen_cond(s->test);
-            if (!getTerminator())
-                condbr(cond, labels[s->T], labels[s->F]);
-        } break;
-        case SAsm:
-            if (currentfunction)
-                module->appendModuleInlineAsm(s->asms);
-            else {
-                auto ty = llvm::FunctionType::get(type_cache.void_type, false);
-                auto f = llvm::InlineAsm::get(ty, s->asms, StringRef(), true);
-                call(ty, f);
+            if (!getTerminator()) {
+                llvm::BranchInst *Branch = condbr(cond, getJumpDest(s->T), getJumpDest(s->F));
+                if (s->hint != BH_None)
+                    Branch->setMetadata(LLVMContext::MD_prof, createBranchHintWeights(s->hint));
             }
-            break;
+        } break;
+        case SAsm: handle_asm(s->asms); break;
+        case SGCCAsm: gen_asm(s); break;
         case SVarDecl: {
             for (const auto &it : s->vars) {
                 IdentRef name = it.name;
@@ -737,12 +1308,12 @@ GEP: ;
                 Expr init = it.init;
                 unsigned idx = it.idx;
                 if (options.g) setDebugLoc(it.loc);
-                auto align = varty->getAlignAsMaybeAlign();
+                auto align = getDeclAlign(it);
                 if (varty->hasTag(TYTYPEDEF)) {
                     /* nothing */
                 } else if (varty->getKind() == TYFUNCTION) {
-                    newFunction(cast<llvm::FunctionType>(wrap(varty)), name, varty->getFunctionAttrTy()->getTags(),
-                                idx);
+                    llvm::Function *F = newFunction(cast<llvm::FunctionType>(wrap(varty)), name,
+                                                    varty->getFunctionAttrTy()->getTags(), idx, false, it.attrs);
                 } else if (!currentfunction || varty->isGlobalStorage()) {
                     auto GV = module->getGlobalVariable(name->getKey(), true);
                     if (GV) {
@@ -756,11 +1327,15 @@ GEP: ;
                             }
                         }
                         if (init) {
-                            GV->setInitializer(cast<llvm::Constant>(gen(init))); // now update initializer
+                            GV->setInitializer(buildGlobalInit(init, wrap(varty))); // now update initializer
                             if (!varty->hasTag(TYSTATIC))
                                 GV->setLinkage(ExternalLinkage); // a definition!
                         }
-                        break;
+                        if (align && GV->getAlign().valueOrOne() < *align)
+                            GV->setAlignment(align);
+                        if (it.attrs)
+                            addGlobalVarAttributes(GV, *it.attrs);
+                        continue;
                     }
                     const type_tag_t tags = varty->getTags();
                     llvm::Type *ty = wrap(varty);
@@ -768,27 +1343,25 @@ GEP: ;
                     if (LLVM_UNLIKELY(ty->isVoidTy())) {
                         ty = type_cache.integer_types[3];
                     }
+                    llvm::Constant *ginit = nullptr;
+                    // a variable with `alias("target")` is a declaration until it is replaced by the alias
+                    if (!(tags & TYEXTERN) && !(it.attrs && !it.attrs->alias.empty()))
+                        ginit = init ? buildGlobalInit(init, ty) : llvm::Constant::getNullValue(ty);
                     GV =
                         new llvm::GlobalVariable(*module, ty, tags & TYCONST, ExternalLinkage, nullptr, name->getKey());
-                    GV->setAlignment(align);
-                    GV->setAlignment(options.DL.getPreferredAlign(GV));
-                    if (!(tags & TYEXTERN)) {
-                        llvm::Constant *ginit = 
-                           init ? 
-                           (init->k == EInitList) ? 
-                                buildAggGlobalInit(init, ty) : 
-                                cast<llvm::Constant>(gen(init)) : 
-                            llvm::Constant::getNullValue(ty);
+                    GV->setAlignment(align ? std::max(*align, options.DL.getPreferredAlign(GV)) : options.DL.getPreferredAlign(GV));
+                    if (ginit)
                         GV->setInitializer(ginit), GV->setDSOLocal(true);
-                    }
                     if (tags & TYTHREAD_LOCAL)
                         GV->setThreadLocal(true);
                     if (tags & TYSTATIC)
                         GV->setLinkage(InternalLinkage);
                     else if (tags & TYEXTERN)
                         GV->setLinkage(ExternalLinkage);
-                    else if (!init && !(tags & TYCONST))
+                    else if (!init && !(tags & TYCONST) && ginit)
                         GV->setLinkage(CommonLinkage);
+                    if (it.attrs)
+                        addGlobalVarAttributes(GV, *it.attrs);
                     if (options.g) {
                         llvm::DIGlobalVariableExpression *GVE = di->createGlobalVariableExpression(getLexScope(), name->getKey(), getLinkageName(varty->getTags()), getFile(), getLine(), wrapDIType(varty), false, GV->isDeclaration());
                         GV->addDebugInfo(GVE);
@@ -796,7 +1369,7 @@ GEP: ;
                     vars[idx] = GV;
                 } else {
                     if (LLVM_UNLIKELY(scope_index_is_unnamed_alloca(idx))) {
-                        if (init->k == EInitList) {
+                        if (isAggInitList(init)) {
                             scope_index_restore_unnamed_alloca(idx);
                         } else {
                             gen(init);
@@ -807,7 +1380,7 @@ GEP: ;
                     llvm::Value *alloca_size;
                     llvm::Type *ty;
                     llvm::MaybeAlign Align;
-                    Align = varty->getAlignAsMaybeAlign();
+                    Align = align;
                     if (LLVM_UNLIKELY(varty->isVLA())) {
                         // llvm.stackrestore()
                         // llvm.stacksave()
@@ -837,12 +1410,14 @@ GEP: ;
                     vars[idx] = val;
                     if (align.hasValue())
                         val->setAlignment(align.valueOrOne());
+                    if (!isVLA)
+                        startLifetime(val, varty, idx);
                     if (init) {
-                        if (init->k == EInitList) {
-                            buildAggLocalInit(ty, init, val);
+                        if (isAggInitList(init)) {
+                            buildAggLocalInit(ty, init, val, val->getAlign());
                         } else {
                             auto initv = gen(init);
-                            store(val, initv, align);
+                            setTBAA(store(val, initv, align), varty);
                         }
                     }
                 }
@@ -850,24 +1425,83 @@ GEP: ;
         } break;
         }
     }
+    // a vector initializer list is a value(see gen), other initializer lists are stored member by member
+    static bool isAggInitList(Expr e) { return e->k == EInitList && e->ty->getKind() != TYVECTOR; }
+    // the initializer of a global variable of type `T`
+    llvm::Constant *buildGlobalInit(Expr init, llvm::Type *T) {
+        if (init->k != EInitList)
+            return cast<llvm::Constant>(gen(init));
+        return buildAggGlobalInit(init, T);
+    }
     llvm::Constant *buildAggGlobalInit(Expr e, llvm::Type *T) {
-        llvm_unreachable("un-implemented");
-        return nullptr;
+        if (!e->packed)
+            llvm_unreachable("un-implemented");
+        llvm::ArrayType *AT = cast<llvm::ArrayType>(T);
+        llvm::Constant *C = getPackedArrayConstant(e->packed, AT);
+        if (e->inits.empty())
+            return C;
+        // address constants(e.g. `(long)&x`) are not packed: patch them into the array, over the whole `[a ... b]`
+        SmallVector<llvm::Constant *, 0> elems;
+        elems.resize_for_overwrite(AT->getNumElements());
+        for (unsigned i = 0;i < elems.size();++i)
+            elems[i] = C->getAggregateElement(i);
+        for (const Initializer &it : e->inits) {
+            const Designator D = it.getDesignator();
+            const uint32_t last = D.isSingle() ? D.getStart() : D.getEnd();
+            llvm::Constant *V = cast<llvm::Constant>(gen(it.value));
+            for (uint32_t i = D.getStart(); i <= last; ++i)
+                elems[i] = V;
+        }
+        return llvm::ConstantArray::get(AT, elems);
+    }
+    // dense: copy the array from a private constant, sparse: clear the array and copy each run.
+    // `Base` is the alignment of the array, lower than the element's in a packed struct
+    void buildPackedLocalInit(llvm::ArrayType *T, const PackedArrayData *P, llvm::Value *val, llvm::Align Base) {
+        llvm::Type *elemTy = T->getElementType();
+        const llvm::Align A = std::min(options.DL.getABITypeAlign(elemTy), Base);
+        if (P->numRuns && isDensePackedArray(P, T->getNumElements())) {
+            createMemCpy(val, createPrivateConstant(getPackedArrayConstant(P, T), A), options.DL.getTypeAllocSize(T), A);
+            return;
+        }
+        createMemSet(val, 0, options.DL.getTypeAllocSize(T), A);
+        for (const PackedArrayData::Run &R : P->getRuns()) {
+            llvm::Constant *C = llvm::ConstantDataArray::getRaw(P->getBytes(R), R.length, elemTy);
+            llvm::Value *p = gep(elemTy, val, R.start);
+            if (R.length == 1)
+                store(p, C->getAggregateElement(0U), llvm::commonAlignment(A, uint64_t(R.start) * P->elementSize));
+            else
+                createMemCpy(p, createPrivateConstant(C, A), uint64_t(R.length) * P->elementSize, A);
+        }
     }
-    void buildAggLocalInit(llvm::Type *T, Expr e, llvm::Value *val) {
+    // `A` is the alignment of `val`, the stores are aligned to the offsets of the members in it
+    void buildAggLocalInit(llvm::Type *T, Expr e, llvm::Value *val, llvm::Align A) {
+        if (e->packed)
+            buildPackedLocalInit(cast<llvm::ArrayType>(T), e->packed, val, A);
         SmallVector<unsigned> idxs;
         for (const Initializer &it : e->inits) {
             ArrayRef<Designator> designators = it.getDesignatorsOneOrMore();
             idxs.resize_for_overwrite(designators.size());
-            for (size_t i = 0;i < designators.size();++i)
+            uint64_t Offset = 0;
+            llvm::Type *Ty = T;
+            for (size_t i = 0;i < designators.size();++i) {
                 idxs[i] = designators[i].getStart();
+                if (const auto ST = dyn_cast<llvm::StructType>(Ty)) {
+                    const unsigned elem = type_cache.getElementIndex(ST, idxs[i]);
+                    Offset += options.DL.getStructLayout(ST)->getElementOffset(elem);
+                    Ty = ST->getElementType(elem);
+                } else {
+                    Ty = Ty->getArrayElementType();
+                    Offset += idxs[i] * options.DL.getTypeAllocSize(Ty);
+                }
+            }
+            const llvm::Align ElemAlign = llvm::commonAlignment(A, Offset);
             llvm::Value *p = structGEP(T, val, idxs);
-            if (it.value->k == EInitList) {
+            if (isAggInitList(it.value)) {
                 llvm::Type *elemTy = wrap(it.value->ty);
-                buildAggLocalInit(elemTy, it.value, p);
+                buildAggLocalInit(elemTy, it.value, p, ElemAlign);
             } else {
                 llvm::Value *v = gen(it.value);
-                store(p, v);
+                store(p, v, std::min(options.DL.getABITypeAlign(v->getType()), ElemAlign));
             }
             idxs.clear();
         }
@@ -881,6 +1515,11 @@ GEP: ;
         return GV;
     }
     llvm::Value *subscript(Expr e, llvm::Type *&ty) {
+        // an element of a vector lvalue is addressed in the vector's memory
+        if (e->left->ty->getKind() == TYVECTOR) {
+            ty = wrap(e->ty);
+            return gep(ty, getAddress(e->left), {gen(e->right)});
+        }
         ty = wrap(e->left->ty->p);
         llvm::Value *v = gen(e->left);
         llvm::Value *r = gen(e->right);
@@ -901,9 +1540,10 @@ GEP: ;
         switch (e->k) {
         case EVar: return vars[e->sval];
         case EMemberAccess: {
-            llvm::Value *agg = getAddress(e->obj);
-            llvm::Type *ty = wrap(e->obj->ty);
-            return structGEP(ty, agg, e->idxs);
+            // `p->member` or `s.member`
+            if (e->obj->ty->getKind() == TYPOINTER)
+                return structGEP(wrap(e->obj->ty->p), gen(e->obj), e->idxs);
+            return structGEP(wrap(e->obj->ty), getAddress(e->obj), e->idxs);
         }
         case EUnary:
             switch (e->uop) {
@@ -924,7 +1564,7 @@ GEP: ;
         case EString:
             return createString(e);
         default:
-            if (e->ty->hasTag(TYREPLACED_CONSTANT)) {
+            if (e->isReplacedConstant()) {
                 auto e2 = reinterpret_cast<ReplacedExpr *>(e);
                 return vars[e2->id];
             }
@@ -958,19 +1598,359 @@ GEP: ;
         assert(ty->isVLA());
         return genVLASizeof(ty->vla_expr, ty->vla_arraytype);
     }
+    // returns true if the binary operator evaluates both operands with gen() and then combines them
+    static bool isSimpleBinOp(enum BinOp op) {
+        switch (op) {
+        case LogicalAnd:
+        case LogicalOr:
+        case Assign:
+        case AtomicrmwAdd:
+        case AtomicrmwSub:
+        case AtomicrmwXor:
+        case AtomicrmwOr:
+        case AtomicrmwAnd: return false;
+        default: return true;
+        }
+    }
+    // generate a left-leaning chain of binary operators(e.g., a0 + a1 + ... + a100000) with an explicit stack,
+    // so that the native stack usage does not depend on the length of the chain
+    llvm::Value *gen_binop_chain(Expr e) {
+        SmallVector<Expr, 16> spine;
+        Expr it = e;
+        do {
+            spine.push_back(it);
+            it = it->lhs;
+        } while (it->k == EBin && isSimpleBinOp(it->bop));
+        llvm::Value *lhs = gen(it);
+        for (size_t i = spine.size(); i--;) {
+            Expr node = spine[i];
+            llvm::Value *rhs = gen(node->rhs);
+            if (options.g)
+                setDebugLoc(node->getBeginLoc());
+            lhs = gen_binop(node, lhs, rhs);
+        }
+        return lhs;
+    }
+    llvm::Value *gen_binop(Expr e, llvm::Value *lhs, llvm::Value *rhs) {
+        unsigned pop = 0;
+        switch (e->bop) {
+        case LogicalOr:
+        case LogicalAnd:
+        case Assign:
+        case AtomicrmwAdd:
+        case AtomicrmwSub:
+        case AtomicrmwXor:
+        case AtomicrmwOr: 
+        case AtomicrmwAnd:
+            llvm_unreachable("invalid control follow");
+        case SAdd:
+        { 
+            llvm::BinaryOperator *it = add(lhs, rhs);
+            it->setHasNoSignedWrap(true);
+            return it;
+        }
+        // clang::ComplexExprEmitter::EmitBinAdd
+        case CAdd: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const l = add(a, c), *const r = add(b, d);
+            return make_complex_pair(e->ty, l, r);
+        }
+        case CFAdd: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const l = fadd(a, c), *const r = fadd(b, d);
+            return make_complex_pair(e->ty, l, r);
+        }
+        // clang::ComplexExprEmitter::EmitBinSub
+        case CFSub: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const l = fsub(a, c), *const r = fsub(b, d);
+            return make_complex_pair(e->ty, l, r);
+        }
+        case CSub: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const l = sub(a, c), *const r = sub(b, d);
+            return make_complex_pair(e->ty, l, r);
+        }
+        // clang::ComplexExprEmitter::EmitBinMul
+        case CFMul: {
+            llvm::Value *LibCallI, *LibCallR;
+            llvm::MDBuilder MDHelper(getLLVMContext());
+            llvm::StructType *ty = cast<llvm::StructType>(wrap(e->ty));
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const AC = fmul(a, c), *const BD = fmul(b, d),
+                               *const AD = fmul(a, d), *const BC = fmul(b, c),
+                               *const ResR = fsub(AC, BD), *const ResI = fadd(AD, BC),
+                               *const IsRNaN = fcmp(llvm::FCmpInst::FCMP_UNO, ResR, ResR);
+            llvm::BasicBlock *ContBB = newBB(), *INaNBB = newBB();
+            llvm::BranchInst *Branch = condbr(IsRNaN, INaNBB, ContBB);
+            llvm::MDNode *BrWeight = MDHelper.createBranchWeights(1, (1U << 20) - 1);
+            llvm::BasicBlock *OrigBB = Branch->getParent();
+            Branch->setMetadata(LLVMContext::MD_prof, BrWeight);
+            append(INaNBB);
+            llvm::Value *const IsINaN = fcmp(llvm::FCmpInst::FCMP_UNO, ResI, ResI);
+            llvm::BasicBlock *LibCallBB = newBB();
+            Branch = condbr(IsINaN, LibCallBB, ContBB);
+            Branch->setMetadata(LLVMContext::MD_prof, BrWeight);
+            append(LibCallBB);
+            {
+                llvm::Type *real_ty = ty->getTypeAtIndex((unsigned)0);
+                StringRef LibCallName;
+                switch (real_ty->getTypeID()) {
+                default: llvm_unreachable("Unsupported floating point type!");
+                case llvm::Type::HalfTyID: LibCallName = "__mulhc3"; break;
+                case llvm::Type::FloatTyID: LibCallName = "__mulsc3"; break;
+                case llvm::Type::DoubleTyID: LibCallName = "__muldc3"; break;
+                case llvm::Type::PPC_FP128TyID: LibCallName = "__multc3"; break;
+                case llvm::Type::X86_FP80TyID: LibCallName = "__mulxc3"; break;
+                case llvm::Type::FP128TyID: LibCallName = "__multc3"; break;
+                }
+                ArrayRef<llvm::Type *> Params = {real_ty, real_ty, real_ty, real_ty};
+                ArrayRef<llvm::Value *> Args = {a, b, c, d};
+                llvm::FunctionType *FTY = llvm::FunctionType::get(ty, Params, false);
+                llvm::AttributeList attrs = llvm::AttributeList::get(
+                    getLLVMContext(), llvm::AttributeList::FunctionIndex,
+                    {llvm::Attribute::NoUnwind, llvm::Attribute::ReadNone, llvm::Attribute::MustProgress,
+                     llvm::Attribute::WillReturn, llvm::Attribute::NoRecurse, llvm::Attribute::NoSync,
+                     llvm::Attribute::NoFree});
+                llvm::FunctionCallee F_C = module->getOrInsertFunction(LibCallName, FTY, attrs);
+                llvm::CallInst *LibCallRes = call(F_C, Args);
+                LibCallR = gen_complex_real(LibCallRes);
+                LibCallI = gen_complex_imag(LibCallRes);
+            }
+            br(ContBB);
+            append(ContBB);
+            llvm::PHINode *RealPHI = phi(ResR->getType(), 3);
+            RealPHI->addIncoming(ResR, OrigBB);
+            RealPHI->addIncoming(ResR, INaNBB);
+            RealPHI->addIncoming(LibCallR, LibCallBB);
+            llvm::PHINode *ImagPHI = phi(ResI->getType(), 3);
+            ImagPHI->addIncoming(ResI, OrigBB);
+            ImagPHI->addIncoming(ResI, INaNBB);
+            ImagPHI->addIncoming(LibCallI, LibCallBB);
+            return make_complex_pair(ty, RealPHI, ImagPHI);
+        }
+        case CMul: {
+            // (a + ib) * (c + id) = (a * c - b * d) + i(a * d + b * c)
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
+            return make_complex_pair(wrapComplexForInteger(e->ty),
+                                     sub(mul(a, c), mul(b, d)),
+                                     sub(mul(a, d), mul(b, c)));
+        }
+        // clang::ComplexExprEmitter::EmitBinDiv
+        case CSDiv: {
+            // (a+ib) / (c+id) = ((ac+bd)/(cc+dd)) + i((bc-ad)/(cc+dd))
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const cc = mul(c, c), *const dd = mul(d, d),
+                               *const cc_plus_dd = add(cc, dd), *const ac = add(a, c),
+                               *const bd = add(b, d), *const bc = add(b, c),
+                               *const ad = add(a, d),
+                               *const L = sdiv(add(ac, bd), cc_plus_dd),
+                               *const R = sdiv(mul(bc, ad), cc_plus_dd);
+            return make_complex_pair(wrapComplexForInteger(e->ty), L, R);
+        }
+        case CUDiv: {
+            // (a+ib) / (c+id) = ((ac+bd)/(cc+dd)) + i((bc-ad)/(cc+dd))
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
+                               *const cc = mul(c, c), *const dd = mul(d, d),
+                               *const cc_plus_dd = add(cc, dd), *const ac = add(a, c),
+                               *const bd = add(b, d), *const bc = add(b, c),
+                               *const ad = add(a, d),
+                               *const L = udiv(sub(ac, bd), cc_plus_dd),
+                               *const R = udiv(sub(bc, ad), cc_plus_dd);
+            return make_complex_pair(wrapComplexForInteger(e->ty), L, R);
+        }
+        case CFDiv: {
+            llvm::StructType *ty = cast<llvm::StructType>(wrapComplex(e->ty));
+            llvm::Type *real_ty = ty->getTypeAtIndex((unsigned)0);
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
+            StringRef LibCallName;
+            switch (real_ty->getTypeID()) {
+            default: llvm_unreachable("Unsupported floating point type!");
+            case llvm::Type::HalfTyID: LibCallName = "__divhc3"; break;
+            case llvm::Type::FloatTyID: LibCallName = "__divsc3"; break;
+            case llvm::Type::DoubleTyID: LibCallName = "__divdc3"; break;
+            case llvm::Type::PPC_FP128TyID: LibCallName = "__divtc3"; break;
+            case llvm::Type::X86_FP80TyID: LibCallName = "__divxc3"; break;
+            case llvm::Type::FP128TyID: LibCallName = "__divtc3"; break;
+            }
+            ArrayRef<llvm::Type *> Params = {real_ty, real_ty, real_ty, real_ty};
+            ArrayRef<llvm::Value *> Args = {a, b, c, d};
+            llvm::FunctionType *FTY = llvm::FunctionType::get(ty, Params, false);
+            llvm::AttributeList attrs = llvm::AttributeList::get(
+                getLLVMContext(), llvm::AttributeList::FunctionIndex,
+                {llvm::Attribute::NoUnwind, llvm::Attribute::ReadNone, llvm::Attribute::MustProgress,
+                 llvm::Attribute::WillReturn, llvm::Attribute::NoRecurse, llvm::Attribute::NoSync,
+                 llvm::Attribute::NoFree});
+            llvm::FunctionCallee F_C = module->getOrInsertFunction(LibCallName, FTY, attrs);
+            return call(F_C, Args);
+        }
+        case CEQ: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
+            llvm::Value *L, *R;
+            if (e->lhs->ty->isFloating()) {
+                L = fcmp(llvm::FCmpInst::FCMP_OEQ, a, c);
+                R = fcmp(llvm::FCmpInst::FCMP_OEQ, b, d);
+            } else {
+                L = icmp(llvm::ICmpInst::ICMP_EQ, a, c);
+                R = icmp(llvm::ICmpInst::ICMP_EQ, b, d);
+            }
+            return createAnd(L, R);
+        }
+        case CNE: {
+            llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
+                               *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
+            llvm::Value *L, *R;
+            if (e->lhs->ty->isFloating()) {
+                L = fcmp(llvm::FCmpInst::FCMP_ONE, a, c);
+                R = fcmp(llvm::FCmpInst::FCMP_ONE, b, d);
+            } else {
+                L = icmp(llvm::ICmpInst::ICMP_NE, a, c);
+                R = icmp(llvm::ICmpInst::ICMP_NE, b, d);
+            }
+            return createOr(L, R);
+        }
+        case SSub: {
+            llvm::BinaryOperator *it = sub(lhs, rhs);
+            it->setHasNoSignedWrap(true);
+            return it;
+        }
+        case SMul: {
+            llvm::BinaryOperator *it = mul(lhs, rhs);
+            it->setHasNoSignedWrap(true);
+            return it;
+        }
+        case PtrDiff: {
+            CType target = e->lhs->ty->p;
+            llvm::Value *dividend;
+
+            lhs = ptrtoint(lhs, type_cache.intptrTy);
+            rhs = ptrtoint(rhs, type_cache.intptrTy);
+            llvm::BinaryOperator *diff = sub(lhs, rhs);
+
+            if (LLVM_UNLIKELY(target->isVLA())) {
+                std::pair<llvm::Value *, llvm::Type *> pair = genVLASizeof(target);
+                uint64_t Size = type_cache.getsizeof(pair.second);
+                if (Size == 1) {
+                    dividend = mul(pair.first, llvm::ConstantInt::get(type_cache.intptrTy, Size));
+                    cast<llvm::Instruction>(dividend)->setHasNoSignedWrap(true);
+                } else {
+                    dividend = pair.first;
+                }
+            } else {
+                uint64_t Size = type_cache.getsizeof(target);
+                if (Size == 1)
+                    return diff;
+                dividend = llvm::ConstantInt::get(type_cache.intptrTy, Size);
+            }
+            llvm::BinaryOperator *it = sdiv(diff, dividend);
+            it->setIsExact(true);
+            return it;
+        }
+        case SAddP: {
+            if (const ConstantInt *CI = dyn_cast<ConstantInt>(rhs))
+                if (CI->isZero())
+                    return lhs;
+            CType target = e->ty->p;
+            llvm::Type *T;
+            if (LLVM_UNLIKELY(target->isVLA())) {
+                const std::pair<llvm::Value *, llvm::Type *> pair = genVLASizeof(target);
+                T = pair.second;
+                if (const ConstantInt *CI = dyn_cast<ConstantInt>(rhs)) {
+                    if (CI->getLimitedValue() == 1) {
+                        rhs = pair.first;
+                        goto VLA_NEXT;
+                    }
+                }
+                rhs = mul(pair.first, rhs);
+                cast<llvm::Instruction>(rhs)->setHasNoSignedWrap(true);
+            } else {
+                T = wrap(target);
+            }
+VLA_NEXT:;
+            return gep(T, lhs, {rhs});
+        }
+        case Complex_CMPLX: return make_complex_pair(e->ty, lhs, rhs);
+        case EQ: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_EQ); goto BINOP_ICMP;
+        case NE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_NE); goto BINOP_ICMP;
+        case UGT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_UGT); goto BINOP_ICMP;
+        case UGE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_UGE); goto BINOP_ICMP;
+        case ULT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_ULT); goto BINOP_ICMP;
+        case ULE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_ULE); goto BINOP_ICMP;
+        case SGT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SGT); goto BINOP_ICMP;
+        case SGE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SGE); goto BINOP_ICMP;
+        case SLT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SLT); goto BINOP_ICMP;
+        case SLE:
+            pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SLE);
+            goto BINOP_ICMP;
+BINOP_ICMP:
+            return icmp(static_cast<llvm::CmpInst::Predicate>(pop), lhs, rhs);
+        case FEQ: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OEQ); goto BINOP_FCMP;
+        case FNE: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_ONE); goto BINOP_FCMP;
+        case FGT: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OGT); goto BINOP_FCMP;
+        case FGE: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OGE); goto BINOP_FCMP;
+        case FLT: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OLT); goto BINOP_FCMP;
+        case FLE:
+            pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OLE);
+            goto BINOP_FCMP;
+BINOP_FCMP:
+            return fcmp(static_cast<llvm::CmpInst::Predicate>(pop), lhs, rhs);
+        case Comma: return rhs;
+        case UAdd: pop = llvm::Instruction::Add; goto BINOP_ARITH;
+        case FAdd: pop = llvm::Instruction::FAdd; goto BINOP_ARITH;
+        case USub: pop = llvm::Instruction::Sub; goto BINOP_ARITH;
+        case FSub: pop = llvm::Instruction::FSub; goto BINOP_ARITH;
+        case UMul: pop = llvm::Instruction::Mul; goto BINOP_ARITH;
+        case FMul: pop = llvm::Instruction::FMul; goto BINOP_ARITH;
+        case UDiv: pop = llvm::Instruction::UDiv; goto BINOP_ARITH;
+        case SDiv: pop = llvm::Instruction::SDiv; goto BINOP_ARITH;
+        case FDiv: pop = llvm::Instruction::FDiv; goto BINOP_ARITH;
+        case URem: pop = llvm::Instruction::URem; goto BINOP_ARITH;
+        case SRem: pop = llvm::Instruction::SRem; goto BINOP_ARITH;
+        case FRem: pop = llvm::Instruction::FRem; goto BINOP_ARITH;
+
+        case Shr: pop = llvm::Instruction::LShr; goto BINOP_SHIFT;
+        case AShr: pop = llvm::Instruction::AShr; goto BINOP_SHIFT;
+        case Shl: pop = llvm::Instruction::Shl; goto BINOP_SHIFT;
+
+        case And: pop = llvm::Instruction::And; goto BINOP_BITWISE;
+        case Xor: pop = llvm::Instruction::Xor; goto BINOP_BITWISE;
+        case Or:
+            pop = llvm::Instruction::Or;
+            goto BINOP_BITWISE;
+BINOP_ARITH:
+BINOP_BITWISE:
+BINOP_SHIFT:
+            return binop(static_cast<llvm::Instruction::BinaryOps>(pop), lhs, rhs);
+        }
+        llvm_unreachable("invalid BinOp");
+    }
     llvm::Value *gen(Expr e) {
         assert(e);
         if (options.g) setDebugLoc(e->getBeginLoc());
         switch (e->k) {
-        case EConstant: return e->C;
+        case EConstant: return getConstant(e->C, wrap(e->ty));
         case EInitList:
         {
-            llvm_unreachable("un-implemented");
-            return nullptr;
+            // only vectors have initializer lists as values: the elements not initialized are zero
+            assert(e->ty->getKind() == TYVECTOR && "un-implemented");
+            llvm::Value *V = llvm::Constant::getNullValue(wrap(e->ty));
+            for (const Initializer &it : e->inits)
+                V = insertElement(V, gen(it.value), ConstantInt::get(type_cache.integer_types[5], it.getDesignator().getStart()));
+            return V;
         } break;
         case EBuiltinCall: {
             const xvector<Expr> &Args = e->buitin_call_args;
-            llvm::Value **callArgs = type_cache.alloc.Allocate<llvm::Value*>(Args.size());
+            SmallVector<llvm::Value *, 8> callArgs(Args.size());
             ArrayRef<llvm::Type*> paramTypes = e->builtin_func_type->params();
             for (size_t i = 0;i < Args.size();++i) {
                 llvm::Value *V = gen(Args[i]);
@@ -981,25 +1961,31 @@ GEP: ;
             }
             std::string Name = llvm::Intrinsic::getName(e->ID, paramTypes, module.get(), e->builtin_func_type);
             llvm::FunctionCallee FC = module->getOrInsertFunction(Name, e->builtin_func_type);
-            return call(FC, llvm::makeArrayRef(callArgs, Args.size()));
+            return call(FC, callArgs);
         }
         case EMemberAccess: 
         {
-
-            llvm::Type *ty = wrap(e->obj->ty);
-            if (e->obj->k == EUnary && e->obj->uop == Dereference) {
-                return structGEP(ty, getAddress(e->obj), e->idxs);
+            // a member of an rvalue(e.g., the struct returned by a call) is extracted from the value
+            if (e->obj->ty->getKind() != TYPOINTER && !e->obj->isLValue()) {
+                SmallVector<unsigned, 4> elems(e->idxs.begin(), e->idxs.end());
+                type_cache.getElementIndexes(wrap(e->obj->ty), elems);
+                return extractValue(gen(e->obj), elems);
             }
-            return extractValue(gen(e->obj), e->idxs);
+            llvm::LoadInst *r = load(getAddress(e), wrap(e->ty), getLValueAlign(e));
+            if (e->ty->hasTag(TYVOLATILE))
+                r->setVolatile(true);
+            setTBAA(r, e);
+            return r;
         }
         case EConstantArraySubstript:
-            return llvm::ConstantExpr::getInBoundsGetElementPtr(wrap(e->ty->p), e->array,
+            return llvm::ConstantExpr::getInBoundsGetElementPtr(wrap(e->ty->p), createString(e->array),
                                                                 ConstantInt::get(type_cache.intptrTy, e->cidx));
         case EPostFix: {
             auto p = getAddress(e->poperand);
             auto ty = wrap(e->ty);
-            auto a = e->poperand->ty->getAlignAsMaybeAlign();
+            auto a = getLValueAlign(e->poperand);
             auto r = load(p, ty, a);
+            setTBAA(r, e->poperand);
             llvm::Value *v;
             if (e->ty->getKind() == TYPOINTER) {
                 ty = wrap(e->poperand->ty->p);
@@ -1011,14 +1997,18 @@ GEP: ;
                 v = (e->pop == PostfixIncrement) ? add(r, llvm::ConstantInt::get(ty, 1))
                                                  : sub(r, llvm::ConstantInt::get(ty, 1));
             }
-            store(p, v, a);
+            setTBAA(store(p, v, a), e->poperand);
             return r;
         }
         case EArrToAddress: return getAddress(e->voidexpr);
         case ESubscript: {
+            if (e->left->ty->getKind() == TYVECTOR)
+                return extractElement(gen(e->left), gen(e->right));
             llvm::Type *ty;
             auto v = subscript(e, ty);
-            return load(v, ty);
+            llvm::LoadInst *r = load(v, ty);
+            setTBAA(r, e);
+            return r;
         }
         case EString: return createString(e);
         case EBin: {
@@ -1033,11 +2023,12 @@ GEP: ;
             {
                 llvm::Value *basep = getAddress(e->lhs),
                             *rhs = gen(e->rhs);
-                llvm::StoreInst *s = store(basep, rhs, e->lhs->ty->getAlignAsMaybeAlign());
+                llvm::StoreInst *s = store(basep, rhs, getLValueAlign(e->lhs));
                 if (e->lhs->ty->hasTag(TYVOLATILE))
                     s->setVolatile(true);
                 if (e->lhs->ty->hasTag(TYATOMIC))
                     s->setOrdering(llvm::AtomicOrdering::SequentiallyConsistent);
+                setTBAA(s, e->lhs);
                 return rhs;
             }
             case AtomicrmwAdd: pop = static_cast<unsigned>(llvm::AtomicRMWInst::Add); goto BINOP_ATOMIC_RMW;
@@ -1059,308 +2050,7 @@ BINOP_ATOMIC_RMW:
 
 }
             }
-            llvm::Value *lhs = gen(e->lhs);
-            llvm::Value *rhs = gen(e->rhs);
-            switch (e->bop) {
-            case LogicalOr:
-            case LogicalAnd:
-            case Assign:
-            case AtomicrmwAdd:
-            case AtomicrmwSub:
-            case AtomicrmwXor:
-            case AtomicrmwOr: 
-            case AtomicrmwAnd:
-                llvm_unreachable("invalid control follow");
-            case SAdd:
-            { 
-                llvm::BinaryOperator *it = add(lhs, rhs);
-                it->setHasNoSignedWrap(true);
-                return it;
-            }
-            // clang::ComplexExprEmitter::EmitBinAdd
-            case CAdd: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const l = add(a, c), *const r = add(b, d);
-                return make_complex_pair(e->ty, l, r);
-            }
-            case CFAdd: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const l = fadd(a, c), *const r = fadd(b, d);
-                return make_complex_pair(e->ty, l, r);
-            }
-            // clang::ComplexExprEmitter::EmitBinSub
-            case CFSub: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const l = fsub(a, c), *const r = fsub(b, d);
-                return make_complex_pair(e->ty, l, r);
-            }
-            case CSub: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const l = sub(a, c), *const r = sub(b, d);
-                return make_complex_pair(e->ty, l, r);
-            }
-            // clang::ComplexExprEmitter::EmitBinMul
-            case CFMul: {
-                llvm::Value *LibCallI, *LibCallR;
-                llvm::MDBuilder MDHelper(getLLVMContext());
-                llvm::StructType *ty = cast<llvm::StructType>(wrap(e->ty));
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const AC = fmul(a, c), *const BD = fmul(b, d),
-                                   *const AD = fmul(a, d), *const BC = fmul(b, c),
-                                   *const ResR = fsub(AC, BD), *const ResI = fadd(AD, BC),
-                                   *const IsRNaN = fcmp(llvm::FCmpInst::FCMP_UNO, ResR, ResR);
-                llvm::BasicBlock *ContBB = newBB(), *INaNBB = newBB();
-                llvm::BranchInst *Branch = condbr(IsRNaN, INaNBB, ContBB);
-                llvm::MDNode *BrWeight = MDHelper.createBranchWeights(1, (1U << 20) - 1);
-                llvm::BasicBlock *OrigBB = Branch->getParent();
-                Branch->setMetadata(LLVMContext::MD_prof, BrWeight);
-                append(INaNBB);
-                llvm::Value *const IsINaN = fcmp(llvm::FCmpInst::FCMP_UNO, ResI, ResI);
-                llvm::BasicBlock *LibCallBB = newBB();
-                Branch = condbr(IsINaN, LibCallBB, ContBB);
-                Branch->setMetadata(LLVMContext::MD_prof, BrWeight);
-                append(LibCallBB);
-                {
-                    llvm::Type *real_ty = ty->getTypeAtIndex((unsigned)0);
-                    StringRef LibCallName;
-                    switch (real_ty->getTypeID()) {
-                    default: llvm_unreachable("Unsupported floating point type!");
-                    case llvm::Type::HalfTyID: LibCallName = "__mulhc3"; break;
-                    case llvm::Type::FloatTyID: LibCallName = "__mulsc3"; break;
-                    case llvm::Type::DoubleTyID: LibCallName = "__muldc3"; break;
-                    case llvm::Type::PPC_FP128TyID: LibCallName = "__multc3"; break;
-                    case llvm::Type::X86_FP80TyID: LibCallName = "__mulxc3"; break;
-                    case llvm::Type::FP128TyID: LibCallName = "__multc3"; break;
-                    }
-                    ArrayRef<llvm::Type *> Params = {real_ty, real_ty, real_ty, real_ty};
-                    ArrayRef<llvm::Value *> Args = {a, b, c, d};
-                    llvm::FunctionType *FTY = llvm::FunctionType::get(ty, Params, false);
-                    llvm::AttributeList attrs = llvm::AttributeList::get(
-                        getLLVMContext(), llvm::AttributeList::FunctionIndex,
-                        {llvm::Attribute::NoUnwind, llvm::Attribute::ReadNone, llvm::Attribute::MustProgress,
-                         llvm::Attribute::WillReturn, llvm::Attribute::NoRecurse, llvm::Attribute::NoSync,
-                         llvm::Attribute::NoFree});
-                    llvm::FunctionCallee F_C = module->getOrInsertFunction(LibCallName, FTY, attrs);
-                    llvm::CallInst *LibCallRes = call(F_C, Args);
-                    LibCallR = gen_complex_real(LibCallRes);
-                    LibCallI = gen_complex_imag(LibCallRes);
-                }
-                br(ContBB);
-                append(ContBB);
-                llvm::PHINode *RealPHI = phi(ResR->getType(), 3);
-                RealPHI->addIncoming(ResR, OrigBB);
-                RealPHI->addIncoming(ResR, INaNBB);
-                RealPHI->addIncoming(LibCallR, LibCallBB);
-                llvm::PHINode *ImagPHI = phi(ResI->getType(), 3);
-                ImagPHI->addIncoming(ResI, OrigBB);
-                ImagPHI->addIncoming(ResI, INaNBB);
-                ImagPHI->addIncoming(LibCallI, LibCallBB);
-                return make_complex_pair(ty, RealPHI, ImagPHI);
-            }
-            case CMul: {
-                // (a + ib) * (c + id) = (a * c - b * d) + i(a * d + b * c)
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
-                return make_complex_pair(wrapComplexForInteger(e->ty),
-                                         sub(mul(a, c), mul(b, d)),
-                                         sub(mul(a, d), mul(b, c)));
-            }
-            // clang::ComplexExprEmitter::EmitBinDiv
-            case CSDiv: {
-                // (a+ib) / (c+id) = ((ac+bd)/(cc+dd)) + i((bc-ad)/(cc+dd))
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const cc = mul(c, c), *const dd = mul(d, d),
-                                   *const cc_plus_dd = add(cc, dd), *const ac = add(a, c),
-                                   *const bd = add(b, d), *const bc = add(b, c),
-                                   *const ad = add(a, d),
-                                   *const L = sdiv(add(ac, bd), cc_plus_dd),
-                                   *const R = sdiv(mul(bc, ad), cc_plus_dd);
-                return make_complex_pair(wrapComplexForInteger(e->ty), L, R);
-            }
-            case CUDiv: {
-                // (a+ib) / (c+id) = ((ac+bd)/(cc+dd)) + i((bc-ad)/(cc+dd))
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs),
-                                   *const cc = mul(c, c), *const dd = mul(d, d),
-                                   *const cc_plus_dd = add(cc, dd), *const ac = add(a, c),
-                                   *const bd = add(b, d), *const bc = add(b, c),
-                                   *const ad = add(a, d),
-                                   *const L = udiv(sub(ac, bd), cc_plus_dd),
-                                   *const R = udiv(sub(bc, ad), cc_plus_dd);
-                return make_complex_pair(wrapComplexForInteger(e->ty), L, R);
-            }
-            case CFDiv: {
-                llvm::StructType *ty = cast<llvm::StructType>(wrapComplex(e->ty));
-                llvm::Type *real_ty = ty->getTypeAtIndex((unsigned)0);
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
-                StringRef LibCallName;
-                switch (real_ty->getTypeID()) {
-                default: llvm_unreachable("Unsupported floating point type!");
-                case llvm::Type::HalfTyID: LibCallName = "__divhc3"; break;
-                case llvm::Type::FloatTyID: LibCallName = "__divsc3"; break;
-                case llvm::Type::DoubleTyID: LibCallName = "__divdc3"; break;
-                case llvm::Type::PPC_FP128TyID: LibCallName = "__divtc3"; break;
-                case llvm::Type::X86_FP80TyID: LibCallName = "__divxc3"; break;
-                case llvm::Type::FP128TyID: LibCallName = "__divtc3"; break;
-                }
-                ArrayRef<llvm::Type *> Params = {real_ty, real_ty, real_ty, real_ty};
-                ArrayRef<llvm::Value *> Args = {a, b, c, d};
-                llvm::FunctionType *FTY = llvm::FunctionType::get(ty, Params, false);
-                llvm::AttributeList attrs = llvm::AttributeList::get(
-                    getLLVMContext(), llvm::AttributeList::FunctionIndex,
-                    {llvm::Attribute::NoUnwind, llvm::Attribute::ReadNone, llvm::Attribute::MustProgress,
-                     llvm::Attribute::WillReturn, llvm::Attribute::NoRecurse, llvm::Attribute::NoSync,
-                     llvm::Attribute::NoFree});
-                llvm::FunctionCallee F_C = module->getOrInsertFunction(LibCallName, FTY, attrs);
-                return call(F_C, Args);
-            }
-            case CEQ: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
-                llvm::Value *L, *R;
-                if (e->lhs->ty->isFloating()) {
-                    L = fcmp(llvm::FCmpInst::FCMP_OEQ, a, c);
-                    R = fcmp(llvm::FCmpInst::FCMP_OEQ, b, d);
-                } else {
-                    L = icmp(llvm::ICmpInst::ICMP_EQ, a, c);
-                    R = icmp(llvm::ICmpInst::ICMP_EQ, b, d);
-                }
-                return createAnd(L, R);
-            }
-            case CNE: {
-                llvm::Value *const a = gen_complex_real(lhs), *const b = gen_complex_imag(lhs),
-                                   *const c = gen_complex_real(rhs), *const d = gen_complex_imag(rhs);
-                llvm::Value *L, *R;
-                if (e->lhs->ty->isFloating()) {
-                    L = fcmp(llvm::FCmpInst::FCMP_ONE, a, c);
-                    R = fcmp(llvm::FCmpInst::FCMP_ONE, b, d);
-                } else {
-                    L = icmp(llvm::ICmpInst::ICMP_NE, a, c);
-                    R = icmp(llvm::ICmpInst::ICMP_NE, b, d);
-                }
-                return createOr(L, R);
-            }
-            case SSub: {
-                llvm::BinaryOperator *it = sub(lhs, rhs);
-                it->setHasNoSignedWrap(true);
-                return it;
-            }
-            case SMul: {
-                llvm::BinaryOperator *it = mul(lhs, rhs);
-                it->setHasNoSignedWrap(true);
-                return it;
-            }
-            case PtrDiff: {
-                CType target = e->lhs->ty->p;
-                llvm::Value *dividend;
-
-                lhs = ptrtoint(lhs, type_cache.intptrTy);
-                rhs = ptrtoint(rhs, type_cache.intptrTy);
-                llvm::BinaryOperator *diff = sub(lhs, rhs);
-
-                if (LLVM_UNLIKELY(target->isVLA())) {
-                    std::pair<llvm::Value *, llvm::Type *> pair = genVLASizeof(target);
-                    uint64_t Size = type_cache.getsizeof(pair.second);
-                    if (Size == 1) {
-                        dividend = mul(pair.first, llvm::ConstantInt::get(type_cache.intptrTy, Size));
-                        cast<llvm::Instruction>(dividend)->setHasNoSignedWrap(true);
-                    } else {
-                        dividend = pair.first;
-                    }
-                } else {
-                    uint64_t Size = type_cache.getsizeof(target);
-                    if (Size == 1)
-                        return diff;
-                    dividend = llvm::ConstantInt::get(type_cache.intptrTy, Size);
-                }
-                llvm::BinaryOperator *it = sdiv(diff, dividend);
-                it->setIsExact(true);
-                return it;
-            }
-            case SAddP: {
-                if (const ConstantInt *CI = dyn_cast<ConstantInt>(rhs))
-                    if (CI->isZero())
-                        return lhs;
-                CType target = e->ty->p;
-                llvm::Type *T;
-                if (LLVM_UNLIKELY(target->isVLA())) {
-                    const std::pair<llvm::Value *, llvm::Type *> pair = genVLASizeof(target);
-                    T = pair.second;
-                    if (const ConstantInt *CI = dyn_cast<ConstantInt>(rhs)) {
-                        if (CI->getLimitedValue() == 1) {
-                            rhs = pair.first;
-                            goto VLA_NEXT;
-                        }
-                    }
-                    rhs = mul(pair.first, rhs);
-                    cast<llvm::Instruction>(rhs)->setHasNoSignedWrap(true);
-                } else {
-                    T = wrap(target);
-                }
-VLA_NEXT:;
-                return gep(T, lhs, {rhs});
-            }
-            case Complex_CMPLX: return make_complex_pair(e->ty, lhs, rhs);
-            case EQ: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_EQ); goto BINOP_ICMP;
-            case NE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_NE); goto BINOP_ICMP;
-            case UGT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_UGT); goto BINOP_ICMP;
-            case UGE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_UGE); goto BINOP_ICMP;
-            case ULT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_ULT); goto BINOP_ICMP;
-            case ULE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_ULE); goto BINOP_ICMP;
-            case SGT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SGT); goto BINOP_ICMP;
-            case SGE: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SGE); goto BINOP_ICMP;
-            case SLT: pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SLT); goto BINOP_ICMP;
-            case SLE:
-                pop = static_cast<unsigned>(llvm::CmpInst::ICMP_SLE);
-                goto BINOP_ICMP;
-BINOP_ICMP:
-                return icmp(static_cast<llvm::CmpInst::Predicate>(pop), lhs, rhs);
-            case FEQ: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OEQ); goto BINOP_FCMP;
-            case FNE: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_ONE); goto BINOP_FCMP;
-            case FGT: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OGT); goto BINOP_FCMP;
-            case FGE: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OGE); goto BINOP_FCMP;
-            case FLT: pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OLT); goto BINOP_FCMP;
-            case FLE:
-                pop = static_cast<unsigned>(llvm::FCmpInst::FCMP_OLE);
-                goto BINOP_FCMP;
-BINOP_FCMP:
-                return fcmp(static_cast<llvm::CmpInst::Predicate>(pop), lhs, rhs);
-            case Comma: return rhs;
-            case UAdd: pop = llvm::Instruction::Add; goto BINOP_ARITH;
-            case FAdd: pop = llvm::Instruction::FAdd; goto BINOP_ARITH;
-            case USub: pop = llvm::Instruction::Sub; goto BINOP_ARITH;
-            case FSub: pop = llvm::Instruction::FSub; goto BINOP_ARITH;
-            case UMul: pop = llvm::Instruction::Mul; goto BINOP_ARITH;
-            case FMul: pop = llvm::Instruction::FMul; goto BINOP_ARITH;
-            case UDiv: pop = llvm::Instruction::UDiv; goto BINOP_ARITH;
-            case SDiv: pop = llvm::Instruction::SDiv; goto BINOP_ARITH;
-            case FDiv: pop = llvm::Instruction::FDiv; goto BINOP_ARITH;
-            case URem: pop = llvm::Instruction::URem; goto BINOP_ARITH;
-            case SRem: pop = llvm::Instruction::SRem; goto BINOP_ARITH;
-            case FRem: pop = llvm::Instruction::FRem; goto BINOP_ARITH;
-
-            case Shr: pop = llvm::Instruction::LShr; goto BINOP_SHIFT;
-            case AShr: pop = llvm::Instruction::AShr; goto BINOP_SHIFT;
-            case Shl: pop = llvm::Instruction::Shl; goto BINOP_SHIFT;
-
-            case And: pop = llvm::Instruction::And; goto BINOP_BITWISE;
-            case Xor: pop = llvm::Instruction::Xor; goto BINOP_BITWISE;
-            case Or:
-                pop = llvm::Instruction::Or;
-                goto BINOP_BITWISE;
-BINOP_ARITH:
-BINOP_BITWISE:
-BINOP_SHIFT:
-                return binop(static_cast<llvm::Instruction::BinaryOps>(pop), lhs, rhs);
-            }
-            llvm_unreachable("invalid BinOp");
+            return gen_binop_chain(e);
         }
         case EVoid: return (void)gen(e->voidexpr), nullptr;
         case EBlockAddress:
@@ -1390,6 +2080,7 @@ BINOP_SHIFT:
                     r->setVolatile(true);
                 if (tags & TYATOMIC)
                     r->setOrdering(llvm::AtomicOrdering::SequentiallyConsistent);
+                setTBAA(r, e);
                 return r;
             }
             case LogicalNot: return createLogicalNot(Val);
@@ -1425,6 +2116,7 @@ BINOP_SHIFT:
                 r->setVolatile(true);
             if (e->ty->hasTag(TYATOMIC))
                 r->setOrdering(llvm::AtomicOrdering::SequentiallyConsistent);
+            setTBAA(r, e);
             return r;
         }
         case ECondition: {
@@ -1471,7 +2163,10 @@ BINOP_SHIFT:
             it->setHasNoSignedWrap(true);
             return it;
         }
-        case ECast: return createCast(getCastOp(e->castop), gen(e->castval), wrap(e->ty));
+        case ECast:
+            if (e->castop == VectorSplat)
+                return vectorSplat(gen(e->castval), e->ty->vec_num_elems);
+            return createCast(getCastOp(e->castop), gen(e->castval), wrap(e->ty));
         case ECallImplictFunction:
         {
             unsigned char attrs = builtin_attr_table[(unsigned)e->imt_ID - (unsigned)Kstart_builtin_functions];
@@ -1497,7 +2192,7 @@ BINOP_SHIFT:
             llvm::FunctionCallee FC = module->getOrInsertFunction(Name, FTy, 
                 llvm::AttributeList::get(getLLVMContext(), llvm::AttributeList::FunctionIndex, builder));
             size_t l = e->imt_args.size();
-            llvm::Value **buf = type_cache.alloc.Allocate<llvm::Value *>(l);
+            SmallVector<llvm::Value *, 8> buf(l);
             for (size_t i = 0; i < l; ++i)
                 buf[i] = gen(e->imt_args[i]);
             // convert call to (...) to (i32, ...), ...etc.
@@ -1508,7 +2203,7 @@ BINOP_SHIFT:
                     callTypes[i] = buf[i]->getType();
                 FTy = llvm::FunctionType::get(FTy->getReturnType(), callTypes, true);
             }
-            return call(FC, ArrayRef<llvm::Value *>(buf, l));
+            return call(FC, buf);
         }
         case ECallCompilerBuiltinCall:
             return GenBuiltinCall(e);
@@ -1522,10 +2217,14 @@ BINOP_SHIFT:
                 f = gen(e->callfunc);
             }
             size_t l = e->callargs.size();
-            llvm::Value **buf = type_cache.alloc.Allocate<llvm::Value *>(l);
+            // not type_cache.alloc: generating an argument may reuse its buffer
+            SmallVector<llvm::Value *, 8> buf(l);
             for (size_t i = 0; i < l; ++i)
                 buf[i] = gen(e->callargs[i]); // eval argument from left to right
-            return call(ty, f, llvm::makeArrayRef(buf, l));
+            llvm::CallInst *CI = call(ty, f, buf);
+            if (flattenCalls)
+                CI->addFnAttr(llvm::Attribute::AlwaysInline);
+            return CI;
         }
         default: llvm_unreachable("bad enum kind!");
         }
@@ -1574,7 +2273,10 @@ BINOP_SHIFT:
         assert(ty);
         switch (ty->getKind()) {
             case TYVECTOR:
-                // TODO
+            {
+                llvm::DINodeArray subscripts = di->getOrCreateArray({di->getOrCreateSubrange(0, (int64_t)ty->vec_num_elems)});
+                return di->createVectorType(type_cache.getsizeof(ty) * 8, type_cache.getAlignof(ty) * 8, wrapDIType(ty->vec_ty), subscripts);
+            }
             case TYPRIM:
                 return di_basic_types[type_cache.getTypeIndex(ty)];
             case TYPOINTER:
@@ -1630,11 +2332,11 @@ BINOP_SHIFT:
                 auto it = di_subroutine_type_cache.insert(std::make_pair(ty, nullptr));
                 if (it.second) {
                     size_t Size = ty->params.size() + 1;
-                    llvm::Metadata **tys = type_cache.alloc.Allocate<llvm::Metadata*>(Size);
+                    SmallVector<llvm::Metadata *, 8> tys(Size);
                     tys[0] = wrapDIType(ty->ret);
                     for (size_t i = 0;i < ty->params.size();i++) 
                         tys[i + 1] = wrapDIType(ty->params[i].ty);
-                    it.first->second = di->createSubroutineType(di->getOrCreateTypeArray(makeArrayRef(tys, Size)));
+                    it.first->second = di->createSubroutineType(di->getOrCreateTypeArray(tys));
                 }
                 return it.first->second;
             }
@@ -1683,11 +2385,18 @@ BINOP_SHIFT:
 
         vars = new llvm::Value *[TU.max_typedef_scope];
 
+        if (options.OptimizationLevel && options.StrictAliasing)
+            tbaa.emplace(getLLVMContext(), type_cache);
+
         runCodeGenTranslationUnit(TU.ast);
 
+        emitAliases();
+        emitUsedGlobals();
+
         RunOptimizationPipeline();
 
         delete [] vars;
+        tbaa.reset();
 
         if (di) {
             di->finalize();
@@ -25,7 +25,516 @@ llvm::Value *IRGen::GenBuiltinCall(Expr e) {
         insertBB = addBB();
         return nullptr;
     }
+    case BI__builtin_clzs:
+    case BI__builtin_clz:
+    case BI__builtin_clzl:
+    case BI__builtin_clzll:
+    case BI__builtin_ctzs:
+    case BI__builtin_ctz:
+    case BI__builtin_ctzl:
+    case BI__builtin_ctzll:
+    {
+        // the result is undefined if the argument is zero(as in GCC), so the backend can select a single bsr/bsf/lzcnt/tzcnt instruction
+        const bool isCLZ = e->cbc_ID <= BI__builtin_clzll;
+        Value *X = gen(Args[0]);
+        Value *Result = call(isCLZ ? Intrinsic::ctlz : Intrinsic::cttz, {X, type_cache.i1_1}, X->getType());
+        return createIntCast(Result, wrap(e->ty));
+    }
+    case BI__builtin_popcount:
+    case BI__builtin_popcountl:
+    case BI__builtin_popcountll:
+    {
+        Value *X = gen(Args[0]);
+        return createIntCast(call(Intrinsic::ctpop, X, X->getType()), wrap(e->ty));
+    }
+    case BI__builtin_bswap16:
+    case BI__builtin_bswap32:
+    case BI__builtin_bswap64:
+    {
+        Value *X = gen(Args[0]);
+        return call(Intrinsic::bswap, X, X->getType());
+    }
+    case BI__builtin_shufflevector:
+    {
+        // the indexes are constants checked by the parser, -1 selects an undefined element
+        SmallVector<int, 16> Mask;
+        for (const Expr Index : Args.drop_front(2)) {
+            const APInt &V = cast<IntConstant>(Index->C)->getValue();
+            Mask.push_back(V.isAllOnes() ? -1 : static_cast<int>(V.getZExtValue()));
+        }
+        Value *V1 = gen(Args[0]), *V2 = gen(Args[1]);
+        return shuffleVector(V1, V2, Mask);
+    }
+    case BI__builtin_memcpy:
+    case BI__builtin_memcpy_inline:
+    {
+        Value *Dst = gen(Args[0]), *Src = gen(Args[1]), *Size = gen(Args[2]);
+        // small copies of a known size are always expanded to loads and stores, not only when the backend thinks it is profitable
+        const ConstantInt *CI = dyn_cast<ConstantInt>(Size);
+        const bool isInline = e->cbc_ID == BI__builtin_memcpy_inline || (CI && CI->getZExtValue() <= 64);
+        CallInst *Call = call(isInline ? Intrinsic::memcpy_inline : Intrinsic::memcpy, {Dst, Src, Size, type_cache.i1_0},
+                              {Dst->getType(), Src->getType(), Size->getType()});
+        Call->addParamAttr(0, Attribute::getWithAlignment(getLLVMContext(), getPointeeAlign(Args[0])));
+        Call->addParamAttr(1, Attribute::getWithAlignment(getLLVMContext(), getPointeeAlign(Args[1])));
+        return e->cbc_ID == BI__builtin_memcpy ? Dst : nullptr;
+    }
+    case BI__builtin_memset:
+    {
+        Value *Dst = gen(Args[0]), *Val = gen(Args[1]), *Size = gen(Args[2]);
+        Val = createIntCast(Val, type_cache.integer_types[3]);
+        // like __builtin_memcpy, small stores of a known size are always expanded
+        const ConstantInt *CI = dyn_cast<ConstantInt>(Size);
+        const bool isInline = CI && CI->getZExtValue() <= 64;
+        CallInst *Call = call(isInline ? Intrinsic::memset_inline : Intrinsic::memset, {Dst, Val, Size, type_cache.i1_0},
+                              {Dst->getType(), Size->getType()});
+        Call->addParamAttr(0, Attribute::getWithAlignment(getLLVMContext(), getPointeeAlign(Args[0])));
+        return Dst;
+    }
+    case BI__builtin_prefetch:
+    {
+        // __builtin_prefetch(addr, rw = 0, locality = 3), the arguments are checked to be constants by the parser
+        Value *Ptr = gen(Args[0]);
+        const uint64_t RW = Args.size() > 1 ? cast<ConstantInt>(gen(Args[1]))->getZExtValue() : 0;
+        const uint64_t Locality = Args.size() > 2 ? cast<ConstantInt>(gen(Args[2]))->getZExtValue() : 3;
+        IntegerType *i32Ty = cast<IntegerType>(type_cache.integer_types[5]);
+        call(Intrinsic::prefetch, {Ptr, ConstantInt::get(i32Ty, RW), ConstantInt::get(i32Ty, Locality), ConstantInt::get(i32Ty, 1)}, Ptr->getType());
+        return nullptr;
+    }
+    case BI__builtin_assume_aligned:
+    {
+        // call void @llvm.assume(i1 true) [ "align"(ptr %p, i64 align, i64 offset) ]
+        Value *Ptr = gen(Args[0]);
+        SmallVector<Value *, 3> BundleArgs{Ptr, gen(Args[1])};
+        if (Args.size() > 2) {
+            Value *Offset = gen(Args[2]);
+            if (!(isa<ConstantInt>(Offset) && cast<ConstantInt>(Offset)->isZero()))
+                BundleArgs.push_back(createIntCast(Offset, type_cache.intptrTy, Args[2]->ty->isSigned()));
+        }
+        OperandBundleDef Bundle("align", BundleArgs);
+        Function *Assume = Intrinsic::getDeclaration(&*module, Intrinsic::assume);
+        Insert(CallInst::Create(Assume->getFunctionType(), Assume, type_cache.i1_1, Bundle, "", insertBB));
+        return Ptr;
+    }
+    case BI__builtin_unreachable:
+        createUnreachable();
+        insertBB = addBB();
+        return nullptr;
+    case BI__builtin_constant_p:
+    {
+        // folded constants are replaced by 1 in the parser, the rest is decided after inlining and constant propagation by llvm.is.constant.
+        // the argument is not evaluated if it has side effects(like GCC and clang, the result is 0 then)
+        CType ty = Args[0]->ty;
+        if (!ty->isScalar())
+            return ConstantInt::get(wrap(e->ty), 0);
+        SideEffectFinder finder;
+        finder.VisitExpr(Args[0]);
+        if (finder.found)
+            return ConstantInt::get(wrap(e->ty), 0);
+        Value *X = gen(Args[0]);
+        return createIntCast(call(Intrinsic::is_constant, X, X->getType()), wrap(e->ty));
+    }
+    case BI__builtin_expect:
+    case BI__builtin_expect_with_probability:
+    {
+        // the branch weights are computed by LowerExpectIntrinsic, which is not in the -O0 pipeline
+        Value *V = gen(Args[0]);
+        Value *Expected = gen(Args[1]);
+        if (options.OptimizationLevel == 0)
+            return V;
+        if (e->cbc_ID == BI__builtin_expect)
+            return call(Intrinsic::expect, {V, Expected}, V->getType());
+        return call(Intrinsic::expect_with_probability, {V, Expected, gen(Args[2])}, V->getType());
+    }
+    case BI__builtin_add_overflow:
+    case BI__builtin_sub_overflow:
+    case BI__builtin_mul_overflow:
+    case BI__builtin_uadd_overflow:
+    case BI__builtin_uaddl_overflow:
+    case BI__builtin_uaddll_overflow:
+    case BI__builtin_usub_overflow:
+    case BI__builtin_usubl_overflow:
+    case BI__builtin_usubll_overflow:
+    case BI__builtin_umul_overflow:
+    case BI__builtin_umull_overflow:
+    case BI__builtin_umulll_overflow:
+    case BI__builtin_sadd_overflow:
+    case BI__builtin_saddl_overflow:
+    case BI__builtin_saddll_overflow:
+    case BI__builtin_ssub_overflow:
+    case BI__builtin_ssubl_overflow:
+    case BI__builtin_ssubll_overflow:
+    case BI__builtin_smul_overflow:
+    case BI__builtin_smull_overflow:
+    case BI__builtin_smulll_overflow:
+        return GenOverflowBuiltin(e);
+    case BI__c11_atomic_init:
+    case BI__c11_atomic_load:
+    case BI__c11_atomic_store:
+    case BI__c11_atomic_exchange:
+    case BI__c11_atomic_compare_exchange_strong:
+    case BI__c11_atomic_compare_exchange_weak:
+    case BI__c11_atomic_fetch_add:
+    case BI__c11_atomic_fetch_sub:
+    case BI__c11_atomic_fetch_and:
+    case BI__c11_atomic_fetch_or:
+    case BI__c11_atomic_fetch_xor:
+    case BI__c11_atomic_fetch_nand:
+    case BI__c11_atomic_fetch_max:
+    case BI__c11_atomic_fetch_min:
+    case BI__c11_atomic_thread_fence:
+    case BI__c11_atomic_signal_fence:
+    case BI__atomic_load:
+    case BI__atomic_load_n:
+    case BI__atomic_store:
+    case BI__atomic_store_n:
+    case BI__atomic_exchange:
+    case BI__atomic_exchange_n:
+    case BI__atomic_compare_exchange:
+    case BI__atomic_compare_exchange_n:
+    case BI__atomic_fetch_add:
+    case BI__atomic_fetch_sub:
+    case BI__atomic_fetch_and:
+    case BI__atomic_fetch_or:
+    case BI__atomic_fetch_xor:
+    case BI__atomic_fetch_nand:
+    case BI__atomic_add_fetch:
+    case BI__atomic_sub_fetch:
+    case BI__atomic_and_fetch:
+    case BI__atomic_or_fetch:
+    case BI__atomic_xor_fetch:
+    case BI__atomic_max_fetch:
+    case BI__atomic_min_fetch:
+    case BI__atomic_nand_fetch:
+    case BI__atomic_test_and_set:
+    case BI__atomic_clear:
+    case BI__atomic_thread_fence:
+    case BI__atomic_signal_fence:
+    case BI__atomic_fetch_min:
+    case BI__atomic_fetch_max:
+        return GenAtomicBuiltin(e);
     default:
         llvm_unreachable("unsupported builtin function");
     }
 }
+
+// __builtin_{add,sub,mul}_overflow and the typed variants: the operation is done in a type that can represent all the operands and the result
+// (like clang's "encompassing type"), then the result is truncated and the truncation is checked
+llvm::Value *IRGen::GenOverflowBuiltin(Expr e) {
+    using namespace llvm;
+    ArrayRef<Expr> Args = e->cbc_args;
+    CType Tys[3] = {Args[0]->ty, Args[1]->ty, Args[2]->ty->p};
+    bool Signed = false;
+    for (CType ty: Tys)
+        Signed |= ty->isSigned();
+    unsigned Width = 0;
+    for (CType ty: Tys)
+        Width = std::max<unsigned>(Width, getSizeInBits(ty) + (Signed && !ty->isSigned()));
+    IntegerType *OpTy = IntegerType::get(getLLVMContext(), Width);
+    IntegerType *ResultTy = cast<IntegerType>(wrap(Tys[2]));
+    Value *LHS = createIntCast(gen(Args[0]), OpTy, Tys[0]->isSigned());
+    Value *RHS = createIntCast(gen(Args[1]), OpTy, Tys[1]->isSigned());
+    Value *ResultPtr = gen(Args[2]);
+    Intrinsic::ID ID;
+    switch (e->cbc_ID) {
+    case BI__builtin_add_overflow:
+    case BI__builtin_uadd_overflow:
+    case BI__builtin_uaddl_overflow:
+    case BI__builtin_uaddll_overflow:
+    case BI__builtin_sadd_overflow:
+    case BI__builtin_saddl_overflow:
+    case BI__builtin_saddll_overflow:
+        ID = Signed ? Intrinsic::sadd_with_overflow : Intrinsic::uadd_with_overflow;
+        break;
+    case BI__builtin_sub_overflow:
+    case BI__builtin_usub_overflow:
+    case BI__builtin_usubl_overflow:
+    case BI__builtin_usubll_overflow:
+    case BI__builtin_ssub_overflow:
+    case BI__builtin_ssubl_overflow:
+    case BI__builtin_ssubll_overflow:
+        ID = Signed ? Intrinsic::ssub_with_overflow : Intrinsic::usub_with_overflow;
+        break;
+    default:
+        ID = Signed ? Intrinsic::smul_with_overflow : Intrinsic::umul_with_overflow;
+        break;
+    }
+    CallInst *Call = call(ID, {LHS, RHS}, OpTy);
+    Value *Result = extractValue(Call, 0);
+    Value *Overflow = extractValue(Call, 1);
+    if (OpTy != ResultTy) {
+        // the result does not fit if truncating and extending it again gives a different value
+        Value *Truncated = createIntCast(Result, ResultTy);
+        Value *Extended = createIntCast(Truncated, OpTy, Tys[2]->isSigned());
+        Overflow = createOr(Overflow, icmp(ICmpInst::ICMP_NE, Extended, Result));
+        Result = Truncated;
+    }
+    store(ResultPtr, Result, MaybeAlign(type_cache.getAlignof(Tys[2])));
+    return Overflow;
+}
+
+// the AtomicOrdering of a C11 memory order(memory_order_relaxed = 0, ..., memory_order_seq_cst = 5).
+// the orders that are invalid for the operation(diagnosed by the parser) become seq_cst
+static llvm::AtomicOrdering getAtomicOrdering(uint64_t Order, IRGen::AtomicOrderKind Kind) {
+    switch (Order) {
+    case 0: return llvm::AtomicOrdering::Monotonic;
+    case 1: // memory_order_consume is promoted to acquire, as every compiler does
+    case 2:
+        if (Kind != IRGen::AtomicOrder_Store)
+            return llvm::AtomicOrdering::Acquire;
+        break;
+    case 3:
+        if (Kind != IRGen::AtomicOrder_Load)
+            return llvm::AtomicOrdering::Release;
+        break;
+    case 4:
+        if (Kind == IRGen::AtomicOrder_RMW)
+            return llvm::AtomicOrdering::AcquireRelease;
+        break;
+    }
+    return llvm::AtomicOrdering::SequentiallyConsistent;
+}
+
+// emit `Emit(Ordering)` with the ordering of the memory order `OrderExpr`. a runtime order becomes a switch over the orders valid for `Kind`,
+// the default is relaxed(like clang's EmitAtomicExpr). returns the result of `Emit`, merged by a phi if there are many
+llvm::Value *IRGen::GenWithMemoryOrder(Expr OrderExpr, AtomicOrderKind Kind, llvm::function_ref<llvm::Value *(llvm::AtomicOrdering)> Emit) {
+    using namespace llvm;
+    Value *Order = gen(OrderExpr);
+    if (const ConstantInt *CI = dyn_cast<ConstantInt>(Order))
+        return Emit(getAtomicOrdering(CI->getZExtValue(), Kind));
+    IntegerType *OrderTy = cast<IntegerType>(Order->getType());
+    BasicBlock *ContBB = newBB(), *DefaultBB = addBB();
+    SwitchInst *SI = Insert(SwitchInst::Create(Order, DefaultBB, 5, insertBB));
+    SmallVector<std::pair<Value *, BasicBlock *>, 6> Results;
+    auto emitCase = [&](AtomicOrdering Ordering) {
+        Value *V = Emit(Ordering);
+        Results.push_back({V, insertBB});
+        br(ContBB);
+    };
+    after(DefaultBB);
+    emitCase(AtomicOrdering::Monotonic);
+    BasicBlock *AcquireBB = nullptr;
+    for (uint64_t i = 1; i <= 5; ++i) {
+        const AtomicOrdering Ordering = getAtomicOrdering(i, Kind);
+        if (Ordering == AtomicOrdering::SequentiallyConsistent && i != 5)
+            continue; // invalid for this operation, undefined behavior: use the default
+        if (i == 2 && AcquireBB) {
+            SI->addCase(ConstantInt::get(OrderTy, i), AcquireBB);
+            continue;
+        }
+        BasicBlock *BB = addBB();
+        SI->addCase(ConstantInt::get(OrderTy, i), BB);
+        if (Ordering == AtomicOrdering::Acquire)
+            AcquireBB = BB;
+        after(BB);
+        emitCase(Ordering);
+    }
+    ContBB->insertInto(currentfunction);
+    after(ContBB);
+    if (!Results.front().first)
+        return nullptr;
+    PHINode *P = phi(Results.front().first->getType(), Results.size());
+    for (const auto &it : Results)
+        P->addIncoming(it.first, it.second);
+    return P;
+}
+
+// the __c11_atomic_* and __atomic_* builtins, the arguments are checked and converted by Parser::check_atomic_builtin
+llvm::Value *IRGen::GenAtomicBuiltin(Expr e) {
+    using namespace llvm;
+    ArrayRef<Expr> Args = e->cbc_args;
+    const unsigned ID = e->cbc_ID;
+    switch (ID) {
+    case BI__atomic_thread_fence:
+    case BI__c11_atomic_thread_fence:
+    case BI__atomic_signal_fence:
+    case BI__c11_atomic_signal_fence:
+    {
+        const bool isSignal = ID == BI__atomic_signal_fence || ID == BI__c11_atomic_signal_fence;
+        return GenWithMemoryOrder(Args[0], AtomicOrder_RMW, [&](AtomicOrdering Ordering) -> Value * {
+            // a relaxed fence does nothing
+            if (Ordering != AtomicOrdering::Monotonic)
+                Insert(new FenceInst(getLLVMContext(), Ordering, isSignal ? SyncScope::SingleThread : SyncScope::System, insertBB));
+            return nullptr;
+        });
+    }
+    case BI__atomic_test_and_set:
+    {
+        Value *Ptr = gen(Args[0]);
+        Value *Old = GenWithMemoryOrder(Args[1], AtomicOrder_RMW, [&](AtomicOrdering Ordering) -> Value * {
+            return atomicRMW(AtomicRMWInst::Xchg, Ptr, ConstantInt::get(type_cache.integer_types[3], 1), Align(1), Ordering);
+        });
+        return createIntCast(icmp(ICmpInst::ICMP_NE, Old, ConstantInt::get(type_cache.integer_types[3], 0)), wrap(e->ty));
+    }
+    case BI__atomic_clear:
+    {
+        Value *Ptr = gen(Args[0]);
+        return GenWithMemoryOrder(Args[1], AtomicOrder_Store, [&](AtomicOrdering Ordering) -> Value * {
+            store(Ptr, ConstantInt::get(type_cache.integer_types[3], 0), Align(1))->setAtomic(Ordering);
+            return nullptr;
+        });
+    }
+    default:
+        break;
+    }
+    // the atomic object: `T` is the type of the object, `Ty` is the type of the memory accesses
+    CType T = Args[0]->ty->p;
+    Value *Ptr = gen(Args[0]);
+    const Align Alignment(type_cache.getAlignof(T));
+    const uint64_t Size = type_cache.getsizeof(T);
+    IntegerType *SizedIntTy = IntegerType::get(getLLVMContext(), Size * 8);
+    Type *ValTy = T->getKind() == TYPOINTER ? type_cache.pointer_type : wrap(T);
+    Type *Ty = ValTy->isIntegerTy(1) ? type_cache.integer_types[3] : ValTy;
+    // the value of T in memory, and back
+    auto toMemory = [&](Value *V) -> Value * { return V->getType()->isIntegerTy(1) ? createIntCast(V, Ty) : V; };
+    auto fromMemory = [&](Value *V) -> Value * { return ValTy->isIntegerTy(1) ? createIntCast(V, ValTy) : V; };
+    switch (ID) {
+    case BI__c11_atomic_init:
+        store(Ptr, toMemory(gen(Args[1])), Alignment);
+        return nullptr;
+    case BI__c11_atomic_load:
+    case BI__atomic_load_n:
+        return fromMemory(GenWithMemoryOrder(Args[1], AtomicOrder_Load, [&](AtomicOrdering Ordering) -> Value * {
+            LoadInst *L = load(Ptr, Ty, Alignment);
+            L->setAtomic(Ordering);
+            return L;
+        }));
+    case BI__atomic_load:
+    {
+        // the generic versions copy the object through an integer of the same size
+        Value *Ret = gen(Args[1]);
+        Value *V = GenWithMemoryOrder(Args[2], AtomicOrder_Load, [&](AtomicOrdering Ordering) -> Value * {
+            LoadInst *L = load(Ptr, SizedIntTy, Alignment);
+            L->setAtomic(Ordering);
+            return L;
+        });
+        store(Ret, V, Alignment);
+        return nullptr;
+    }
+    case BI__c11_atomic_store:
+    case BI__atomic_store_n:
+    case BI__atomic_store:
+    {
+        Value *V = ID == BI__atomic_store ? static_cast<Value *>(load(gen(Args[1]), SizedIntTy, Alignment)) : toMemory(gen(Args[1]));
+        return GenWithMemoryOrder(Args[2], AtomicOrder_Store, [&](AtomicOrdering Ordering) -> Value * {
+            store(Ptr, V, Alignment)->setAtomic(Ordering);
+            return nullptr;
+        });
+    }
+    case BI__atomic_exchange:
+    {
+        Value *V = load(gen(Args[1]), SizedIntTy, Alignment);
+        Value *Ret = gen(Args[2]);
+        Value *Old = GenWithMemoryOrder(Args[3], AtomicOrder_RMW, [&](AtomicOrdering Ordering) -> Value * {
+            return atomicRMW(AtomicRMWInst::Xchg, Ptr, V, Alignment, Ordering);
+        });
+        store(Ret, Old, Alignment);
+        return nullptr;
+    }
+    case BI__c11_atomic_compare_exchange_strong:
+    case BI__c11_atomic_compare_exchange_weak:
+    case BI__atomic_compare_exchange_n:
+    case BI__atomic_compare_exchange:
+    {
+        // cmpxchg takes integers and pointers, other types are compared as integers of the same size
+        const bool isC11 = ID != BI__atomic_compare_exchange_n && ID != BI__atomic_compare_exchange;
+        Type *CmpTy = Ty->isIntegerTy() || Ty->isPointerTy() ? Ty : SizedIntTy;
+        Value *ExpectedPtr = gen(Args[1]);
+        Value *Desired = ID == BI__atomic_compare_exchange ? load(gen(Args[2]), CmpTy, Alignment) : toMemory(gen(Args[2]));
+        if (Desired->getType() != CmpTy)
+            Desired = createCast(Instruction::BitCast, Desired, CmpTy);
+        bool isWeak = ID == BI__c11_atomic_compare_exchange_weak;
+        if (!isC11) {
+            // a runtime `weak` is treated as strong, which is always correct
+            const ConstantInt *Weak = dyn_cast<ConstantInt>(gen(Args[3]));
+            isWeak = Weak && !Weak->isZero();
+        }
+        Value *Expected = load(ExpectedPtr, CmpTy, Alignment);
+        Expr Success = Args[isC11 ? 3 : 4], Failure = Args[isC11 ? 4 : 5];
+        Value *Ok = GenWithMemoryOrder(Success, AtomicOrder_RMW, [&](AtomicOrdering SuccessOrdering) -> Value * {
+            return GenWithMemoryOrder(Failure, AtomicOrder_Load, [&](AtomicOrdering FailureOrdering) -> Value * {
+                AtomicCmpXchgInst *CX = Insert(new AtomicCmpXchgInst(Ptr, Expected, Desired, Alignment, SuccessOrdering, FailureOrdering,
+                                                                     SyncScope::System, insertBB));
+                CX->setWeak(isWeak);
+                Value *Old = extractValue(CX, 0), *Success = extractValue(CX, 1);
+                // on failure, the current value is written to *expected
+                BasicBlock *StoreBB = addBB(), *ContBB = addBB();
+                condbr(Success, ContBB, StoreBB);
+                after(StoreBB);
+                store(ExpectedPtr, Old, Alignment);
+                br(ContBB);
+                after(ContBB);
+                return Success;
+            });
+        });
+        return createIntCast(Ok, wrap(e->ty));
+    }
+    default:
+        break;
+    }
+    // read-modify-write: (T *, T, order) -> T
+    AtomicRMWInst::BinOp Op;
+    Instruction::BinaryOps PostOp = Instruction::BinaryOpsEnd; // __atomic_OP_fetch: the new value is computed from the old one
+    const bool isSigned = T->getKind() == TYPRIM && T->isSigned();
+    switch (ID) {
+    case BI__c11_atomic_exchange:
+    case BI__atomic_exchange_n: Op = AtomicRMWInst::Xchg; break;
+    case BI__atomic_add_fetch: PostOp = Instruction::Add; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_add:
+    case BI__atomic_fetch_add: Op = AtomicRMWInst::Add; break;
+    case BI__atomic_sub_fetch: PostOp = Instruction::Sub; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_sub:
+    case BI__atomic_fetch_sub: Op = AtomicRMWInst::Sub; break;
+    case BI__atomic_and_fetch: PostOp = Instruction::And; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_and:
+    case BI__atomic_fetch_and: Op = AtomicRMWInst::And; break;
+    case BI__atomic_or_fetch: PostOp = Instruction::Or; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_or:
+    case BI__atomic_fetch_or: Op = AtomicRMWInst::Or; break;
+    case BI__atomic_xor_fetch: PostOp = Instruction::Xor; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_xor:
+    case BI__atomic_fetch_xor: Op = AtomicRMWInst::Xor; break;
+    case BI__atomic_nand_fetch: PostOp = Instruction::And; LLVM_FALLTHROUGH;
+    case BI__c11_atomic_fetch_nand:
+    case BI__atomic_fetch_nand: Op = AtomicRMWInst::Nand; break;
+    case BI__atomic_max_fetch:
+    case BI__c11_atomic_fetch_max:
+    case BI__atomic_fetch_max: Op = isSigned ? AtomicRMWInst::Max : AtomicRMWInst::UMax; break;
+    case BI__atomic_min_fetch:
+    case BI__c11_atomic_fetch_min:
+    case BI__atomic_fetch_min: Op = isSigned ? AtomicRMWInst::Min : AtomicRMWInst::UMin; break;
+    default: llvm_unreachable("unsupported atomic builtin");
+    }
+    Value *Val = toMemory(gen(Args[1]));
+    const bool isPointerArith = T->getKind() == TYPOINTER && Op != AtomicRMWInst::Xchg;
+    if (isPointerArith) {
+        // atomic arithmetic on pointers is done on intptr_t, the C11 builtins scale the operand by the size of the pointee(GNU ones do not)
+        Val = createIntCast(Val, type_cache.intptrTy, true);
+        if (ID == BI__c11_atomic_fetch_add || ID == BI__c11_atomic_fetch_sub) {
+            const uint64_t ElementSize = T->p->isVoid() ? 1 : type_cache.getsizeof(T->p);
+            Val = binop(Instruction::Mul, Val, ConstantInt::get(type_cache.intptrTy, ElementSize));
+        }
+    }
+    Value *Old = GenWithMemoryOrder(Args[2], AtomicOrder_RMW, [&](AtomicOrdering Ordering) -> Value * {
+        return atomicRMW(Op, Ptr, Val, Alignment, Ordering);
+    });
+    Value *Result = Old;
+    switch (ID) {
+    case BI__atomic_max_fetch:
+    case BI__atomic_min_fetch:
+    {
+        const bool isMax = ID == BI__atomic_max_fetch;
+        ICmpInst::Predicate Pred = isSigned ? (isMax ? ICmpInst::ICMP_SGT : ICmpInst::ICMP_SLT) : (isMax ? ICmpInst::ICMP_UGT : ICmpInst::ICMP_ULT);
+        Result = select(icmp(Pred, Old, Val), Old, Val);
+        break;
+    }
+    default:
+        if (PostOp != Instruction::BinaryOpsEnd)
+            Result = binop(PostOp, Old, Val);
+        if (ID == BI__atomic_nand_fetch)
+            Result = binop(Instruction::Xor, Result, ConstantInt::getAllOnesValue(Result->getType()));
+        break;
+    }
+    if (isPointerArith)
+        return createCast(Instruction::IntToPtr, Result, ValTy);
+    return fromMemory(Result);
+}
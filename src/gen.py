@@ -19,12 +19,10 @@ type_tags = (
 	"TYREGISTER",
 	"TYTHREAD_LOCAL",
 	"TYTYPEDEF",
-	"TYLVALUE",
 	"TYVOID",
 	"TYCOMPLEX",
 	"TYIMAGINARY",
 	"TYNULLPTR",
-	"TYREPLACED_CONSTANT",
 	"TYPAREN"
 )
 
@@ -180,13 +178,22 @@ stmts = {
 	"SGotoWithLocName": ("label_t location3", "location_t goto_loc3", "IdentRef goto_name", ),
 	"SGotoWithLoc": ("label_t location2", "location_t goto_loc",),
 	"SGoto": ("label_t location",),
-	"SCondJump": ("Expr test", "label_t T", "label_t F",),
+	"SCondJump": ("Expr test", "label_t T", "label_t F", "enum BranchHint hint",),
 	"SSwitch": ("Expr itest", "xvector<SwitchCase> switchs", "xvector<GNUSwitchCase> gnu_switchs", "label_t sw_default", "location_t sw_default_loc",),
 	"SIndirectBr": ("Expr jump_addr",),
 	"SReturn": ("Expr ret", "location_t ret_loc",),
 	"SExpr": ("Expr exprbody",),
 	"SNoReturnCall": ("Expr call_expr",),
 	"SAsm": ("xstring asms",),
+	"SGCCAsm": (
+		"xstring asm_template",
+		"xvector<AsmOperand> asm_outputs",
+		"xvector<AsmOperand> asm_inputs",
+		"xvector<xstring> asm_clobbers",
+		"xvector<label_t> asm_labels",
+		"bool asm_volatile",
+		"location_t asm_loc"
+	),
 	"SVarDecl": ("xvector<VarDecl> vars",),
 	"SDecl": ("unsigned decl_idx", "CType decl_ty",),
 	"SFunction": (
@@ -198,16 +205,17 @@ stmts = {
 		"label_t *indirectBrs",
 		"unsigned localStart",
 		"unsigned localSize",
-		"location_t funcDefLoc"
+		"location_t funcDefLoc",
+		"const DeclAttributes *funcattrs"
 	),
 }
 exprs = {
-	"EConstant": ("llvm::Constant* C", "location_t constantLoc", "location_t constantEndLoc",),
+	"EConstant": ("const ConstantValue *C", "location_t constantLoc", "location_t constantEndLoc",),
 	"EBin": ("Expr lhs", "enum BinOp bop", "Expr rhs",),
 	"EUnary": ("Expr uoperand", "enum UnaryOp uop", "location_t opLoc",),
-	"EString": ("llvm::Constant *string", "location_t stringLoc", "location_t stringEndLoc"),
-	"EConstantArraySubstript": ("llvm::Constant *array", "uint64_t cidx", "location_t casLoc", "location_t casEndLoc",),
-	"EInitList": ("location_t initStartLoc", "location_t initEndLoc", "xvector<Initializer> inits"),
+	"EString": ("const StringLiteralData *string", "location_t stringLoc", "location_t stringEndLoc"),
+	"EConstantArraySubstript": ("const StringLiteralData *array", "uint64_t cidx", "location_t casLoc", "location_t casEndLoc",),
+	"EInitList": ("location_t initStartLoc", "location_t initEndLoc", "xvector<Initializer> inits", "const PackedArrayData *packed"),
 	"EVoid": ("Expr voidexpr", "location_t voidStartLoc"),
 	"EVar": ("unsigned sval", "IdentRef varName", "location_t varLoc",),
 	"ECondition": ("Expr cond, cleft, cright",),
@@ -463,6 +471,16 @@ def gen_expr():
 	f.write("// C expressions -- generated by gen.py\n")
 	f.write("enum ExprKind: uint8_t {\n    " + ',\n    '.join(exprs.keys()) + '\n};\n')
 	f.write("""\
+// value category of an expression, kept out of the CType so that marking an lvalue never copies a type
+enum ExprFlags: uint8_t {
+    EF_None = 0,
+    // designates an object
+    EF_LValue = 0x1,
+    // a bit-field member: its address cannot be taken
+    EF_BitField = 0x2,
+    // a ReplacedExpr: a reference to a constant variable which is replaced by its value
+    EF_ReplacedConstant = 0x4
+};
 struct OpaqueExpr {
 OpaqueExpr()=delete;
 ~OpaqueExpr()=delete;
@@ -484,7 +502,11 @@ location_t *getParenRLoc();
 location_t getBeginLoc() const ;
 location_t getEndLoc() const;
 SourceRange getSourceRange() const {return SourceRange(getBeginLoc(), getEndLoc());}
+bool isLValue() const { return flags & EF_LValue; }
+bool isBitField() const { return flags & EF_BitField; }
+bool isReplacedConstant() const { return flags & EF_ReplacedConstant; }
 ExprKind k;
+uint8_t flags;
 CType ty;
 union alignas(void*) {
 """)
@@ -497,11 +519,11 @@ union alignas(void*) {
 		realname = name[1::] + "Expr"
 		l.append(realname)
 		if decls:
-			f.write("struct " + realname + " {\n    enum ExprKind k=" + name + ";\n    CType ty;\n    struct alignas(void*) {\n    ")
+			f.write("struct " + realname + " {\n    enum ExprKind k=" + name + ";\n    uint8_t flags=EF_None;\n    CType ty;\n    struct alignas(void*) {\n    ")
 			f.write('      ' + ';\n        '.join(decls) + ';')
 			f.write("\n  };\n};\n")
 		else:
-			f.write("    struct " + realname + " {\n    enum ExprKind k=" + name + ";\n    CType ty;\n};\n")
+			f.write("    struct " + realname + " {\n    enum ExprKind k=" + name + ";\n    uint8_t flags=EF_None;\n    CType ty;\n};\n")
 	f.write("static uint8_t expr_size_map[] = {\n    " + 
 		',\n    '.join(sizeof(l)) + 
 		"\n};\n")
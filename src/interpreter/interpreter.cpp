@@ -180,6 +180,9 @@ struct Function: public DiagnosticHelper {
 	       	case SAsm:
 	       		warning("Assembly %R ignored in intepreter", pc->asms.str());
 	       		break;
+	       	case SGCCAsm:
+	       		warning("Assembly %R ignored in intepreter", pc->asm_template.str());
+	       		break;
 	       	case SVarDecl:
 	       		{
 	       			for (const VarDecl &it: pc->vars) {
@@ -223,7 +226,7 @@ struct Function: public DiagnosticHelper {
         case EArrToAddress: return getAddress(e->voidexpr);
         case EString: llvm_unreachable("");
         default:
-            if (e->ty->hasTag(TYREPLACED_CONSTANT)) {
+            if (e->isReplacedConstant()) {
                 auto e2 = reinterpret_cast<ReplacedExpr *>(e);
                 return getVarAddress(e2->id);
             }
@@ -252,67 +255,36 @@ struct Function: public DiagnosticHelper {
         }
         llvm_unreachable("");
 	}
-	Value eval(Expr e) {
-		switch (e->k) {
-            case EConstant:
-            {
-                const llvm::Constant * const C = e->C;
-                if (const ConstantInt *CI = dyn_cast<ConstantInt>(C)) {
-                    return Value::fromU64(CI->getValue().getLimitedValue());
-                }
-                if (const ConstantFP *CF = dyn_cast<ConstantFP>(C)) {
-                    const APFloat &F = CF->getValue();
-                    switch (APFloat::SemanticsToEnum(F.getSemantics())) {
-                        case APFloat::S_IEEEhalf:
-                        case APFloat::S_BFloat:
-                        case APFloat::S_IEEEsingle:
-                            return Value::fromFloat(F.convertToFloat());
-                        default:
-                            return Value::fromDouble(F.convertToDouble());
-                    }
-                }
-            }
-            case ECallCompilerBuiltinCall:
-            case ECallImplictFunction:
-            case EBuiltinCall: llvm_unreachable("unsupported builtin function");
-            case EInitList: llvm_unreachable("");
-            case EBlockAddress:
-        	   return Value::fromPointer(getLabel(e->addr));
-            case EConstantArraySubstript: 
-                llvm_unreachable("");
-            case EString: llvm_unreachable("");
-            case EBin:
-    {
-        enum BinOp bop = e->bop;
-        switch (bop) {
-        default: break;
-        case LogicalOr:
-            return Value::fromU64(eval_cond(e->lhs) || eval_cond(e->rhs));
+    static bool isSimpleBinOp(enum BinOp op) {
+        switch (op) {
         case LogicalAnd:
-            return Value::fromU64(eval_cond(e->lhs) && eval_cond(e->rhs));
+        case LogicalOr:
         case Assign:
-            {
-                // limit sequence points to left => right
-                Address addr = getAddress(e->lhs);
-                Value val = eval(e->rhs);
-                return *addr = val;
-            }
         case AtomicrmwAdd:
         case AtomicrmwSub:
         case AtomicrmwXor:
-        case AtomicrmwOr: 
-        case AtomicrmwAnd:
-            {
-                Address addr = getAddress(e->lhs);
-                Value prev = *addr;
-                Value r = eval(e->rhs);
-                *addr = atomicOp(bop, prev, r, e->ty);
-                return prev;
-            }
+        case AtomicrmwOr:
+        case AtomicrmwAnd: return false;
+        default: return true;
         }
+    }
+    // evaluate a left-leaning chain of binary operators with an explicit stack
+    Value eval_binop_chain(Expr e) {
+        SmallVector<Expr, 16> spine;
+        Expr it = e;
+        do {
+            spine.push_back(it);
+            it = it->lhs;
+        } while (it->k == EBin && isSimpleBinOp(it->bop));
         // sequence points
-        Value lhs = eval(e->lhs);
-        Value rhs = eval(e->rhs);
+        Value lhs = eval(it);
+        for (size_t i = spine.size(); i--;) {
+            Value rhs = eval(spine[i]->rhs);
+            lhs = eval_binop(spine[i], lhs, rhs);
+        }
+        return lhs;
+    }
+    Value eval_binop(Expr e, Value lhs, Value rhs) {
         switch (e->bop) {
             case LogicalOr:
             case LogicalAnd:
@@ -439,6 +411,67 @@ struct Function: public DiagnosticHelper {
     case CNE:
         llvm_unreachable("");
     }   
+        llvm_unreachable("invalid BinOp");
+    }
+	Value eval(Expr e) {
+		switch (e->k) {
+            case EConstant:
+            {
+                const ConstantValue * const C = e->C;
+                if (const IntConstant *CI = dyn_cast<IntConstant>(C)) {
+                    return Value::fromU64(CI->getValue().getLimitedValue());
+                }
+                if (const FloatConstant *CF = dyn_cast<FloatConstant>(C)) {
+                    const APFloat &F = CF->getValue();
+                    switch (APFloat::SemanticsToEnum(F.getSemantics())) {
+                        case APFloat::S_IEEEhalf:
+                        case APFloat::S_BFloat:
+                        case APFloat::S_IEEEsingle:
+                            return Value::fromFloat(F.convertToFloat());
+                        default:
+                            return Value::fromDouble(F.convertToDouble());
+                    }
+                }
+            }
+            case ECallCompilerBuiltinCall:
+            case ECallImplictFunction:
+            case EBuiltinCall: llvm_unreachable("unsupported builtin function");
+            case EInitList: llvm_unreachable("");
+            case EBlockAddress:
+        	   return Value::fromPointer(getLabel(e->addr));
+            case EConstantArraySubstript: 
+                llvm_unreachable("");
+            case EString: llvm_unreachable("");
+            case EBin:
+    {
+        enum BinOp bop = e->bop;
+        switch (bop) {
+        default: break;
+        case LogicalOr:
+            return Value::fromU64(eval_cond(e->lhs) || eval_cond(e->rhs));
+        case LogicalAnd:
+            return Value::fromU64(eval_cond(e->lhs) && eval_cond(e->rhs));
+        case Assign:
+            {
+                // limit sequence points to left => right
+                Address addr = getAddress(e->lhs);
+                Value val = eval(e->rhs);
+                return *addr = val;
+            }
+        case AtomicrmwAdd:
+        case AtomicrmwSub:
+        case AtomicrmwXor:
+        case AtomicrmwOr: 
+        case AtomicrmwAnd:
+            {
+                Address addr = getAddress(e->lhs);
+                Value prev = *addr;
+                Value r = eval(e->rhs);
+                *addr = atomicOp(bop, prev, r, e->ty);
+                return prev;
+            }
+        }
+        return eval_binop_chain(e);
     }
             case EUnary:
                 
@@ -55,6 +55,9 @@ struct Lexer : public EvalHelper {
     std::vector<PPMacroDef *> expansion_list;
     xstring lexIdnetBuffer = xstring::get_with_capacity(20);
     uint32_t counter = 0;
+    // `#pragma GCC optimize`: the optimization level of the functions defined after it, and the levels saved by push_options
+    enum DeclAttributes::Optimize pragmaOptimize = DeclAttributes::OptimizeUnspecified;
+    SmallVector<enum DeclAttributes::Optimize, 2> pragmaOptimizeStack;
     location_t loc = 0, endLoc = 0;
     xcc_context &context;
     ScratchBuffer ScratchBuf;
@@ -466,6 +469,40 @@ R:
         endLoc = SM.getLoc() - 2;
         return TokenV(TStringLit, BufferPtr);
     }
+    // `#pragma GCC optimize("O3", ...)`, `#pragma GCC push_options`, `pop_options` and `reset_options`, other pragmas are ignored
+    void handlePragma(location_t loc, ArrayRef<TokenV> pragmas) {
+        const auto isName = [&](unsigned i, StringRef Name) {
+            return i < pragmas.size() && pragmas[i].tok >= kw_start && pragmas[i].s->getKey() == Name;
+        };
+        if (!isName(0, "GCC"))
+            return;
+        if (isName(1, "push_options")) {
+            pragmaOptimizeStack.push_back(pragmaOptimize);
+        } else if (isName(1, "pop_options")) {
+            if (pragmaOptimizeStack.empty()) {
+                warning(loc, "'#pragma GCC pop_options' without a corresponding '#pragma GCC push_options'");
+                return;
+            }
+            pragmaOptimize = pragmaOptimizeStack.pop_back_val();
+        } else if (isName(1, "reset_options")) {
+            pragmaOptimize = DeclAttributes::OptimizeUnspecified;
+        } else if (isName(1, "optimize")) {
+            for (const TokenV &it : pragmas.drop_front(2)) {
+                SmallString<16> Arg;
+                if (it.tok == TStringLit)
+                    lexString(Arg, it);
+                else if (it.tok == PPNumber)
+                    Arg = it.getPPNumberLit();
+                else
+                    continue; // '(', ')' and ','
+                const auto O = DeclAttributes::parseOptimize(Arg);
+                if (O == DeclAttributes::OptimizeUnspecified)
+                    warning(loc, "bad option '%R' to pragma 'optimize' ignored", Arg.str());
+                else
+                    pragmaOptimize = O;
+            }
+        }
+    }
     void lexString(SmallVectorImpl<char> &buffer, const TokenV &theTok) {
         const unsigned char *s = reinterpret_cast<const unsigned char*>(theTok.getStringLiteral().data());
         do {} while (*s++ != '\"');
@@ -560,6 +597,11 @@ R:
     }
 public:
     void cpp() {
+        // -ferror-limit=: the token stream ends, so the parser stops at the statement it is in
+        if (engine.hasErrorLimitReached()) {
+            tok = TEOF;
+            return;
+        }
         if (tokenq.empty())
             tok = lexAndLoc();
         else
@@ -937,7 +979,7 @@ STD_INCLUDE:
                             pragmas.push_back(tok);
                         tok = lex();
                     }
-                    // TODO: pragma
+                    handlePragma(loc, pragmas);
                 } break;
                 case PPerror:
                 case PPwarning: {
@@ -1,3 +1,55 @@
+// LLVM targets are registered on demand instead of InitializeAllTargets() and friends at startup:
+// the TargetInfos of all targets are needed to look up a triple, the backend(and its MC layer) of the selected target to create a TargetMachine,
+// and its AsmPrinter and AsmParser only to emit assembly or object files.
+struct TargetInitializer {
+    const char *name; // the backend name, see llvm/Config/Targets.def
+    void (*init)();
+};
+static const TargetInitializer targetInitializers[] = {
+#define LLVM_TARGET(TargetName) {#TargetName, LLVMInitialize##TargetName##Target},
+#include <llvm/Config/Targets.def>
+};
+static const TargetInitializer targetMCInitializers[] = {
+#define LLVM_TARGET(TargetName) {#TargetName, LLVMInitialize##TargetName##TargetMC},
+#include <llvm/Config/Targets.def>
+};
+static const TargetInitializer asmPrinterInitializers[] = {
+#define LLVM_ASM_PRINTER(TargetName) {#TargetName, LLVMInitialize##TargetName##AsmPrinter},
+#include <llvm/Config/AsmPrinters.def>
+};
+static const TargetInitializer asmParserInitializers[] = {
+#define LLVM_ASM_PARSER(TargetName) {#TargetName, LLVMInitialize##TargetName##AsmParser},
+#include <llvm/Config/AsmParsers.def>
+};
+static void runTargetInitializer(ArrayRef<TargetInitializer> table, StringRef name) {
+    for (const TargetInitializer &I : table) {
+        if (name == I.name)
+            return I.init();
+    }
+}
+static void initializeLLVMTargetInfos() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        // programs like the JIT may have registered the targets by themselves
+        if (llvm::TargetRegistry::targets().empty())
+            llvm::InitializeAllTargetInfos();
+    });
+}
+// register the backend of `T`, and its AsmPrinter and AsmParser if `emission` is true
+static void initializeLLVMBackend(const llvm::Target &T, bool emission) {
+    static std::mutex lock;
+    static llvm::StringSet<> initialized; // backend names, and "<name>.emit"
+    const StringRef name = T.getBackendName();
+    std::lock_guard<std::mutex> guard(lock);
+    if (initialized.insert(name).second) {
+        runTargetInitializer(targetInitializers, name);
+        runTargetInitializer(targetMCInitializers, name);
+    }
+    if (emission && initialized.insert((name + ".emit").str()).second) {
+        runTargetInitializer(asmPrinterInitializers, name);
+        runTargetInitializer(asmParserInitializers, name);
+    }
+}
 struct Options {
     StringRef mainFileName;
     llvm::Triple triple;
@@ -15,9 +67,25 @@ struct Options {
     bool DisableIntegratedAS : 1;
     bool VerifyModule : 1;
     bool TimeTrace: 1;
+    // -fstrict-aliasing: loads and stores have TBAA metadata when optimizing
+    bool StrictAliasing : 1;
+    // -disable-lifetime-markers: no llvm.lifetime.start/end for block-scoped locals
+    bool DisableLifetimeMarkers : 1;
     unsigned OptimizationLevel;
     unsigned OptimizeSize;
     unsigned TimeTraceGranularity;
+    // the maximum number of typo corrections tried in a translation unit
+    unsigned SpellCheckingLimit;
+    // the number of threads compiling the input files, 0 means one per core
+    unsigned Jobs;
+    // -mcpu=(-march= on x86), -mtune= and -target-feature: the TargetMachine, and the "target-cpu", "tune-cpu" and
+    // "target-features" attributes of every function
+    std::string CPU;
+    std::string TuneCPU;
+    std::string Features; // comma separated, e.g. "+avx2,-sse4a"
+    std::vector<std::string> inputFiles;
+    // -o, empty if not given(see getOutputFileName)
+    std::string outputFile;
     std::vector<std::string> PassPlugins;
     llvm::Reloc::Model RelocationModel;
     Optional<llvm::CodeModel::Model> CodeModel;
@@ -38,9 +106,18 @@ struct Options {
         DisableIntegratedAS{false},
         VerifyModule{false},
         TimeTrace {false},
+        StrictAliasing{true},
+        DisableLifetimeMarkers{false},
         OptimizationLevel{0},
         OptimizeSize{0},
         TimeTraceGranularity{500},
+        SpellCheckingLimit{50},
+        Jobs{1},
+        CPU{"generic"},
+        TuneCPU{},
+        Features{},
+        inputFiles{},
+        outputFile{},
         PassPlugins{},
         RelocationModel{llvm::Reloc::PIC_},
         CodeModel{}
@@ -56,10 +133,13 @@ struct Options {
         case 3: return llvm::CodeGenOpt::Aggressive;
         }
     }
+    // create the TargetMachine, a copy of Options with `machine` cleared reuses the looked up target
     void createTarget(DiagnosticsEngine &engine) {
-        if (this->theTarget) return;
+        if (this->machine) return;
         std::string Error;
-        this->theTarget = llvm::TargetRegistry::lookupTarget(this->triple.str(), Error);
+        initializeLLVMTargetInfos();
+        if (!this->theTarget)
+            this->theTarget = llvm::TargetRegistry::lookupTarget(this->triple.str(), Error);
         if (!this->theTarget) {
             DiagnosticHelper helper{engine};
             helper.error("unknown target triple %R, please use -triple or -arch", this->triple.str());
@@ -68,11 +148,12 @@ struct Options {
             assert(it != llvm::TargetRegistry::targets().end() && "No target registered");
             this->theTarget = &*it;
         }
+        initializeLLVMBackend(*this->theTarget, false);
         llvm::TargetOptions opt;
         this->machine = this->theTarget->createTargetMachine(
             this->triple.str(), 
-            "generic", 
-            "", 
+            this->CPU, 
+            this->Features, 
             opt,
             this->RelocationModel, 
             this->CodeModel,
@@ -82,4 +163,16 @@ struct Options {
             llvm::report_fatal_error("Failed to create TargetMachine");
         this->DL = this->machine->createDataLayout();
     }
+    // the output of compiling `input` to a file with the suffix `ext`(e.g. ".o"): -o if given, otherwise the file name
+    // of `input` with its extension replaced, in the current directory(`-c src/a.c` writes `a.o`, as GCC does)
+    std::string getOutputFileName(StringRef input, StringRef ext) const {
+        if (!outputFile.empty())
+            return outputFile;
+        return (llvm::sys::path::stem(input) + ext).str();
+    }
+    // register what `machine` needs to emit assembly or object files
+    void initializeEmitter() const {
+        assert(this->theTarget && "createTarget() is not called");
+        initializeLLVMBackend(*this->theTarget, true);
+    }
 };
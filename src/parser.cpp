@@ -39,8 +39,11 @@ struct Parser : public EvalHelper {
     struct Variable_Info {
         CType ty = nullptr;
         location_t loc = 0;
-        llvm::Constant *val = nullptr;
+        const ConstantValue *val = nullptr;
         uint8_t tags = 0;
+        // the type of expressions referencing this variable(after lvalue conversion), created on first use
+        CType ref_ty = nullptr;
+        const DeclAttributes *attrs = nullptr; // the merged attributes of all declarations
     };
     enum Implict_Conversion_Kind : unsigned char {
         Implict_Cast,
@@ -58,6 +61,7 @@ struct Parser : public EvalHelper {
         FunctionAndBlockScope<Variable_Info> typedefs;
         BlockScope<Type_info> tags;
         uint8_t currentAlign = 0; // current align(bytes)
+        DeclAttributes *declAttrs = nullptr; // receives the GNU attributes in the declaration-specifiers of the current declaration
         bool type_error = false;  // type error
     } sema;
     struct JumpBuilder {
@@ -133,7 +137,7 @@ NORMAL:
                 return ENEW(SizeofExpr){
                     .ty = context.getSize_t(), .theType = ty, .sizeof_loc_begin = begin, .sizeof_loc_end = end};
         }
-        return wrap(context.getSize_t(), ConstantInt::get(getLLVMContext(), APInt(llvmTypeCache.pointerSizeInBits, getsizeof(e->ty))), begin, end);
+        return wrap(context.getSize_t(), context.createIntConstant(APInt(llvmTypeCache.pointerSizeInBits, getsizeof(e->ty))), begin, end);
     }
     [[nodiscard]] Expr binop(Expr a, BinOp op, Expr b, CType ty) {
         return ENEW(BinExpr){.ty = ty, .lhs = a, .bop = op, .rhs = b};
@@ -141,34 +145,214 @@ NORMAL:
     [[nodiscard]] Expr unary(Expr e, UnaryOp op, CType ty, location_t opLoc = 0) {
         return ENEW(UnaryExpr){.ty = ty, .uoperand = e, .uop = op, .opLoc = opLoc};
     }
+    // constant folding: the front-end constants follow the folding rules of llvm::ConstantExpr, including undef and poison
+    const ConstantValue *getNullConstant(llvm::Type *T) {
+        if (auto IT = dyn_cast<llvm::IntegerType>(T))
+            return context.createIntConstant(APInt::getZero(IT->getBitWidth()));
+        if (T->isPointerTy())
+            return null_ptr_expr->C;
+        if (auto ST = dyn_cast<llvm::StructType>(T)) { // complex
+            auto zero = getNullConstant(ST->getElementType(0));
+            return context.createComplexConstant(zero, zero);
+        }
+        if (auto VT = dyn_cast<llvm::FixedVectorType>(T)) {
+            SmallVector<const ConstantValue *, 16> elements(VT->getNumElements(), getNullConstant(VT->getElementType()));
+            return context.createVectorConstant(elements);
+        }
+        return context.createFloatConstant(APFloat::getZero(T->getFltSemantics()));
+    }
+    // zero of the same type as `C`
+    const ConstantValue *getZeroLike(const ConstantValue *C) {
+        if (auto CI = dyn_cast<IntConstant>(C))
+            return context.createIntConstant(APInt::getZero(CI->getValue().getBitWidth()));
+        return context.createFloatConstant(APFloat::getZero(cast<FloatConstant>(C)->getValue().getSemantics()));
+    }
+    const ConstantValue *fold_cast(CastOp op, const ConstantValue *C, llvm::Type *DestTy) {
+        if (auto U = dyn_cast<UndefConstant>(C)) {
+            // zext(undef) = 0, sext(undef) = 0, [us]itofp(undef) = 0: the result is bounded
+            if (!U->isPoison && (op == ZExt || op == SExt || op == UIToFP || op == SIToFP))
+                return getNullConstant(DestTy);
+            return C;
+        }
+        switch (op) {
+        case Trunc:
+        case ZExt:
+        case SExt: {
+            const APInt &V = cast<IntConstant>(C)->getValue();
+            const unsigned width = DestTy->getIntegerBitWidth();
+            return context.createIntConstant(op == Trunc ? V.trunc(width) : op == ZExt ? V.zext(width) : V.sext(width));
+        }
+        case FPTrunc:
+        case FPExt: {
+            bool ignored;
+            APFloat F = cast<FloatConstant>(C)->getValue();
+            F.convert(DestTy->getFltSemantics(), APFloat::rmNearestTiesToEven, &ignored);
+            return context.createFloatConstant(std::move(F));
+        }
+        case UIToFP:
+        case SIToFP: {
+            APFloat F(DestTy->getFltSemantics());
+            F.convertFromAPInt(cast<IntConstant>(C)->getValue(), op == SIToFP, APFloat::rmNearestTiesToEven);
+            return context.createFloatConstant(std::move(F));
+        }
+        case FPToUI:
+        case FPToSI: {
+            bool ignored;
+            llvm::APSInt I(DestTy->getIntegerBitWidth(), op == FPToUI);
+            // the destination type cannot represent the value
+            if (cast<FloatConstant>(C)->getValue().convertToInteger(I, APFloat::rmTowardZero, &ignored) ==
+                APFloat::opInvalidOp)
+                return context.getUndefConstant(true);
+            return context.createIntConstant(std::move(I));
+        }
+        case IntToPtr:
+            return context.createPointerConstant(cast<IntConstant>(C)->getValue());
+        case PtrToInt:
+            return context.createIntConstant(
+                cast<PointerConstant>(C)->address.zextOrTrunc(llvmTypeCache.pointerSizeInBits).zextOrTrunc(
+                    DestTy->getIntegerBitWidth()));
+        case BitCast: return fold_bitcast(C, DestTy);
+        default: llvm_unreachable("bad cast to fold");
+        }
+    }
+    // reinterprets the bits of a scalar or a vector as `DestTy`, in the byte order of the target
+    const ConstantValue *fold_bitcast(const ConstantValue *C, llvm::Type *DestTy) {
+        ArrayRef<const ConstantValue *> elements(C);
+        if (auto V = dyn_cast<VectorConstant>(C))
+            elements = V->getElements();
+        llvm::Type *ET = DestTy->getScalarType();
+        const auto VT = dyn_cast<llvm::FixedVectorType>(DestTy);
+        const unsigned n = VT ? VT->getNumElements() : 1;
+        const unsigned width = ET->getPrimitiveSizeInBits();
+        const bool little = options.DL.isLittleEndian();
+        APInt bits = APInt::getZero(width * n);
+        unsigned offset = 0;
+        for (const ConstantValue *E : elements) {
+            APInt V;
+            if (auto CI = dyn_cast<IntConstant>(E))
+                V = CI->getValue();
+            else if (auto CF = dyn_cast<FloatConstant>(E))
+                V = CF->getValue().bitcastToAPInt();
+            else // an undef element can be any value, zero is one of them
+                V = APInt::getZero(bits.getBitWidth() / elements.size());
+            bits.insertBits(V, little ? offset : bits.getBitWidth() - offset - V.getBitWidth());
+            offset += V.getBitWidth();
+        }
+        SmallVector<const ConstantValue *, 16> results;
+        for (unsigned i = 0; i < n; ++i) {
+            APInt V = bits.extractBits(width, little ? i * width : bits.getBitWidth() - (i + 1) * width);
+            if (ET->isIntegerTy())
+                results.push_back(context.createIntConstant(std::move(V)));
+            else
+                results.push_back(context.createFloatConstant(APFloat(ET->getFltSemantics(), V)));
+        }
+        return VT ? context.createVectorConstant(results) : results.front();
+    }
+    const ConstantValue *fold_binop(BinOp op, const ConstantValue *a, const ConstantValue *b) {
+        const auto UA = dyn_cast<UndefConstant>(a), UB = dyn_cast<UndefConstant>(b);
+        if ((UA && UA->isPoison) || (UB && UB->isPoison))
+            return context.getUndefConstant(true);
+        if (UA || UB) {
+            switch (op) {
+            case UAdd:
+            case SAdd:
+            case USub:
+            case SSub: return context.getUndefConstant();
+            case Shl:
+                if (UA && UB) // undef << undef -> undef
+                    return a;
+                if (UB) // X << undef -> poison
+                    return context.getUndefConstant(true);
+                return getZeroLike(b); // undef << X -> 0
+            case UDiv:
+            case SDiv:
+            case URem:
+            case SRem:
+                if (UB) // X / undef -> poison
+                    return context.getUndefConstant(true);
+                if ((op == UDiv || op == SDiv) && cast<IntConstant>(b)->getValue().isOne()) // undef / 1 -> undef
+                    return a;
+                return getZeroLike(b); // undef / X -> 0
+            case FMul:
+                if (auto CF = dyn_cast<FloatConstant>(UA ? b : a); CF && CF->getValue().isExactlyValue(1.0))
+                    return UA ? a : b;
+                [[fallthrough]];
+            case FDiv:
+            case FRem:
+                if (UA && UB)
+                    return a;
+                // any floating operation with an undef operand can return NaN
+                return context.createFloatConstant(
+                    APFloat::getNaN(cast<FloatConstant>(UA ? b : a)->getValue().getSemantics()));
+            default: llvm_unreachable("bad binary operator to fold");
+            }
+        }
+        if (const auto CI = dyn_cast<IntConstant>(a)) {
+            const APInt &x = CI->getValue(), &y = cast<IntConstant>(b)->getValue();
+            switch (op) {
+            case UAdd:
+            case SAdd: return context.createIntConstant(x + y);
+            case USub:
+            case SSub: return context.createIntConstant(x - y);
+            case Shl:
+                if (y.uge(x.getBitWidth()))
+                    return context.getUndefConstant(true);
+                return context.createIntConstant(x.shl(y));
+            case UDiv:
+            case URem:
+            case SDiv:
+            case SRem:
+                if (y.isZero() || ((op == SDiv || op == SRem) && x.isMinSignedValue() && y.isAllOnes()))
+                    return context.getUndefConstant(true);
+                switch (op) {
+                case UDiv: return context.createIntConstant(x.udiv(y));
+                case URem: return context.createIntConstant(x.urem(y));
+                case SDiv: return context.createIntConstant(x.sdiv(y));
+                default: return context.createIntConstant(x.srem(y));
+                }
+            default: llvm_unreachable("bad binary operator to fold");
+            }
+        }
+        APFloat F = cast<FloatConstant>(a)->getValue();
+        const APFloat &y = cast<FloatConstant>(b)->getValue();
+        switch (op) {
+        case FMul: F.multiply(y, APFloat::rmNearestTiesToEven); break;
+        case FDiv: F.divide(y, APFloat::rmNearestTiesToEven); break;
+        case FRem: F.mod(y); break;
+        default: llvm_unreachable("bad binary operator to fold");
+        }
+        return context.createFloatConstant(std::move(F));
+    }
+    const ConstantValue *fold_neg(const ConstantValue *C) {
+        if (auto CI = dyn_cast<IntConstant>(C))
+            return context.createIntConstant(-CI->getValue());
+        if (auto CF = dyn_cast<FloatConstant>(C))
+            return context.createFloatConstant(neg(CF->getValue()));
+        return C; // -undef is undef
+    }
     Expr complex_from_real(Expr real, CType ty) {
         ty = context.tryGetComplexTypeFromNonComplex(ty);
-        auto zero = llvm::Constant::getNullValue(wrapNoComplexScalar(ty));
+        auto zero = getNullConstant(wrapNoComplexScalar(ty));
         if (real->k == EConstant)
-            return wrap(ty, llvm::ConstantStruct::get(wrapComplex(ty), {real->C, zero}), real->getBeginLoc(),
-                        real->getEndLoc());
+            return wrap(ty, context.createComplexConstant(real->C, zero), real->getBeginLoc(), real->getEndLoc());
         return binop(real, Complex_CMPLX, wrap(ty, zero, real->getBeginLoc(), real->getEndLoc()), ty);
     }
     Expr complex_from_imag(Expr imag, CType ty) {
         ty = context.tryGetComplexTypeFromNonComplex(ty);
-        auto zero = ConstantFP::getZero(wrapNoComplexScalar(ty));
+        auto zero = getNullConstant(wrapNoComplexScalar(ty));
         if (imag->k == EConstant)
-            return wrap(ty, llvm::ConstantStruct::get(wrapComplex(ty), {zero, imag->C}), imag->getBeginLoc(),
-                        imag->getEndLoc());
+            return wrap(ty, context.createComplexConstant(zero, imag->C), imag->getBeginLoc(), imag->getEndLoc());
         return binop(wrap(ty, zero, imag->getBeginLoc(), imag->getEndLoc()), Complex_CMPLX, imag, ty);
     }
     Expr complex_pair(Expr a, Expr b, CType ty) {
         return (a->k == EConstant && b->k == EConstant)
-                   ? wrap(ty, llvm::ConstantStruct::get(wrapComplex(ty), {a->C, b->C}), a->getBeginLoc(),
-                          b->getEndLoc())
+                   ? wrap(ty, context.createComplexConstant(a->C, b->C), a->getBeginLoc(), b->getEndLoc())
                    : binop(a, Complex_CMPLX, b, ty);
     }
     Expr complex_get_real(Expr e) {
         if (e->k == EConstant) {
-            if (const auto AZ = dyn_cast<llvm::ConstantAggregateZero>(e->C))
-                return wrap(e->ty, AZ->getElementValue((unsigned)0), e->getBeginLoc(), e->getEndLoc());
-            if (const auto CS = dyn_cast<llvm::ConstantStruct>(e->C))
-                return wrap(e->ty, CS->getOperand(0), e->getBeginLoc(), e->getEndLoc());
+            if (const auto CC = dyn_cast<ComplexConstant>(e->C))
+                return wrap(e->ty, CC->real, e->getBeginLoc(), e->getEndLoc());
         }
         if (e->k == EBin && e->bop == Complex_CMPLX) {
             return e->lhs;
@@ -177,10 +361,8 @@ NORMAL:
     }
     Expr complex_get_imag(Expr e) {
         if (e->k == EConstant) {
-            if (const auto AZ = dyn_cast<llvm::ConstantAggregateZero>(e->C))
-                return wrap(e->ty, AZ->getElementValue((unsigned)1), e->getBeginLoc(), e->getEndLoc());
-            if (const auto CS = dyn_cast<llvm::ConstantStruct>(e->C))
-                return wrap(e->ty, CS->getOperand(1), e->getBeginLoc(), e->getEndLoc());
+            if (const auto CC = dyn_cast<ComplexConstant>(e->C))
+                return wrap(e->ty, CC->imag, e->getBeginLoc(), e->getEndLoc());
         }
         if (e->k == EBin && e->bop == Complex_CMPLX) {
             return e->rhs;
@@ -193,37 +375,35 @@ NORMAL:
     }
     Expr complex_zero(CType ty, location_t startLoc, location_t endLoc) {
         assert(ty->isComplex());
-        auto T = wrapComplex(ty);
-        auto zero = llvm::Constant::getNullValue(T->getTypeAtIndex((unsigned)0));
-        return wrap(ty, llvm::ConstantStruct::get(T, {zero, zero}), startLoc, endLoc);
+        auto zero = getNullConstant(wrapNoComplexScalar(ty));
+        return wrap(ty, context.createComplexConstant(zero, zero), startLoc, endLoc);
+    }
+    // a complex constant of floating type
+    Expr complex_float_pair(CType ty, APFloat real, APFloat imag, location_t startLoc, location_t endLoc) {
+        return wrap(ty,
+                    context.createComplexConstant(context.createFloatConstant(std::move(real)),
+                                                  context.createFloatConstant(std::move(imag))),
+                    startLoc, endLoc);
     }
     Expr complex_neg_zero(CType ty, location_t startLoc, location_t endLoc) {
         assert(ty->isComplex());
-        auto T = wrapComplex(ty);
-        auto neg_zero = ConstantFP::getNegativeZero(T->getTypeAtIndex((unsigned)0));
-        return wrap(ty, llvm::ConstantStruct::get(T, {neg_zero, neg_zero}), startLoc, endLoc);
+        const auto &S = wrapNoComplexScalar(ty)->getFltSemantics();
+        return complex_float_pair(ty, APFloat::getZero(S, true), APFloat::getZero(S, true), startLoc, endLoc);
     }
     Expr complex_pos_neg_zero(CType ty, location_t startLoc, location_t endLoc) {
         assert(ty->isComplex());
-        auto T = wrapComplex(ty);
-        auto TY = T->getTypeAtIndex((unsigned)0);
-        auto zero = ConstantFP::getZero(TY);
-        auto neg_zero = ConstantFP::getNegativeZero(TY);
-        return wrap(ty, llvm::ConstantStruct::get(T, {zero, neg_zero}), startLoc, endLoc);
+        const auto &S = wrapNoComplexScalar(ty)->getFltSemantics();
+        return complex_float_pair(ty, APFloat::getZero(S), APFloat::getZero(S, true), startLoc, endLoc);
     }
     Expr complex_neg_nan_pair(CType ty, location_t startLoc, location_t endLoc) {
         assert(ty->isComplex());
-        auto T = wrapComplex(ty);
-        auto TY = T->getTypeAtIndex((unsigned)0);
-        auto neg_zero = ConstantFP::getNegativeZero(TY);
-        auto qnan = ConstantFP::getQNaN(TY, true);
-        return wrap(ty, llvm::ConstantStruct::get(T, {neg_zero, qnan}), startLoc, endLoc);
+        const auto &S = wrapNoComplexScalar(ty)->getFltSemantics();
+        return complex_float_pair(ty, APFloat::getZero(S, true), APFloat::getQNaN(S, true), startLoc, endLoc);
     }
     Expr complex_inf_pair(CType ty, location_t startLoc, location_t endLoc) {
         assert(ty->isComplex());
-        auto T = wrapComplex(ty);
-        auto inf = ConstantFP::getInfinity(T->getTypeAtIndex((unsigned)0));
-        return wrap(ty, llvm::ConstantStruct::get(T, {inf, inf}), startLoc, endLoc);
+        const auto &S = wrapNoComplexScalar(ty)->getFltSemantics();
+        return complex_float_pair(ty, APFloat::getInf(S), APFloat::getInf(S), startLoc, endLoc);
     }
     ArenaAllocator &getAllocator() { return context.getAllocator(); }
     CType gettypedef(IdentRef Name) {
@@ -332,7 +512,7 @@ NORMAL:
         }
         sema.typedefs.putSym(Name, Variable_Info{
                                        .ty = context.getConstInt(),
-                                       .val = ConstantInt::get(llvmTypeCache.integer_types[context.getEnumLog2()], val),
+                                       .val = context.createIntConstant(APInt(context.getEnumSizeInBits(), val)),
                                        .tags = ASSIGNED | USED, // enums are used by default ignore warnings
                                    });
     }
@@ -408,13 +588,14 @@ NORMAL:
             }
 PUT:
             it->ty = yt;
+            it->ref_ty = nullptr;
         } else {
             idx = sema.typedefs.putSym(Name, Variable_Info{.ty = yt, .loc = full_loc, .tags = LOCAL_GARBAGE});
         }
         return idx;
     }
     bool istype() {
-        return is_declaration_specifier(l.tok.tok)
+        return (is_declaration_specifier(l.tok.tok) || l.tok.tok == K__attribute)
                    ? true
                    : (l.tok.tok == TIdentifier ? gettypedef(l.tok.s) != nullptr : false);
     }
@@ -500,12 +681,12 @@ PUT:
         const unsigned rA = k1, rB = k2;
         auto k3 = rA > rB ? k1 : k2;
         if (rA > rB)
-            return e->k == EConstant ? wrap(to, llvm::ConstantExpr::getFPExtend(e->C, wrapNoComplexScalar(to)),
-                                            e->getBeginLoc(), e->getEndLoc())
+            return e->k == EConstant ? wrap(to, fold_cast(FPExt, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
+                                            e->getEndLoc())
                                      : make_cast(e, FPExt, to);
         if (rA < rB)
-            return e->k == EConstant ? wrap(to, llvm::ConstantExpr::getFPTrunc(e->C, wrapNoComplexScalar(to)),
-                                            e->getBeginLoc(), e->getEndLoc())
+            return e->k == EConstant ? wrap(to, fold_cast(FPTrunc, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
+                                            e->getEndLoc())
                                      : make_cast(e, FPTrunc, to);
         if ((k3 >= F_Decimal32 && k3 <= F_Decimal128) || k3 == F_PPC128 || k3 == F_BFloat)
             type_error(e->getBeginLoc(), "unsupported floating fast") << e->getSourceRange();
@@ -514,9 +695,7 @@ PUT:
     }
     Expr int_cast_promote(Expr e, bool isASigned, CType to) {
         return e->k == EConstant
-                   ? wrap(to,
-                          (e->ty->isSigned() ? &llvm::ConstantExpr::getSExt : &llvm::ConstantExpr::getZExt)(
-                              e->C, wrapNoComplexScalar(to), false),
+                   ? wrap(to, fold_cast(e->ty->isSigned() ? SExt : ZExt, e->C, wrapNoComplexScalar(to)),
                           e->getBeginLoc(), e->getEndLoc())
                    : make_cast(e, e->ty->isSigned() ? SExt : ZExt, to);
     }
@@ -528,14 +707,12 @@ PUT:
             const unsigned rA = to->getIntegerKind().getBitWidth(), rB = e->ty->getIntegerKind().getBitWidth();
             if (rA > rB)
                 return e->k == EConstant
-                           ? wrap(to,
-                                  (e->ty->isSigned() ? &llvm::ConstantExpr::getSExt : &llvm::ConstantExpr::getZExt)(
-                                      e->C, wrapNoComplexScalar(to), false),
+                           ? wrap(to, fold_cast(e->ty->isSigned() ? SExt : ZExt, e->C, wrapNoComplexScalar(to)),
                                   e->getBeginLoc(), e->getEndLoc())
                            : make_cast(e, e->ty->isSigned() ? SExt : ZExt, to);
             if (rA < rB)
-                return e->k == EConstant ? wrap(to, llvm::ConstantExpr::getTrunc(e->C, wrapNoComplexScalar(to)),
-                                                e->getBeginLoc(), e->getEndLoc())
+                return e->k == EConstant ? wrap(to, fold_cast(Trunc, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
+                                                e->getEndLoc())
                                          : make_cast(e, Trunc, to);
             return bit_cast(e, to);
         }
@@ -547,10 +724,10 @@ PUT:
         assert((e->ty->isInteger()) && "bad call to integer_to_ptr()");
         assert((to->getKind() == TYPOINTER) && "bad call to integer_to_ptr()");
         if (e->k == EConstant) {
-            auto CI = cast<ConstantInt>(e->C);
+            auto CI = cast<IntConstant>(e->C);
             if (CI->isZero()) // A interger constant expression with the value 0 is a *null pointer constant*
                 return null_ptr_expr;
-            return wrap(to, llvm::ConstantExpr::getIntToPtr(CI, llvmTypeCache.pointer_type), e->getBeginLoc(), e->getEndLoc());
+            return wrap(to, fold_cast(IntToPtr, CI, llvmTypeCache.pointer_type), e->getBeginLoc(), e->getEndLoc());
         }
         if (implict != Implict_Cast) {
             CType arg1 = e->ty;
@@ -609,8 +786,7 @@ PUT:
             warning(e->getBeginLoc(), "cast to smaller integer type %T from %T", to, e->ty);
         }
         if (e->k == EConstant)
-            return wrap(to, llvm::ConstantExpr::getPtrToInt(e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
-                        e->getEndLoc());
+            return wrap(to, fold_cast(PtrToInt, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(), e->getEndLoc());
         return make_cast(e, PtrToInt, to);
     }
     Expr integer_to_float(Expr e, CType to) {
@@ -619,13 +795,11 @@ PUT:
         assert((e->ty->isInteger()) && "bad call to integer_to_float()");
         if (e->ty->isSigned()) {
             if (e->k == EConstant)
-                return wrap(to, llvm::ConstantExpr::getSIToFP(e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
-                            e->getEndLoc());
+                return wrap(to, fold_cast(SIToFP, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(), e->getEndLoc());
             return make_cast(e, SIToFP, to);
         }
         if (e->k == EConstant)
-            return wrap(to, llvm::ConstantExpr::getUIToFP(e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
-                        e->getEndLoc());
+            return wrap(to, fold_cast(UIToFP, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(), e->getEndLoc());
         return make_cast(e, UIToFP, to);
     }
     Expr float_to_integer(Expr e, CType to) {
@@ -634,13 +808,11 @@ PUT:
         assert((to->isInteger()) && "bad call to float_to_integer()");
         if (to->isSigned()) {
             if (e->k == EConstant)
-                return wrap(to, llvm::ConstantExpr::getFPToSI(e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
-                            e->getEndLoc());
+                return wrap(to, fold_cast(FPToSI, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(), e->getEndLoc());
             return make_cast(e, FPToSI, to);
         }
         if (e->k == EConstant)
-            return wrap(to, llvm::ConstantExpr::getFPToUI(e->C, wrapNoComplexScalar(to)), e->getBeginLoc(),
-                        e->getEndLoc());
+            return wrap(to, fold_cast(FPToUI, e->C, wrapNoComplexScalar(to)), e->getBeginLoc(), e->getEndLoc());
         return make_cast(e, FPToUI, to);
     }
     Expr ptr_cast(Expr e, CType to, enum Implict_Conversion_Kind implict = Implict_Cast) {
@@ -720,6 +892,18 @@ PTR_CAST:
             return castto(bit_cast(e, context.getEnumRealType()), to);
         if (k == TYTAG && to->isEnum()) // cast to enum: do-cast e to int first, then bit-cast to enum
             return bit_cast(castto(e, context.getEnumRealType()), to);
+        if (k0 == TYVECTOR || k == TYVECTOR) {
+            // an explicit cast reinterprets a vector as another vector or as a scalar of the same size, and vice versa
+            CType other = k0 == TYVECTOR ? to : e->ty;
+            const bool reinterpretable = other->getKind() == TYVECTOR || (other->getKind() == TYPRIM && !other->isVoid() &&
+                                                                          !other->isComplex() && !other->isBool());
+            if (implict == Implict_Cast && reinterpretable && getsizeof(e->ty) == getsizeof(to)) {
+                if (e->k == EConstant)
+                    return wrap(to, fold_cast(BitCast, e->C, llvmTypeCache.wrap(to)), e->getBeginLoc(), e->getEndLoc());
+                return make_cast(e, BitCast, to);
+            }
+            return type_error(loc, "invalid conversion from %T to %T", e->ty, to), e;
+        }
         if (k0 != TYPRIM || k != TYPRIM)
             return type_error(loc, "invalid conversion from %T to %T", e->ty, to), e;
         if (e->ty->hasTag(TYVOID))
@@ -731,7 +915,7 @@ PTR_CAST:
             else if (e->k == ECast && e->castop == ZExt && e->castval->ty->isBool())
                 return e->castval;
             if (e->k == EConstant)
-                if (auto CI = dyn_cast<ConstantInt>(e->C))
+                if (auto CI = dyn_cast<IntConstant>(e->C))
                     return getCBool(!CI->isZero());
             return unary(e, ToBool, to);
         }
@@ -748,21 +932,21 @@ PTR_CAST:
         // conversion rules for the corresponding real types.
         if (e->ty->isImaginary()) {
             if (!(to->isComplex() || to->isImaginary()))
-                return wrap(to, llvm::Constant::getNullValue(wrapNoComplexScalar(to)), e->getBeginLoc(),
+                return wrap(to, getNullConstant(wrapNoComplexScalar(to)), e->getBeginLoc(),
                             e->getEndLoc());
             CType ty = context.make_cached(e->ty->del(TYIMAGINARY | TYCOMPLEX));
             CType ty2 = context.make_cached(to->del(TYCOMPLEX | TYIMAGINARY));
             Expr res = castto(bit_cast(e, ty), ty2);
             if (to->isImaginary())
                 return res;
-            return complex_pair(wrap(to, llvm::Constant::getNullValue(wrapNoComplexScalar(ty2)), e->getBeginLoc(),
+            return complex_pair(wrap(to, getNullConstant(wrapNoComplexScalar(ty2)), e->getBeginLoc(),
                                      e->getEndLoc()),
                                 res, to);
         }
         if (to->isImaginary()) {
             if (e->ty->isComplex())
                 return bit_cast(complex_get_imag(e), to);
-            return wrap(to, llvm::Constant::getNullValue(wrapNoComplexScalar(to)), e->getBeginLoc(),
+            return wrap(to, getNullConstant(wrapNoComplexScalar(to)), e->getBeginLoc(),
                         e->getEndLoc());
         }
         // if e is a complex number
@@ -944,8 +1128,7 @@ SIDE_EFFECT:
             if (e->ty->getIntegerKind().asLog2() < 5) {
                 e = (e->k == EConstant
                          ? wrap(context.getInt(),
-                                (e->ty->isSigned() ? &llvm::ConstantExpr::getSExt
-                                                   : &llvm::ConstantExpr::getZExt)(e->C, llvmTypeCache.integer_types[5], false),
+                                fold_cast(e->ty->isSigned() ? SExt : ZExt, e->C, llvmTypeCache.integer_types[5]),
                                 e->getBeginLoc(), e->getEndLoc())
                          : make_cast(e, e->ty->isSigned() ? SExt : ZExt, context.getInt()));
             }
@@ -1154,6 +1337,59 @@ SIDE_EFFECT:
         }
         llvm_unreachable("bad expr kind");
     }
+    static bool hasVectorOperand(Expr a, Expr b) {
+        return a->ty->getKind() == TYVECTOR || b->ty->getKind() == TYVECTOR;
+    }
+    // GCC vector extensions: the operands of a binary operator are two vectors of the same type, or a vector and a scalar,
+    // which is converted to the element type and broadcast. returns the vector type, nullptr on error
+    CType vector_conv(Expr &a, Expr &b, location_t opLoc) {
+        if (a->ty->getKind() == TYVECTOR && b->ty->getKind() == TYVECTOR) {
+            if (!type_equal(a->ty, b->ty))
+                return (type_error(opLoc, "cannot convert between vector values of different types(%T and %T)", a->ty, b->ty)
+                        << a->getSourceRange() << b->getSourceRange()), nullptr;
+            return a->ty;
+        }
+        const bool isVectorA = a->ty->getKind() == TYVECTOR;
+        CType ty = isVectorA ? a->ty : b->ty;
+        Expr &scalar = isVectorA ? b : a;
+        if (!(checkArithmetic(scalar->ty) && !scalar->ty->isComplex()))
+            return (type_error(opLoc, "cannot convert %T to vector type %T", scalar->ty, ty) << scalar->getSourceRange()), nullptr;
+        scalar = vector_splat(castto(scalar, ty->vec_ty), ty);
+        return ty;
+    }
+    Expr vector_splat(Expr e, CType ty) {
+        if (e->k == EConstant) {
+            SmallVector<const ConstantValue *, 16> elements(ty->vec_num_elems, e->C);
+            return wrap(ty, context.createVectorConstant(elements), e->getBeginLoc(), e->getEndLoc());
+        }
+        return make_cast(e, VectorSplat, ty);
+    }
+    // an element-wise binary operator of vectors: `sop`, `uop` and `fop` are the operators for signed integer, unsigned integer
+    // and floating elements, 0 if the operator is not defined for the element type
+    void make_vector_binop(Expr &result, Expr &r, BinOp sop, BinOp uop, BinOp fop, location_t opLoc) {
+        CType ty = vector_conv(result, r, opLoc);
+        if (!ty)
+            return;
+        CType elem = ty->vec_ty;
+        const BinOp op = elem->isFloating() ? fop : elem->isSigned() ? sop : uop;
+        if (!op)
+            return (void)(type_error(opLoc, "invalid operands to binary expression(%T and %T)", result->ty, r->ty)
+                          << result->getSourceRange() << r->getSourceRange());
+        result = binop(result, op, r, ty);
+    }
+    // a vector comparison yields a vector of signed integers as wide as the elements, an element is 0 or -1(all bits set)
+    void make_vector_cmp(Expr &result, Expr &r, Token tok, location_t opLoc) {
+        CType ty = vector_conv(result, r, opLoc);
+        if (!ty)
+            return;
+        CType elem = ty->vec_ty;
+        const unsigned n = ty->vec_num_elems;
+        CType maskTy = context.getVectorType(
+            context.make_cached(build_integer(IntegerKind::fromBytes(getsizeof(elem)), true)), n);
+        Expr cmp = binop(result, get_relational_expression_op(tok, elem->isFloating(), elem->isSigned2()), r,
+                         context.getVectorType(context.getBool(), n));
+        result = make_cast(cmp, SExt, maskTy);
+    }
     Expr make_add_pointer(Expr rhs, Expr lhs) {
         Expr ptrPart = lhs;
         Expr intPart = rhs;
@@ -1166,12 +1402,12 @@ SIDE_EFFECT:
             return ptrPart;
         }
         if (intPart->k == EConstant) {
-            if (auto CI = dyn_cast<ConstantInt>(intPart->C)) {
+            if (auto CI = dyn_cast<IntConstant>(intPart->C)) {
                 uint64_t offset = (intPart->ty->isSigned() ? CI->getValue().sextOrTrunc(llvmTypeCache.pointerSizeInBits)
                                                        : CI->getValue().zextOrTrunc(llvmTypeCache.pointerSizeInBits)).getLimitedValue();
                 if (ptrPart->k == EString)
                     return ENEW(ConstantArraySubstriptExpr){.ty = ptrPart->ty,
-                                                            .array = ptrPart->array,
+                                                            .array = ptrPart->string,
                                                             .cidx = offset,
                                                             .casLoc = lhs->getBeginLoc(),
                                                             .casEndLoc = rhs->getEndLoc()};
@@ -1194,6 +1430,8 @@ SIDE_EFFECT:
         return binop(ptrPart, SAddP, intPart, pointer_ty);
     }
     void make_add(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, SAdd, UAdd, FAdd, opLoc);
         if (result->ty->getKind() == TYPOINTER || r->ty->getKind() == TYPOINTER) {
             if (result->ty->getKind() == r->ty->getKind())
                 return (void)(type_error(opLoc, "adding two pointers are not allowed") << result->getSourceRange(),
@@ -1239,19 +1477,19 @@ SIDE_EFFECT:
         checkSpec(result, r);
         if (result->ty->isComplex()) {
             if (result->k == EConstant && r->k == EConstant) {
-                if (isa<llvm::ConstantAggregateZero>(result->C))
+                if (result->C->isNullValue())
                     return (void)(result = r);
-                if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (r->C->isNullValue())
                     return;
             }
             if (result->ty->isFloating()) {
                 if (result->k == EConstant && r->k == EConstant) {
-                    if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                        if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                            const auto &a = cast<ConstantFP>(X->getOperand(0))->getValue();
-                            const auto &b = cast<ConstantFP>(X->getOperand(1))->getValue();
-                            const auto &c = cast<ConstantFP>(Y->getOperand(0))->getValue();
-                            const auto &d = cast<ConstantFP>(Y->getOperand(1))->getValue();
+                    if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                        if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                            const auto &a = cast<FloatConstant>(X->real)->getValue();
+                            const auto &b = cast<FloatConstant>(X->imag)->getValue();
+                            const auto &c = cast<FloatConstant>(Y->real)->getValue();
+                            const auto &d = cast<FloatConstant>(Y->imag)->getValue();
                             APFloat REAL = a;
                             handleOpStatus(REAL.add(c, APFloat::rmNearestTiesToEven));
 
@@ -1259,9 +1497,8 @@ SIDE_EFFECT:
                             handleOpStatus(IMAG.add(d, APFloat::rmNearestTiesToEven));
 
                             result = wrap(r->ty,
-                                          llvm::ConstantStruct::get(wrapComplex(r->ty),
-                                                                    ConstantFP::get(getLLVMContext(), REAL),
-                                                                    ConstantFP::get(getLLVMContext(), IMAG)),
+                                          context.createComplexConstant(context.createFloatConstant(REAL),
+                                                                        context.createFloatConstant(IMAG)),
                                           result->getBeginLoc(), result->getEndLoc());
                             return;
                         }
@@ -1271,22 +1508,22 @@ SIDE_EFFECT:
                 return;
             }
             if (result->k == EConstant && r->k == EConstant) {
-                if (isa<llvm::ConstantAggregateZero>(result->C))
+                if (result->C->isNullValue())
                     return (void)(result = r);
-                if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (r->C->isNullValue())
                     return /* (void)(result = result) */;
 
-                if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                    if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                        const auto &a = cast<ConstantInt>(X->getOperand(0))->getValue();
-                        const auto &b = cast<ConstantInt>(X->getOperand(1))->getValue();
-                        const auto &c = cast<ConstantInt>(Y->getOperand(0))->getValue();
-                        const auto &d = cast<ConstantInt>(Y->getOperand(1))->getValue();
+                if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                    if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                        const auto &a = cast<IntConstant>(X->real)->getValue();
+                        const auto &b = cast<IntConstant>(X->imag)->getValue();
+                        const auto &c = cast<IntConstant>(Y->real)->getValue();
+                        const auto &d = cast<IntConstant>(Y->imag)->getValue();
 
                         result =
                             wrap(r->ty,
-                                 llvm::ConstantStruct::get(wrapComplex(r->ty), ConstantInt::get(getLLVMContext(), a + c),
-                                                           ConstantInt::get(getLLVMContext(), b + d)),
+                                 context.createComplexConstant(context.createIntConstant(a + c),
+                                                               context.createIntConstant(b + d)),
                                  result->getBeginLoc(), result->getEndLoc());
                         return;
                     }
@@ -1297,43 +1534,45 @@ SIDE_EFFECT:
         }
         if (result->ty->isFloating()) {
             if (result->k == EConstant && r->k == EConstant) {
-                auto CF1 = cast<ConstantFP>(result->C);
-                auto CF2 = cast<ConstantFP>(r->C);
+                auto CF1 = cast<FloatConstant>(result->C);
+                auto CF2 = cast<FloatConstant>(r->C);
                 APFloat F = CF1->getValue();
                 handleOpStatus(F.add(CF2->getValue(), APFloat::rmNearestTiesToEven));
-                result = wrap(r->ty, ConstantFP::get(getLLVMContext(), F), r->getBeginLoc(), r->getEndLoc());
+                result = wrap(r->ty, context.createFloatConstant(F), r->getBeginLoc(), r->getEndLoc());
                 return;
             }
             result = binop(result, FAdd, r, r->ty);
             return;
         }
         if (result->k == EConstant && r->k == EConstant) {
-            if (auto CI = dyn_cast<ConstantInt>(result->C)) {
+            if (auto CI = dyn_cast<IntConstant>(result->C)) {
                 if (CI->isZero())
                     return (void)(result = r);
-                if (auto CI2 = dyn_cast<ConstantInt>(r->C)) {
+                if (auto CI2 = dyn_cast<IntConstant>(r->C)) {
                     if (CI2->isZero())
                         return;
                     bool overflow = false;
                     result = wrap(result->ty,
-                                  ConstantInt::get(getLLVMContext(), result->ty->isSigned()
+                                  context.createIntConstant(result->ty->isSigned()
                                                                   ? CI->getValue().sadd_ov(CI2->getValue(), overflow)
                                                                   : CI->getValue().uadd_ov(CI2->getValue(), overflow)),
                                   result->getBeginLoc(), r->getEndLoc());
                     if (overflow)
                         warning(opLoc, "%s addition overflow, the result is %A",
                                 result->ty->isSigned() ? "signed" : "unsigned",
-                                &cast<ConstantInt>(result->C)->getValue());
+                                &cast<IntConstant>(result->C)->getValue());
                     return;
                 }
             }
-            result = wrap(r->ty, llvm::ConstantExpr::getAdd(result->C, r->C, false, r->ty->isSigned()),
+            result = wrap(r->ty, fold_binop(r->ty->isSigned() ? SAdd : UAdd, result->C, r->C),
                           result->getBeginLoc(), r->getEndLoc());
             return;
         }
         result = binop(result, r->ty->isSigned() ? SAdd : UAdd, r, r->ty);
     }
     void make_sub(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, SSub, USub, FSub, opLoc);
         bool p1 = result->ty->getKind() == TYPOINTER;
         bool p2 = r->ty->getKind() == TYPOINTER;
         if (p1 && p2) {
@@ -1346,7 +1585,7 @@ SIDE_EFFECT:
             Expr intPart = p1 ? r : result;
             Expr ptrPart = p1 ? result : r;
             if (intPart->k == EConstant) {
-                intPart = wrap(intPart->ty, llvm::ConstantExpr::getNeg(intPart->C), intPart->getBeginLoc(),
+                intPart = wrap(intPart->ty, fold_neg(intPart->C), intPart->getBeginLoc(),
                                intPart->getEndLoc());
             } else {
                 intPart = unary(intPart, UNeg, intPart->ty);
@@ -1376,7 +1615,7 @@ SIDE_EFFECT:
                 // e.g., (3i) - (4) => -4 + 3i
                 conv(e2, r);
                 if (e2->k == EConstant) {
-                    return (void)(result = complex_pair(wrap(e2->ty, llvm::ConstantExpr::getNeg(e2->C),
+                    return (void)(result = complex_pair(wrap(e2->ty, fold_neg(e2->C),
                                                              e2->getBeginLoc(), e2->getEndLoc()),
                                                         r));
                 } else {
@@ -1396,7 +1635,7 @@ SIDE_EFFECT:
             // e.g, 4 - 3i
             conv(result, e2);
             if (e2->k == EConstant) {
-                e2 = wrap(e2->ty, llvm::ConstantExpr::getNeg(e2->C), e2->getBeginLoc(), e2->getEndLoc());
+                e2 = wrap(e2->ty, fold_neg(e2->C), e2->getBeginLoc(), e2->getEndLoc());
             } else {
                 e2 = unary(e2, e2->ty->isFloating() ? FNeg : UNeg, e2->ty);
             }
@@ -1405,40 +1644,38 @@ SIDE_EFFECT:
         checkSpec(result, r);
         if (result->ty->isComplex()) {
             if (result->k == EConstant && r->k == EConstant) {
-                if (isa<llvm::ConstantAggregateZero>(result->C)) {
-                    if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (result->C->isNullValue()) {
+                    if (r->C->isNullValue())
                         // zero - zero => zero
                         return (void)(result = complex_zero(result->ty, result->getBeginLoc(), r->getEndLoc()));
-                    const auto CS = cast<llvm::ConstantStruct>(r->C);
-                    if (auto CI = dyn_cast<ConstantInt>(CS->getOperand(0))) {
-                        auto CI2 = cast<ConstantInt>(CS->getOperand(1));
+                    const auto CS = cast<ComplexConstant>(r->C);
+                    if (auto CI = dyn_cast<IntConstant>(CS->real)) {
+                        auto CI2 = cast<IntConstant>(CS->imag);
                         return (void)(result = wrap(
                                           r->ty,
-                                          llvm::ConstantStruct::get(wrapComplexForInteger(r->ty),
-                                                                    {ConstantInt::get(getLLVMContext(), -CI->getValue()),
-                                                                     ConstantInt::get(getLLVMContext(), -CI2->getValue())}),
+                                          context.createComplexConstant(context.createIntConstant(-CI->getValue()),
+                                                                        context.createIntConstant(-CI2->getValue())),
                                           result->getBeginLoc(), result->getEndLoc()));
                     }
-                    auto CF = cast<ConstantFP>(CS->getOperand(0));
-                    auto CF2 = cast<ConstantFP>(CS->getOperand(1));
+                    auto CF = cast<FloatConstant>(CS->real);
+                    auto CF2 = cast<FloatConstant>(CS->imag);
                     return (void)(result =
                                       wrap(r->ty,
-                                           llvm::ConstantStruct::get(wrapComplex(r->ty),
-                                                                     {ConstantFP::get(getLLVMContext(), -CF->getValue()),
-                                                                      ConstantFP::get(getLLVMContext(), -CF2->getValue())}),
+                                           context.createComplexConstant(context.createFloatConstant(-CF->getValue()),
+                                                                         context.createFloatConstant(-CF2->getValue())),
                                            result->getBeginLoc(), result->getEndLoc()));
                 }
-                if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (r->C->isNullValue())
                     return /* (void)(result = result) */;
             }
             if (result->ty->isFloating()) {
                 if (result->k == EConstant && r->k == EConstant) {
-                    if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                        if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                            const auto &a = cast<ConstantFP>(X->getOperand(0))->getValue();
-                            const auto &b = cast<ConstantFP>(X->getOperand(1))->getValue();
-                            const auto &c = cast<ConstantFP>(Y->getOperand(0))->getValue();
-                            const auto &d = cast<ConstantFP>(Y->getOperand(1))->getValue();
+                    if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                        if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                            const auto &a = cast<FloatConstant>(X->real)->getValue();
+                            const auto &b = cast<FloatConstant>(X->imag)->getValue();
+                            const auto &c = cast<FloatConstant>(Y->real)->getValue();
+                            const auto &d = cast<FloatConstant>(Y->imag)->getValue();
                             APFloat REAL = a;
                             handleOpStatus(REAL.subtract(c, APFloat::rmNearestTiesToEven));
 
@@ -1447,8 +1684,8 @@ SIDE_EFFECT:
 
                             result = wrap(
                                 r->ty,
-                                llvm::ConstantStruct::get(wrapComplex(r->ty), {ConstantFP::get(getLLVMContext(), REAL),
-                                                                                     ConstantFP::get(getLLVMContext(), IMAG)}),
+                                context.createComplexConstant(context.createFloatConstant(REAL),
+                                                              context.createFloatConstant(IMAG)),
                                 result->getBeginLoc(), result->getEndLoc());
                             return;
                         }
@@ -1458,17 +1695,17 @@ SIDE_EFFECT:
                 return;
             }
             if (result->k == EConstant && r->k == EConstant) {
-                if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                    if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                        const auto &a = cast<ConstantInt>(X->getOperand(0))->getValue();
-                        const auto &b = cast<ConstantInt>(X->getOperand(1))->getValue();
-                        const auto &c = cast<ConstantInt>(Y->getOperand(0))->getValue();
-                        const auto &d = cast<ConstantInt>(Y->getOperand(1))->getValue();
+                if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                    if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                        const auto &a = cast<IntConstant>(X->real)->getValue();
+                        const auto &b = cast<IntConstant>(X->imag)->getValue();
+                        const auto &c = cast<IntConstant>(Y->real)->getValue();
+                        const auto &d = cast<IntConstant>(Y->imag)->getValue();
 
                         result =
                             wrap(r->ty,
-                                 llvm::ConstantStruct::get(wrapComplex(r->ty), ConstantInt::get(getLLVMContext(), a - c),
-                                                           ConstantInt::get(getLLVMContext(), b - d)),
+                                 context.createComplexConstant(context.createIntConstant(a - c),
+                                                               context.createIntConstant(b - d)),
                                  result->getBeginLoc(), result->getEndLoc());
                         return;
                     }
@@ -1479,11 +1716,11 @@ SIDE_EFFECT:
         }
         if (result->ty->isFloating()) {
             if (result->k == EConstant && r->k == EConstant) {
-                auto CF1 = cast<ConstantFP>(result->C);
-                auto CF2 = cast<ConstantFP>(r->C);
+                auto CF1 = cast<FloatConstant>(result->C);
+                auto CF2 = cast<FloatConstant>(r->C);
                 APFloat F = CF1->getValue();
                 handleOpStatus(F.subtract(CF2->getValue(), APFloat::rmNearestTiesToEven));
-                result = wrap(r->ty, ConstantFP::get(getLLVMContext(), F), r->getBeginLoc(), r->getEndLoc());
+                result = wrap(r->ty, context.createFloatConstant(F), r->getBeginLoc(), r->getEndLoc());
                 return;
             }
             conv(result, r);
@@ -1491,38 +1728,40 @@ SIDE_EFFECT:
             return;
         }
         if (result->k == EConstant && r->k == EConstant) {
-            if (auto CI = dyn_cast<ConstantInt>(result->C)) {
+            if (auto CI = dyn_cast<IntConstant>(result->C)) {
                 if (CI->isZero())
                     return (void)(result = r);
-                if (auto CI2 = dyn_cast<ConstantInt>(r->C)) {
+                if (auto CI2 = dyn_cast<IntConstant>(r->C)) {
                     if (CI2->isZero())
                         return;
                     bool overflow = false;
                     result = wrap(result->ty,
-                                  ConstantInt::get(getLLVMContext(), result->ty->isSigned()
+                                  context.createIntConstant(result->ty->isSigned()
                                                                   ? CI->getValue().ssub_ov(CI2->getValue(), overflow)
                                                                   : CI->getValue().usub_ov(CI2->getValue(), overflow)),
                                   result->getBeginLoc(), r->getEndLoc());
                     if (overflow)
                         warning(opLoc, "%s subscription overflow, the result is %A",
                                 result->ty->isSigned() ? "signed" : "unsigned",
-                                &cast<ConstantInt>(result->C)->getValue());
+                                &cast<IntConstant>(result->C)->getValue());
                     return;
                 }
             }
-            result = wrap(r->ty, llvm::ConstantExpr::getSub(result->C, r->C, false, r->ty->isSigned()),
+            result = wrap(r->ty, fold_binop(r->ty->isSigned() ? SSub : USub, result->C, r->C),
                           r->getBeginLoc(), r->getEndLoc());
             return;
         }
         result = binop(result, r->ty->isSigned() ? SSub : USub, r, r->ty);
     }
     void make_shl(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, Shl, Shl, static_cast<BinOp>(0), opLoc);
         checkInteger(result, r, opLoc);
         integer_promotions(result);
         integer_promotions(r);
         if (r->k != EConstant)
             goto NOT_CONSTANT;
-        if (const auto CI = dyn_cast<ConstantInt>(r->C)) {
+        if (const auto CI = dyn_cast<IntConstant>(r->C)) {
             auto width = result->ty->getIntegerKind().getBitWidth();
             const APInt &shift = CI->getValue();
             if (r->ty->isSigned() && shift.isNegative()) {
@@ -1537,38 +1776,41 @@ SIDE_EFFECT:
             if (result->k != EConstant)
                 goto NOT_CONSTANT;
             {
-                const APInt &obj = cast<ConstantInt>(result->C)->getValue();
+                const APInt &obj = cast<IntConstant>(result->C)->getValue();
                 bool overflow = false;
                 if (result->ty->isSigned() && obj.isNegative())
                     warning(opLoc, "shifting a negative signed value is undefined");
                 result = wrap(
                     result->ty,
-                    ConstantInt::get(getLLVMContext(), result->ty->isSigned() ? obj.sshl_ov(shift, overflow) : obj << shift),
+                    context.createIntConstant(result->ty->isSigned() ? obj.sshl_ov(shift, overflow) : obj << shift),
                     result->getBeginLoc(), result->getEndLoc());
                 if (overflow)
-                    warning(opLoc, "shift-left overflow, result is %A", &cast<ConstantInt>(result->C)->getValue())
+                    warning(opLoc, "shift-left overflow, result is %A", &cast<IntConstant>(result->C)->getValue())
                         << result->getSourceRange() << r->getSourceRange();
                 return;
             }
 BAD:
-            result = wrap(result->ty, ConstantInt::get(getLLVMContext(), APInt::getZero(width)), result->getBeginLoc(),
+            result = wrap(result->ty, context.createIntConstant(APInt::getZero(width)), result->getBeginLoc(),
                           result->getEndLoc());
             return;
         }
         if (result->k != EConstant)
             goto NOT_CONSTANT;
-        result = wrap(r->ty, llvm::ConstantExpr::getShl(result->C, r->C), r->getBeginLoc(), r->getEndLoc());
+        result = wrap(r->ty, fold_binop(Shl, result->C, r->C), r->getBeginLoc(), r->getEndLoc());
         return;
 NOT_CONSTANT:
-        result = binop(result, Shl, r, result->ty);
+        // LLVM shifts operands of the same type, the result has the type of the promoted left operand
+        result = binop(result, Shl, int_cast(r, result->ty), result->ty);
     }
     void make_shr(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, AShr, Shr, static_cast<BinOp>(0), opLoc);
         checkInteger(result, r, opLoc);
         integer_promotions(result);
         integer_promotions(r);
         if (r->k != EConstant)
             goto NOT_CONSTANT;
-        if (const auto CI = dyn_cast<ConstantInt>(r->C)) {
+        if (const auto CI = dyn_cast<IntConstant>(r->C)) {
             auto width = result->ty->getIntegerKind().getBitWidth();
             const APInt &shift = CI->getValue();
             if (r->ty->isSigned() && shift.isNegative()) {
@@ -1583,42 +1825,45 @@ NOT_CONSTANT:
             if (result->k != EConstant)
                 goto NOT_CONSTANT;
             {
-                APInt obj = cast<ConstantInt>(result->C)->getValue();
+                APInt obj = cast<IntConstant>(result->C)->getValue();
                 if (result->ty->isSigned())
                     obj.ashrInPlace((unsigned)shift.getZExtValue());
                 else
                     obj.lshrInPlace((unsigned)shift.getZExtValue());
-                result = wrap(result->ty, ConstantInt::get(getLLVMContext(), obj), result->getBeginLoc(), result->getEndLoc());
+                result = wrap(result->ty, context.createIntConstant(obj), result->getBeginLoc(), result->getEndLoc());
                 return;
             }
 BAD:
-            result = wrap(result->ty, ConstantInt::get(getLLVMContext(), APInt::getZero(width)), result->getBeginLoc(),
+            result = wrap(result->ty, context.createIntConstant(APInt::getZero(width)), result->getBeginLoc(),
                           result->getEndLoc());
             return;
         }
         if (result->k != EConstant)
             goto NOT_CONSTANT;
-        result = wrap(r->ty, llvm::ConstantExpr::getShl(result->C, r->C), r->getBeginLoc(), r->getEndLoc());
+        result = wrap(r->ty, fold_binop(Shl, result->C, r->C), r->getBeginLoc(), r->getEndLoc());
         return;
 NOT_CONSTANT:
-        result = binop(result, result->ty->isSigned() ? AShr : Shr, r, result->ty);
+        result = binop(result, result->ty->isSigned() ? AShr : Shr, int_cast(r, result->ty), result->ty);
     }
     Expr bit_cast(Expr e, CType to) {
         e = context.clone(e);
         e->ty = to;
+        e->flags = EF_None;
         return e;
     }
     void make_bitop(Expr &result, Expr &r, BinOp op, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, op, op, static_cast<BinOp>(0), opLoc);
         checkInteger(result, r, opLoc);
         conv(result, r);
         if (result->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(result->C)) {
+            if (const auto CI = dyn_cast<IntConstant>(result->C)) {
                 if (CI->isZero())
                     goto ZERO;
                 if (CI->getValue().isAllOnes() && op != Xor)
                     goto ONE;
                 if (r->k == EConstant) {
-                    if (const auto CI2 = dyn_cast<ConstantInt>(r->C)) {
+                    if (const auto CI2 = dyn_cast<IntConstant>(r->C)) {
                         APInt val(CI->getValue());
                         switch (op) {
                         case And: val &= CI2->getValue(); break;
@@ -1626,14 +1871,14 @@ NOT_CONSTANT:
                         case Xor: val ^= CI2->getValue(); break;
                         default: llvm_unreachable("");
                         }
-                        result = wrap(result->ty, ConstantInt::get(getLLVMContext(), val), result->getBeginLoc(),
+                        result = wrap(result->ty, context.createIntConstant(val), result->getBeginLoc(),
                                       result->getEndLoc());
                         return;
                     }
                 }
             }
         } else if (r->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(r->C)) {
+            if (const auto CI = dyn_cast<IntConstant>(r->C)) {
                 if (CI->isZero())
                     goto ZERO;
                 if (CI->getValue().isAllOnes() && op != Xor)
@@ -1651,7 +1896,7 @@ ZERO : {
     else
         msg = "'bitwise xor' to zero is always itself";
     warning(opLoc, msg) << result->getSourceRange() << r->getSourceRange();
-    result = wrap(result->ty, ConstantInt::get(getLLVMContext(), result->ty->getIntegerKind().getZero()),
+    result = wrap(result->ty, context.createIntConstant(result->ty->getIntegerKind().getZero()),
                   result->getBeginLoc(), getEndLoc());
     return;
 }
@@ -1661,7 +1906,7 @@ ONE : {
         warning(opLoc, "'bitsize or' to %r is always all ones", allOnes)
             << result->getSourceRange() << r->getSourceRange();
         result = result =
-            wrap(result->ty, ConstantInt::get(getLLVMContext(), APInt::getAllOnes(result->ty->getIntegerKind().getBitWidth())),
+            wrap(result->ty, context.createIntConstant(APInt::getAllOnes(result->ty->getIntegerKind().getBitWidth())),
                  result->getBeginLoc(), result->getEndLoc());
         return;
     }
@@ -1669,6 +1914,8 @@ ONE : {
 }
     }
     void make_mul(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, SMul, UMul, FMul, opLoc);
         checkArithmetic(result, r);
         if (result->ty->isImaginary() || r->ty->isImaginary()) {
             assert(result->ty->getKind() == TYPRIM);
@@ -1686,7 +1933,7 @@ ONE : {
                     Expr e3 = bit_cast(r, context.getImaginaryElementType(r->ty));
                     make_mul(e2, e3, opLoc);
                     if (e2->k == EConstant)
-                        result = wrap(e2->ty, llvm::ConstantExpr::getNeg(e2->C), e2->getBeginLoc(), e2->getEndLoc());
+                        result = wrap(e2->ty, fold_neg(e2->C), e2->getBeginLoc(), e2->getEndLoc());
                     else
                         result = unary(e2, e2->ty->isFloating() ? FNeg : UNeg, e2->ty);
                     return;
@@ -1714,23 +1961,22 @@ ONE : {
         conv(result, r);
         if (result->ty->isComplex()) {
             if (result->k == EConstant && r->k == EConstant) {
-                if (isa<llvm::ConstantAggregateZero>(result->C))
+                if (result->C->isNullValue())
                     return (void)(result = complex_zero(r->ty, result->getBeginLoc(), r->getEndLoc()));
-                if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (r->C->isNullValue())
                     return (void)(result = complex_zero(r->ty, result->getBeginLoc(), r->getEndLoc()));
             }
             if (result->ty->isFloating()) {
                 if (result->k == EConstant && r->k == EConstant) {
-                    if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                        if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                            const auto &a = cast<ConstantFP>(X->getOperand(0))->getValue();
-                            const auto &b = cast<ConstantFP>(X->getOperand(1))->getValue();
-                            const auto &c = cast<ConstantFP>(Y->getOperand(0))->getValue();
-                            const auto &d = cast<ConstantFP>(Y->getOperand(1))->getValue();
+                    if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                        if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                            const auto &a = cast<FloatConstant>(X->real)->getValue();
+                            const auto &b = cast<FloatConstant>(X->imag)->getValue();
+                            const auto &c = cast<FloatConstant>(Y->real)->getValue();
+                            const auto &d = cast<FloatConstant>(Y->imag)->getValue();
                             result = wrap(r->ty,
-                                          llvm::ConstantStruct::get(wrapComplex(r->ty),
-                                                                    ConstantFP::get(getLLVMContext(), a * c - b * d),
-                                                                    ConstantFP::get(getLLVMContext(), b * c + a * d)),
+                                          context.createComplexConstant(context.createFloatConstant(a * c - b * d),
+                                                                        context.createFloatConstant(b * c + a * d)),
                                           result->getBeginLoc(), result->getEndLoc());
                             return;
                         }
@@ -1740,17 +1986,16 @@ ONE : {
                 return;
             }
             if (result->k == EConstant && r->k == EConstant) {
-                if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                    if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                        const auto &a = cast<ConstantInt>(X->getOperand(0))->getValue();
-                        const auto &b = cast<ConstantInt>(X->getOperand(1))->getValue();
-                        const auto &c = cast<ConstantInt>(Y->getOperand(0))->getValue();
-                        const auto &d = cast<ConstantInt>(Y->getOperand(1))->getValue();
+                if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                    if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                        const auto &a = cast<IntConstant>(X->real)->getValue();
+                        const auto &b = cast<IntConstant>(X->imag)->getValue();
+                        const auto &c = cast<IntConstant>(Y->real)->getValue();
+                        const auto &d = cast<IntConstant>(Y->imag)->getValue();
 
                         result = wrap(r->ty,
-                                      llvm::ConstantStruct::get(wrapComplex(r->ty),
-                                                                ConstantInt::get(getLLVMContext(), a * c - b * d),
-                                                                ConstantInt::get(getLLVMContext(), b * c + a * d)),
+                                      context.createComplexConstant(context.createIntConstant(a * c - b * d),
+                                                                    context.createIntConstant(b * c + a * d)),
                                       result->getBeginLoc(), result->getEndLoc());
                         return;
                     }
@@ -1761,17 +2006,17 @@ ONE : {
         }
         if (result->k != EConstant)
             goto NOT_CONSTANT;
-        if (const auto lhs = dyn_cast<ConstantInt>(result->C)) {
+        if (const auto lhs = dyn_cast<IntConstant>(result->C)) {
             if (lhs->isZero())
                 goto ZERO;
             if (r->k != EConstant)
                 goto NOT_CONSTANT;
-            if (const auto rhs = dyn_cast<ConstantInt>(r->C)) {
+            if (const auto rhs = dyn_cast<IntConstant>(r->C)) {
                 bool overflow = false;
                 if (rhs->isZero())
                     goto ZERO;
                 result = wrap(r->ty,
-                              ConstantInt::get(getLLVMContext(), r->ty->isSigned()
+                              context.createIntConstant(r->ty->isSigned()
                                                               ? lhs->getValue().smul_ov(rhs->getValue(), overflow)
                                                               : lhs->getValue().umul_ov(rhs->getValue(), overflow)),
                               result->getBeginLoc(), result->getEndLoc());
@@ -1779,17 +2024,17 @@ ONE : {
                     warning(opLoc, "multiplication overflow") << result->getSourceRange() << r->getSourceRange();
                 return;
             }
-        } else if (const auto lhs = dyn_cast<ConstantFP>(result->C)) {
+        } else if (const auto lhs = dyn_cast<FloatConstant>(result->C)) {
             if (r->k != EConstant)
                 goto NOT_CONSTANT;
-            if (const auto rhs = dyn_cast<ConstantFP>(result->C)) {
+            if (const auto rhs = dyn_cast<FloatConstant>(result->C)) {
                 APFloat F = lhs->getValue();
                 handleOpStatus(F.multiply(rhs->getValue(), APFloat::rmNearestTiesToEven));
-                result = wrap(r->ty, ConstantFP::get(getLLVMContext(), F), result->getBeginLoc(), result->getEndLoc());
+                result = wrap(r->ty, context.createFloatConstant(F), result->getBeginLoc(), result->getEndLoc());
                 return;
             }
             result =
-                wrap(r->ty, llvm::ConstantExpr::getMul(result->C, r->C), result->getBeginLoc(), result->getEndLoc());
+                wrap(r->ty, fold_binop(FMul, result->C, r->C), result->getBeginLoc(), result->getEndLoc());
             return;
         }
 NOT_CONSTANT:
@@ -1800,6 +2045,8 @@ ZERO:
             << result->getSourceRange() << r->getSourceRange();
     }
     void make_div(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, SDiv, UDiv, FDiv, opLoc);
         checkArithmetic(result, r);
         if (result->ty->isImaginary() || r->ty->isImaginary()) {
             assert(result->ty->getKind() == TYPRIM);
@@ -1844,8 +2091,8 @@ ZERO:
             // if the first operand is a nonzero finite number or an infinity and the second operand is a zero then the
             // result of the / operator is an infinity.
             if (result->k == EConstant && r->k == EConstant) {
-                if (isa<llvm::ConstantAggregateZero>(result->C)) {
-                    if (isa<llvm::ConstantAggregateZero>(r->C)) {
+                if (result->C->isNullValue()) {
+                    if (r->C->isNullValue()) {
                         if (r->ty->isFloating())
                             return (void)(result =
                                               complex_neg_nan_pair(result->ty, result->getBeginLoc(), r->getEndLoc()));
@@ -1853,7 +2100,7 @@ ZERO:
                     }
                     goto NEXT_NEXT;
                 }
-                if (isa<llvm::ConstantAggregateZero>(r->C)) {
+                if (r->C->isNullValue()) {
                     if (r->ty->isFloating())
                         return (void)(result = complex_inf_pair(r->ty, result->getBeginLoc(), r->getEndLoc()));
                     goto CINT_ZERO;
@@ -1868,17 +2115,16 @@ CINT_ZERO:
 NEXT_NEXT:
             if (result->ty->isFloating()) {
                 if (result->k == EConstant && r->k == EConstant) {
-                    if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                        if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                            const auto &a = cast<ConstantFP>(X->getOperand(0))->getValue();
-                            const auto &b = cast<ConstantFP>(X->getOperand(1))->getValue();
-                            const auto &c = cast<ConstantFP>(Y->getOperand(0))->getValue();
-                            const auto &d = cast<ConstantFP>(Y->getOperand(1))->getValue();
+                    if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                        if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                            const auto &a = cast<FloatConstant>(X->real)->getValue();
+                            const auto &b = cast<FloatConstant>(X->imag)->getValue();
+                            const auto &c = cast<FloatConstant>(Y->real)->getValue();
+                            const auto &d = cast<FloatConstant>(Y->imag)->getValue();
                             APFloat tmp = c * c + d * d;
                             result = wrap(r->ty,
-                                          llvm::ConstantStruct::get(wrapComplex(r->ty),
-                                                                    ConstantFP::get(getLLVMContext(), (a * c + b * d) / tmp),
-                                                                    ConstantFP::get(getLLVMContext(), (b * c - a * d) / tmp)),
+                                          context.createComplexConstant(context.createFloatConstant((a * c + b * d) / tmp),
+                                                                        context.createFloatConstant((b * c - a * d) / tmp)),
                                           result->getBeginLoc(), result->getEndLoc());
                             return;
                         }
@@ -1889,20 +2135,18 @@ NEXT_NEXT:
             }
             const bool isSigned = r->ty->isSigned();
             if (result->k == EConstant && r->k == EConstant) {
-                if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                    if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                        const auto &a = cast<ConstantInt>(X->getOperand(0))->getValue();
-                        const auto &b = cast<ConstantInt>(X->getOperand(1))->getValue();
-                        const auto &c = cast<ConstantInt>(Y->getOperand(0))->getValue();
-                        const auto &d = cast<ConstantInt>(Y->getOperand(1))->getValue();
+                if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                    if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                        const auto &a = cast<IntConstant>(X->real)->getValue();
+                        const auto &b = cast<IntConstant>(X->imag)->getValue();
+                        const auto &c = cast<IntConstant>(Y->real)->getValue();
+                        const auto &d = cast<IntConstant>(Y->imag)->getValue();
                         APInt tmp0 = c * c + d * d;
                         APInt tmp1 = a * c + b * d;
                         APInt tmp2 = b * c - a * d;
                         result = wrap(r->ty,
-                                      llvm::ConstantStruct::get(
-                                          wrapComplex(r->ty),
-                                          ConstantInt::get(getLLVMContext(), isSigned ? tmp1.sdiv(tmp0) : tmp1.udiv(tmp0)),
-                                          ConstantInt::get(getLLVMContext(), isSigned ? tmp2.sdiv(tmp0) : tmp2.udiv(tmp0))),
+                                      context.createComplexConstant(context.createIntConstant(isSigned ? tmp1.sdiv(tmp0) : tmp1.udiv(tmp0)),
+                                                                    context.createIntConstant(isSigned ? tmp2.sdiv(tmp0) : tmp2.udiv(tmp0))),
                                       result->getBeginLoc(), result->getEndLoc());
                         return;
                     }
@@ -1913,30 +2157,29 @@ NEXT_NEXT:
         }
         if (r->k != EConstant)
             goto NOT_CONSTANT;
-        if (const auto CI = dyn_cast<ConstantInt>(r->C)) {
+        if (const auto CI = dyn_cast<IntConstant>(r->C)) {
             if (CI->getValue().isZero()) {
                 warning(opLoc, "integer division by zero is undefined")
                     << result->getSourceRange() << r->getSourceRange();
-                result = wrap(r->ty, llvm::UndefValue::get(CI->getType()), result->getBeginLoc(), result->getEndLoc());
+                result = wrap(r->ty, context.getUndefConstant(), result->getBeginLoc(), result->getEndLoc());
                 return;
             }
             if (result->k != EConstant)
                 goto NOT_CONSTANT;
             result = wrap(r->ty,
-                          llvm::ConstantExpr::get(r->ty->isSigned() ? llvm::Instruction::SDiv : llvm::Instruction::UDiv,
-                                                  result->C, r->C),
+                          fold_binop(r->ty->isSigned() ? SDiv : UDiv, result->C, r->C),
                           result->getBeginLoc(), result->getEndLoc());
             return;
-        } else if (const auto CFP = dyn_cast<ConstantFP>(r->C)) {
+        } else if (const auto CFP = dyn_cast<FloatConstant>(r->C)) {
             if (CFP->isZero()) {
                 warning(opLoc, "floating division by zero is undefined")
                     << result->getSourceRange() << r->getSourceRange();
-                result = wrap(r->ty, llvm::UndefValue::get(CFP->getType()), result->getBeginLoc(), result->getEndLoc());
+                result = wrap(r->ty, context.getUndefConstant(), result->getBeginLoc(), result->getEndLoc());
                 return;
             }
             if (result->k != EConstant)
                 goto NOT_CONSTANT;
-            result = wrap(r->ty, llvm::ConstantExpr::get(llvm::Instruction::FDiv, result->C, r->C),
+            result = wrap(r->ty, fold_binop(FDiv, result->C, r->C),
                           result->getBeginLoc(), result->getEndLoc());
             return;
         }
@@ -1945,32 +2188,33 @@ NOT_CONSTANT:
     }
     void handleOpStatus(APFloat::opStatus status) { }
     void make_rem(Expr &result, Expr &r, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_binop(result, r, SRem, URem, static_cast<BinOp>(0), opLoc);
         checkInteger(result, r, opLoc);
         conv(result, r);
         if (result->k == EConstant && r->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(r->C)) {
+            if (const auto CI = dyn_cast<IntConstant>(r->C)) {
                 if (CI->getValue().isZero()) {
                     warning(opLoc, "integer remainder by zero is undefined")
                         << result->getSourceRange() << r->getSourceRange();
                     result =
-                        wrap(r->ty, llvm::UndefValue::get(CI->getType()), result->getBeginLoc(), result->getEndLoc());
+                        wrap(r->ty, context.getUndefConstant(), result->getBeginLoc(), result->getEndLoc());
                     return;
                 }
                 result =
                     wrap(r->ty,
-                         llvm::ConstantExpr::get(r->ty->isSigned() ? llvm::Instruction::SRem : llvm::Instruction::URem,
-                                                 result->C, r->C),
+                         fold_binop(r->ty->isSigned() ? SRem : URem, result->C, r->C),
                          result->getBeginLoc(), result->getEndLoc());
                 return;
-            } else if (const auto CFP = dyn_cast<ConstantFP>(r->C)) {
+            } else if (const auto CFP = dyn_cast<FloatConstant>(r->C)) {
                 if (CFP->isZero()) {
                     warning(opLoc, "integer remainder by zero is undefined")
                         << result->getSourceRange() << r->getSourceRange();
                     result =
-                        wrap(r->ty, llvm::UndefValue::get(CFP->getType()), result->getBeginLoc(), result->getEndLoc());
+                        wrap(r->ty, context.getUndefConstant(), result->getBeginLoc(), result->getEndLoc());
                     return;
                 }
-                result = wrap(r->ty, llvm::ConstantExpr::get(llvm::Instruction::FRem, result->C, r->C),
+                result = wrap(r->ty, fold_binop(FRem, result->C, r->C),
                               result->getBeginLoc(), result->getEndLoc());
                 return;
             }
@@ -1988,18 +2232,27 @@ NOT_CONSTANT:
         default: llvm_unreachable("");
         }
     }
-    void make_cmp(Expr &result, Token tok, bool isEq, location_t opLoc) {
-        Expr r;
-        consume();
-        if (!(r = isEq ? relational_expression() : shift_expression()))
-            return;
+    static bool isNullPointerConstant(Expr e) {
+        if (e->k != EConstant || !e->ty->isInteger())
+            return false;
+        const auto CI = dyn_cast<IntConstant>(e->C);
+        return CI && CI->isZero();
+    }
+    void make_cmp(Expr &result, Expr &r, Token tok, bool isEq, location_t opLoc) {
+        if (hasVectorOperand(result, r))
+            return make_vector_cmp(result, r, tok, opLoc);
+        // `p == 0`: the null pointer constant is converted to a pointer
+        if (result->ty->getKind() == TYPOINTER && isNullPointerConstant(r))
+            r = null_ptr_expr;
+        else if (r->ty->getKind() == TYPOINTER && isNullPointerConstant(result))
+            result = null_ptr_expr;
         checkSpec(result, r);
         if ((result->ty->isComplex()) && !isEq)
             return (void)(type_error(opLoc, "complex numbers unsupported in relational-expression")
                           << result->getSourceRange() << r->getSourceRange());
         if (result->k == EConstant && r->k == EConstant) {
-            if (const auto CI = dyn_cast<ConstantInt>(result->C)) {
-                auto CI2 = dyn_cast<ConstantInt>(r->C);
+            if (const auto CI = dyn_cast<IntConstant>(result->C)) {
+                auto CI2 = dyn_cast<IntConstant>(r->C);
                 const APInt &A1 = CI->getValue();
                 const APInt &A2 = CI2->getValue();
                 int status;
@@ -2037,8 +2290,8 @@ NOT_CONSTANT:
                 result = getBool(B);
                 return;
             }
-            if (const auto CFP = dyn_cast<ConstantFP>(result->C)) {
-                const auto CFP2 = dyn_cast<ConstantFP>(r->C);
+            if (const auto CFP = dyn_cast<FloatConstant>(result->C)) {
+                const auto CFP2 = dyn_cast<FloatConstant>(r->C);
                 bool B;
                 APFloat::cmpResult status = CFP->getValue().compare(CFP2->getValue());
                 switch (tok) {
@@ -2054,27 +2307,27 @@ NOT_CONSTANT:
                 return;
             }
             if (result->ty->isComplex()) {
-                if (isa<llvm::ConstantAggregateZero>(result->C)) {
-                    if (isa<llvm::ConstantAggregateZero>(r->C))
+                if (result->C->isNullValue()) {
+                    if (r->C->isNullValue())
                         return (void)(result = getBool(tok == TEq)); // equal!
                     return (void)(result = getBool(tok != TEq));     // not equal!
                 }
-                if (isa<llvm::ConstantAggregateZero>(r->C)) // not equal!
+                if (r->C->isNullValue()) // not equal!
                     return (void)(result = getBool(tok != TEq));
-                if (auto X = dyn_cast<llvm::ConstantStruct>(result->C)) {
-                    if (auto Y = dyn_cast<llvm::ConstantStruct>(r->C)) {
-                        if (const auto &C1 = dyn_cast<ConstantInt>(X->getOperand(0))) {
-                            const auto &a = C1->getValue(), &b = cast<ConstantInt>(X->getOperand(1))->getValue(),
-                                       &c = cast<ConstantInt>(Y->getOperand(0))->getValue(),
-                                       &d = cast<ConstantInt>(Y->getOperand(1))->getValue();
+                if (auto X = dyn_cast<ComplexConstant>(result->C)) {
+                    if (auto Y = dyn_cast<ComplexConstant>(r->C)) {
+                        if (const auto &C1 = dyn_cast<IntConstant>(X->real)) {
+                            const auto &a = C1->getValue(), &b = cast<IntConstant>(X->imag)->getValue(),
+                                       &c = cast<IntConstant>(Y->real)->getValue(),
+                                       &d = cast<IntConstant>(Y->imag)->getValue();
                             const bool l = (tok == TEq) ? a == c : a != c, r = (tok == TEq) ? b == d : b != d;
                             result = getBool(tok == TEq ? (l & r) : (l | r));
                             return;
                         }
-                        const auto &a = cast<ConstantFP>(X->getOperand(0))->getValue(),
-                                   &b = cast<ConstantFP>(X->getOperand(1))->getValue(),
-                                   &c = cast<ConstantFP>(Y->getOperand(0))->getValue(),
-                                   &d = cast<ConstantFP>(Y->getOperand(1))->getValue();
+                        const auto &a = cast<FloatConstant>(X->real)->getValue(),
+                                   &b = cast<FloatConstant>(X->imag)->getValue(),
+                                   &c = cast<FloatConstant>(Y->real)->getValue(),
+                                   &d = cast<FloatConstant>(Y->imag)->getValue();
                         const bool l = (tok == TEq) ? a.compare(c) == cmpEqual : a.compare(c) != cmpEqual,
                                    r = (tok == TEq) ? b.compare(d) == cmpEqual : b.compare(d) != cmpEqual;
                         result = getBool(tok == TEq ? (l & r) : (l | r));
@@ -2115,6 +2368,7 @@ NOT_CONSTANT:
             case Krestrict: ty->addTag(TYRESTRICT), consume(); continue;
             case Kvolatile: ty->addTag(TYVOLATILE), consume(); continue;
             case K_Atomic: ty->addTag(TYATOMIC), consume(); continue;
+            case K__attribute: ignored_attributes(); continue;
             default: return;
             }
     }
@@ -2140,6 +2394,9 @@ NOT_CONSTANT:
     }
     CType specifier_qualifier_list() {
         location_t loc = getLoc();
+        // only the outermost declaration-specifiers of a declaration take attributes, not the nested ones(e.g. struct members)
+        DeclAttributes *attrs = sema.declAttrs;
+        sema.declAttrs = nullptr;
         CType eat_typedef = nullptr;
         bool no_typedef = false;
         type_tag_t tags = 0;
@@ -2147,12 +2404,22 @@ NOT_CONSTANT:
                  numimaginary = 0, numint128 = 0, numfloat128 = 0, numfloat80 = 0, numimb128 = 0, numdecimal32 = 0,
                  numdecimal64 = 0, numdecimal128 = 0, num__fp16 = 0;
         type_tag_t old_tag;
-        const Token firstTok = l.tok.tok;
+        Token firstTok = l.tok.tok;
         unsigned count = 0;
         for (;; ++count) {
             const Token theTok = l.tok.tok;
             old_tag = tags;
             switch (theTok) {
+            case K__attribute:
+                if (attrs) {
+                    if (!gnu_attributes(*attrs))
+                        return nullptr;
+                } else {
+                    ignored_attributes();
+                }
+                if (count-- == 0)
+                    firstTok = l.tok.tok;
+                continue;
             case Kinline: tags |= TYINLINE; goto NO_REPEAT;
             case K_Noreturn: tags |= TYNORETURN; goto NO_REPEAT;
             case Kextern: tags |= TYEXTERN; goto NO_REPEAT;
@@ -2458,30 +2725,34 @@ BREAK:
         }
         return direct_declarator(ty, flags);
     }
-    llvm::Constant *parse_string_literal(size_t &strLength, location_t &endLoc, enum StringPrefix &prefix) {
+    const StringLiteralData *parse_string_literal(location_t &endLoc, enum StringPrefix &prefix) {
         assert(l.tok.tok == TStringLit);
         prefix = l.tok.getStringPrefix();
         unsigned Size = context.getStringCharSizeInBits(prefix);
         parse_string_literal_data(endLoc, prefix);
-        llvm::Constant *C;
+        const StringLiteralData *S;
         switch (Size) {
         case 8:
             parseLiteralCache.push_back('\0');
-            C = enc::getUTF8(parseLiteralCache.str(), getLLVMContext());
-            strLength = parseLiteralCache.size();
-            break;
-        case 16:
-            C = enc::getUTF16As16Bit(parseLiteralCache.str(), getLLVMContext(), strLength);
-            break;
-        case 32:
-            C = prefix == Prefix_L ? 
-                enc::getUTF16As32Bit(parseLiteralCache.str(), getLLVMContext(), strLength) : 
-                enc::getUTF32(parseLiteralCache.str(), getLLVMContext(), strLength);
+            S = context.createStringLiteral(parseLiteralCache.str());
             break;
+        case 16: {
+            SmallVector<uint16_t, 32> data;
+            enc::getUTF16As16Bit(parseLiteralCache.str(), data);
+            S = context.createStringLiteral(ArrayRef<uint16_t>(data));
+        } break;
+        case 32: {
+            SmallVector<uint32_t, 32> data;
+            if (prefix == Prefix_L)
+                enc::getUTF16As32Bit(parseLiteralCache.str(), data);
+            else
+                enc::getUTF32(parseLiteralCache.str(), data);
+            S = context.createStringLiteral(ArrayRef<uint32_t>(data));
+        } break;
         default: llvm_unreachable("unhandled size");
         }
         parseLiteralCache.clear();
-        return C;
+        return S;
     }
     Expr scalar_init_list() {
         CType ty = sema.currentInitTy;
@@ -2492,42 +2763,42 @@ BREAK:
             location_t loc1 = getLoc();
             location_t endLoc;
             enum StringPrefix enc;
-            size_t strLength;
-            llvm::Constant *C = parse_string_literal(strLength, endLoc, enc);
+            const StringLiteralData *S = parse_string_literal(endLoc, enc);
+            const size_t strLength = S->numElements;
             Expr result;
             switch (enc) {
             case Prefix_none:
             case Prefix_u8:
                 if (!(ty->arrtype->isInteger() && ty->arrtype->getIntegerKind().asLog2() == 3))
                     type_error(loc1, "initializing %T array with string literal", ty->arrtype);
-                result = wrap(context.getFixArrayType(enc == Prefix_none ? context.getChar() : context.getChar8_t(),
+                result = createString(context.getFixArrayType(enc == Prefix_none ? context.getChar() : context.getChar8_t(),
                                                     strLength),
-                            C, loc1, endLoc);
+                            S, loc1, endLoc);
                 break;
             case Prefix_L:
                 if (!(ty->arrtype->isInteger() && ty->arrtype->getIntegerKind().asLog2() == 5))
                     type_error(loc1, "initializing %T array with wide string literal", ty->arrtype);
-                result = wrap(context.getFixArrayType(context.getWChar(), strLength),
-                            C,
+                result = createString(context.getFixArrayType(context.getWChar(), strLength),
+                            S,
                             loc1, endLoc);
                 break;
             case Prefix_u:
                 if (!(ty->arrtype->isInteger() && ty->arrtype->getIntegerKind().asLog2() == 5))
                     type_error(loc1, "initializing %T array with UTF-16 string literal", ty->arrtype);
-                result = wrap(context.getFixArrayType(context.getChar16_t(), strLength),
-                            C, loc1, endLoc);
+                result = createString(context.getFixArrayType(context.getChar16_t(), strLength),
+                            S, loc1, endLoc);
                 break;
             case Prefix_U:
                 if (!(ty->arrtype->isInteger() && ty->arrtype->getIntegerKind().asLog2() == 5))
                     type_error(loc1, "initializing %T array with UTF-32 string literal", ty->arrtype);
-                result = wrap(context.getFixArrayType(context.getUChar(), strLength), C,
+                result = createString(context.getFixArrayType(context.getUChar(), strLength), S,
                             loc1, endLoc);
                 break;
             default: llvm_unreachable("bad string encoding");
             }
             return result;
         }
-        if (!ty->isScalar())
+        if (!ty->isScalar() && ty->getKind() != TYVECTOR)
             return type_error(getLoc(), "expect bracket initializer for aggregate types"), nullptr;
         Expr e;
         if (!(e = assignment_expression()))
@@ -2570,17 +2841,23 @@ BREAK:
             }
         }
         if (!init)
-            init = wrap(ty, llvm::Constant::getNullValue(llvmTypeCache.wrap(ty)), loc, getLoc());
+            init = wrap(ty, getNullConstant(llvmTypeCache.wrap(ty)), loc, getLoc());
         return castto(init, ty, Implict_Init);
     }
     Expr initializer_list() {
         if (l.tok.tok != TLcurlyBracket)
             return scalar_init_list();
+        location_t loc = getLoc();
         consume(); // eat '{'
         CType ty = sema.currentInitTy;
         if (ty->getKind() == TYPRIM) 
             return simple_initializer_list();
-        return agg_init_list();
+        if (ty->getKind() == TYVECTOR)
+            return vector_init_list(loc);
+        if (ty->getKind() == TYARRAY)
+            if (unsigned elementSize = getPackedElementSize(ty->arrtype))
+                return packed_array_init_list(ty, elementSize, loc);
+        return agg_init_list(loc);
     }
 /*
 braced-initializer:
@@ -2633,7 +2910,7 @@ designator:
                         consume();
                         Expr indexExpr2 = constant_expression();
                         if (!indexExpr2) return nullptr;
-                        uint64_t index2 = force_eval(indexExpr);
+                        uint64_t index2 = force_eval(indexExpr2);
                         designators.push_back(Designator(index, index2));
                     } else {
                         designators.push_back(Designator(index));
@@ -2666,10 +2943,193 @@ designator:
             }
         }
     }
-    Expr agg_init_list() {
+    // the size in bytes of the elements of an array that PackedArrayBuilder can pack, or 0
+    static unsigned getPackedElementSize(CType ty) {
+        if (ty->getKind() != TYPRIM || ty->hasTag(TYVOID) || ty->isComplex() || ty->isImaginary())
+            return 0;
+        if (ty->isInteger()) {
+            const uint8_t shift = ty->getIntegerKind().asLog2();
+            return (shift >= 3 && shift <= 6) ? 1U << (shift - 3) : 0;
+        }
+        switch (ty->getFloatKind().asEnum()) {
+        case F_Half:
+        case F_BFloat: return 2;
+        case F_Float: return 4;
+        case F_Double: return 8;
+        default: return 0;
+        }
+    }
+    // collects the constant elements of an array initializer, see PackedArrayData
+    struct PackedArrayBuilder {
+        SmallVector<char, 0> bytes; // the elements in the order they are written
+        SmallVector<uint32_t, 0> indexes; // the index of each element, filled after the first out-of-order element
+        unsigned elementSize;
+        bool inOrder = true;
+        PackedArrayBuilder(unsigned elementSize): elementSize{elementSize} {}
+        size_t size() const { return bytes.size() / elementSize; }
+        // returns false if `C` is not an integer or floating constant
+        bool add(uint32_t index, const ConstantValue *C) {
+            uint64_t bits;
+            if (const IntConstant *CI = dyn_cast<IntConstant>(C))
+                bits = CI->getValue().getZExtValue();
+            else if (const FloatConstant *CF = dyn_cast<FloatConstant>(C))
+                bits = CF->getValue().bitcastToAPInt().getZExtValue();
+            else
+                return false;
+            if (inOrder && index != size()) {
+                inOrder = false;
+                indexes.resize_for_overwrite(size());
+                std::iota(indexes.begin(), indexes.end(), 0);
+            }
+            if (!inOrder)
+                indexes.push_back(index);
+            const size_t oldSize = bytes.size();
+            bytes.resize_for_overwrite(oldSize + elementSize);
+            char *p = bytes.data() + oldSize;
+            switch (elementSize) {
+            case 1: *p = static_cast<char>(bits); break;
+            case 2: { const uint16_t v = bits; memcpy(p, &v, sizeof(v)); } break;
+            case 4: { const uint32_t v = bits; memcpy(p, &v, sizeof(v)); } break;
+            case 8: memcpy(p, &bits, sizeof(bits)); break;
+            default: llvm_unreachable("bad element size");
+            }
+            return true;
+        }
+        // sort the elements by index(a later initializer overrides an earlier one) and group them into runs
+        const PackedArrayData *finish(xcc_context &context) const {
+            const size_t N = size();
+            if (inOrder) {
+                const PackedArrayData::Run R{.start = 0, .length = static_cast<uint32_t>(N), .offset = 0};
+                return context.createPackedArray(elementSize, N ? ArrayRef<PackedArrayData::Run>(R) : ArrayRef<PackedArrayData::Run>(),
+                                                 StringRef(bytes.data(), bytes.size()));
+            }
+            SmallVector<uint32_t, 0> order;
+            order.resize_for_overwrite(N);
+            std::iota(order.begin(), order.end(), 0);
+            llvm::stable_sort(order, [&](uint32_t a, uint32_t b) { return indexes[a] < indexes[b]; });
+            SmallVector<PackedArrayData::Run, 4> runs;
+            SmallVector<char, 0> out;
+            uint32_t count = 0;
+            for (size_t i = 0; i < N; ++i) {
+                const uint32_t pos = order[i], index = indexes[pos];
+                if (i + 1 < N && indexes[order[i + 1]] == index)
+                    continue; // overridden by a later initializer
+                if (runs.empty() || runs.back().start + runs.back().length != index)
+                    runs.push_back(PackedArrayData::Run{.start = index, .length = 0, .offset = count});
+                ++runs.back().length, ++count;
+                const char *p = bytes.data() + size_t(pos) * elementSize;
+                out.append(p, p + elementSize);
+            }
+            return context.createPackedArray(elementSize, runs, StringRef(out.data(), out.size()));
+        }
+    };
+    // agg_init_list() for arrays of integer or floating types(lookup tables, sparse designated initializers):
+    // constant elements are packed into bytes instead of one Initializer per element, other elements are kept as
+    // Initializers, and IRGen applies them after the packed elements.
+    Expr packed_array_init_list(CType ty, unsigned elementSize, location_t startLoc) {
+        CType elemTy = ty->arrtype;
+        const unsigned numElements = ty->getNumElements();
+        PackedArrayBuilder builder(elementSize);
+        SmallVector<Initializer, 0> inits;
+        llvm::DenseSet<uint32_t> initIndexes; // indexes initialized by `inits`
+        uint32_t length = 0; // the highest index + 1
+        for (uint32_t index = 0;;++index) {
+            uint32_t start = index;
+            Expr e;
+            switch (l.tok.tok) {
+                case TRcurlyBracket:
+                {
+                    location_t endLoc = getLoc();
+                    consume();
+                    if (!ty->hassize)
+                        ty = context.getFixArrayType(elemTy, length);
+                    return ENEW(InitListExpr) {.ty = ty, .initStartLoc = startLoc, .initEndLoc = endLoc,
+                        .inits = xvector<Initializer>::get_frozen(inits, getAllocator()), .packed = builder.finish(context)};
+                }
+                case TDot:
+                case TLSquareBrackets:
+                {
+                    SmallVector<Designator, 2> designators;
+                    if (!(e = parse_designator_initializer(ty, designators)))
+                        return nullptr;
+                    // the elements are scalars, so there is only one designator
+                    const Designator D = designators.front();
+                    start = D.getStart();
+                    index = D.isSingle() ? start : D.getEnd();
+                    if (index < start) {
+                        type_error(e->getBeginLoc(), "array designator range [%u, %u] is empty", start, index);
+                        index = start;
+                        goto NEXT;
+                    }
+                    break;
+                }
+                default:
+                {
+                    llvm::SaveAndRestore<CType> tmp(sema.currentInitTy, elemTy);
+                    if (!(e = initializer_list()))
+                        return nullptr;
+                    break;
+                }
+            }
+            if (index >= numElements) {
+                type_error(e->getBeginLoc(), "excess elements in array initializer");
+                goto NEXT;
+            }
+            for (uint32_t i = start;; ++i) {
+                if (!(e->k == EConstant && !initIndexes.contains(i) && builder.add(i, e->C)))
+                    inits.push_back(Initializer(e, Designator(i))), initIndexes.insert(i);
+                if (i == index)
+                    break;
+            }
+            length = std::max(length, index + 1);
+            NEXT:
+            if (l.tok.tok == TComma)
+                consume();
+        }
+    }
+    // `{a, b, ...}` for a vector: the elements are converted to the element type, the missing ones are zero.
+    // all-constant initializers are folded to a vector constant, other ones are built with insertelement by IRGen
+    Expr vector_init_list(location_t startLoc) {
+        CType ty = sema.currentInitTy;
+        const unsigned numElements = ty->vec_num_elems;
+        SmallVector<Initializer, 8> inits;
+        bool allConstant = true;
+        for (unsigned index = 0; l.tok.tok != TRcurlyBracket; ++index) {
+            Expr e;
+            {
+                llvm::SaveAndRestore<CType> tmp(sema.currentInitTy, ty->vec_ty);
+                if (!(e = initializer_list()))
+                    return nullptr;
+            }
+            if (index >= numElements) {
+                if (index == numElements)
+                    type_error(e->getBeginLoc(), "excess elements in vector initializer") << e->getSourceRange();
+            } else {
+                inits.push_back(Initializer(e, Designator(index)));
+                allConstant &= e->k == EConstant;
+            }
+            if (l.tok.tok != TComma)
+                break;
+            consume();
+        }
+        location_t endLoc = getLoc();
+        if (l.tok.tok != TRcurlyBracket)
+            return expect(endLoc, "'}'"), nullptr;
+        consume();
+        if (allConstant) {
+            SmallVector<const ConstantValue *, 16> elems(numElements, getNullConstant(wrapNoComplexScalar(ty->vec_ty)));
+            for (const Initializer &it : inits)
+                elems[it.getDesignator().getStart()] = it.value->C;
+            return wrap(ty, context.createVectorConstant(elems), startLoc, endLoc);
+        }
+        return ENEW(InitListExpr){.ty = ty, .initStartLoc = startLoc, .initEndLoc = endLoc,
+                                  .inits = xvector<Initializer>::get_frozen(inits, getAllocator())};
+    }
+    Expr agg_init_list(location_t startLoc) {
         CType ty = sema.currentInitTy;
         xvector<Initializer> inits = xvector<Initializer>::get();
         unsigned numElements = ty->getNumElements();
+        unsigned length = 0; // for incomplete arrays: the highest index + 1
         for (unsigned FieldIndex = 0;;++FieldIndex) {
             if (FieldIndex > numElements) {
                 StringRef N;
@@ -2684,15 +3144,20 @@ designator:
             }
             switch (l.tok.tok) {
                 case TRcurlyBracket:
+                {
+                    location_t endLoc = getLoc();
                     consume();
-                    return ENEW(InitListExpr) {.ty = ty, .inits = inits};
+                    if (ty->getKind() == TYARRAY && !ty->hassize)
+                        ty = context.getFixArrayType(ty->arrtype, length);
+                    return ENEW(InitListExpr) {.ty = ty, .initStartLoc = startLoc, .initEndLoc = endLoc, .inits = inits};
+                }
                 case TDot:
                 case TLSquareBrackets:
                 {
                     SmallVector<Designator, 2> designators;
                     Expr e = parse_designator_initializer(ty, designators);
                     if (!e) return nullptr;
-                    if (designators.size() > 2)
+                    if (designators.size() > 1)
                         inits.push_back(Initializer(e, designators));
                     else
                         inits.push_back(Initializer(e, designators.front()));
@@ -2708,6 +3173,7 @@ designator:
                     break;
                 }
             }
+            length = std::max(length, FieldIndex + 1);
             if (l.tok.tok == TComma) {
                 consume();
             }
@@ -2851,6 +3317,56 @@ designator:
         }
         return d;
     }
+    // records with more members than this get a name => access path index(RecordDecl::members)
+    enum { MemberIndexThreshold = 16 };
+    // call fn(Name, path) for the member `F`, or for every member of `F` if it is an anonymous struct/union
+    template <typename Fn> static void forEachMember(const FieldDecl &F, SmallVectorImpl<unsigned> &path, Fn &&fn) {
+        if (F.name)
+            return fn(F.name, ArrayRef<unsigned>(path));
+        if (!F.ty->isAgg() || F.ty->isEnum() || !F.ty->getRecord())
+            return;
+        const auto &fields = F.ty->getRecord()->fields;
+        for (unsigned i = 0; i < fields.size(); ++i) {
+            path.push_back(i);
+            forEachMember(fields[i], path, fn);
+            path.pop_back();
+        }
+    }
+    void indexMember(RecordDecl *RD, unsigned idx) {
+        SmallVector<unsigned, 4> path{idx};
+        forEachMember(RD->fields[idx], path, [&](IdentRef Name, ArrayRef<unsigned> path) {
+            unsigned *buf = getAllocator().Allocate<unsigned>(path.size());
+            std::copy(path.begin(), path.end(), buf);
+            RD->members->insert(std::make_pair(Name, ArrayRef<unsigned>(buf, path.size())));
+        });
+    }
+    // append a field to the record being defined, reporting members that are already declared(including members of
+    // anonymous structs/unions)
+    void addMember(CType record, const FieldDecl &F) {
+        RecordDecl *RD = record->getRecord();
+        SmallVector<unsigned, 4> path{unsigned(RD->fields.size())};
+        unsigned count = 0;
+        forEachMember(F, path, [&](IdentRef Name, ArrayRef<unsigned>) {
+            ++count;
+            bool found;
+            if (RD->members) {
+                found = RD->members->count(Name);
+            } else {
+                SmallVector<Designator, 4> idxs;
+                found = record->getFieldIndex(Name, idxs) != nullptr;
+            }
+            if (found)
+                type_error(current_declator_loc, "duplicate member %I", Name);
+        });
+        RD->fields.push_back(F);
+        if (RD->members) {
+            indexMember(RD, RD->fields.size() - 1);
+        } else if (RD->fields.size() > MemberIndexThreshold || count > MemberIndexThreshold) {
+            RD->members = getAllocator().createWithDestructor<DenseMap<IdentRef, ArrayRef<unsigned>>>();
+            for (unsigned i = 0; i < RD->fields.size(); ++i)
+                indexMember(RD, i);
+        }
+    }
     CType struct_union(Token tok) {
         // parse a struct or union, return it
         // for example:  `struct Foo`
@@ -2860,6 +3376,9 @@ designator:
         //               `struct Foo { ... }`
         location_t full_loc = getLoc();
         consume(); // eat struct/union
+        DeclAttributes A; // `struct __attribute__((packed)) Foo { ... }` or `struct Foo { ... } __attribute__((packed))`
+        if (!gnu_attributes(A))
+            return nullptr;
         IdentRef Name = nullptr;
         if (l.tok.tok == TIdentifier) {
             Name = l.tok.s;
@@ -2871,9 +3390,8 @@ designator:
         }
         CType result = TNEW(TagType){.tag = tok == Kstruct ? TagType_Struct : TagType_Union,
                                      .tag_name = Name,
-                                     .tag_decl = new (getAllocator())(RecordDecl){}};
+                                     .tag_decl = getAllocator().createWithDestructor<RecordDecl>()};
         result->setKind(TYTAG);
-        SmallVectorImpl<FieldDecl> &fields = result->getRecord()->fields;
         consume();
         while (l.tok.tok != TRcurlyBracket) {
             CType base;
@@ -2891,24 +3409,17 @@ designator:
                 Declator e = struct_declarator(base);
                 if (!e.ty)
                     return parse_error(current_declator_loc, "expect struct-declarator"), nullptr;
+                if (l.tok.tok == K__attribute)
+                    ignored_attributes();
                 if (e.ty->isIncomplete())
                     type_error(current_declator_loc, "field has incomplete type %T", e.ty);
                 else if (e.ty->isVLA())
                     type_error(current_declator_loc, "fields must have a constant size: 'variable length array in structure' extension will never be supported");
-                if (e.name) {
-                    for (const auto &p : fields) {
-                        if (p.name == e.name) {
-                            type_error(current_declator_loc, "duplicate member %I", e.name);
-                            break;
-                        }
-                    }
-                } else {
-                    if (e.ty->isAgg() && e.ty->hasTagName()) {
-                        warning(current_declator_loc, "declaration does not declare anything");
-                        goto SKIP;
-                    }
+                if (!e.name && e.ty->isAgg() && e.ty->hasTagName()) {
+                    warning(current_declator_loc, "declaration does not declare anything");
+                    goto SKIP;
                 }
-                fields.push_back(e);
+                addMember(result, e);
 SKIP:
                 if (l.tok.tok == TComma)
                     consume();
@@ -2919,6 +3430,17 @@ SKIP:
             }
         }
         consume();
+        if (!gnu_attributes(A))
+            return nullptr;
+        if (!A.empty()) {
+            RecordDecl *RD = result->getRecord();
+            RD->isPacked = A.has(DeclAttributes::Packed);
+            RD->align = A.align;
+            A.flags &= ~(DeclAttributes::Packed | DeclAttributes::Unused);
+            A.align = 0;
+            if (!A.empty())
+                warning(full_loc, "attributes ignored on %s declaration", show(tok));
+        }
         result->idx = puttag(Name, result, full_loc, tok == Kstruct ? TagType_Struct : TagType_Union);
         return result;
     }
@@ -2957,7 +3479,7 @@ SKIP:
                 if (!(e = constant_expression()))
                     return nullptr;
                 if (e->k == EConstant) {
-                    const APInt &I = cast<ConstantInt>(e->C)->getValue();
+                    const APInt &I = cast<IntConstant>(e->C)->getValue();
                     if (I.getActiveBits() > 32) {
                         warning(full_loc, "enum constant exceeds 32 bit");
                     }
@@ -2998,9 +3520,13 @@ SKIP:
             Declator nt = declarator(base, D_Function);
             if (!nt.ty)
                 return expect(current_declator_loc, "abstract-declarator"), false;
+            if (l.tok.tok == K__attribute)
+                ignored_attributes();
             params.push_back(nt);
             params.back().loc = current_declator_loc;
-            if (nt.ty->isIncomplete())
+            // `(void)` is an empty parameter list
+            const bool isVoidList = i == 1 && nt.ty->isVoid() && !nt.name && l.tok.tok == TRbracket;
+            if (nt.ty->isIncomplete() && !isVoidList)
                 type_error(current_declator_loc, "parameter %u has imcomplete type %T", i, nt.ty), ok = false;
             if (nt.name) {
                 if (sema.typedefs.getSymInCurrentScope(nt.name))
@@ -3067,24 +3593,300 @@ SKIP:
         consume();
         return true;
     }
-    Stmt parse_asm() {
-        Stmt result;
+    // check the constraint `C` of an asm operand, `numOutputs` outputs are before an input operand
+    bool check_asm_constraint(StringRef C, bool isOutput, unsigned numOutputs, location_t loc) {
+        const GCCAsmTarget target(options.triple);
+        const char *desc = isOutput ? "output" : "input";
+        size_t i = 0;
+        if (isOutput) {
+            if (C.empty() || (C.front() != '=' && C.front() != '+'))
+                return type_error(loc, "output constraint '%R' must start with '=' or '+'", C), false;
+            i = 1;
+        }
+        if (i == C.size())
+            return type_error(loc, "empty %s constraint in asm", desc), false;
+        for (; i < C.size(); ++i) {
+            const char c = C[i];
+            switch (c) {
+            case '&':
+                if (!isOutput)
+                    return type_error(loc, "invalid input constraint '%R' in asm: '&' is only allowed in outputs", C), false;
+                continue;
+            case '%':
+            case '*':
+            case '?':
+            case '!':
+            case ',':
+            case '#': continue;
+            case '{': {
+                const size_t end = C.find('}', i);
+                if (end == StringRef::npos)
+                    return type_error(loc, "invalid %s constraint '%R' in asm: missing '}'", desc, C), false;
+                StringRef Reg = C.slice(i + 1, end);
+                if (!target.isValidRegisterName(Reg))
+                    return type_error(loc, "unknown register name '%R' in asm", Reg), false;
+                i = end;
+                continue;
+            }
+            default:
+                if (llvm::isDigit(c)) {
+                    if (isOutput)
+                        return type_error(loc, "invalid output constraint '%R' in asm: matching constraint not allowed", C), false;
+                    unsigned N = 0;
+                    for (; i < C.size() && llvm::isDigit(C[i]); ++i)
+                        N = N * 10 + (C[i] - '0');
+                    --i;
+                    if (N >= numOutputs)
+                        return type_error(loc, "invalid input constraint '%R' in asm: matching constraint references invalid operand number", C), false;
+                    continue;
+                }
+                if (StringRef("rmoVinEFsgXp<>").contains(c) || target.validateConstraintCode(C, i))
+                    continue;
+                return type_error(loc, "invalid %s constraint '%R' in asm", desc, C), false;
+            }
+        }
+        return true;
+    }
+    // the index of the operand named `Name` in `[name]` of an asm template, or -1 if there is none
+    static int find_asm_operand(StringRef Name, ArrayRef<AsmOperand> outputs, ArrayRef<AsmOperand> inputs, ArrayRef<IdentRef> labels) {
+        unsigned i = 0;
+        for (const AsmOperand &op : outputs) {
+            if (op.name && op.name->getKey() == Name)
+                return i;
+            ++i;
+        }
+        for (const AsmOperand &op : inputs) {
+            if (op.name && op.name->getKey() == Name)
+                return i;
+            ++i;
+        }
+        for (IdentRef L : labels) {
+            if (L->getKey() == Name)
+                return i;
+            ++i;
+        }
+        return -1;
+    }
+    // translate the template of an extended asm to the syntax of LLVM inline asm: `%0` => `${0}`, `%k[name]` => `${N:k}`,
+    // `%%` => `%`, `%=` => `${:uid}`, `$` => `$$`, `%{ %| %}` => `$( $| $)`.
+    // LLVM puts the tied inputs of `+` outputs before the labels, so label operands are shifted by `numTied`.
+    bool convert_asm_template(StringRef Str, ArrayRef<AsmOperand> outputs, ArrayRef<AsmOperand> inputs, ArrayRef<IdentRef> labels,
+                              unsigned numTied, location_t loc, SmallVectorImpl<char> &Out) {
+        const unsigned numOperands = outputs.size() + inputs.size();
+        llvm::raw_svector_ostream OS(Out);
+        for (size_t i = 0; i < Str.size();) {
+            char c = Str[i++];
+            if (c == '$') {
+                OS << "$$";
+                continue;
+            }
+            if (c != '%') {
+                OS << c;
+                continue;
+            }
+            if (i == Str.size())
+                return type_error(loc, "invalid escape at the end of asm string"), false;
+            c = Str[i++];
+            switch (c) {
+            case '%': OS << '%'; continue;
+            case '=': OS << "${:uid}"; continue;
+            case '{': OS << "$("; continue;
+            case '|': OS << "$|"; continue;
+            case '}': OS << "$)"; continue;
+            }
+            StringRef modifier;
+            if (llvm::isAlpha(c)) {
+                modifier = Str.substr(i - 1, 1);
+                if (i == Str.size())
+                    return type_error(loc, "invalid operand in asm string: missing operand after modifier '%R'", modifier), false;
+                c = Str[i++];
+            }
+            unsigned N = 0;
+            if (llvm::isDigit(c)) {
+                N = c - '0';
+                for (; i < Str.size() && llvm::isDigit(Str[i]); ++i)
+                    N = N * 10 + (Str[i] - '0');
+                if (N >= numOperands + labels.size())
+                    return type_error(loc, "invalid operand number %u in asm string", N), false;
+            } else if (c == '[') {
+                const size_t end = Str.find(']', i);
+                if (end == StringRef::npos)
+                    return type_error(loc, "unterminated symbolic operand name in asm string"), false;
+                StringRef Name = Str.slice(i, end);
+                i = end + 1;
+                int idx = find_asm_operand(Name, outputs, inputs, labels);
+                if (idx < 0)
+                    return type_error(loc, "undefined symbolic operand name '%R' in asm string", Name), false;
+                N = idx;
+            } else {
+                return type_error(loc, "invalid escape in asm string"), false;
+            }
+            if (N >= numOperands)
+                N += numTied;
+            OS << "${" << N;
+            if (!modifier.empty())
+                OS << ':' << modifier;
+            OS << '}';
+        }
+        return true;
+    }
+    // asm-operand: [ '[' identifier ']' ] string-literal '(' expression ')'
+    // the operands are separated by ',', the list ends at ':' or ')'
+    bool parse_asm_operands(SmallVectorImpl<AsmOperand> &operands, bool isOutput, unsigned numOutputs) {
+        if (l.tok.tok == TColon || l.tok.tok == TRbracket)
+            return true;
+        for (;;) {
+            AsmOperand op{};
+            if (l.tok.tok == TLSquareBrackets) {
+                consume();
+                if (l.tok.tok != TIdentifier)
+                    return expect(getLoc(), "symbolic operand name"), false;
+                op.name = l.tok.s;
+                consume();
+                if (l.tok.tok != TRSquareBrackets)
+                    return expect(getLoc(), "']'"), false;
+                consume();
+            }
+            if (l.tok.tok != TStringLit)
+                return expect(getLoc(), "asm operand constraint"), false;
+            const location_t loc = getLoc();
+            location_t endLoc;
+            parse_string_literal_data(endLoc, l.tok.getStringPrefix());
+            const StringRef C = parseLiteralCache.str();
+            if (!check_asm_constraint(C, isOutput, numOutputs, loc)) {
+                parseLiteralCache.clear();
+                return false;
+            }
+            op.constraint = xstring::get_frozen(C, getAllocator());
+            parseLiteralCache.clear();
+            if (l.tok.tok != TLbracket)
+                return expectLB(getLoc()), false;
+            consume();
+            op.e = expression();
+            if (!op.e)
+                return false;
+            if (l.tok.tok != TRbracket)
+                return expectRB(getLoc()), false;
+            consume();
+            if (isOutput) {
+                if (!assignable(op.e, "cannot assign to const-qualified variable %r in asm output: %T",
+                                "array is not assignable in asm output", "asm output operand must be an lvalue"))
+                    return false;
+            } else if (GCCAsmTarget::isMemoryOnly(op.constraint) && !op.e->isLValue()) {
+                return type_error(loc, "asm input operand with memory constraint must be an lvalue"), false;
+            }
+            operands.push_back(op);
+            if (l.tok.tok != TComma)
+                return true;
+            consume();
+        }
+    }
+    // asm-statement:
+    //   asm asm-qualifiers '(' string-literal ')'
+    //   asm asm-qualifiers '(' string-literal ':' outputs [ ':' inputs [ ':' clobbers [ ':' labels ] ] ] ')'
+    // the statement is inserted, basic asm at file scope become module-level asm
+    void parse_asm(bool isFileScope = false) {
+        const location_t loc = getLoc();
         consume(); // eat asm
+        bool isVolatile = false, isGoto = false;
+        for (;; consume()) {
+            if (l.tok.tok == Kvolatile)
+                isVolatile = true;
+            else if (l.tok.tok == Kgoto)
+                isGoto = true;
+            else if (l.tok.tok != Kinline)
+                break;
+        }
         if (l.tok.tok != TLbracket)
-            return expectLB(getLoc()), nullptr;
+            return expectLB(getLoc());
         consume(); // eat '('
         if (l.tok.tok != TStringLit)
-            return expect(getLoc(), "string literal"), nullptr;
+            return expect(getLoc(), "string literal");
         location_t endLoc;
-        enum StringPrefix prefix = l.tok.getStringPrefix();
-        parse_string_literal_data(endLoc, prefix);
-        result = SNEW(AsmStmt){.asms = xstring::get(parseLiteralCache.str())};
+        parse_string_literal_data(endLoc, l.tok.getStringPrefix());
+        const xstring Str = xstring::get_frozen(parseLiteralCache.str(), getAllocator());
         parseLiteralCache.clear();
-        consume(); // eat string
+        if (l.tok.tok == TRbracket) {
+            consume(); // eat ')'
+            if (isGoto)
+                return (void)type_error(loc, "'asm goto' requires a label list");
+            checkSemicolon();
+            return insertStmt(SNEW(AsmStmt){.asms = Str});
+        }
+        if (isFileScope)
+            return (void)type_error(loc, "expected ')': extended asm is not allowed at file scope");
+        SmallVector<AsmOperand, 4> outputs, inputs;
+        SmallVector<xstring, 4> clobbers;
+        SmallVector<IdentRef, 4> labelNames;
+        SmallVector<label_t, 4> labels;
+        // outputs
+        if (l.tok.tok != TColon)
+            return expect(getLoc(), "':' or ')'");
+        consume();
+        if (!parse_asm_operands(outputs, true, 0))
+            return;
+        // inputs
+        if (l.tok.tok == TColon) {
+            consume();
+            if (!parse_asm_operands(inputs, false, outputs.size()))
+                return;
+            // clobbers
+            if (l.tok.tok == TColon) {
+                consume();
+                const GCCAsmTarget target(options.triple);
+                while (l.tok.tok == TStringLit) {
+                    const location_t clobberLoc = getLoc();
+                    parse_string_literal_data(endLoc, l.tok.getStringPrefix());
+                    const StringRef Name = parseLiteralCache.str();
+                    if (Name != "memory" && Name != "cc" && !target.isValidRegisterName(Name)) {
+                        type_error(clobberLoc, "unknown register name '%R' in asm", Name);
+                        parseLiteralCache.clear();
+                        return;
+                    }
+                    clobbers.push_back(xstring::get_frozen(GCCAsmTarget::normalizeRegisterName(Name), getAllocator()));
+                    parseLiteralCache.clear();
+                    if (l.tok.tok != TComma)
+                        break;
+                    consume();
+                }
+                // labels
+                if (l.tok.tok == TColon) {
+                    consume();
+                    if (!isGoto)
+                        return (void)type_error(getLoc(), "labels are only allowed in 'asm goto'");
+                    while (l.tok.tok == TIdentifier) {
+                        labelNames.push_back(l.tok.s);
+                        labels.push_back(getLabel(l.tok.s));
+                        consume();
+                        if (l.tok.tok != TComma)
+                            break;
+                        consume();
+                    }
+                    if (labels.empty())
+                        return expect(getLoc(), "label");
+                }
+            }
+        }
         if (l.tok.tok != TRbracket)
-            return expectRB(getLoc()), nullptr;
+            return expectRB(getLoc());
         consume(); // eat ')'
-        return result;
+        checkSemicolon();
+        if (isGoto && labels.empty())
+            return (void)type_error(loc, "'asm goto' requires a label list");
+        unsigned numTied = 0;
+        for (const AsmOperand &op : outputs)
+            numTied += op.constraint.str().front() == '+';
+        SmallString<64> Template;
+        if (!convert_asm_template(Str, outputs, inputs, labelNames, numTied, loc, Template))
+            return;
+        insertStmt(SNEW(GCCAsmStmt){.asm_template = xstring::get_frozen(Template.str(), getAllocator()),
+                                    .asm_outputs = xvector<AsmOperand>::get_frozen(outputs, getAllocator()),
+                                    .asm_inputs = xvector<AsmOperand>::get_frozen(inputs, getAllocator()),
+                                    .asm_clobbers = xvector<xstring>::get_frozen(clobbers, getAllocator()),
+                                    .asm_labels = xvector<label_t>::get_frozen(labels, getAllocator()),
+                                    // an asm without outputs, and asm goto, are implicitly volatile
+                                    .asm_volatile = isVolatile || isGoto || outputs.empty(),
+                                    .asm_loc = loc});
     }
     bool consume_static_assert() {
         uint64_t ok;
@@ -3131,15 +3933,104 @@ SKIP:
             return true;
         }
         if (e->ty->getKind() == TYPOINTER) {
-            if ((e->ty->hasTag(TYLVALUE)) && e->ty->p->getKind() == TYARRAY)
+            if (e->isLValue() && e->ty->p->getKind() == TYARRAY)
                 return type_error(getLoc(), msg2), false;
             return true;
         }
-        if (e->ty->hasTag(TYLVALUE))
+        if (e->isLValue())
             return true;
         return type_error(getLoc(), msg3), false;
     }
-    void declaration() {
+    // `T __attribute__((vector_size(N)))`: a vector of N / sizeof(T) elements of the arithmetic type T, the qualifiers and the
+    // storage-class of T apply to the vector. returns nullptr on error
+    CType make_vector_type(CType ty, uint64_t bytes, location_t loc) {
+        if (!(ty->getKind() == TYPRIM && !ty->isVoid() && !ty->isComplex() && !ty->isImaginary() && !ty->isBool()))
+            return type_error(loc, "invalid vector element type %T", ty), nullptr;
+        const uint64_t size = getsizeof(ty);
+        if (!llvm::isPowerOf2_64(size))
+            return type_error(loc, "invalid vector element type %T", ty), nullptr;
+        if (bytes % size)
+            return type_error(loc, "vector size not an integral multiple of component size"), nullptr;
+        if (!llvm::isPowerOf2_64(bytes / size))
+            return type_error(loc, "number of elements must be power of 2"), nullptr;
+        CType result = context.getVectorType(context.make_cached(ty->getTagsNoQualifiersAndStorages()), bytes / size);
+        result->addTags(ty->getTagsQualifiersAndStoragesOnly());
+        return result;
+    }
+    // check the attributes `A` of the declarator `st`(the symbol `idx`), and merge them with the attributes of the previous declarations.
+    // returns the merged attributes, or nullptr if there is none
+    const DeclAttributes *mergeDeclAttributes(const Declator &st, DeclAttributes &A, unsigned idx, bool isDefinition) {
+        constexpr uint32_t FunctionOnly = DeclAttributes::AlwaysInline | DeclAttributes::NoInline | DeclAttributes::Hot |
+                                          DeclAttributes::Cold | DeclAttributes::Flatten | DeclAttributes::Pure |
+                                          DeclAttributes::Const | DeclAttributes::Malloc | DeclAttributes::NoReturn;
+        const location_t loc = current_declator_loc;
+        if (st.ty->hasTag(TYTYPEDEF)) {
+            A.flags &= ~DeclAttributes::Unused;
+            if (!A.empty())
+                warning(loc, "attributes ignored on typedef %I", st.name);
+            return nullptr;
+        }
+        Variable_Info &info = sema.typedefs.getSym(idx);
+        if (A.has(DeclAttributes::Unused))
+            info.tags |= USED;
+        if (A.empty())
+            return info.attrs;
+        const bool isFunction = st.ty->getKind() == TYFUNCTION;
+        if (!isFunction && ((A.flags & FunctionOnly) || A.nonnull || A.optimize != DeclAttributes::OptimizeUnspecified)) {
+            warning(loc, "function attributes ignored on variable %I", st.name);
+            A.flags &= ~FunctionOnly;
+            A.nonnull = 0;
+            A.optimize = DeclAttributes::OptimizeUnspecified;
+        }
+        if (A.has(DeclAttributes::Packed)) {
+            warning(loc, "'packed' attribute ignored on %I", st.name);
+            A.flags &= ~DeclAttributes::Packed;
+        }
+        if (!isFunction && !isTopLevel() && !st.ty->isGlobalStorage()) {
+            // only the alignment has a meaning for automatic variables
+            if ((A.flags & (DeclAttributes::Used | DeclAttributes::Weak)) || !A.section.empty() || !A.alias.empty() ||
+                A.visibility != DeclAttributes::VisibilityUnspecified) {
+                warning(loc, "linkage attributes ignored on local variable %I", st.name);
+                A.flags &= ~(DeclAttributes::Used | DeclAttributes::Weak);
+                A.section = A.alias = StringRef();
+                A.visibility = DeclAttributes::VisibilityUnspecified;
+            }
+        }
+        if (A.has(DeclAttributes::Weak) && st.ty->hasTag(TYSTATIC))
+            type_error(loc, "weak declaration of %I must be public", st.name);
+        if (!A.alias.empty() && isDefinition)
+            type_error(loc, "%I is defined, it cannot be an alias", st.name);
+        if (isFunction && A.nonnull != ~uint64_t(0)) {
+            const auto &params = st.ty->params;
+            for (unsigned i = 0; i < 64; ++i) {
+                if (!(A.nonnull >> i & 1))
+                    continue;
+                if (i >= params.size())
+                    type_error(loc, "'nonnull' attribute parameter %u is out of bounds", i + 1);
+                else if (params[i].ty->getKind() != TYPOINTER)
+                    warning(loc, "'nonnull' attribute applied to non-pointer parameter %u", i + 1);
+            }
+        }
+        if (A.has(DeclAttributes::NoReturn)) {
+            // calls to it end the basic block, like `_Noreturn`
+            st.ty->addTag(TYNORETURN);
+            info.ty->addTag(TYNORETURN);
+            info.ref_ty = nullptr;
+        }
+        DeclAttributes merged = info.attrs ? *info.attrs : DeclAttributes();
+        merged.merge(A);
+        if (merged.has(DeclAttributes::AlwaysInline) && merged.has(DeclAttributes::NoInline)) {
+            warning(loc, "'always_inline' and 'noinline' attributes are not compatible, 'always_inline' is ignored");
+            merged.flags &= ~DeclAttributes::AlwaysInline;
+        }
+        if (merged.has(DeclAttributes::Hot) && merged.has(DeclAttributes::Cold)) {
+            warning(loc, "'hot' and 'cold' attributes are not compatible, both are ignored");
+            merged.flags &= ~(DeclAttributes::Hot | DeclAttributes::Cold);
+        }
+        return info.attrs = new (getAllocator()) DeclAttributes(merged);
+    }
+    // `prefix` is the C23 attributes before the declaration, if they are parsed by the caller
+    void declaration(const DeclAttributes *prefix = nullptr) {
         // parse declaration or function definition
         CType base;
         Stmt result = nullptr;
@@ -3149,10 +4040,17 @@ SKIP:
             consume_static_assert();
             return;
         }
+        DeclAttributes specAttrs; // attributes apply to all declarators
+        if (prefix)
+            specAttrs = *prefix;
+        if (!attributes(specAttrs))
+            return;
+        // an empty declaration, or an attribute declaration: `__attribute__((fallthrough));`
         if (l.tok.tok == TSemicolon) {
             consume();
             return;
         }
+        sema.declAttrs = &specAttrs;
         if (!(base = declaration_specifiers()))
             return expect(loc, "declaration-specifiers");
         if (sema.currentAlign) {
@@ -3176,6 +4074,17 @@ SKIP:
             Declator st = declarator(base, D_Direct);
             if (!st.ty)
                 return;
+            DeclAttributes declAttrs = specAttrs;
+            // GNU attributes after the declarator: `void f(void) __attribute__((noinline));`
+            if (!gnu_attributes(declAttrs))
+                return;
+            // `typedef float v4sf __attribute__((vector_size(16)));`, for functions it applies to the return type
+            if (declAttrs.vector_size) {
+                CType &T = st.ty->getKind() == TYFUNCTION ? st.ty->ret : st.ty;
+                if (!(T = make_vector_type(T, declAttrs.vector_size, current_declator_loc)))
+                    return;
+                declAttrs.vector_size = 0;
+            }
             if (l.tok.tok == TLcurlyBracket) {
                 if (st.ty->getKind() != TYFUNCTION)
                     return (void)type_error(current_declator_loc, "unexpected function definition");
@@ -3212,12 +4121,15 @@ ARGV_OK:;
                 unsigned idx = putsymtype2(st.name, st.ty, current_declator_loc, true);
                 if (!isTopLevel())
                     return (void)parse_error(current_declator_loc, "function definition is not allowed here");
+                if (declAttrs.optimize == DeclAttributes::OptimizeUnspecified)
+                    declAttrs.optimize = l.pragmaOptimize;
                 Stmt res = SNEW(FunctionStmt){.func_idx = idx,
                                               .funcname = st.name,
                                               .functy = st.ty,
                                               .indirectBrs = nullptr,
                                               .localStart = static_cast<unsigned>(sema.typedefs.data.size()),
-                                              .funcDefLoc = current_declator_loc
+                                              .funcDefLoc = current_declator_loc,
+                                              .funcattrs = mergeDeclAttributes(st, declAttrs, idx, true)
                                           };
                 sema.currentfunction = st.ty;
                 sema.pfunc = st.name;
@@ -3253,7 +4165,12 @@ ARGV_OK:;
             unsigned idx = putsymtype(st.name, st.ty, current_declator_loc);
             if (!result)
                 result = SNEW(VarDeclStmt){.vars = xvector<VarDecl>::get()};
-            result->vars.push_back(VarDecl{.name = st.name, .ty = st.ty, .init = nullptr, .idx = idx, .loc = current_declator_loc});
+            result->vars.push_back(VarDecl{.name = st.name,
+                                           .ty = st.ty,
+                                           .init = nullptr,
+                                           .idx = idx,
+                                           .loc = current_declator_loc,
+                                           .attrs = mergeDeclAttributes(st, declAttrs, idx, l.tok.tok == TAssign)});
             if (st.ty->hasTag(TYINLINE))
                 warning(current_declator_loc, "inline can only used in function declaration");
             if (l.tok.tok == TAssign) {
@@ -3389,33 +4306,34 @@ ARGV_OK:;
             consume();
             if (!(e = cast_expression()))
                 return nullptr;
+            if (e->ty->getKind() == TYVECTOR && e->ty->vec_ty->isInteger())
+                return unary(e, Not, e->ty);
             if (!(checkInteger(e->ty) || (e->ty->isComplex())))
                 return type_error(loc, "integer type expected"), nullptr;
             integer_promotions(e);
             if (e->ty->isComplex()) {
                 if (e->k == EConstant) {
-                    if (auto CS = dyn_cast<llvm::ConstantStruct>(e->C)) {
-                        if (auto REAL = dyn_cast<ConstantFP>(CS->getOperand(0))) {
-                            const auto &i = cast<ConstantFP>(CS->getOperand(1))->getValue();
-                            auto IMAG = ConstantFP::get(getLLVMContext(), -i);
-                            return wrap(e->ty, llvm::ConstantStruct::get(wrapComplex(e->ty), {REAL, IMAG}),
+                    if (auto CS = dyn_cast<ComplexConstant>(e->C)) {
+                        if (auto REAL = dyn_cast<FloatConstant>(CS->real)) {
+                            const auto &i = cast<FloatConstant>(CS->imag)->getValue();
+                            auto IMAG = context.createFloatConstant(-i);
+                            return wrap(e->ty, context.createComplexConstant(REAL, IMAG),
                                         e->getBeginLoc(), e->getEndLoc());
                         }
-                        const auto REAL = cast<ConstantInt>(CS->getOperand(0));
-                        const auto &i = cast<ConstantInt>(CS->getOperand(1))->getValue();
-                        auto IMAG = ConstantInt::get(getLLVMContext(), -i);
-                        return wrap(e->ty, llvm::ConstantStruct::get(wrapComplexForInteger(e->ty), {REAL, IMAG}),
+                        const auto REAL = cast<IntConstant>(CS->real);
+                        const auto &i = cast<IntConstant>(CS->imag)->getValue();
+                        auto IMAG = context.createIntConstant(-i);
+                        return wrap(e->ty, context.createComplexConstant(REAL, IMAG),
                                     e->getBeginLoc(), e->getEndLoc());
                     }
-                    if (isa<llvm::ConstantAggregateZero>(e->C)) {
-                        return e->ty->isFloating() ? complex_pos_neg_zero(e->ty, e->getBeginLoc(), e->getEndLoc())
-                                                   : complex_zero(e->ty, e->getBeginLoc(), e->getEndLoc());
-                    }
                 }
                 return unary(e, CConj, e->ty);
             }
-            if (e->k == EConstant) // fold simple bitwise-not, e.g., ~0ULL
-                return wrap(e->ty, llvm::ConstantExpr::getNot(e->C), e->getBeginLoc(), e->getEndLoc());
+            if (e->k == EConstant) { // fold simple bitwise-not, e.g., ~0ULL
+                if (auto CI = dyn_cast<IntConstant>(e->C))
+                    return wrap(e->ty, context.createIntConstant(~CI->getValue()), e->getBeginLoc(), e->getEndLoc());
+                return e; // ~undef is still undef
+            }
             return unary(e, Not, e->ty);
         }
         case TLogicalAnd:
@@ -3437,13 +4355,7 @@ ARGV_OK:;
                 return nullptr;
             if (e->k == EString) {
                 assert(e->ty->getKind() == TYPOINTER);
-                if (auto CA = dyn_cast<llvm::ConstantDataArray>(e->string)) {
-                    e->ty = context.getPointerType(context.getFixArrayType(e->ty->p, CA->getType()->getNumElements()));
-                } else {
-                    auto AZ = cast<llvm::ConstantAggregateZero>(e->string);
-                    e->ty = context.getPointerType(
-                        context.getFixArrayType(e->ty->p, cast<llvm::ArrayType>(AZ->getType())->getNumElements()));
-                }
+                e->ty = context.getPointerType(context.getFixArrayType(e->ty->p, e->string->numElements));
                 return e;
             }
             if (e->k == EArrToAddress) {
@@ -3452,10 +4364,11 @@ ARGV_OK:;
             if (e->ty->hasTag(TYREGISTER))
                 warning(loc, "taking address of register variable");
             if (e->k == EUnary && e->uop == AddressOf && e->ty->p->getKind() == TYFUNCTION) {
-                e->ty = context.clone(e->ty);
-                e->ty->clearTag(TYLVALUE);
+                e->flags = EF_None;
                 return e;
             }
+            if (e->isBitField())
+                return type_error(loc, "address of bit-field requested") << e->getSourceRange(), e;
             if (!assignable(e))
                 return e;
             return unary(e, AddressOf, context.getPointerType(e->ty));
@@ -3465,35 +4378,39 @@ ARGV_OK:;
             consume();
             if (!(e = unary_expression()))
                 return nullptr;
+            if (e->ty->getKind() == TYVECTOR) {
+                CType elem = e->ty->vec_ty;
+                return unary(e, elem->isFloating() ? FNeg : (elem->isSigned() ? SNeg : UNeg), e->ty);
+            }
             if (!checkArithmetic(e->ty))
                 return type_error(loc, "arithmetic type expected"), nullptr;
             integer_promotions(e);
             if (e->k == EConstant) { // fold simple negate numbers, e.g, -10
                 if (e->ty->isComplex()) {
-                    if (isa<llvm::ConstantAggregateZero>(e->C))
+                    if (e->C->isNullValue())
                         return e->ty->isFloating() ? complex_neg_zero(e->ty, e->getBeginLoc(), e->getEndLoc())
                                                    : complex_zero(e->ty, e->getBeginLoc(), e->getEndLoc());
-                    if (auto CS = dyn_cast<llvm::ConstantStruct>(e->C)) {
-                        if (auto CF = dyn_cast<ConstantFP>(CS->getOperand(0))) {
+                    if (auto CS = dyn_cast<ComplexConstant>(e->C)) {
+                        if (auto CF = dyn_cast<FloatConstant>(CS->real)) {
                             const auto &r = CF->getValue();
-                            const auto &i = cast<ConstantFP>(CS->getOperand(1))->getValue();
-                            auto REAL = ConstantFP::get(getLLVMContext(), -r);
-                            auto IMAG = ConstantFP::get(getLLVMContext(), -i);
-                            return wrap(e->ty, llvm::ConstantStruct::get(wrapComplex(e->ty), {REAL, IMAG}),
+                            const auto &i = cast<FloatConstant>(CS->imag)->getValue();
+                            auto REAL = context.createFloatConstant(-r);
+                            auto IMAG = context.createFloatConstant(-i);
+                            return wrap(e->ty, context.createComplexConstant(REAL, IMAG),
                                         e->getBeginLoc(), e->getEndLoc());
                         }
-                        const auto &r = cast<ConstantInt>(CS->getOperand(0))->getValue();
-                        const auto &i = cast<ConstantInt>(CS->getOperand(1))->getValue();
-                        auto REAL = ConstantInt::get(getLLVMContext(), -r);
-                        auto IMAG = ConstantInt::get(getLLVMContext(), -i);
-                        return wrap(e->ty, llvm::ConstantStruct::get(wrapComplexForInteger(e->ty), {REAL, IMAG}),
+                        const auto &r = cast<IntConstant>(CS->real)->getValue();
+                        const auto &i = cast<IntConstant>(CS->imag)->getValue();
+                        auto REAL = context.createIntConstant(-r);
+                        auto IMAG = context.createIntConstant(-i);
+                        return wrap(e->ty, context.createComplexConstant(REAL, IMAG),
                                     e->getBeginLoc(), e->getEndLoc());
                     }
+                } else if (auto CF = dyn_cast<FloatConstant>(e->C)) {
+                    return wrap(e->ty, context.createFloatConstant(-CF->getValue()), e->getBeginLoc(),
+                                e->getEndLoc());
                 } else {
-                    return wrap(e->ty,
-                                e->ty->isSigned() ? llvm::ConstantExpr::getNSWNeg(e->C)
-                                                  : llvm::ConstantExpr::getNeg(e->C),
-                                e->getBeginLoc(), e->getEndLoc());
+                    return wrap(e->ty, fold_neg(e->C), e->getBeginLoc(), e->getEndLoc());
                 }
             }
             return unary(e,
@@ -3505,6 +4422,8 @@ ARGV_OK:;
             consume();
             if (!(e = unary_expression()))
                 return nullptr;
+            if (e->ty->getKind() == TYVECTOR)
+                return e;
             if (!checkArithmetic(e->ty))
                 return type_error(loc, "arithmetic type expected"), nullptr;
             integer_promotions(e);
@@ -3524,8 +4443,8 @@ ARGV_OK:;
             CType ty = e->ty->getKind() == TYPOINTER ? context.getSize_t() : e->ty;
             Expr obj = e;
             Expr one = e->ty->isFloating()
-                           ? wrap(ty, ConstantFP::get(wrapFloating(ty), 1.0), e->getBeginLoc(), e->getEndLoc())
-                           : wrap(ty, ConstantInt::get(getLLVMContext(), APInt(ty->getBitWidth(), 1)), e->getBeginLoc(),
+                           ? wrap(ty, context.createFloatConstant(APFloat(wrapFloating(ty)->getFltSemantics(), 1)), e->getBeginLoc(), e->getEndLoc())
+                           : wrap(ty, context.createIntConstant(APInt(ty->getBitWidth(), 1)), e->getBeginLoc(),
                                   e->getEndLoc());
             (tok == TAddAdd) ? make_add(e, one, opLoc) : make_sub(e, one, opLoc);
             return binop(obj, Assign, e, e->ty);
@@ -3544,7 +4463,7 @@ ARGV_OK:;
                     location_t endLoc = getLoc();
                     consume();
                     return wrap(context.getSize_t(),
-                                ConstantInt::get(getLLVMContext(), APInt(llvmTypeCache.pointerSizeInBits, getsizeof(ty))), loc,
+                                context.createIntConstant(APInt(llvmTypeCache.pointerSizeInBits, getsizeof(ty))), loc,
                                 endLoc);
                 }
                 if (!(e = unary_expression()))
@@ -3571,7 +4490,7 @@ ARGV_OK:;
                 if (!ty)
                     return expect(getLoc(), "type-name"), nullptr;
                 result = wrap(context.getSize_t(),
-                              ConstantInt::get(getLLVMContext(), APInt(llvmTypeCache.pointerSizeInBits, getAlignof(ty))), loc,
+                              context.createIntConstant(APInt(llvmTypeCache.pointerSizeInBits, getAlignof(ty))), loc,
                               getLoc());
             } else {
                 Expr e = unary_expression();
@@ -3579,7 +4498,7 @@ ARGV_OK:;
                     return nullptr;
                 result =
                     wrap(context.getSize_t(),
-                         ConstantInt::get(getLLVMContext(), APInt(llvmTypeCache.pointerSizeInBits, getAlignof(e))), loc, getLoc());
+                         context.createIntConstant(APInt(llvmTypeCache.pointerSizeInBits, getAlignof(e))), loc, getLoc());
             }
             if (l.tok.tok != TRbracket)
                 return expectRB(getLoc()), nullptr;
@@ -3599,11 +4518,11 @@ ARGV_OK:;
             if (e->ty->isComplex())
                 return unary(e, tok == K__imag ? C__imag__ : C__real__, ty);
             if (e->ty->isImaginary())
-                return tok == K__real ? wrap(ty, llvm::Constant::getNullValue(wrapNoComplexScalar(ty)),
+                return tok == K__real ? wrap(ty, getNullConstant(wrapNoComplexScalar(ty)),
                                              e->getBeginLoc(), e->getEndLoc())
                                       : e;
             return tok == K__real ? e
-                                  : wrap(ty, llvm::Constant::getNullValue(wrapNoComplexScalar(ty)),
+                                  : wrap(ty, getNullConstant(wrapNoComplexScalar(ty)),
                                          e->getBeginLoc(), e->getEndLoc());
         }
         case K__extension__: {
@@ -3649,7 +4568,7 @@ START_LEX:
             assert(llvm::isDigit(str.front()));
             return wrap(
                 context.getInt(), 
-                ConstantInt::get(getLLVMContext(), APInt(32, uint64_t(*s) - '0')), 0, 0);
+                context.createIntConstant(APInt(32, uint64_t(*s) - '0')), 0, 0);
         }
         if (*s == '0') {
             s++;
@@ -3812,7 +4731,7 @@ NEXT:
             }
             if (su.isImaginary)
                 ty->addTag(TYIMAGINARY);
-            return wrap(ty, ConstantFP::get(getLLVMContext(), F), 0, 0);
+            return wrap(ty, context.createFloatConstant(F), 0, 0);
         }
         bool overflow = false;
         xint128_t bigVal = xint128_t::getZero();
@@ -3863,26 +4782,38 @@ NEXT:
             }
         }
         auto bit_width = ty->getIntegerKind().getBitWidth();
-        ConstantInt *CI = H ? ConstantInt::get(getLLVMContext(), APInt(bit_width, {H, L}))
-                            : ConstantInt::get(getLLVMContext(), APInt(bit_width, L));
+        const IntConstant *CI = H ? context.createIntConstant(APInt(bit_width, {H, L}))
+                            : context.createIntConstant(APInt(bit_width, L));
         if (su.isImaginary)
             ty = context.tryGetImaginaryTypeFromNonImaginary(ty);
         return wrap(ty, CI, 0, 0);
     }
-    Expr wrap(CType ty, llvm::Constant *C, location_t loc, location_t endLoc) {
+    Expr wrap(CType ty, const ConstantValue *C, location_t loc, location_t endLoc) {
         return ENEW(ConstantExpr){.ty = ty, .C = C, .constantLoc = loc, .constantEndLoc = endLoc};
     }
-    Expr createString(CType ty, llvm::Constant *C, location_t loc, location_t endLoc) {
-        return ENEW(StringExpr){.ty = ty, .string = C, .stringLoc = loc, .stringEndLoc = endLoc};
+    Expr createString(CType ty, const StringLiteralData *S, location_t loc, location_t endLoc) {
+        return ENEW(StringExpr){.ty = ty, .string = S, .stringLoc = loc, .stringEndLoc = endLoc};
     }
     Expr getIntZero() const { return intzero; }
     Expr getIntOne() const { return intone; }
     struct best_match {
-        best_match(IdentRef goal) : m_goal{goal->getKey()} { }
+        best_match(IdentRef goal) : m_goal{goal->getKey()}, m_goalSig{getSignature(m_goal)} { }
         unsigned m_best = 0;
-        bool m_hasBest = false;
+        unsigned m_bestED = unsigned(-1);
         StringRef m_goal;
-        void consider(IdentRef candidate, unsigned idx) {
+        uint64_t m_goalSig;
+        // the set of characters in a name(folded to 64 bits)
+        static uint64_t getSignature(StringRef key) {
+            uint64_t sig = 0;
+            for (unsigned char c : key)
+                sig |= uint64_t(1) << (c & 63);
+            return sig;
+        }
+        // candidates must have a length in [minLength(), maxLength()]
+        unsigned minLength() const { return m_goal.size() - m_goal.size() / 3; }
+        unsigned maxLength() const { return m_goal.size() + m_goal.size() / 3; }
+        void consider(IdentRef candidate, unsigned idx) { consider(candidate, getSignature(candidate->getKey()), idx); }
+        void consider(IdentRef candidate, uint64_t sig, unsigned idx) {
             StringRef key = candidate->getKey();
 
             unsigned MinED = abs((int)key.size() - (int)m_goal.size());
@@ -3891,21 +4822,38 @@ NEXT:
 
             // Compute an upper bound on the allowable edit distance, so that the
             // edit-distance algorithm can short-circuit.
-            unsigned UpperBound = (m_goal.size() + 2) / 3;
+            unsigned UpperBound = std::min((m_goal.size() + 2) / 3, size_t(m_bestED));
+            // every character missing from the other name needs at least one edit
+            unsigned MinChars = std::max(llvm::countPopulation(sig & ~m_goalSig), llvm::countPopulation(m_goalSig & ~sig));
+            if (MinChars > UpperBound)
+                return;
             unsigned ED = m_goal.edit_distance(key, true, UpperBound);
-            if (ED > UpperBound)
+            if (ED == 0 || ED > UpperBound)
                 return;
 
-            if (ED > m_best)
-                return select(idx);
+            // prefer the closest name, then the nearest declaration
+            if (ED < m_bestED || idx > m_best)
+                return select(idx, ED);
         }
-        void select(unsigned idx) {
-            m_hasBest = true;
+        void select(unsigned idx, unsigned ED) {
             m_best = idx;
+            m_bestED = ED;
         }
         unsigned best() const { return m_best; }
-        bool hasBest() const { return m_hasBest; }
+        bool hasBest() const { return m_bestED != unsigned(-1); }
     };
+    // the names at file scope(including every declaration from headers) are the bulk of the visible names, and they
+    // are never popped, so they are bucketed by length once and the index is only extended.
+    struct TypoIndex {
+        struct Entry {
+            uint64_t sig;
+            unsigned idx;
+        };
+        SmallVector<SmallVector<Entry, 0>, 0> by_length;
+        unsigned indexed = 0;
+        // number of typo corrections tried in this translation unit
+        unsigned corrections = 0;
+    } typo_index;
     // clang::TypoCorrectionConsumer::addName
     // https://splichal.eu/doxygen/spellcheck_8h_source.html
     // quote from
@@ -3913,10 +4861,29 @@ NEXT:
     // > Scopes are searched from innermost outwards, and within a scope in reverse order of declaration, thus
     // benefiting candidates "near" to the current scope.
     IdentRef try_suggest_identfier(IdentRef ID, SourceRange &declRange) {
+        // like clang's -fspell-checking-limit: a file with a missing header will not spend its time on suggestions
+        if (typo_index.corrections >= options.SpellCheckingLimit)
+            return nullptr;
+        typo_index.corrections++;
         best_match result(ID);
         const auto &data = sema.typedefs.data;
-        for (unsigned i = data.size(); i--;)
+        const auto &blocks = sema.typedefs.blocks;
+        const unsigned globalEnd = blocks.size() > 1 ? blocks[1] : data.size();
+        for (unsigned i = typo_index.indexed; i < globalEnd; ++i) {
+            StringRef key = data[i].sym->getKey();
+            if (key.size() >= typo_index.by_length.size())
+                typo_index.by_length.resize(key.size() + 1);
+            typo_index.by_length[key.size()].push_back(TypoIndex::Entry{best_match::getSignature(key), i});
+        }
+        typo_index.indexed = std::max(typo_index.indexed, globalEnd);
+        for (unsigned i = data.size(); i-- > globalEnd;)
             result.consider(data[i].sym, i);
+        const unsigned maxLength = result.maxLength(), numLengths = typo_index.by_length.size();
+        for (unsigned len = result.minLength(); len <= maxLength && len < numLengths; ++len) {
+            const auto &bucket = typo_index.by_length[len];
+            for (size_t i = bucket.size(); i--;)
+                result.consider(data[bucket[i].idx].sym, bucket[i].sig, bucket[i].idx);
+        }
         if (result.hasBest()) {
             auto &it = data[result.best()];
             declRange = SourceRange(it.info.loc, it.sym);
@@ -3943,7 +4910,15 @@ NEXT:
         }
         // else '__builtin_' or '__sync_' functions
         xvector<Expr> callArgs = xvector<Expr>::get();
+        CType convertTy = nullptr; // the type-name argument of __builtin_convertvector
         for (;l.tok.tok != TRbracket;) {
+            if (ID == BI__builtin_convertvector && callArgs.size() == 1) {
+                if (!(convertTy = type_name()))
+                    return expect(getLoc(), "type-name"), nullptr;
+                if (l.tok.tok == TComma)
+                    consume();
+                continue;
+            }
             Expr e = assignment_expression();
             if (!e)
                 return nullptr;
@@ -3966,7 +4941,8 @@ NEXT:
         assert(ty->getKind() == TYFUNCTION);
         size_t argSize = callArgs.size();
         size_t paramSize = ty->params.size();
-        if (argSize > paramSize) {
+        CType ret = ty->ret;
+        if (argSize > paramSize && !ty->isVarArg) {
             type_error(range.getStart(), "too many arguments to builtin function %I: expect %u arguments, %u provided", Name, paramSize, argSize);
         } else if (argSize < paramSize) {
             if (ty->isVarArg)
@@ -3974,18 +4950,343 @@ NEXT:
             else
                 type_error(range.getStart(), "too few arguments to builtin function %I: expect %u arguments, %u provided", Name, paramSize, argSize);
         } else {
-            for (size_t i = 0;i < argSize;++i) {
-                const Param &p = ty->params[i];
-                if (!compatible(p.ty, callArgs[i]->ty))
-                    type_error(
-                        range.getStart(),
-                        "incompatible type for calling builtin function %I:"
-                        " expect %T for parameter %u, %T provided", Name, p.ty, i, callArgs[i]->ty);
-                else 
-                    callArgs[i] = castto(callArgs[i], p.ty, Implict_Call);
+            // the arguments are converted as if by assignment, like the arguments of a prototyped function
+            for (size_t i = 0;i < paramSize;++i) {
+                Expr e = castto(callArgs[i], ty->params[i].ty, Implict_Call);
+                if (!e)
+                    return nullptr;
+                // a pointer keeps its pointee type: IRGen aligns the operands of memcpy/memset from it
+                if (e->ty->getKind() != TYPOINTER || callArgs[i]->ty->getKind() != TYPOINTER)
+                    callArgs[i] = e;
+            }
+            for (size_t i = 0;i < paramSize;++i) {
+                if ((IntegerConstantArgs & (1U << i)) && callArgs[i]->k != EConstant)
+                    type_error(callArgs[i]->getBeginLoc(), "argument %u to builtin function %I must be an integer constant expression", (unsigned)i + 1, Name) << callArgs[i]->getSourceRange();
+            }
+            // __builtin_constant_p of a folded expression is known in the front-end
+            if (ID == BI__builtin_constant_p && argSize == 1 && callArgs[0]->k == EConstant)
+                return getIntOne();
+            check_builtin_call(ID, Name, callArgs, range.getStart());
+            if (Expr folded = fold_builtin_call(ID, callArgs, ty->ret, range.getStart(), endLoc))
+                return folded;
+            ret = check_atomic_builtin(ID, Name, callArgs, ret, range.getStart());
+            ret = check_vector_builtin(ID, Name, callArgs, convertTy, ret, range.getStart());
+            if (ID == BI__builtin_convertvector && ret->getKind() == TYVECTOR)
+                return convert_vector(callArgs.front(), ret);
+        }
+        return ENEW(CallCompilerBuiltinCallExpr) {.ty = ret, .cbc_args = callArgs, .cbc_type = ty, .cbc_name = Name, .cbc_ID = (Token)ID, .cbc_start_loc = range.getStart(), .cbc_end_loc = endLoc};
+    }
+    // __builtin_shufflevector(a, b, index...) and __builtin_convertvector(v, T) of the vector extensions.
+    // returns the type of the call, `ret` if `ID` is not one of them or on error
+    CType check_vector_builtin(unsigned ID, IdentRef Name, const xvector<Expr> &args, CType convertTy, CType ret, location_t loc) {
+        switch (ID) {
+        case BI__builtin_shufflevector: {
+            if (args.size() < 3)
+                return type_error(loc, "too few arguments to builtin function %I: at least 3 arguments are requested", Name), ret;
+            CType ty = args[0]->ty;
+            if (ty->getKind() != TYVECTOR || !type_equal(ty, args[1]->ty))
+                return type_error(loc, "the first two arguments to %I must be vectors of the same type, %T and %T provided", Name,
+                                  ty, args[1]->ty),
+                       ret;
+            // the indexes select from the concatenation of the two vectors, -1 is an undefined element
+            const uint64_t limit = uint64_t(ty->vec_num_elems) * 2;
+            for (size_t i = 2; i < args.size(); ++i) {
+                const APInt *V = getIntegerConstant(args[i]);
+                if (!V)
+                    return (type_error(args[i]->getBeginLoc(), "index for %I must be a constant integer", Name)
+                            << args[i]->getSourceRange()),
+                           ret;
+                if (!V->isAllOnes() && V->getLimitedValue() >= limit)
+                    return (type_error(args[i]->getBeginLoc(), "index for %I not within bounds of the input vectors; index of -1 specifies an undefined value", Name)
+                            << args[i]->getSourceRange()),
+                           ret;
+            }
+            return context.getVectorType(ty->vec_ty, args.size() - 2);
+        }
+        case BI__builtin_convertvector:
+            if (args.size() != 1 || !convertTy)
+                return type_error(loc, "builtin function %I expect a vector and a type-name", Name), ret;
+            if (args[0]->ty->getKind() != TYVECTOR || convertTy->getKind() != TYVECTOR)
+                return type_error(loc, "%I requires vector arguments, %T and %T provided", Name, args[0]->ty, convertTy), ret;
+            if (args[0]->ty->vec_num_elems != convertTy->vec_num_elems)
+                return type_error(loc, "first two arguments to %I must have the same number of elements", Name), ret;
+            return convertTy;
+        default: return ret;
+        }
+    }
+    // element-wise conversion of a vector: the cast between the element types applied to the whole vector
+    Expr convert_vector(Expr e, CType to) {
+        CType from = e->ty->vec_ty, elem = to->vec_ty;
+        CastOp op;
+        if (from->isFloating() && elem->isFloating()) {
+            const uint64_t a = getsizeof(from), b = getsizeof(elem);
+            if (from->getFloatKind().asEnum() == elem->getFloatKind().asEnum())
+                return bit_cast(e, to);
+            if (a == b)
+                return type_error(e->getBeginLoc(), "unsupported conversion from %T to %T", e->ty, to), e;
+            op = a < b ? FPExt : FPTrunc;
+        } else if (from->isFloating()) {
+            op = elem->isSigned() ? FPToSI : FPToUI;
+        } else if (elem->isFloating()) {
+            op = from->isSigned() ? SIToFP : UIToFP;
+        } else {
+            const unsigned a = from->getIntegerKind().asLog2(), b = elem->getIntegerKind().asLog2();
+            if (a == b)
+                return bit_cast(e, to);
+            op = a > b ? Trunc : (from->isSigned() ? SExt : ZExt);
+        }
+        return make_cast(e, op, to);
+    }
+    // the memory order argument of an atomic builtin: converted to int, constant orders that are not valid for the operation are diagnosed.
+    // `invalidOrders` is a mask of (1 << memory_order), the codegen makes them seq_cst
+    void check_memory_order(Expr &e, unsigned invalidOrders) {
+        if (!checkInteger(e))
+            return (void)(type_error(e->getBeginLoc(), "memory order argument to atomic operation must be an integer, %T provided", e->ty) << e->getSourceRange());
+        e = castto(e, context.getInt(), Implict_Call);
+        if (const APInt *V = getIntegerConstant(e))
+            if (V->getZExtValue() > 5 || (invalidOrders & (1U << V->getZExtValue())))
+                warning(e->getBeginLoc(), "memory order argument to atomic operation is invalid") << e->getSourceRange();
+    }
+    // the generic __c11_atomic_* and __atomic_* builtins: the first argument points to the atomic object of type T, the values are converted
+    // to T and the memory orders to int(memory_order_relaxed = 0, ..., memory_order_seq_cst = 5).
+    // returns the type of the call, `ret` if `ID` is not one of them
+    CType check_atomic_builtin(unsigned ID, IdentRef Name, xvector<Expr> &args, CType ret, location_t loc) {
+        constexpr unsigned LoadInvalid = (1U << 3) | (1U << 4), StoreInvalid = (1U << 1) | (1U << 2) | (1U << 4);
+        enum {
+            Init,        // (T *, T)
+            Load,        // (T *, order) -> T
+            LoadCopy,    // (T *, T *ret, order)
+            Store,       // (T *, T, order)
+            StoreCopy,   // (T *, T *val, order)
+            RMW,         // (T *, T, order) -> T
+            XchgCopy,    // (T *, T *val, T *ret, order)
+            C11CmpXchg,  // (T *, T *expected, T desired, order success, order failure) -> bool
+            CmpXchgN,    // (T *, T *expected, T desired, bool weak, order success, order failure) -> bool
+            CmpXchgCopy, // (T *, T *expected, T *desired, bool weak, order success, order failure) -> bool
+        } form;
+        enum { Any, Arithmetic, Integer } operand = Any;
+        switch (ID) {
+        case BI__atomic_thread_fence:
+        case BI__atomic_signal_fence:
+        case BI__c11_atomic_thread_fence:
+        case BI__c11_atomic_signal_fence: check_memory_order(args[0], 0); return ret;
+        case BI__atomic_test_and_set: check_memory_order(args[1], 0); return ret;
+        case BI__atomic_clear: check_memory_order(args[1], StoreInvalid); return ret;
+        case BI__c11_atomic_init: form = Init; break;
+        case BI__c11_atomic_load:
+        case BI__atomic_load_n: form = Load; break;
+        case BI__atomic_load: form = LoadCopy; break;
+        case BI__c11_atomic_store:
+        case BI__atomic_store_n: form = Store; break;
+        case BI__atomic_store: form = StoreCopy; break;
+        case BI__c11_atomic_exchange:
+        case BI__atomic_exchange_n: form = RMW; break;
+        case BI__atomic_exchange: form = XchgCopy; break;
+        case BI__c11_atomic_compare_exchange_strong:
+        case BI__c11_atomic_compare_exchange_weak: form = C11CmpXchg; break;
+        case BI__atomic_compare_exchange_n: form = CmpXchgN; break;
+        case BI__atomic_compare_exchange: form = CmpXchgCopy; break;
+        case BI__c11_atomic_fetch_add:
+        case BI__c11_atomic_fetch_sub:
+        case BI__atomic_fetch_add:
+        case BI__atomic_fetch_sub:
+        case BI__atomic_add_fetch:
+        case BI__atomic_sub_fetch: form = RMW, operand = Arithmetic; break;
+        case BI__c11_atomic_fetch_and:
+        case BI__c11_atomic_fetch_or:
+        case BI__c11_atomic_fetch_xor:
+        case BI__c11_atomic_fetch_nand:
+        case BI__c11_atomic_fetch_max:
+        case BI__c11_atomic_fetch_min:
+        case BI__atomic_fetch_and:
+        case BI__atomic_fetch_or:
+        case BI__atomic_fetch_xor:
+        case BI__atomic_fetch_nand:
+        case BI__atomic_fetch_max:
+        case BI__atomic_fetch_min:
+        case BI__atomic_and_fetch:
+        case BI__atomic_or_fetch:
+        case BI__atomic_xor_fetch:
+        case BI__atomic_nand_fetch:
+        case BI__atomic_max_fetch:
+        case BI__atomic_min_fetch: form = RMW, operand = Integer; break;
+        default: return ret;
+        }
+        static const unsigned numArgs[] = {2, 2, 3, 3, 3, 3, 4, 5, 6, 6};
+        if (args.size() != numArgs[form])
+            return type_error(loc, "builtin function %I expect %u arguments, %u provided", Name, numArgs[form], (unsigned)args.size()), ret;
+        const bool isC11 = ID >= BI__c11_atomic_init && ID <= BI__c11_atomic_fetch_min;
+        CType PtrTy = args[0]->ty;
+        if (PtrTy->getKind() != TYPOINTER)
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin must be a pointer, %T provided", PtrTy) << args[0]->getSourceRange(), ret;
+        CType T = PtrTy->p;
+        if (isC11 && !T->hasTag(TYATOMIC))
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin must be a pointer to _Atomic type, %T provided", PtrTy) << args[0]->getSourceRange(), ret;
+        if (T->hasTag(TYCONST) && form != Load && form != LoadCopy)
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin cannot be const-qualified, %T provided", PtrTy) << args[0]->getSourceRange(), ret;
+        if (T->isIncomplete() || (T->getKind() == TYPRIM && T->isVoid()))
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin must be a pointer to a complete object type, %T provided", PtrTy) << args[0]->getSourceRange(), ret;
+        if (T->hasTag(TYCONST | TYVOLATILE | TYATOMIC | TYRESTRICT)) {
+            T = context.clone(T);
+            T->clearTags(TYCONST | TYVOLATILE | TYATOMIC | TYRESTRICT);
+        }
+        const bool isInteger = T->getKind() == TYPRIM && T->isInteger() && !T->isComplex();
+        const bool isScalar = isInteger || T->getKind() == TYPOINTER || (T->getKind() == TYPRIM && T->isFloating() && !T->isComplex());
+        const bool isCopy = form == LoadCopy || form == StoreCopy || form == XchgCopy || form == CmpXchgCopy;
+        if (!isScalar && !isCopy)
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin must be a pointer to integer, floating point or pointer, %T provided", PtrTy) << args[0]->getSourceRange(), ret;
+        if ((operand == Integer && !isInteger) || (operand == Arithmetic && !isInteger && T->getKind() != TYPOINTER))
+            return type_error(args[0]->getBeginLoc(), "address argument to atomic builtin must be a pointer to %s, %T provided",
+                              operand == Integer ? "integer" : "integer or pointer", PtrTy) << args[0]->getSourceRange(), ret;
+        const uint64_t size = getsizeof(T);
+        if (size > 16 || !llvm::isPowerOf2_64(size))
+            return type_error(args[0]->getBeginLoc(), "atomic operation on a type of size %u is not supported", (unsigned)size) << args[0]->getSourceRange(), ret;
+        // the value operands: T, or a pointer to T for the generic forms
+        auto checkPointer = [&](size_t i) {
+            if (args[i]->ty->getKind() != TYPOINTER)
+                type_error(args[i]->getBeginLoc(), "argument %u to atomic builtin must be a pointer, %T provided", (unsigned)i, args[i]->ty) << args[i]->getSourceRange();
+        };
+        auto convertValue = [&](size_t i) {
+            // atomic pointer arithmetic takes a ptrdiff_t
+            args[i] = castto(args[i], operand == Arithmetic && T->getKind() == TYPOINTER ? context.getSSize_t() : T, Implict_Call);
+        };
+        switch (form) {
+        case Init: convertValue(1); return context.getVoid();
+        case Load: check_memory_order(args[1], LoadInvalid); return T;
+        case LoadCopy: checkPointer(1); check_memory_order(args[2], LoadInvalid); return context.getVoid();
+        case Store: convertValue(1); check_memory_order(args[2], StoreInvalid); return context.getVoid();
+        case StoreCopy: checkPointer(1); check_memory_order(args[2], StoreInvalid); return context.getVoid();
+        case RMW: convertValue(1); check_memory_order(args[2], 0); return T;
+        case XchgCopy: checkPointer(1); checkPointer(2); check_memory_order(args[3], 0); return context.getVoid();
+        case C11CmpXchg:
+            checkPointer(1);
+            convertValue(2);
+            check_memory_order(args[3], 0);
+            check_memory_order(args[4], LoadInvalid);
+            return context.getBool();
+        case CmpXchgN:
+        case CmpXchgCopy:
+            checkPointer(1);
+            if (form == CmpXchgN)
+                convertValue(2);
+            else
+                checkPointer(2);
+            args[3] = castto(args[3], context.getBool(), Implict_Call);
+            check_memory_order(args[4], 0);
+            check_memory_order(args[5], LoadInvalid);
+            return context.getBool();
+        }
+        llvm_unreachable("invalid atomic builtin form");
+    }
+    // bit counting and byte swapping of integer constants, so they can be used in initializers of global variables
+    Expr fold_builtin_call(unsigned ID, const xvector<Expr> &args, CType ret, location_t loc, location_t endLoc) {
+        if (args.size() != 1)
+            return nullptr;
+        const APInt *V = getIntegerConstant(args[0]);
+        if (!V)
+            return nullptr;
+        uint64_t result;
+        switch (ID) {
+        case BI__builtin_clzs:
+        case BI__builtin_clz:
+        case BI__builtin_clzl:
+        case BI__builtin_clzll:
+            if (V->isZero())
+                return nullptr; // undefined, left to the code generator
+            result = V->countLeadingZeros();
+            break;
+        case BI__builtin_ctzs:
+        case BI__builtin_ctz:
+        case BI__builtin_ctzl:
+        case BI__builtin_ctzll:
+            if (V->isZero())
+                return nullptr;
+            result = V->countTrailingZeros();
+            break;
+        case BI__builtin_popcount:
+        case BI__builtin_popcountl:
+        case BI__builtin_popcountll:
+            result = V->countPopulation();
+            break;
+        case BI__builtin_bswap16:
+        case BI__builtin_bswap32:
+        case BI__builtin_bswap64:
+            return wrap(ret, context.createIntConstant(V->byteSwap()), loc, endLoc);
+        default:
+            return nullptr;
+        }
+        return wrap(ret, context.createIntConstant(APInt(ret->getBitWidth(), result)), loc, endLoc);
+    }
+    // checks the builtin functions that the type string cannot describe(the variadic ones and the ones with constant arguments)
+    void check_builtin_call(unsigned ID, IdentRef Name, xvector<Expr> &args, location_t loc) {
+        switch (ID) {
+        case BI__builtin_constant_p:
+            if (args.size() != 1)
+                type_error(loc, "builtin function %I expect 1 argument, %u provided", Name, (unsigned)args.size());
+            break;
+        case BI__builtin_assume_aligned:
+        {
+            if (args.size() > 3) {
+                type_error(loc, "too many arguments to builtin function %I: expect at most 3 arguments, %u provided", Name, (unsigned)args.size());
+                break;
+            }
+            if (args[1]->k != EConstant) {
+                type_error(args[1]->getBeginLoc(), "alignment of %I must be an integer constant expression", Name) << args[1]->getSourceRange();
+                break;
+            }
+            uint64_t align = force_eval(args[1]);
+            if (!llvm::isPowerOf2_64(align))
+                type_error(args[1]->getBeginLoc(), "requested alignment is not a power of 2") << args[1]->getSourceRange();
+            if (args.size() == 3 && !checkInteger(args[2]))
+                type_error(args[2]->getBeginLoc(), "offset of %I must be an integer, %T provided", Name, args[2]->ty) << args[2]->getSourceRange();
+            break;
+        }
+        case BI__builtin_prefetch:
+            if (args.size() > 3) {
+                type_error(loc, "too many arguments to builtin function %I: expect at most 3 arguments, %u provided", Name, (unsigned)args.size());
+                break;
             }
+            // __builtin_prefetch(addr, rw = 0, locality = 3)
+            for (size_t i = 1;i < args.size();++i) {
+                const uint64_t max = i == 1 ? 1 : 3;
+                if (args[i]->k != EConstant || !checkInteger(args[i])) {
+                    type_error(args[i]->getBeginLoc(), "argument %u to builtin function %I must be an integer constant expression", (unsigned)i + 1, Name) << args[i]->getSourceRange();
+                } else if (force_eval(args[i]) > max) {
+                    type_error(args[i]->getBeginLoc(), "argument %u to builtin function %I must be in range [0, %u]", (unsigned)i + 1, Name, (unsigned)max) << args[i]->getSourceRange();
+                }
+            }
+            break;
+        case BI__builtin_expect_with_probability:
+        {
+            const FloatConstant *CF = args[2]->k == EConstant ? dyn_cast<FloatConstant>(args[2]->C) : nullptr;
+            if (!CF) {
+                type_error(args[2]->getBeginLoc(), "probability argument to %I must be a constant floating-point expression", Name) << args[2]->getSourceRange();
+                break;
+            }
+            const double P = CF->getValue().convertToDouble();
+            if (!(P >= 0.0 && P <= 1.0))
+                type_error(args[2]->getBeginLoc(), "probability argument to %I is outside the range [0.0, 1.0]", Name) << args[2]->getSourceRange();
+            break;
+        }
+        case BI__builtin_add_overflow:
+        case BI__builtin_sub_overflow:
+        case BI__builtin_mul_overflow:
+        {
+            if (args.size() != 3) {
+                type_error(loc, "builtin function %I expect 3 arguments, %u provided", Name, (unsigned)args.size());
+                break;
+            }
+            for (size_t i = 0;i < 2;++i)
+                if (!checkInteger(args[i]))
+                    type_error(args[i]->getBeginLoc(), "operand argument to overflow builtin must be an integer, %T provided", args[i]->ty) << args[i]->getSourceRange();
+            CType ty = args[2]->ty;
+            if (!(ty->getKind() == TYPOINTER && checkInteger(ty->p) && !ty->p->isBool() && !ty->p->hasTag(TYCONST)))
+                type_error(args[2]->getBeginLoc(), "result argument to overflow builtin must be a pointer to a non-const integer, %T provided", ty) << args[2]->getSourceRange();
+            break;
+        }
+        default:
+            break;
         }
-        return ENEW(CallCompilerBuiltinCallExpr) {.ty = ty->ret, .cbc_args = callArgs, .cbc_type = ty, .cbc_name = Name, .cbc_ID = (Token)ID, .cbc_start_loc = range.getStart(), .cbc_end_loc = endLoc};
     }
     Expr llvm_builtin_call(IdentRef Name, SourceRange range) {
         StringRef NameStr = Name->getKey();
@@ -4042,12 +5343,12 @@ NEXT:
                     CType to = context.getIntTypeFromBitSize(ATW);
                     if (ATW > BTW) {
                         it = (it->k == EConstant)
-                                   ? wrap(to, (it->ty->isSigned() ? &llvm::ConstantExpr::getSExt : &llvm::ConstantExpr::getZExt)(it->C, PT, false), it->getBeginLoc(), it->getEndLoc())
+                                   ? wrap(to, fold_cast(it->ty->isSigned() ? SExt : ZExt, it->C, PT), it->getBeginLoc(), it->getEndLoc())
                                    : make_cast(it, it->ty->isSigned() ? SExt : ZExt, to);
                     } else { 
                         assert(ATW < BTW);
                         it = (it->k == EConstant)
-                            ? wrap(to, llvm::ConstantExpr::getTrunc(it->C, PT), it->getBeginLoc(), it->getEndLoc())
+                            ? wrap(to, fold_cast(Trunc, it->C, PT), it->getBeginLoc(), it->getEndLoc())
                             : make_cast(it, Trunc, to);
                     }
                 } else {
@@ -4073,16 +5374,15 @@ NEXT:
             case Prefix_U: ty = context.getChar32_t(); break;
             default: llvm_unreachable("bad encoding");
             }
-            result = wrap(ty, ConstantInt::get(getLLVMContext(), APInt(ty->getIntegerKind().getBitWidth(), l.tok.i)), loc,
+            result = wrap(ty, context.createIntConstant(APInt(ty->getIntegerKind().getBitWidth(), l.tok.i)), loc,
                           getEndLoc());
             consume();
         } break;
         case TStringLit: {
             location_t endLoc;
-            size_t strLength;
             enum StringPrefix enc;
-            llvm::Constant *C = parse_string_literal(strLength, endLoc, enc);
-            return createString(context.getStringType(enc), C, loc, endLoc);
+            const StringLiteralData *S = parse_string_literal(endLoc, enc);
+            return createString(context.getStringType(enc), S, loc, endLoc);
         } break;
         case PPNumber: {
             StringRef s = l.tok.getPPNumberLit();
@@ -4136,39 +5436,31 @@ NEXT:
                     return (type_error(loc, "typedefs are not allowed here %I", sym) << SourceRange(loc, endLoc)),
                            getIntZero();
                 it->tags |= USED;
-                CType ty = context.clone(it->ty);
-                // lvalue conversions
-                ty->lvalue_cast();
-                if (it->val) {
-                    if (it->tags & CONST_VAR) {
-                        ty->addTags(TYREPLACED_CONSTANT | TYLVALUE);
-                        return ENEW(ReplacedExpr){.ty = ty, .C = it->val, .id = idx, .ReplacedLoc = loc};
+                CType ty = it->ref_ty;
+                if (!ty) {
+                    ty = it->ty;
+                    // lvalue conversions
+                    if (ty->getTagsNoQualifiersAndStoragesAndFunctions() != ty->getTags()) {
+                        ty = context.clone(ty);
+                        ty->lvalue_cast();
                     }
+                    it->ref_ty = ty;
+                }
+                if (it->val) {
+                    if (it->tags & CONST_VAR)
+                        return ENEW(ReplacedExpr){.ty = ty, .C = it->val, .id = idx, .ReplacedLoc = loc};
                     return wrap(ty, it->val, loc, endLoc);
                 }
-                ty->addTag(TYLVALUE);
+                Expr var = ENEW(VarExpr){.flags = EF_LValue, .ty = ty, .sval = idx, .varName = sym, .varLoc = loc};
                 switch (ty->getKind()) {
-                case TYFUNCTION:
-                    result = unary(ENEW(VarExpr){.ty = ty, .sval = idx, .varName = sym, .varLoc = loc}, AddressOf,
-                                   context.getPointerType(ty));
-                    break;
+                case TYFUNCTION: result = unary(var, AddressOf, context.getPointerType(ty)); break;
                 case TYVLA:
-                    result = ENEW(ArrToAddressExpr){
-                        .ty = context.getPointerType(ty->vla_arraytype),
-                        .arr3 = ENEW(VarExpr){.ty = ty, .sval = idx, .varName = sym, .varLoc = loc}};
+                    result = ENEW(ArrToAddressExpr){.ty = context.getPointerType(ty->vla_arraytype), .arr3 = var};
                     break;
                 case TYARRAY:
-                    result = ENEW(ArrToAddressExpr){
-                        .ty = context.getArrayDecayedType(ty),
-                        .arr3 = ENEW(VarExpr){.ty = ty, .sval = idx, .varName = sym, .varLoc = loc}};
+                    result = ENEW(ArrToAddressExpr){.ty = context.getArrayDecayedType(ty), .arr3 = var};
                     break;
-                default:
-                    result = ENEW(VarExpr){
-                        .ty = ty,
-                        .sval = idx,
-                        .varName = sym,
-                        .varLoc = loc,
-                    };
+                default: result = var;
                 }
             }
         } break;
@@ -4185,7 +5477,7 @@ NEXT:
                 Ptr[0] = loc;
                 Ptr[1] = endLoc;
             } else {
-                if (result->ty->hasTag(TYREPLACED_CONSTANT)) {
+                if (result->isReplacedConstant()) {
                     location_t *const Ptr = reinterpret_cast<ReplacedExprParen *>(result)->paren_loc;
                     Ptr[0] = loc;
                     Ptr[1] = endLoc;
@@ -4251,14 +5543,14 @@ GENERIC_END:
                 warning(loc, "predefined identifier is only valid inside function");
                 return createString(
                     context.stringty,
-                    enc::getUTF8(StringRef("", 1), getLLVMContext()),
+                    context.createStringLiteral(StringRef("", 1)),
                     loc,
                     endLoc
                 );
             }
             SmallString<64> Str = sema.pfunc->getKey();
             Str.push_back(0);
-            return createString(context.stringty, enc::getUTF8(Str.str(), getLLVMContext()), loc, endLoc);
+            return createString(context.stringty, context.createStringLiteral(Str.str()), loc, endLoc);
         }
         case K__PRETTY_FUNCTION__: {
             location_t endLoc = getEndLoc();
@@ -4267,7 +5559,7 @@ GENERIC_END:
                 warning(loc, "predefined identifier is only valid inside function");
                 return createString(
                     context.stringty,
-                    enc::getUTF8(StringRef("top level", 10), getLLVMContext()),
+                    context.createStringLiteral(StringRef("top level", 10)),
                     loc,
                     endLoc
                 );
@@ -4278,7 +5570,7 @@ GENERIC_END:
             Str.push_back(0);
             return createString(
                 context.stringty,
-                enc::getUTF8(Str.str(), getLLVMContext()),
+                context.createStringLiteral(Str.str()),
                 loc,
                 endLoc
             );
@@ -4304,22 +5596,22 @@ GENERIC_END:
                     warning(loc, "predefined identifier is only valid inside function");
                     return createString(
                         context.stringty,
-                        enc::getUTF8(StringRef("", 1), getLLVMContext()),
+                        context.createStringLiteral(StringRef("", 1)),
                         loc,
                         endLoc
                     );
                 }
                 SmallString<64> Str = sema.pfunc->getKey();
                 Str.push_back(0);
-                return createString(context.stringty, enc::getUTF8(Str.str(), getLLVMContext()), loc, endLoc);
+                return createString(context.stringty, context.createStringLiteral(Str.str()), loc, endLoc);
             }
             case K__builtin_LINE:
                 return wrap(context.getInt(),
-                            ConstantInt::get(llvmTypeCache.integer_types[context.getIntLog2()], SM().getLineNumber(loc)), loc,
+                            context.createIntConstant(APInt(context.getInt()->getBitWidth(), SM().getLineNumber(loc))), loc,
                             endLoc);
             case K__builtin_COLUMN:
                 return wrap(context.getInt(),
-                            ConstantInt::get(llvmTypeCache.integer_types[context.getIntLog2()], SM().getColumnNumber(loc)), loc,
+                            context.createIntConstant(APInt(context.getInt()->getBitWidth(), SM().getColumnNumber(loc))), loc,
                             endLoc);
             case K__builtin_FILE:
             {
@@ -4327,7 +5619,7 @@ GENERIC_END:
                 Str.push_back(0);
                 return createString(
                     context.stringty,
-                    enc::getUTF8(Str.str(), getLLVMContext()),
+                    context.createStringLiteral(Str.str()),
                     loc,
                     endLoc
                 );
@@ -4382,7 +5674,7 @@ DOT:
                             << result->getSourceRange();
                         return result;
                     }
-                    isLvalue = ty->hasTag(TYLVALUE);
+                    isLvalue = result->isLValue();
                 }
                 if (!(ty->isAgg() && !ty->isEnum())) {
                     type_error(opLoc, "member access is not struct or union") << result->getSourceRange();
@@ -4391,27 +5683,29 @@ DOT:
                 IdentRef FieldName = l.tok.s;
                 location_t mem_loc_end = getEndLoc();
                 consume();
-                xvector<unsigned> idxs = xvector<unsigned>::get_with_capacity(1);
+                SmallVector<unsigned, 4> idxs;
                 CType memberTy = ty->getFieldIndex(FieldName, idxs);
                 if (idxs.empty())
                     type_error("no member named '%R' in %T", FieldName, ty);
-                if (isLvalue) {
-                    memberTy = context.clone(memberTy);
-                    memberTy->addTag(TYLVALUE);
-                }
-                return ENEW(MemberAccessExpr) {.ty = memberTy, .obj = result, .idxs = idxs, .memberEndLoc = mem_loc_end};
+                result = ENEW(MemberAccessExpr) {.ty = memberTy,
+                                                 .obj = result,
+                                                 .idxs = xvector<unsigned>::get_frozen(idxs, getAllocator()),
+                                                 .memberEndLoc = mem_loc_end};
+                if (isLvalue)
+                    result->flags = memberTy && memberTy->getKind() == TYBITFIELD ? EF_LValue | EF_BitField : EF_LValue;
             } break;
             case TLbracket: // function call
             {
                 CType ty = (result->k == EUnary && result->uop == AddressOf)
                                ? result->ty->p
                                : ((result->ty->getKind() == TYPOINTER) ? result->ty->p : result->ty);
-                result = ENEW(CallExpr){.ty = ty->ret, .callfunc = result, .callargs = xvector<Expr>::get()};
+                result = ENEW(CallExpr){.ty = ty->ret, .callfunc = result, .callargs = xvector<Expr>::get_null()};
                 if (ty->getKind() != TYFUNCTION)
                     return type_error(getLoc(), "expect function or function pointer, but the expression has type %T",
                                       ty),
                            nullptr;
                 consume();
+                SmallVector<Expr, 8> args;
                 if (l.tok.tok == TRbracket)
                     consume();
                 else {
@@ -4419,7 +5713,7 @@ DOT:
                         Expr e = assignment_expression();
                         if (!e)
                             return nullptr;
-                        result->callargs.push_back(e);
+                        args.push_back(e);
                         if (l.tok.tok == TComma)
                             consume();
                         else if (l.tok.tok == TRbracket) {
@@ -4429,6 +5723,7 @@ DOT:
                         }
                     }
                 }
+                result->callargs = xvector<Expr>::get_frozen(args, getAllocator());
                 auto &params = ty->params;
                 if (ty->isVarArg) {
                     if (result->callargs.size() < params.size())
@@ -4466,7 +5761,17 @@ DOT:
                 consume();
                 if (!(rhs = expression()))
                     return result;
-                if (result->ty->getKind() != TYPOINTER && rhs->ty->getKind() != TYPOINTER) {
+                if (result->ty->getKind() == TYVECTOR) {
+                    // an element of a vector: extractelement, or insertelement if it is assigned
+                    if (!checkInteger(rhs)) {
+                        type_error(rhs->getBeginLoc(), "array subscript is not an integer") << rhs->getSourceRange();
+                    } else {
+                        Expr e = ENEW(SubscriptExpr){.ty = result->ty->vec_ty, .left = result, .right = rhs};
+                        if (result->isLValue())
+                            e->flags = EF_LValue;
+                        result = e;
+                    }
+                } else if (result->ty->getKind() != TYPOINTER && rhs->ty->getKind() != TYPOINTER) {
                     type_error(getLoc(), "subscripted value is not an array, pointer, or vector");
                 } else {
                     result = make_add_pointer(result, rhs);
@@ -4494,70 +5799,55 @@ DOT:
         if (e->ty->p->isIncomplete())
             return (void)type_error(loc, "dereference from incomplete/void type: %T", e->ty);
         if (e->k == EConstantArraySubstript) {
-            llvm::Constant *C = e->array;
-            if (auto CS = dyn_cast<llvm::ConstantDataSequential>(C)) {
-                const unsigned numops = CS->getNumElements();
-                if (e->cidx >= numops)
-                    warning(loc, "array index %u is past the end of the array (which contains %u elements)", e->cidx,
-                            numops);
-                else
-                    return (void)(e = wrap(e->ty->p, CS->getElementAsConstant(e->cidx), e->getBeginLoc(),
-                                           e->getEndLoc()));
-
-            } else if (llvm::ConstantAggregate *CA = dyn_cast<llvm::ConstantAggregate>(C)) {
-                const unsigned numops = CA->getNumOperands();
-                if (e->cidx >= numops)
-                    warning(loc, "array index %u is past the end of the array (which contains %u elements)", e->cidx, numops);
-                else
-                    return (void)(e = wrap(e->ty->p, CA->getOperand(e->cidx), e->getBeginLoc(), e->getEndLoc()));
-            }
+            const StringLiteralData *S = e->array;
+            const unsigned numops = S->numElements;
+            if (e->cidx >= numops)
+                warning(loc, "array index %u is past the end of the array (which contains %u elements)", e->cidx,
+                        numops);
+            else
+                return (void)(e = wrap(e->ty->p, context.createIntConstant(APInt(e->ty->p->getIntegerKind().getBitWidth(), S->getElement(e->cidx))), e->getBeginLoc(),
+                                       e->getEndLoc()));
         }
-        CType ty = context.clone(e->ty->p);
-        ty->addTag(TYLVALUE);
-        e = unary(e, Dereference, ty);
+        e = unary(e, Dereference, e->ty->p);
+        e->flags = EF_LValue;
     }
     Expr getCBool(bool b) { return b ? ctrue : cfalse; }
     Expr getBool(bool b) { return b ? getIntOne() : getIntZero(); }
     void foldBool(Expr &e, bool reverse = false) {
-        llvm::Constant *C = e->C;
-        switch (C->getValueID()) {
-        case llvm::Value::ConstantIntVal: {
-            const auto CI = cast<ConstantInt>(C);
+        const ConstantValue *C = e->C;
+        switch (C->kind) {
+        case ConstantValue::CK_Int: {
+            const auto CI = cast<IntConstant>(C);
             e = getBool(reverse ? CI->isZero() : !CI->isZero());
         } break;
-        case llvm::Value::ConstantFPVal: {
-            const auto CFP = cast<ConstantFP>(C);
+        case ConstantValue::CK_Float: {
+            const auto CFP = cast<FloatConstant>(C);
             e = getBool(reverse ? CFP->isZero() : CFP->getValue().isNonZero());
         } break;
-        case llvm::Value::UndefValueVal:
-        case llvm::Value::PoisonValueVal: {
+        case ConstantValue::CK_Undef: {
             /* TODO: undefined value is true/false ? */
         } break;
-        case llvm::Value::ConstantStructVal: {
-            const auto CT = cast<llvm::ConstantStruct>(C);
-            assert(CT->getNumOperands() == 2 && "bad complex constant!");
-            const auto O0 = CT->getOperand(0), O1 = CT->getOperand(1);
-            if (const auto CI1 = dyn_cast<ConstantInt>(O0)) {
-                const auto CI2 = cast<ConstantInt>(O1);
+        case ConstantValue::CK_Complex: {
+            const auto CT = cast<ComplexConstant>(C);
+            const auto O0 = CT->real, O1 = CT->imag;
+            if (const auto CI1 = dyn_cast<IntConstant>(O0)) {
+                const auto CI2 = cast<IntConstant>(O1);
                 bool c = !CI1->isZero() || !CI2->isZero();
                 if (reverse)
                     c = !c;
                 e = getBool(c);
             } else {
-                const auto CF1 = cast<ConstantFP>(O0);
-                const auto CF2 = cast<ConstantFP>(O1);
+                const auto CF1 = cast<FloatConstant>(O0);
+                const auto CF2 = cast<FloatConstant>(O1);
                 bool c = !CF1->isZero() || !CF2->isZero();
                 if (reverse)
                     c = !c;
                 e = getBool(c);
             }
         } break;
-        case llvm::Value::ConstantAggregateZeroVal: {
-            assert((e->ty->isComplex()) && "only complex number/structures are able to convert to bool");
-            e = getBool(reverse);
-        } break;
-        case llvm::Value::ConstantPointerNullVal: {
-            e = getBool(reverse);
+        case ConstantValue::CK_Pointer: {
+            if (cast<PointerConstant>(C)->isNull())
+                e = getBool(reverse);
         } break;
         default: break;
         }
@@ -4569,23 +5859,76 @@ DOT:
             return nullptr;
         if (e->k != EConstant)
             return type_error(loc, "case value is not a integer constant expression"), nullptr;
-        if (auto CI = dyn_cast<ConstantInt>(e->C)) {
+        if (auto CI = dyn_cast<IntConstant>(e->C)) {
             CType to = sema.currentswitch->itest->ty;
             auto rA = to->getIntegerKind().getBitWidth();
             auto rB = e->ty->getIntegerKind().getBitWidth();
             if (rA < rB) {
-                auto NEW_CI = ConstantInt::get(getLLVMContext(), CI->getValue().trunc(rA));
+                auto NEW_CI = context.createIntConstant(CI->getValue().trunc(rA));
                 if (NEW_CI->getValue() != CI->getValue())
                     warning(loc, "overflow converting case value to switch condition type (%A to %A)", &CI->getValue(),
                             &NEW_CI->getValue());
                 CI = NEW_CI;
             } else if (rA > rB) {
-                CI = ConstantInt::get(getLLVMContext(), e->ty->isSigned() ? CI->getValue().sext(rA) : CI->getValue().zext(rA));
+                CI = context.createIntConstant(e->ty->isSigned() ? CI->getValue().sext(rA) : CI->getValue().zext(rA));
             }
             return &CI->getValue();
         }
         return type_error(loc, "statement requires expression of integer type (%T invalid)", e->ty), nullptr;
     }
+    // report duplicate case values and overlapping case ranges of a switch statement.
+    // all cases are sorted by their first value, then a sweep compares each case with the furthest end seen so far,
+    // so this is O(n log n) in the number of cases(and ranges).
+    bool check_switch_cases(Stmt sw) {
+        struct CaseInterval {
+            const APInt *lo;
+            APInt hi;
+            const SwitchCase *S;
+            bool isRange;
+        };
+        const bool isSigned = sw->itest->ty->isSigned();
+        const auto less = [isSigned](const APInt &A, const APInt &B) { return isSigned ? A.slt(B) : A.ult(B); };
+        SmallVector<CaseInterval, 0> cases;
+        cases.reserve(sw->switchs.size() + sw->gnu_switchs.size());
+        for (const SwitchCase &S : sw->switchs)
+            cases.push_back(CaseInterval{.lo = S.CaseStart, .hi = *S.CaseStart, .S = &S, .isRange = false});
+        for (const GNUSwitchCase &G : sw->gnu_switchs)
+            cases.push_back(CaseInterval{.lo = G.CaseStart, .hi = *G.CaseStart + G.range, .S = &G, .isRange = true});
+        // ties are broken by source location, so the first case written is reported as the previous one
+        llvm::sort(cases, [&less](const CaseInterval &A, const CaseInterval &B) {
+            if (less(*A.lo, *B.lo))
+                return true;
+            if (less(*B.lo, *A.lo))
+                return false;
+            return A.S->loc < B.S->loc;
+        });
+        size_t furthest = 0;
+        for (size_t i = 1; i < cases.size(); ++i) {
+            const CaseInterval &B = cases[i], &A = cases[furthest];
+            if (less(A.hi, *B.lo)) {
+                if (less(A.hi, B.hi))
+                    furthest = i;
+                continue;
+            }
+            // A and B overlaps
+            location_t startLoc = A.S->loc, endLoc = B.S->loc;
+            if (startLoc > endLoc)
+                std::swap(startLoc, endLoc);
+            if (!A.isRange && !B.isRange) {
+                type_error(endLoc, "duplicate case value %A", B.lo);
+            } else if (A.isRange && B.isRange) {
+                type_error(endLoc, "duplicate (or overlapping) case range: (%A - %A) and (%A - %A)", A.lo, &A.hi, B.lo,
+                           &B.hi);
+            } else {
+                const CaseInterval &One = A.isRange ? B : A, &Range = A.isRange ? A : B;
+                type_error(endLoc, "duplicate (or overlapping) case value %A in range (%A - %A)", One.lo, Range.lo,
+                           &Range.hi);
+            }
+            note(startLoc, "previous case defined here");
+            return false;
+        }
+        return true;
+    }
     void valid_condition(Expr &e, bool reverse = false) {
         if (!e->ty->isScalar()) {
             type_error(e->getBeginLoc(), "conditions requires a scalar expression");
@@ -4631,7 +5974,7 @@ DOT:
         if (!sreachable) return;
         label_t thenBB = jumper.createLabel();
         if (test->k == EConstant) {
-            if (auto CI = dyn_cast<ConstantInt>(test->C)) {
+            if (auto CI = dyn_cast<IntConstant>(test->C)) {
                 insertBr(CI->isZero() ? thenBB : dst);
                 goto NEXT;
             }
@@ -4640,22 +5983,334 @@ DOT:
 NEXT:
         return insertLabel(thenBB);
     }
-    void jumpIfFalse(Expr test, label_t dst) {
-        if (!sreachable) return;
+    // returns the inserted CondJumpStmt, or nullptr if the test is folded
+    Stmt jumpIfFalse(Expr test, label_t dst, enum BranchHint hint = BH_None) {
+        if (!sreachable) return nullptr;
         label_t thenBB = jumper.createLabel();
+        Stmt s = nullptr;
         if (test->k == EConstant) {
-            if (auto CI = dyn_cast<ConstantInt>(test->C)) {
+            if (auto CI = dyn_cast<IntConstant>(test->C)) {
                 insertBr(CI->isZero() ? dst : thenBB);
                 goto NEXT;
             }
         }
-        insertStmtInternal(SNEW(CondJumpStmt){.test = test, .T = thenBB, .F = dst});
+        insertStmtInternal(s = SNEW(CondJumpStmt){.test = test, .T = thenBB, .F = dst, .hint = hint});
 NEXT:
-        return insertLabel(thenBB);
+        insertLabel(thenBB);
+        return s;
     }
-    void condJump(Expr test, label_t T, label_t F) {
+    void condJump(Expr test, label_t T, label_t F, enum BranchHint hint = BH_None) {
         if (sreachable)
-            insertStmtInternal(SNEW(CondJumpStmt){.test = test, .T = T, .F = F});
+            insertStmtInternal(SNEW(CondJumpStmt){.test = test, .T = T, .F = F, .hint = hint});
+    }
+    static bool isAttributeName(Token tok) { return tok == TIdentifier || (tok >= kw_start && tok <= kw_end); }
+    // the name of an attribute, keywords like `const` are valid attribute names
+    StringRef attributeName() const { return l.tok.tok == TIdentifier ? l.tok.s->getKey() : StringRef(show(l.tok.tok)); }
+    // skip a balanced `( ... )` argument clause
+    bool skip_attribute_args() {
+        for (unsigned depth = 0;;) {
+            if (l.tok.tok == TEOF)
+                return parse_error(getLoc(), "unterminated attribute argument list"), false;
+            if (l.tok.tok == TLbracket)
+                ++depth;
+            else if (l.tok.tok == TRbracket && !--depth)
+                break;
+            consume();
+        }
+        consume();
+        return true;
+    }
+    // the `("string")` argument of an attribute, the string is copied into the arena
+    bool attribute_string_arg(StringRef Name, location_t loc, StringRef &result) {
+        if (l.tok.tok != TLbracket)
+            return type_error(loc, "'%R' attribute requires a string", Name), true;
+        consume();
+        if (l.tok.tok != TStringLit)
+            return expect(getLoc(), "string literal"), false;
+        location_t endLoc;
+        parse_string_literal_data(endLoc, l.tok.getStringPrefix());
+        result = parseLiteralCache.str().copy(getAllocator());
+        parseLiteralCache.clear();
+        if (l.tok.tok != TRbracket)
+            return expectRB(getLoc()), false;
+        consume();
+        return true;
+    }
+    // an attribute in a GNU or C23 attribute list, the name is consumed, and its arguments(if any) are parsed here.
+    // returns false on parse error.
+    bool attribute(StringRef Name, location_t loc, DeclAttributes &A) {
+        Name.consume_front("__");
+        Name.consume_back("__");
+        const uint32_t flag = llvm::StringSwitch<uint32_t>(Name)
+                                  .Case("always_inline", DeclAttributes::AlwaysInline)
+                                  .Case("noinline", DeclAttributes::NoInline)
+                                  .Case("hot", DeclAttributes::Hot)
+                                  .Case("cold", DeclAttributes::Cold)
+                                  .Case("flatten", DeclAttributes::Flatten)
+                                  .Case("pure", DeclAttributes::Pure)
+                                  .Case("const", DeclAttributes::Const)
+                                  .Case("malloc", DeclAttributes::Malloc)
+                                  .Case("packed", DeclAttributes::Packed)
+                                  .Case("used", DeclAttributes::Used)
+                                  .Case("weak", DeclAttributes::Weak)
+                                  .Cases("noreturn", "_Noreturn", DeclAttributes::NoReturn)
+                                  .Cases("unused", "maybe_unused", DeclAttributes::Unused)
+                                  .Case("likely", DeclAttributes::Likely)
+                                  .Case("unlikely", DeclAttributes::Unlikely)
+                                  .Default(0);
+        if (flag) {
+            if ((flag == DeclAttributes::Likely && A.has(DeclAttributes::Unlikely)) ||
+                (flag == DeclAttributes::Unlikely && A.has(DeclAttributes::Likely)))
+                type_error(loc, "conflicting attributes 'likely' and 'unlikely'");
+            A.flags |= flag;
+            if (l.tok.tok != TLbracket)
+                return true;
+            warning(loc, "'%R' attribute takes no arguments", Name);
+            return skip_attribute_args();
+        }
+        if (Name == "aligned") {
+            uint64_t a = 16; // __BIGGEST_ALIGNMENT__
+            if (l.tok.tok == TLbracket) {
+                consume();
+                Expr e = constant_expression();
+                if (!e)
+                    return false;
+                a = force_eval(e);
+                if (l.tok.tok != TRbracket)
+                    return expectRB(getLoc()), false;
+                consume();
+            }
+            if (!llvm::isPowerOf2_64(a))
+                type_error(loc, "requested alignment is not a power of 2");
+            else if (a > (uint64_t(1) << 29))
+                type_error(loc, "requested alignment must be %u bytes or smaller", 1U << 29);
+            else
+                A.align = std::max<uint32_t>(A.align, a);
+            return true;
+        }
+        if (Name == "vector_size") {
+            if (l.tok.tok != TLbracket)
+                return type_error(loc, "'vector_size' attribute requires an argument"), true;
+            consume();
+            Expr e = constant_expression();
+            if (!e)
+                return false;
+            const uint64_t N = force_eval(e);
+            if (N == 0)
+                type_error(loc, "zero vector size");
+            else if (N > (uint64_t(1) << 20))
+                type_error(loc, "vector size too large");
+            else
+                A.vector_size = N; // the element type is checked when the attribute is applied
+            if (l.tok.tok != TRbracket)
+                return expectRB(getLoc()), false;
+            consume();
+            return true;
+        }
+        if (Name == "section")
+            return attribute_string_arg(Name, loc, A.section);
+        if (Name == "alias") {
+            A.aliasLoc = loc;
+            return attribute_string_arg(Name, loc, A.alias);
+        }
+        if (Name == "visibility") {
+            StringRef V;
+            if (!attribute_string_arg(Name, loc, V))
+                return false;
+            const auto vis = llvm::StringSwitch<enum DeclAttributes::Visibility>(V)
+                                 .Case("default", DeclAttributes::VisibilityDefault)
+                                 .Cases("hidden", "internal", DeclAttributes::VisibilityHidden)
+                                 .Case("protected", DeclAttributes::VisibilityProtected)
+                                 .Default(DeclAttributes::VisibilityUnspecified);
+            if (vis == DeclAttributes::VisibilityUnspecified)
+                type_error(loc, "unknown visibility '%R'", V);
+            else
+                A.visibility = vis;
+            return true;
+        }
+        if (Name == "nonnull") {
+            // without arguments, all pointer parameters are nonnull
+            if (l.tok.tok != TLbracket) {
+                A.nonnull = ~uint64_t(0);
+                return true;
+            }
+            consume();
+            for (;;) {
+                Expr e = constant_expression();
+                if (!e)
+                    return false;
+                uint64_t i = force_eval(e);
+                if (i == 0 || i > 64)
+                    type_error(e->getBeginLoc(), "'nonnull' attribute parameter %u is out of bounds", unsigned(i));
+                else
+                    A.nonnull |= uint64_t(1) << (i - 1);
+                if (l.tok.tok != TComma)
+                    break;
+                consume();
+            }
+            if (l.tok.tok != TRbracket)
+                return expectRB(getLoc()), false;
+            consume();
+            return true;
+        }
+        if (Name == "optimize") {
+            if (l.tok.tok != TLbracket)
+                return type_error(loc, "'optimize' attribute requires an argument"), true;
+            consume();
+            for (;;) {
+                if (l.tok.tok == TStringLit) {
+                    location_t endLoc;
+                    parse_string_literal_data(endLoc, l.tok.getStringPrefix());
+                    const auto O = DeclAttributes::parseOptimize(parseLiteralCache.str());
+                    // other options like "-funroll-loops" are per translation unit in LLVM
+                    if (O == DeclAttributes::OptimizeUnspecified)
+                        warning(loc, "bad option '%R' to attribute 'optimize' ignored", parseLiteralCache.str());
+                    else
+                        A.optimize = O;
+                    parseLiteralCache.clear();
+                } else {
+                    Expr e = constant_expression();
+                    if (!e)
+                        return false;
+                    A.optimize = DeclAttributes::getOptimizeLevel(force_eval(e));
+                }
+                if (l.tok.tok != TComma)
+                    break;
+                consume();
+            }
+            if (l.tok.tok != TRbracket)
+                return expectRB(getLoc()), false;
+            consume();
+            return true;
+        }
+        // attributes accepted for compatibility, they have no effect on the generated code
+        const bool known = llvm::StringSwitch<bool>(Name)
+                               .Cases("deprecated", "nodiscard", "warn_unused_result", "fallthrough", true)
+                               .Cases("format", "format_arg", "nothrow", "leaf", "sentinel", true)
+                               .Cases("artificial", "gnu_inline", "may_alias", "alloc_size", "returns_nonnull", true)
+                               .Cases("nonstring", "access", "warning", "error", "unavailable", true)
+                               .Cases("no_instrument_function", "externally_visible", "reproducible", "unsequenced", true)
+                               .Default(false);
+        if (!known)
+            warning(loc, "unknown attribute '%R' ignored", Name);
+        return l.tok.tok == TLbracket ? skip_attribute_args() : true;
+    }
+    // GNU attributes: `__attribute__((name, name(args), ...))`, may be repeated.
+    bool gnu_attributes(DeclAttributes &A) {
+        while (l.tok.tok == K__attribute) {
+            consume();
+            if (l.tok.tok != TLbracket)
+                return expectLB(getLoc()), false;
+            consume();
+            if (l.tok.tok != TLbracket)
+                return expectLB(getLoc()), false;
+            consume();
+            while (l.tok.tok != TRbracket) {
+                // empty attributes are allowed: `__attribute__((,))`
+                if (l.tok.tok == TComma) {
+                    consume();
+                    continue;
+                }
+                if (!isAttributeName(l.tok.tok))
+                    return parse_error(getLoc(), "expect attribute name"), false;
+                location_t loc = getLoc();
+                StringRef Name = attributeName();
+                consume();
+                if (!attribute(Name, loc, A))
+                    return false;
+                if (l.tok.tok == TComma)
+                    consume();
+                else if (l.tok.tok != TRbracket)
+                    return expect(getLoc(), "',' or ')' in attribute list"), false;
+            }
+            consume();
+            if (l.tok.tok != TRbracket)
+                return expectRB(getLoc()), false;
+            consume();
+        }
+        return true;
+    }
+    // C23 attributes: `[[name, prefix::name(args), ...]]`, may be repeated.
+    // the gnu:: and clang:: prefixes are the same as no prefix, attributes of other vendors are ignored.
+    bool c23_attributes(DeclAttributes &A) {
+        while (l.tok.tok == TLSquareBrackets) {
+            consume();
+            if (l.tok.tok != TLSquareBrackets)
+                return parse_error(getLoc(), "expect '[[' to start an attribute specifier"), false;
+            consume();
+            while (l.tok.tok != TRSquareBrackets) {
+                if (l.tok.tok == TComma) {
+                    consume();
+                    continue;
+                }
+                if (!isAttributeName(l.tok.tok))
+                    return parse_error(getLoc(), "expect attribute name"), false;
+                location_t loc = getLoc();
+                StringRef Name = attributeName();
+                bool known = true;
+                consume();
+                // attribute-prefix :: attribute-name
+                if (l.tok.tok == TColon) {
+                    consume();
+                    if (l.tok.tok != TColon)
+                        return parse_error(getLoc(), "expect '::' after attribute prefix"), false;
+                    consume();
+                    if (!isAttributeName(l.tok.tok))
+                        return parse_error(getLoc(), "expect attribute name after '::'"), false;
+                    known = Name == "clang" || Name == "gnu";
+                    Name = attributeName();
+                    consume();
+                }
+                if (known) {
+                    if (!attribute(Name, loc, A))
+                        return false;
+                } else {
+                    warning(loc, "unknown attribute '%R' ignored", Name);
+                    if (l.tok.tok == TLbracket && !skip_attribute_args())
+                        return false;
+                }
+                if (l.tok.tok == TComma)
+                    consume();
+                else if (l.tok.tok != TRSquareBrackets)
+                    return parse_error(getLoc(), "expect ',' or ']]' in attribute list"), false;
+            }
+            consume();
+            if (l.tok.tok != TRSquareBrackets)
+                return parse_error(getLoc(), "expect ']]' to end an attribute specifier"), false;
+            consume();
+        }
+        return true;
+    }
+    // any sequence of GNU and C23 attributes
+    bool attributes(DeclAttributes &A) {
+        while (l.tok.tok == K__attribute || l.tok.tok == TLSquareBrackets)
+            if (!(l.tok.tok == K__attribute ? gnu_attributes(A) : c23_attributes(A)))
+                return false;
+        return true;
+    }
+    // GNU attributes in a place where they have no meaning(e.g. struct members, casts)
+    void ignored_attributes() {
+        DeclAttributes A;
+        location_t loc = getLoc();
+        if (!gnu_attributes(A))
+            return;
+        A.flags &= ~DeclAttributes::Unused;
+        if (!A.empty())
+            warning(loc, "attributes ignored here");
+    }
+    // C23 attributes before a statement, only [[likely]] and [[unlikely]] have a meaning
+    enum BranchHint statement_attributes() {
+        DeclAttributes A;
+        c23_attributes(A);
+        if (A.has(DeclAttributes::Likely))
+            return BH_Likely;
+        if (A.has(DeclAttributes::Unlikely))
+            return BH_Unlikely;
+        return BH_None;
+    }
+    // the hint for the statement that follows, which is the target of a branch
+    enum BranchHint branch_hint() {
+        return l.tok.tok == TLSquareBrackets ? statement_attributes() : BH_None;
     }
     void insertBr(label_t L) { 
         if (sreachable)
@@ -4705,8 +6360,17 @@ NEXT:
         current_stmt_loc = loc;
         switch (l.tok.tok) {
         case TSemicolon: return consume();
-        case Kasm: return parse_asm(), checkSemicolon();
+        case Kasm: return parse_asm();
         case TLcurlyBracket: return compound_statement();
+        case K__attribute: return declaration(); // e.g. `__attribute__((fallthrough));`
+        case TLSquareBrackets: {
+            DeclAttributes A;
+            if (!c23_attributes(A))
+                return;
+            if (istype())
+                return declaration(&A);
+            return statement();
+        }
         case Kcase: {
             const APInt *CaseStart = nullptr, *CaseEnd = nullptr;
             consume();
@@ -4730,7 +6394,7 @@ NEXT:
 ONE_CASE:
                             sema.currentswitch->switchs.push_back(SwitchCase(loc, L, CaseStart));
                         } else {
-                            if (CaseStart->ugt(*CaseEnd))
+                            if (sema.currentswitch->itest->ty->isSigned() ? CaseStart->sgt(*CaseEnd) : CaseStart->ugt(*CaseEnd))
                                 warning(loc, "empty case range specified");
                             else if (*CaseStart == *CaseEnd) {
                                 goto ONE_CASE;
@@ -4816,7 +6480,7 @@ ONE_CASE:
                 if (!sema.currentfunction->ret->isVoid()) {
                     type_error(loc, "function should not return void in a function return %T",
                                sema.currentfunction->ret);
-                    ret = wrap(sema.currentfunction->ret, llvm::UndefValue::get(llvmTypeCache.wrap(sema.currentfunction->ret)),
+                    ret = wrap(sema.currentfunction->ret, context.getUndefConstant(),
                                loc, loc);
                 }
                 insertStmt(SNEW(ReturnStmt) {.ret = ret, .ret_loc = loc});
@@ -4871,47 +6535,8 @@ ONE_CASE:
                 }
                 insertLabel(LEAVE);
                 // clang::Sema::ActOnFinishSwitchStmt
-                std::stable_sort(sw->switchs.begin(), sw->switchs.end(), SwitchCase::equals);
-                for (unsigned i = 1; i < sw->switchs.size(); ++i) {
-                    const SwitchCase &A = sw->switchs[i], &B = sw->switchs[i - 1];
-                    if (SwitchCase::equals(A, B)) {
-                        type_error(A.loc, "duplicate case value %A", A.CaseStart);
-                        note(B.loc, "previous case defined here");
-                        return;
-                    }
-                }
-                // this method may be slow if GNU switchs are many.
-                for (unsigned i = 0; i < sw->gnu_switchs.size(); ++i) {
-                    const GNUSwitchCase &G = sw->gnu_switchs[i];
-                    for (unsigned j = 0; j < sw->switchs.size(); ++j) {
-                        const SwitchCase &A = sw->switchs[i];
-                        if (G.contains(A)) {
-                            location_t startLoc = A.loc, endLoc = G.loc;
-                            if (startLoc > endLoc)
-                                std::swap(startLoc, endLoc);
-                            const APInt sw_end = *G.CaseStart + G.range;
-                            type_error(endLoc, "duplicate (or overlapping) case value %A in range (%A - %A)",
-                                       A.CaseStart, G.CaseStart, &sw_end);
-                            note(startLoc, "previous case defined here");
-                            return;
-                        }
-                    }
-                    for (unsigned j = 0; j < sw->gnu_switchs.size(); ++j) {
-                        if (i == j)
-                            continue;
-                        const GNUSwitchCase &B = sw->gnu_switchs[j];
-                        if (G.overlaps(B)) {
-                            location_t startLoc = G.loc, endLoc = B.loc;
-                            if (startLoc > endLoc)
-                                std::swap(startLoc, endLoc);
-                            const APInt sw_end1 = *G.CaseStart + G.range, sw_end2 = *B.CaseStart + B.range;
-                            type_error(endLoc, "duplicate (or overlapping) case range: (%A - %A) and (%A - %A)",
-                                       G.CaseStart, &sw_end1, B.CaseStart, &sw_end2);
-                            note(startLoc, "previous case defined here");
-                            return;
-                        }
-                    }
-                }
+                if (!check_switch_cases(sw))
+                    return;
                 if (origintestTy->isAgg() && origintestTy->isEnum() && !hasDefault) {
                     const auto &eelems = origintestTy->getEnum()->enums;
                     llvm::BitVector handled_enums(eelems.size(), false);
@@ -4970,9 +6595,10 @@ ONE_CASE:
             llvm::SaveAndRestore<label_t> saved_b(jumper.topBreak, LEAVE);
             insertBr(CMP);
             insertLabel(BODY);
+            const enum BranchHint hint = branch_hint();
             statement();
             insertLabel(CMP);
-            insertStmt(SNEW(CondJumpStmt){.test = test, .T = BODY, .F = LEAVE});
+            insertStmt(SNEW(CondJumpStmt){.test = test, .T = BODY, .F = LEAVE, .hint = hint});
             insertLabel(LEAVE);
             return;
         }
@@ -5025,17 +6651,22 @@ ONE_CASE:
             label_t CMP = jumper.createLabel();
             label_t LEAVE = jumper.createLabel();
             label_t BODY = jumper.createLabel();
+            // 'continue' jumps to the increment
+            label_t STEP = forincl ? jumper.createLabel() : CMP;
             llvm::SaveAndRestore<label_t> saved_b(jumper.topBreak, LEAVE);
-            llvm::SaveAndRestore<label_t> saved_c(jumper.topContinue, CMP);
+            llvm::SaveAndRestore<label_t> saved_c(jumper.topContinue, STEP);
+            const enum BranchHint hint = branch_hint();
             insertLabel(CMP);
             if (cond)
-                condJump(cond, BODY, LEAVE);
+                condJump(cond, BODY, LEAVE, hint);
             else
                 insertBr(BODY);
             insertLabel(BODY);
-            if (forincl)
-                insertStmt(SNEW(ExprStmt){.exprbody = forincl});
             statement();
+            if (forincl) {
+                insertLabel(STEP);
+                insertStmt(SNEW(ExprStmt){.exprbody = forincl});
+            }
             insertBr(CMP);
             insertLabel(LEAVE);
             auto num = leaveBlock(false);
@@ -5049,43 +6680,62 @@ ONE_CASE:
         }
         case Kdo: {
             Expr test;
+            label_t BODY = jumper.createLabel();
             label_t CMP = jumper.createLabel();
             label_t LEAVE = jumper.createLabel();
             llvm::SaveAndRestore<label_t> saved_b(jumper.topBreak, LEAVE);
             llvm::SaveAndRestore<label_t> saved_c(jumper.topContinue, CMP);
-            insertLabel(CMP);
             consume();
+            insertLabel(BODY);
+            const enum BranchHint hint = branch_hint();
             statement();
+            insertLabel(CMP);
             if (l.tok.tok != Kwhile)
-                parse_error(loc, "missing 'while' in do-while statement");
-            else
-                consume();
-            if (l.tok.tok != TLbracket)
-                return expectLB(loc);
-            consume();
+                return (void)parse_error(loc, "missing 'while' in do-while statement");
             if (!(test = Bexpression()))
                 return;
             checkSemicolon();
-            jumpIfTrue(test, CMP);
-            condJump(test, CMP, LEAVE);
+            condJump(test, BODY, LEAVE, hint);
+            insertLabel(LEAVE);
+            return;
         }
         case Kif: {
-            Expr test;
-            if (!(test = Bexpression()))
-                return;
-            label_t IF_END = jumper.createLabel();
-            jumpIfFalse(test, IF_END);
-            statement();
-            if (l.tok.tok == Kelse) {
-                label_t END = jumper.createLabel();
+            // 'else if' ladders are parsed iteratively, every branch jumps to the same end label
+            label_t END = 0;
+            bool hasElse = false;
+            for (;;) {
+                Expr test;
+                if (!(test = Bexpression()))
+                    break;
+                label_t IF_END = jumper.createLabel();
+                Stmt condJumpStmt = jumpIfFalse(test, IF_END, branch_hint());
+                statement();
+                if (l.tok.tok != Kelse) {
+                    insertLabel(IF_END);
+                    break;
+                }
+                if (!hasElse) {
+                    END = jumper.createLabel();
+                    hasElse = true;
+                }
                 consume();
+                // 'else [[likely]]' makes the false edge likely
+                if (const enum BranchHint hint = branch_hint()) {
+                    if (condJumpStmt)
+                        condJumpStmt->hint = hint == BH_Likely ? BH_Unlikely : BH_Likely;
+                }
                 insertBr(END);
                 insertLabel(IF_END);
+                if (l.tok.tok == Kif) {
+                    current_stmt_loc = getLoc();
+                    continue;
+                }
                 statement();
-                insertLabel(END);
-                return;
+                break;
             }
-            return insertLabel(IF_END);
+            if (hasElse)
+                insertLabel(END);
+            return;
         }
         case Kelse: return parse_error(loc, "'else' without a previous 'if'"), consume();
         case TIdentifier: {
@@ -5095,15 +6745,14 @@ ONE_CASE:
             if (l.tok.tok == TColon) { // labeled-statement
                 consume();
                 label_t L = putLable(tok.s, full_loc);
-                if (l.tok.tok == TRcurlyBracket) {
-                    warning(full_loc, "missing statement after label, adding ';' for you");
-                    return;
-                }
                 if (hasFlag(Flag_this_scope_has_vla)) {
                     jumper.vla_forbidden_labels.push_back(L);
                 }
-                statement();
+                // the label is before the statement it labels
                 insertLabel(L, tok.s, loc);
+                if (l.tok.tok == TRcurlyBracket)
+                    return (void)warning(full_loc, "missing statement after label, adding ';' for you");
+                return statement();
             }
             l.tokenq.push_back(l.tok), l.tok = tok;
             // not a labeled-statement, now put the token back and try to parse a expression
@@ -5127,264 +6776,176 @@ ONE_CASE:
         }
         return insertStmt(SNEW(ExprStmt){.exprbody = e});
     }
-    Expr multiplicative_expression() {
-        Expr result = cast_expression();
-        if (!result)
-            return nullptr;
-        for (;;) {
-            const Token tok = l.tok.tok;
-            switch (tok) {
-            case TMul:
-            case TSlash:
-            case TPercent: {
-                location_t opLoc = getLoc();
-                consume();
-                Expr r;
-                if (!(r = cast_expression()))
-                    return getIntZero();
-                switch (tok) {
-                case TMul: make_mul(result, r, opLoc); break;
-                case TPercent: make_rem(result, r, opLoc); continue;
-                case TSlash: make_div(result, r, opLoc); continue;
-                default: llvm_unreachable("invalid control follow");
+    // binary operator precedence, higher binds tighter (C11 6.5.5 - 6.5.14)
+    enum BinaryPrecedence : unsigned char {
+        Prec_Unknown = 0,
+        Prec_LogicalOr,
+        Prec_LogicalAnd,
+        Prec_InclusiveOr,
+        Prec_ExclusiveOr,
+        Prec_And,
+        Prec_Equality,
+        Prec_Relational,
+        Prec_Shift,
+        Prec_Additive,
+        Prec_Multiplicative
+    };
+    static enum BinaryPrecedence getBinaryPrecedence(Token tok) {
+        switch (tok) {
+        case TMul:
+        case TSlash:
+        case TPercent: return Prec_Multiplicative;
+        case TAdd:
+        case TDash: return Prec_Additive;
+        case Tshl:
+        case Tshr: return Prec_Shift;
+        case TLt:
+        case TLe:
+        case TGt:
+        case TGe: return Prec_Relational;
+        case TEq:
+        case TNe: return Prec_Equality;
+        case TBitAnd: return Prec_And;
+        case TXor: return Prec_ExclusiveOr;
+        case TBitOr: return Prec_InclusiveOr;
+        case TLogicalAnd: return Prec_LogicalAnd;
+        case TLogicalOr: return Prec_LogicalOr;
+        default: return Prec_Unknown;
+        }
+    }
+    static bool hasSideEffects(Expr e) {
+        SideEffectFinder finder;
+        finder.VisitExpr(e);
+        return finder.found;
+    }
+    // the value of `a && b` or `a || b` when `b` decides it: `a` is still evaluated if it has side effects
+    Expr logicalResult(Expr a, Expr value) { return hasSideEffects(a) ? comma(a, value) : value; }
+    void make_logical_and(Expr &result, Expr &r, location_t opLoc) {
+        Expr old_result = result;
+        Expr old_r = r;
+        valid_condition(result);
+        valid_condition(r);
+        if (result->k == EConstant) {
+            if (auto CI = dyn_cast<IntConstant>(result->C)) {
+                if (CI->isZero()) {
+                    warning(opLoc, "logical AND first operand is zero always evaluates to zero")
+                        << old_result->getSourceRange() << old_r->getSourceRange();
+                    result = getIntZero();
+                    return;
+                }
+                if (r->k == EConstant) {
+                    if (auto CI2 = dyn_cast<IntConstant>(r->C)) {
+                        warning(opLoc, "use of logical '&&' with constant operand")
+                            << old_r->getSourceRange() << old_result->getSourceRange();
+                        note(opLoc, "use '&' for a bitwise operation")
+                            << SourceRange(opLoc, opLoc + 1) << FixItHint::CreateInsertion("&", opLoc);
+                        result = CI2->isZero() ? getIntZero() : getIntOne();
+                        return;
+                    }
                 }
             }
-            default: return result;
+        } else if (r->k == EConstant) {
+            if (auto CI = dyn_cast<IntConstant>(r->C)) {
+                if (CI->isZero()) {
+                    warning(opLoc, "logical AND second operand is zero always evaluates to zero")
+                        << old_result->getSourceRange() << old_r->getSourceRange();
+                    result = logicalResult(result, getIntZero());
+                    return;
+                }
+                // `a && 1` is `a != 0`
             }
         }
-    }
-    Expr additive_expression() {
-        Expr r, result = multiplicative_expression();
-        if (!result)
-            return nullptr;
-        for (;;)
-            if (l.tok.tok == TAdd) {
-                location_t opLoc = getLoc();
-                consume();
-                if (!(r = multiplicative_expression()))
-                    return nullptr;
-                make_add(result, r, opLoc);
-            } else if (l.tok.tok == TDash) {
-                location_t opLoc = getLoc();
-                consume();
-                if (!(r = multiplicative_expression()))
-                    return nullptr;
-                make_sub(result, r, opLoc);
-            } else
-                return result;
-    }
-    Expr shift_expression() {
-        Expr r, result = additive_expression();
-        if (!result)
-            return nullptr;
-        for (;;)
-            if (l.tok.tok == Tshl) {
-                location_t opLoc = getLoc();
-                consume();
-                if (!(r = additive_expression()))
-                    return nullptr;
-                make_shl(result, r, opLoc);
-            } else if (l.tok.tok == Tshr) {
-                location_t opLoc = getLoc();
-                consume();
-                if (!(r = additive_expression()))
-                    return nullptr;
-                make_shr(result, r, opLoc);
-            } else
-                return result;
-    }
-    Expr relational_expression() {
-        Expr result = shift_expression();
-        if (!result)
-            return nullptr;
-        for (;;) {
-            switch (l.tok.tok) {
-            case TLt:
-            case TLe:
-            case TGt:
-            case TGe: {
-                make_cmp(result, l.tok.tok, false, getLoc());
-                continue;
-            }
-            default: return result;
-            }
+        if (result->k == ECast && result->castop == ZExt && r->k == ECast && r->castop == ZExt) {
+            result = boolToInt(binop(result->castval, LogicalAnd, r->castval, context.getInt()));
+        } else {
+            result = boolToInt(binop(result, LogicalAnd, r, context.getInt()));
         }
     }
-    Expr equality_expression() {
-        Expr result = relational_expression();
-        if (!result)
-            return nullptr;
-        for (;;) {
-            switch (l.tok.tok) {
-            case TEq:
-            case TNe: {
-                make_cmp(result, l.tok.tok, true, getLoc());
-                continue;
+    void make_logical_or(Expr &result, Expr &r, location_t opLoc) {
+        Expr old_result = result;
+        Expr old_r = r;
+        valid_condition(result);
+        valid_condition(r);
+        if (result->k == EConstant) {
+            if (auto CI = dyn_cast<IntConstant>(result->C)) {
+                if (!CI->isZero()) {
+                    warning(opLoc, "logical OR first operand is non-zero always evaluates to non-zero")
+                        << old_result->getSourceRange() << old_r->getSourceRange();
+                    result = getIntOne();
+                    return;
+                }
+                if (r->k == EConstant) {
+                    if (auto CI2 = dyn_cast<IntConstant>(r->C)) {
+                        warning(opLoc, "use of logical '||' with constant operand")
+                            << old_result->getSourceRange() << old_r->getSourceRange();
+                        note(opLoc, "use '|' for a bitwise operation")
+                            << SourceRange(opLoc, opLoc + 1) << FixItHint::CreateInsertion("|", opLoc);
+                        result = CI2->isZero() ? getIntZero() : getIntOne();
+                        return;
+                    }
+                }
             }
-            default: return result;
+        } else if (r->k == EConstant) {
+            if (auto CI = dyn_cast<IntConstant>(r->C)) {
+                if (!CI->isZero()) {
+                    warning(opLoc, "logical OR second operand is non-zero always evaluates to non-zero")
+                        << old_result->getSourceRange() << old_r->getSourceRange();
+                    result = logicalResult(result, getIntOne());
+                    return;
+                }
+                // `a || 0` is `a != 0`
             }
         }
-    }
-    Expr AND_expression() {
-        Expr result = equality_expression();
-        if (!result)
-            return nullptr;
-        for (;;)
-            if (l.tok.tok == TBitAnd) {
-                location_t opLoc = getLoc();
-                consume();
-                Expr r;
-                if (!(r = equality_expression()))
-                    return nullptr;
-                make_bitop(result, r, And, opLoc);
-            } else
-                return result;
-    }
-    Expr exclusive_OR_expression() {
-        Expr result = AND_expression();
-        if (!result)
-            return nullptr;
-        for (;;) {
-            if (l.tok.tok == TXor) {
-                location_t opLoc = getLoc();
-                consume();
-                Expr r;
-                if (!(r = AND_expression()))
-                    return nullptr;
-                make_bitop(result, r, Xor, opLoc);
-            } else
-                return result;
-        }
-    }
-    Expr inclusive_OR_expression() {
-        Expr result = exclusive_OR_expression();
-        if (!result)
-            return nullptr;
-        for (;;) {
-            if (l.tok.tok == TBitOr) {
-                location_t opLoc = getLoc();
-                consume();
-                Expr r;
-                if (!(r = exclusive_OR_expression()))
-                    return nullptr;
-                make_bitop(result, r, Or, opLoc);
-            } else
-                return result;
+        if (result->k == ECast && result->castop == ZExt && r->k == ECast && r->castop == ZExt) {
+            result = boolToInt(binop(result->castval, LogicalOr, r->castval, context.getInt()));
+        } else {
+            result = boolToInt(binop(result, LogicalOr, r, context.getInt()));
         }
     }
-    Expr logical_AND_expression() {
-        Expr result = inclusive_OR_expression();
+    // precedence climbing for binary operators from multiplicative-expression to logical-OR-expression.
+    // the recursion depth is bounded by the number of precedence levels, not by the length of the expression.
+    Expr binary_expression(enum BinaryPrecedence minPrec = Prec_LogicalOr) {
+        Expr result = cast_expression();
         if (!result)
             return nullptr;
-        for (;;) {
-            if (l.tok.tok == TLogicalAnd) {
-                location_t opLoc = getLoc() + 1;
-                consume();
-                Expr r;
-                if (!(r = inclusive_OR_expression()))
-                    return nullptr;
-                Expr old_result = result;
-                Expr old_r = r;
-                valid_condition(result);
-                valid_condition(r);
-                if (result->k == EConstant) {
-                    if (auto CI = dyn_cast<ConstantInt>(result->C)) {
-                        if (CI->isZero()) {
-                            warning(opLoc, "logical AND first operand is zero always evaluates to zero")
-                                << old_result->getSourceRange() << old_r->getSourceRange();
-                            result = getIntZero();
-                            continue;
-                        }
-                        if (r->k == EConstant) {
-                            if (auto CI2 = dyn_cast<ConstantInt>(r->C)) {
-                                warning(opLoc, "use of logical '&&' with constant operand")
-                                    << old_r->getSourceRange() << old_result->getSourceRange();
-                                note(opLoc, "use '&' for a bitwise operation")
-                                    << SourceRange(opLoc, opLoc + 1) << FixItHint::CreateInsertion("&", opLoc);
-                                result = CI2->isZero() ? getIntZero() : getIntOne();
-                            } else {
-                                result = r;
-                            }
-                            continue;
-                        }
-                    }
-                } else if (r->k == EConstant) {
-                    if (auto CI = dyn_cast<ConstantInt>(r->C)) {
-                        if (CI->isZero()) {
-                            warning(opLoc, "logical AND second operand is zero always evaluates to zero")
-                                << old_result->getSourceRange() << old_r->getSourceRange();
-                            result = getIntZero();
-                        }
-                        /* else { result = result; }*/
-                        continue;
-                    }
-                }
-                if (result->k == ECast && result->castop == ZExt && r->k == ECast && r->castop == ZExt) {
-                    result = boolToInt(binop(result->castval, LogicalAnd, r->castval, context.getInt()));
-                } else {
-                    result = boolToInt(binop(result, LogicalAnd, r, context.getInt()));
-                }
-            } else
-                return result;
-        }
+        return binary_expression_rhs(result, minPrec);
     }
-    Expr logical_OR_expression() {
-        Expr result = logical_AND_expression();
-        if (!result)
-            return nullptr;
+    Expr binary_expression_rhs(Expr result, enum BinaryPrecedence minPrec) {
         for (;;) {
-            if (l.tok.tok == TLogicalOr) {
-                location_t opLoc = getLoc() + 1;
-                consume();
-                Expr r;
-                if (!(r = logical_AND_expression()))
-                    return nullptr;
-                Expr old_result = result;
-                Expr old_r = r;
-                valid_condition(result);
-                valid_condition(r);
-                if (result->k == EConstant) {
-                    if (auto CI = dyn_cast<ConstantInt>(result->C)) {
-                        if (!CI->isZero()) {
-                            warning(opLoc, "logical OR first operand is non-zero always evaluates to non-zero")
-                                << old_result->getSourceRange() << old_r->getSourceRange();
-                            result = getIntOne();
-                            continue;
-                        }
-                        if (r->k == EConstant) {
-                            if (auto CI2 = dyn_cast<ConstantInt>(r->C)) {
-                                warning(opLoc, "use of logical '||' with constant operand")
-                                    << old_result->getSourceRange() << old_r->getSourceRange();
-                                note(opLoc, "use '|' for a bitwise operation")
-                                    << SourceRange(opLoc, opLoc + 1) << FixItHint::CreateInsertion("|", opLoc);
-                                ;
-                                result = CI2->isZero() ? getIntZero() : getIntOne();
-                            } else {
-                                result = r;
-                            }
-                            continue;
-                        }
-                    }
-                } else if (r->k == EConstant) {
-                    if (auto CI = dyn_cast<ConstantInt>(r->C)) {
-                        if (!CI->isZero()) {
-                            warning(opLoc, "logical OR second operand is non-zero always evaluates to non-zero")
-                                << old_result->getSourceRange() << old_r->getSourceRange();
-                            result = getIntZero();
-                        }
-                        /* else { result = result; }*/
-                        continue;
-                    }
-                }
-                if (result->k == ECast && result->castop == ZExt && r->k == ECast && r->castop == ZExt) {
-                    result = boolToInt(binop(result->castval, LogicalOr, r->castval, context.getInt()));
-                } else {
-                    result = boolToInt(binop(result, LogicalOr, r, context.getInt()));
-                }
-            } else
+            const Token tok = l.tok.tok;
+            const enum BinaryPrecedence prec = getBinaryPrecedence(tok);
+            if (prec < minPrec || prec == Prec_Unknown)
                 return result;
+            location_t opLoc = getLoc();
+            consume();
+            // all binary operators are left-associative
+            Expr r = binary_expression(static_cast<enum BinaryPrecedence>(prec + 1));
+            if (!r)
+                return prec == Prec_Multiplicative ? getIntZero() : nullptr;
+            switch (tok) {
+            case TMul: make_mul(result, r, opLoc); break;
+            case TPercent: make_rem(result, r, opLoc); break;
+            case TSlash: make_div(result, r, opLoc); break;
+            case TAdd: make_add(result, r, opLoc); break;
+            case TDash: make_sub(result, r, opLoc); break;
+            case Tshl: make_shl(result, r, opLoc); break;
+            case Tshr: make_shr(result, r, opLoc); break;
+            case TLt:
+            case TLe:
+            case TGt:
+            case TGe: make_cmp(result, r, tok, false, opLoc); break;
+            case TEq:
+            case TNe: make_cmp(result, r, tok, true, opLoc); break;
+            case TBitAnd: make_bitop(result, r, And, opLoc); break;
+            case TXor: make_bitop(result, r, Xor, opLoc); break;
+            case TBitOr: make_bitop(result, r, Or, opLoc); break;
+            case TLogicalAnd: make_logical_and(result, r, opLoc + 1); break;
+            case TLogicalOr: make_logical_or(result, r, opLoc + 1); break;
+            default: llvm_unreachable("invalid control follow");
+            }
         }
     }
+    Expr logical_OR_expression() { return binary_expression(Prec_LogicalOr); }
     Expr expression() {
         // parse a expression
         Expr result = assignment_expression();
@@ -5429,7 +6990,7 @@ ONE_CASE:
         conv(lhs, rhs);
         valid_condition(start);
         if (start->k == EConstant)
-            if (auto CI = dyn_cast<ConstantInt>(start->C))
+            if (auto CI = dyn_cast<IntConstant>(start->C))
                 return CI->isZero() ? rhs : lhs;
         return ENEW(ConditionExpr){.ty = lhs->ty, .cond = start, .cleft = lhs, .cright = rhs};
     }
@@ -5438,7 +6999,7 @@ ONE_CASE:
         if (!e)
             return nullptr;
         if (l.tok.tok == TQuestionMark)
-            return conditional_expression(e);
+            return consume(), conditional_expression(e);
         return e;
     }
     bool is_assigment_op(Token tok) {
@@ -5509,9 +7070,13 @@ ONE_CASE:
                 }
             }
             // make `a += b` to `a = a + b`
-            make_assign(tok, result, e, opLoc);
-            rhs = castto(e, result->ty, Implict_Assign);
-            return binop(result, Assign, rhs, result->ty);
+            const Expr lhs = result;
+            if (tok != TAssign) {
+                make_assign(tok, result, e, opLoc);
+                e = result;
+            }
+            rhs = castto(e, lhs->ty, Implict_Assign);
+            return binop(lhs, Assign, rhs, lhs->ty);
         } else
             return result;
     }
@@ -5521,7 +7086,7 @@ ONE_CASE:
         sreachable = true;
         while (l.tok.tok != TEOF) {
             if (l.tok.tok == Kasm)
-                parse_asm(), checkSemicolon();
+                parse_asm(true);
             else
                 declaration();
             if (getNumErrors())
@@ -5666,18 +7231,11 @@ public:
     // constructor
     Parser(SourceMgr &SM, xcc_context &theContext, LLVMTypeConsumer &llvmTypeCache, const Options &options)
         : EvalHelper{SM}, l(SM, theContext, this), context{theContext}, options{options}, llvmTypeCache{llvmTypeCache},
-intzero{wrap(context.getInt(), context.getIntLog2() == 5 ? llvmTypeCache.i32_0 : ConstantInt::get(getLLVMContext(), APInt::getZero(context.getInt()->getBitWidth())), 0, 0)},
-intone{
-    wrap(
-        context.getInt(), 
-        (context.getIntLog2() == 5) ? llvmTypeCache.i32_1 : 
-            ConstantInt::get(getLLVMContext(), APInt(context.getInt()->getBitWidth(), 1))
-            , 0, 0
-    )
-},
-cfalse{wrap(context.getBool(), llvmTypeCache.i1_0, 0, 0)},
-ctrue{wrap(context.getBool(), llvmTypeCache.i1_1, 0, 0)},
-null_ptr_expr{wrap(context.getNullPtr_t(), llvmTypeCache.null_ptr, 0, 0)} { }
+intzero{wrap(context.getInt(), context.createIntConstant(APInt::getZero(context.getInt()->getBitWidth())), 0, 0)},
+intone{wrap(context.getInt(), context.createIntConstant(APInt(context.getInt()->getBitWidth(), 1)), 0, 0)},
+cfalse{wrap(context.getBool(), context.createIntConstant(APInt(1, 0)), 0, 0)},
+ctrue{wrap(context.getBool(), context.createIntConstant(APInt(1, 1)), 0, 0)},
+null_ptr_expr{wrap(context.getNullPtr_t(), context.createPointerConstant(APInt::getZero(llvmTypeCache.pointerSizeInBits)), 0, 0)} { }
     // used by Lexer
     Expr constant_expression() { return conditional_expression(); }
     void startParse() {
@@ -44,84 +44,64 @@ raw_ostream &printTag(const_CType ty, raw_ostream &OS) {
     return OS << show(ty->getTagDeclTagType()) << " " << (Name ? Name->getKey() : "<anonymous>");
 }
 
-void printConstant(const llvm::Constant *C, llvm::raw_ostream &OS) {
-    if (const ConstantInt *CI = dyn_cast<ConstantInt>(C)) {
+void printStringLiteral(const StringLiteralData *S, llvm::raw_ostream &OS) {
+    if (S->charSizeInBits == 8)
+        return printCString(OS, S->getBytes());
+    OS << "{";
+    for (uint32_t i = 0; i < S->numElements; ++i) {
+        if (i)
+            OS << ", ";
+        OS << S->getElement(i);
+    }
+    OS << "}";
+}
+
+void printConstant(const ConstantValue *C, llvm::raw_ostream &OS) {
+    switch (C->kind) {
+    case ConstantValue::CK_Int:
         OS.changeColor(raw_ostream::GREEN);
-        CI->getValue().print(OS, true);
+        cast<IntConstant>(C)->getValue().print(OS, true);
         OS.resetColor();
         return;
-    }
-    if (const ConstantFP *CFP = dyn_cast<ConstantFP>(C)) {
+    case ConstantValue::CK_Float:
         OS.changeColor(raw_ostream::GREEN);
-        return CFP->getValue().print(OS);
+        cast<FloatConstant>(C)->getValue().print(OS);
         OS.resetColor();
-    }
-    if (isa<llvm::ConstantAggregateZero>(C)) {
-        OS << "{0}";
         return;
-    }
-    if (const llvm::ConstantAggregate *CAG = dyn_cast<llvm::ConstantAggregate>(C)) {
-        unsigned max = CAG->getNumOperands();
-        OS << "{";
-        for (unsigned i = 0; i < max; ++i) {
-            printConstant(CAG->getOperand(i), OS);
-            if (i != max)
-                OS << ", ";
-        }
-        OS << "}";
-        return;
-    }
-    if (const llvm::ConstantDataArray *CDA = dyn_cast<llvm::ConstantDataArray>(C)) {
-        if (CDA->isString())
-            return printCString(OS, CDA->getAsString());
-        auto T = CDA->getElementType();
-        if (T->isIntegerTy()) {
-            unsigned max = CDA->getNumElements();
-            OS << "{";
-            for (unsigned i = 0; i < max; ++i) {
-                OS << CDA->getElementAsInteger(i);
-                if (i != max)
-                    OS << ", ";
-            }
-            OS << "}";
+    case ConstantValue::CK_Pointer:
+        if (cast<PointerConstant>(C)->isNull()) {
+            OS.changeColor(raw_ostream::RED);
+            OS << "nullptr"; // nullptr, NULL ?
+            OS.resetColor();
             return;
         }
-        if (T->isDoubleTy()) {
-            unsigned max = CDA->getNumElements();
-            OS << "{";
-            for (unsigned i = 0; i < max; ++i) {
-                OS << CDA->getElementAsDouble(i);
-                if (i != max)
-                    OS << ", ";
-            }
-            OS << "}";
+        OS << "(void *)" << cast<PointerConstant>(C)->address;
+        return;
+    case ConstantValue::CK_Complex:
+        if (C->isNullValue()) {
+            OS << "{0}";
             return;
         }
-        if (T->isFloatTy()) {
-            unsigned max = CDA->getNumElements();
-            OS << "{";
-            for (unsigned i = 0; i < max; ++i) {
-                OS << CDA->getElementAsFloat(i);
-                if (i != max)
-                    OS << ", ";
-            }
-            OS << "}";
-            return;
+        OS << "{";
+        printConstant(cast<ComplexConstant>(C)->real, OS);
+        OS << ", ";
+        printConstant(cast<ComplexConstant>(C)->imag, OS);
+        OS << "}";
+        return;
+    case ConstantValue::CK_Vector: {
+        OS << "{";
+        bool first = true;
+        for (const ConstantValue *E : cast<VectorConstant>(C)->getElements()) {
+            if (!first)
+                OS << ", ";
+            first = false;
+            printConstant(E, OS);
         }
-    }
-    if (isa<llvm::ConstantPointerNull>(C)) {
-        OS.changeColor(raw_ostream::RED);
-        OS << "nullptr"; // nullptr, NULL ?
-        OS.resetColor();
+        OS << "}";
         return;
     }
-    if (const llvm::BlockAddress *BADR = dyn_cast<llvm::BlockAddress>(C)) {
-        const llvm::BasicBlock *BB = BADR->getBasicBlock();
-        OS << "label-address " << BB->getName();
+    case ConstantValue::CK_Undef: OS << (cast<UndefConstant>(C)->isPoison ? "poison" : "undef"); return;
     }
-    if (const llvm::GlobalVariable *GV = dyn_cast<llvm::GlobalVariable>(C))
-        return printConstant(GV->getInitializer(), OS);
-    C->print(OS);
 }
 
 raw_ostream &operator<<(llvm::raw_ostream &OS, const_Expr e);
@@ -162,21 +142,35 @@ raw_ostream &operator<<(llvm::raw_ostream &OS, const_Expr e) {
         }
         return OS;
     case EString: 
-        printConstant(e->string, OS); 
+        printStringLiteral(e->string, OS); 
         return OS;
     case EConstantArraySubstript: 
-        printConstant(e->array, OS); 
+        printStringLiteral(e->array, OS); 
         OS << " + " << e->cidx;
         return OS;
     case EConstant: printConstant(e->C, OS); return OS;
-    case EBin: 
-        maybe_print_paren(e->lhs, OS);
-        OS << ' ' << show(e->bop) << ' ';
-        maybe_print_paren(e->rhs, OS);
+    case EBin: {
+        // print left-leaning binary chains iteratively
+        SmallVector<const_Expr, 16> spine;
+        const_Expr it = e;
+        do {
+            spine.push_back(it);
+            it = it->lhs;
+        } while (it->k == EBin && !it->ty->hasTag(TYPAREN));
+        maybe_print_paren(it, OS);
+        for (size_t i = spine.size(); i--;) {
+            OS << ' ' << show(spine[i]->bop) << ' ';
+            maybe_print_paren(spine[i]->rhs, OS);
+        }
         return OS;
+    }
     case EInitList:
     {
         OS << '{';
+        if (e->packed) {
+            for (const PackedArrayData::Run &R : e->packed->getRuns())
+                OS << "packed [" << R.start << " ... " << (R.start + R.length - 1) << "], ";
+        }
         size_t Size = e->inits.size();
         for (unsigned i = 0;i < Size;++i) {
             const Initializer &it = e->inits[i];
@@ -205,7 +199,7 @@ raw_ostream &operator<<(llvm::raw_ostream &OS, const_Expr e) {
         return OS << '}';
     }
     case EUnary:
-        if (e->uop == AddressOf && e->ty->p->getKind() == TYFUNCTION && !e->ty->hasTag(TYLVALUE))
+        if (e->uop == AddressOf && e->ty->p->getKind() == TYFUNCTION && !e->isLValue())
             return maybe_print_paren(e->uoperand, OS), OS;
         OS << show(e->uop);
         maybe_print_paren(e->uoperand, OS);
@@ -299,7 +293,9 @@ raw_ostream &operator<<(llvm::raw_ostream &OS, const_CType ty) {
             vla_expr = vla_expr->castval;
         return OS << ty->vla_arraytype << " [" << vla_expr << ']';
     }
-    case TYVECTOR: return OS << ty->vec_ty << " __attribute__((vector_size(" << ty->vec_num_elems << "))";
+    case TYVECTOR:
+        // vector_size is in bytes
+        return OS << ty->vec_ty << " __attribute__((vector_size(" << ty->vec_num_elems << " * sizeof(" << ty->vec_ty << "))))";
     case TYBITINT: return OS << ty->getBitIntBaseType() << " _BitInt(" << ty->getBitIntBits() << ")";
     case TYFUNCTION: {
         auto str = ty->get_storage_str();
@@ -571,7 +567,10 @@ struct AstDumper {
             OS << "branch ";
             OS.resetColor();
             printExpr(s->test);
-            OS << " %" << s->T << ", %" << s->F << ';';
+            OS << " %" << s->T << ", %" << s->F;
+            if (s->hint != BH_None)
+                OS << (s->hint == BH_Likely ? " likely" : " unlikely");
+            OS << ';';
             newline();
             return;
         case SSwitch: {
@@ -624,10 +623,49 @@ struct AstDumper {
             OS << "__asm__";
             OS.resetColor();
             OS << "(";
-            printCString(OS, s->asms.str().drop_back());
+            printCString(OS, s->asms.str());
             OS << ')';
             newline();
             return;
+        case SGCCAsm: {
+            OS.changeColor(raw_ostream::RED);
+            OS << "__asm__";
+            OS.resetColor();
+            if (s->asm_volatile)
+                OS << " volatile";
+            if (s->asm_labels.size())
+                OS << " goto";
+            OS << "(";
+            printCString(OS, s->asm_template.str());
+            auto printOperands = [&](const xvector<AsmOperand> &operands) {
+                OS << " :";
+                for (size_t i = 0; i < operands.size(); ++i) {
+                    const AsmOperand &op = operands[i];
+                    OS << (i ? ", " : " ");
+                    if (op.name)
+                        OS << '[' << op.name->getKey() << "] ";
+                    printCString(OS, op.constraint.str());
+                    OS << '(';
+                    printExpr(op.e);
+                    OS << ')';
+                }
+            };
+            printOperands(s->asm_outputs);
+            printOperands(s->asm_inputs);
+            OS << " :";
+            for (size_t i = 0; i < s->asm_clobbers.size(); ++i) {
+                OS << (i ? ", " : " ");
+                printCString(OS, s->asm_clobbers[i].str());
+            }
+            if (s->asm_labels.size()) {
+                OS << " :";
+                for (size_t i = 0; i < s->asm_labels.size(); ++i)
+                    OS << (i ? ", " : " ") << '%' << s->asm_labels[i];
+            }
+            OS << ')';
+            newline();
+            return;
+        }
         case SVarDecl: {
             size_t end = s->vars.size();
             for (size_t i = 0; i < end; ++i) {
@@ -742,7 +780,8 @@ struct AstJSONDumper {
                 {
                     {"test", printExpr(s->test)},
                     {"T", s->T},
-                    {"F", s->F}
+                    {"F", s->F},
+                    {"hint", s->hint == BH_None ? "none" : s->hint == BH_Likely ? "likely" : "unlikely"}
                 }
             ));
             return;
@@ -774,6 +813,33 @@ struct AstJSONDumper {
                 {"expr", s->asms}
             ));
             return;
+        case SGCCAsm: {
+            auto printOperands = [&](const xvector<AsmOperand> &operands) {
+                llvm::json::Array A;
+                for (const AsmOperand &op : operands) {
+                    llvm::json::Object O{{"constraint", op.constraint.str()}, {"expr", printExpr(op.e)}};
+                    if (op.name)
+                        O["name"] = op.name->getKey();
+                    A.push_back(std::move(O));
+                }
+                return A;
+            };
+            llvm::json::Array clobbers, labels;
+            for (const xstring &Clobber : s->asm_clobbers)
+                clobbers.push_back(Clobber.str());
+            for (label_t L : s->asm_labels)
+                labels.push_back(L);
+            JOS.value(llvm::json::Object(
+                {"kind", "GCCAsmStmt"},
+                {"template", s->asm_template.str()},
+                {"volatile", s->asm_volatile},
+                {"outputs", printOperands(s->asm_outputs)},
+                {"inputs", printOperands(s->asm_inputs)},
+                {"clobbers", std::move(clobbers)},
+                {"labels", std::move(labels)}
+            ));
+            return;
+        }
         case SVarDecl: 
             return;
         case SFunction:
@@ -47,22 +47,8 @@ IsUTF8(StringRef str) {
 
 // clang-format on
 
-llvm::Constant *getUTF8(StringRef s, LLVMContext &ctx) {
-    assert(s.back() == 0 && "C string must be null terminated");
-    if (s.size() == 1) {
-        auto Ty = llvm::ArrayType::get(llvm::Type::getInt8Ty(ctx), 1);
-        return llvm::ConstantAggregateZero::get(Ty);
-    }
-    return llvm::ConstantDataArray::getString(ctx, s, false);
-}
-
-template <typename T> llvm::Constant *getUTF16AsNBit(StringRef s, LLVMContext &ctx, size_t &strLength) {
-    if (s.empty()) {
-        auto Ty = llvm::ArrayType::get(llvm::Type::getIntNTy(ctx, sizeof(T)), 1);
-        strLength = 0;
-        return llvm::ConstantAggregateZero::get(Ty);
-    }
-    SmallVector<T> data;
+// The encoders below append the null-terminated encoded string to `data`, the front-end copies it into the arena.
+template <typename T> void getUTF16AsNBit(StringRef s, SmallVectorImpl<T> &data) {
     uint32_t state = 0, codepoint;
     for (auto c : s) {
         if (decode(&state, &codepoint, (uint32_t)(unsigned char)c))
@@ -75,26 +61,17 @@ template <typename T> llvm::Constant *getUTF16AsNBit(StringRef s, LLVMContext &c
         data.push_back(0xDC00 + (codepoint & 0x3FF));
     }
     data.push_back(0);
-    strLength = data.size();
-    return llvm::ConstantDataArray::get(ctx, data);
 }
 // in Linux, wchar_t are 32 bit(int)
-llvm::Constant *getUTF16As32Bit(StringRef s, LLVMContext &ctx, size_t &strLength) { return getUTF16AsNBit<uint32_t>(s, ctx, strLength); }
+void getUTF16As32Bit(StringRef s, SmallVectorImpl<uint32_t> &data) { getUTF16AsNBit<uint32_t>(s, data); }
 // in Windows, wchar_t are 16 bit(unsigned short)
-llvm::Constant *getUTF16As16Bit(StringRef s, LLVMContext &ctx, size_t &strLength) { return getUTF16AsNBit<uint16_t>(s, ctx, strLength); }
-llvm::Constant *getUTF32(StringRef s, LLVMContext &ctx, size_t &strLength) {
-    if (s.empty()) {
-        auto Ty = llvm::ArrayType::get(llvm::Type::getInt32Ty(ctx), 1);
-        return llvm::ConstantAggregateZero::get(Ty);
-    }
+void getUTF16As16Bit(StringRef s, SmallVectorImpl<uint16_t> &data) { getUTF16AsNBit<uint16_t>(s, data); }
+void getUTF32(StringRef s, SmallVectorImpl<uint32_t> &data) {
     uint32_t state = 0, codepoint;
-    llvm::SmallVector<uint32_t> data;
     for (const auto c : s)
         if (!decode(&state, &codepoint, (uint32_t)(unsigned char)c))
             data.push_back(codepoint);
     data.push_back(0);
-    strLength = data.size();
-    return llvm::ConstantDataArray::get(ctx, data);
 }
 
 } // namespace enc
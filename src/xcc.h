@@ -3,6 +3,8 @@
 #if !WINDOWS
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #else
 #include <windows.h>
 #endif
@@ -32,7 +34,10 @@
 #include <llvm/ADT/IntrusiveRefCntPtr.h>
 #include <llvm/ADT/Optional.h>
 #include <llvm/ADT/SmallSet.h>
+#include <llvm/ADT/StringSet.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/MapVector.h>
 #include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/StringSwitch.h>
 #include <llvm/ADT/Triple.h>
@@ -121,6 +126,7 @@
 #include <llvm/Support/MathExtras.h>
 #include <llvm/Support/ErrorHandling.h>
 #include <llvm/Support/ExitCodes.h>
+#include <llvm/Support/Format.h>
 #include <llvm/Support/FormatVariadic.h>
 #include <llvm/Support/PrettyStackTrace.h>
 #include <llvm/Support/Program.h>
@@ -188,7 +194,12 @@
 #include <cstdint>
 #include <cstdio>
 #include <ctime>
+#include <chrono>
+#include <cstring>
 #include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include <optional>
 #include <cassert>
 #include <type_traits>
@@ -435,7 +446,9 @@ enum CastOp: unsigned char {
     FPExt,
     PtrToInt,
     IntToPtr,
-    BitCast
+    BitCast,
+    // GCC vector extensions: a scalar broadcast to all elements of a vector
+    VectorSplat
 };
 static llvm::Instruction::CastOps getCastOp(CastOp a) {
     switch (a) {
@@ -547,6 +560,7 @@ static const char *show(enum CastOp op) {
     case PtrToInt: return "ptrToInt";
     case IntToPtr: return "intToPtr";
     case BitCast: return "bitcast";
+    case VectorSplat: return "splat";
     }
     llvm_unreachable("invalid CastOp");
 }
@@ -681,13 +695,14 @@ struct IntegerKind {
     }
     constexpr bool operator==(const IntegerKind &other) const { return asLog2() == other.asLog2(); }
     constexpr static IntegerKind fromLog2(uint8_t Value) { return IntegerKind(Value); }
+    // `shift` is the log2 of the bit width: 4 bytes is 32 bits, shift 5
     static IntegerKind fromBytes(uint64_t Bytes) {
         assert(llvm::isPowerOf2_64(Bytes));
-        return fromLog2(llvm::Log2_64(Bytes));
+        return fromBits(Bytes * 8);
     }
     static IntegerKind fromBits(uint64_t Bits) {
         assert(llvm::isPowerOf2_64(Bits));
-        return fromBytes(llvm::Log2_64(Bits));
+        return fromLog2(llvm::Log2_64(Bits));
     }
     APInt getZero() const { return APInt::getZero(asBits()); }
     bool isBool() const { return shift == 0; }
@@ -860,6 +875,93 @@ struct EnumPair {
     uint64_t val;
     EnumPair(IdentRef Name, uint64_t val) : name{Name}, val{val} { }
 };
+// GNU `__attribute__((...))` and C23 `[[...]]` attributes of a declaration, merged over all redeclarations.
+// https://gcc.gnu.org/onlinedocs/gcc/Attribute-Syntax.html
+struct DeclAttributes {
+    enum : uint32_t {
+        AlwaysInline = 0x1,
+        NoInline = 0x2,
+        Hot = 0x4,
+        Cold = 0x8,
+        Flatten = 0x10,
+        Pure = 0x20,
+        Const = 0x40,
+        Malloc = 0x80,
+        Packed = 0x100,
+        Used = 0x200,
+        Weak = 0x400,
+        NoReturn = 0x800,
+        Unused = 0x1000,
+        Likely = 0x2000,
+        Unlikely = 0x4000
+    };
+    enum Visibility : uint8_t {
+        VisibilityUnspecified,
+        VisibilityDefault,
+        VisibilityHidden,
+        VisibilityProtected
+    };
+    // optimize("O2"), optimize(3) or `#pragma GCC optimize`: the optimization level of a function
+    enum Optimize : uint8_t {
+        OptimizeUnspecified,
+        OptimizeO0,
+        OptimizeO1,
+        OptimizeO2,
+        OptimizeO3,
+        OptimizeOs,
+        OptimizeOz
+    };
+    uint32_t flags = 0;
+    uint32_t align = 0;    // aligned(N), in bytes, 0 if not specified
+    uint32_t vector_size = 0; // vector_size(N), in bytes, 0 if not specified
+    uint64_t nonnull = 0;  // nonnull(...), bit i is set if the i-th parameter(0-based) is nonnull
+    StringRef section;     // section("name")
+    StringRef alias;       // alias("target")
+    location_t aliasLoc = 0;
+    enum Visibility visibility = VisibilityUnspecified;
+    enum Optimize optimize = OptimizeUnspecified;
+    bool has(uint32_t f) const { return flags & f; }
+    bool empty() const {
+        return !flags && !align && !vector_size && !nonnull && section.empty() && alias.empty() && visibility == VisibilityUnspecified &&
+               optimize == OptimizeUnspecified;
+    }
+    // -O<N>, larger levels are -O3 as in GCC
+    static enum Optimize getOptimizeLevel(uint64_t N) {
+        return N == 0 ? OptimizeO0 : N == 1 ? OptimizeO1 : N == 2 ? OptimizeO2 : OptimizeO3;
+    }
+    // an argument of optimize: "O2", "-Os", "3" ..., OptimizeUnspecified if it is not a level(e.g. "-funroll-loops")
+    static enum Optimize parseOptimize(StringRef S) {
+        S.consume_front("-");
+        uint64_t N;
+        if (!S.getAsInteger(10, N))
+            return getOptimizeLevel(N);
+        if (!S.consume_front("O"))
+            return OptimizeUnspecified;
+        if (S.empty() || S == "g")
+            return OptimizeO1;
+        if (!S.getAsInteger(10, N))
+            return getOptimizeLevel(N);
+        return llvm::StringSwitch<enum Optimize>(S)
+            .Case("fast", OptimizeO3)
+            .Case("s", OptimizeOs)
+            .Case("z", OptimizeOz)
+            .Default(OptimizeUnspecified);
+    }
+    // add the attributes of `other`(a later declaration) to this
+    void merge(const DeclAttributes &other) {
+        flags |= other.flags;
+        align = std::max(align, other.align);
+        nonnull |= other.nonnull;
+        if (!other.section.empty())
+            section = other.section;
+        if (!other.alias.empty())
+            alias = other.alias, aliasLoc = other.aliasLoc;
+        if (other.visibility != VisibilityUnspecified)
+            visibility = other.visibility;
+        if (other.optimize != OptimizeUnspecified)
+            optimize = other.optimize;
+    }
+};
 // Any declaration or definition but except function definition
 // https://clang.llvm.org/doxygen/classclang_1_1VarDecl.html
 struct VarDecl {
@@ -868,6 +970,7 @@ struct VarDecl {
     Expr init; // maybe null
     unsigned idx;
     location_t loc;
+    const DeclAttributes *attrs; // maybe null
 };
 // enum declaration
 // https://clang.llvm.org/doxygen/classclang_1_1EnumDecl.html
@@ -884,7 +987,13 @@ struct FieldDecl : public Declator {
 // https://clang.llvm.org/doxygen/classclang_1_1RecordDecl.html
 struct RecordDecl {
     SmallVector<FieldDecl, 4> fields;
+    // member name => access path(indexes into `fields`, anonymous members are flattened).
+    // only built for records with many members, small records are searched linearly.
+    // like the RecordDecl, it is created by ArenaAllocator::createWithDestructor, so its heap buckets are freed with the arena.
+    DenseMap<IdentRef, ArrayRef<unsigned>> *members = nullptr;
 //    ArrayRef<unsigned> LLVMTypeMap;
+    bool isPacked = false; // __attribute__((packed))
+    uint32_t align = 0;    // __attribute__((aligned(N))), in bytes
 };
 // Tag - A record or enum
 // https://clang.llvm.org/doxygen/classclang_1_1TagDecl.html
@@ -934,13 +1043,126 @@ struct Initializer {
         return isSingle() ? ArrayRef<Designator>(&idx, 1) : ArrayRef<Designator>(idxs);
     }
 };
+// A string literal owned by the front-end.
+// The encoded characters(in host byte order, including the terminating null character) are stored in the arena,
+// the llvm::Constant is created by IRGen.
+struct StringLiteralData {
+    const char *data;
+    uint32_t numElements; // including the terminating null character
+    uint8_t charSizeInBits; // 8, 16 or 32
+    size_t getByteLength() const { return size_t(numElements) * (charSizeInBits / 8); }
+    StringRef getBytes() const { return StringRef(data, getByteLength()); }
+    template <typename T> ArrayRef<T> getElements() const {
+        assert(sizeof(T) * 8 == charSizeInBits && "bad element type");
+        return ArrayRef<T>(reinterpret_cast<const T *>(data), numElements);
+    }
+    uint32_t getElement(size_t i) const {
+        assert(i < numElements && "index out of bounds");
+        switch (charSizeInBits) {
+        case 8: return static_cast<unsigned char>(data[i]);
+        case 16: return getElements<uint16_t>()[i];
+        case 32: return getElements<uint32_t>()[i];
+        default: llvm_unreachable("bad character size");
+        }
+    }
+};
+// A constant folded by the front-end(the value of an EConstant), created in the arena by xcc_context.
+// The parser and EvalHelper fold them, IRGen::getConstant is the only place where they become llvm::Constant objects,
+// so folded constants are freed with the arena instead of being uniqued in the LLVMContext.
+struct ConstantValue {
+    enum Kind : uint8_t {
+        CK_Int, // an integer or a bool
+        CK_Float,
+        CK_Pointer, // an integer converted to a pointer, 0 is the null pointer
+        CK_Complex,
+        CK_Vector,
+        CK_Undef // the result of undefined behavior, e.g., division by zero
+    };
+    const Kind kind;
+    ConstantValue(Kind kind): kind{kind} {}
+    // like llvm::Constant::isNullValue(): zero, positive zero, the null pointer, or all elements are null
+    bool isNullValue() const;
+};
+struct IntConstant : public ConstantValue {
+    const APInt V;
+    IntConstant(APInt V): ConstantValue{CK_Int}, V{std::move(V)} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Int; }
+    const APInt &getValue() const { return V; }
+    bool isZero() const { return V.isZero(); }
+};
+struct FloatConstant : public ConstantValue {
+    const APFloat V;
+    FloatConstant(APFloat V): ConstantValue{CK_Float}, V{std::move(V)} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Float; }
+    const APFloat &getValue() const { return V; }
+    bool isZero() const { return V.isZero(); } // positive or negative zero
+};
+struct PointerConstant : public ConstantValue {
+    const APInt address; // as wide as the integer converted from
+    PointerConstant(APInt address): ConstantValue{CK_Pointer}, address{std::move(address)} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Pointer; }
+    bool isNull() const { return address.isZero(); }
+};
+struct ComplexConstant : public ConstantValue {
+    const ConstantValue *real, *imag;
+    ComplexConstant(const ConstantValue *real, const ConstantValue *imag): ConstantValue{CK_Complex}, real{real}, imag{imag} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Complex; }
+};
+struct VectorConstant : public ConstantValue {
+    const ConstantValue *const *elements;
+    uint32_t numElements;
+    VectorConstant(const ConstantValue *const *elements, uint32_t numElements): ConstantValue{CK_Vector}, elements{elements}, numElements{numElements} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Vector; }
+    ArrayRef<const ConstantValue *> getElements() const { return ArrayRef<const ConstantValue *>(elements, numElements); }
+};
+// IRGen creates an llvm::UndefValue(or an llvm::PoisonValue) of the type of the expression
+struct UndefConstant : public ConstantValue {
+    const bool isPoison;
+    UndefConstant(bool isPoison): ConstantValue{CK_Undef}, isPoison{isPoison} {}
+    static bool classof(const ConstantValue *C) { return C->kind == CK_Undef; }
+};
+inline bool ConstantValue::isNullValue() const {
+    switch (kind) {
+    case CK_Int: return cast<IntConstant>(this)->isZero();
+    case CK_Float: return cast<FloatConstant>(this)->getValue().isPosZero();
+    case CK_Pointer: return cast<PointerConstant>(this)->isNull();
+    case CK_Complex: return cast<ComplexConstant>(this)->real->isNullValue() && cast<ComplexConstant>(this)->imag->isNullValue();
+    case CK_Vector: return llvm::all_of(cast<VectorConstant>(this)->getElements(), [](const ConstantValue *C) { return C->isNullValue(); });
+    case CK_Undef: return false;
+    }
+    llvm_unreachable("bad constant kind");
+}
+// The constant elements of an array of integer or floating types, packed by the front-end.
+// The elements(in host byte order) are stored as runs of consecutive indexes, elements not covered by any run are zero:
+// a dense initializer is one run, a sparse one(`[999999] = 1`) is a few short runs.
+// IRGen creates a ConstantDataArray for dense data, and zeroinitializer plus the runs for sparse data.
+struct PackedArrayData {
+    struct Run {
+        uint32_t start; // index of the first element
+        uint32_t length; // number of elements
+        uint32_t offset; // offset of the first element in `data`, in elements
+    };
+    const char *data;
+    const Run *runs; // sorted by index, not overlapping
+    uint32_t numRuns;
+    uint8_t elementSize; // in bytes: 1, 2, 4 or 8
+    ArrayRef<Run> getRuns() const { return ArrayRef<Run>(runs, numRuns); }
+    StringRef getBytes(const Run &R) const {
+        return StringRef(data + size_t(R.offset) * elementSize, size_t(R.length) * elementSize);
+    }
+    uint64_t getNumInitialized() const {
+        uint64_t N = 0;
+        for (const Run &R : getRuns())
+            N += R.length;
+        return N;
+    }
+};
 // Simple 'case' statement with one value
 struct SwitchCase {
     location_t loc;
     const APInt *CaseStart;
     label_t label;
     SwitchCase(location_t loc, label_t label, const APInt *CastStart) : loc{loc}, CaseStart{CastStart}, label{label} { }
-    static bool equals(const SwitchCase &lhs, const SwitchCase &rhs) { return *lhs.CaseStart == *rhs.CaseStart; }
 };
 // GNU extension: from (start ... end) or (start ... start + range)
 struct GNUSwitchCase : public SwitchCase {
@@ -949,17 +1171,6 @@ struct GNUSwitchCase : public SwitchCase {
         : SwitchCase(loc, label, CastStart), range{*CaseEnd - *CastStart} { }
     bool contains(const APInt &C) const { return (C - *CaseStart).ule(range); }
     bool contains(const SwitchCase &G) const { return contains(*G.CaseStart); }
-    bool overlaps(const GNUSwitchCase &G) const {
-        // https://stackoverflow.com/questions/3269434/whats-the-most-efficient-way-to-test-if-two-ranges-overlap
-        // G   :  [xxxxxxx]
-        // this:     [yyyyyyy]
-        if (G.CaseStart->ult(*CaseStart)) {
-            return (*G.CaseStart + G.range).uge(*CaseStart);
-        }
-        // G   :      [xxxxxxx]
-        // this: [yyyyyyy]
-        return (*CaseStart + range).ule(*G.CaseStart);
-    }
 };
 struct TranslationUnit {
     Stmt ast; // A HeadStmt
@@ -991,6 +1202,18 @@ enum VectorKind: unsigned char {
     /// is AArch64 SVE fixed-length predicate vector
      SveFixedLengthPredicateVector
 };
+// a [[likely]]/[[unlikely]] hint of the true edge of a conditional jump
+enum BranchHint: unsigned char {
+    BH_None,
+    BH_Likely,
+    BH_Unlikely
+};
+// an output or input operand of a GNU extended asm statement: `[name] "constraint" (expr)`
+struct AsmOperand {
+    IdentRef name; // maybe null
+    xstring constraint;
+    Expr e; // an lvalue for outputs
+};
 #include "ctypes.inc"
 #include "expressions.inc"
 #include "statements.inc"
@@ -1002,9 +1225,10 @@ enum VectorKind: unsigned char {
 
 struct ReplacedExprParen {
     enum ExprKind k = EConstant;
+    uint8_t flags = EF_LValue | EF_ReplacedConstant;
     CType ty;
     struct {
-        llvm::Constant *C;
+        const ConstantValue *C;
         unsigned id;
         IdentRef varName;
         location_t ReplacedLoc;
@@ -1013,16 +1237,17 @@ struct ReplacedExprParen {
 };
 struct ReplacedExpr {
     enum ExprKind k = EConstant;
+    uint8_t flags = EF_LValue | EF_ReplacedConstant;
     CType ty;
     struct {
-        llvm::Constant *C;
+        const ConstantValue *C;
         unsigned id;
         IdentRef varName;
         location_t ReplacedLoc;
     };
 };
 location_t *OpaqueExpr::getParenLLoc() {
-    if (ty->hasTag(TYREPLACED_CONSTANT)) {
+    if (isReplacedConstant()) {
         return reinterpret_cast<ReplacedExprParen *>(this)->paren_loc;
     }
     const size_t Size = expr_size_map[k];
@@ -1032,58 +1257,66 @@ const location_t *OpaqueExpr::getParenLLoc() const { return const_cast<Expr>(thi
 const location_t *OpaqueExpr::getParenRLoc() const { return getParenLLoc() + 1; }
 location_t *OpaqueExpr::getParenRLoc() { return getParenLLoc() + 1; }
 location_t OpaqueExpr::getBeginLoc() const {
-    if (ty->hasTag(TYPAREN))
-        return *getParenLLoc();
-    switch (k) {
-    case EBlockAddress: return block_loc_begin;
-    case ESizeof: return sizeof_loc_begin;
-    case EVar: return varLoc;
-    case EBin: return lhs->getBeginLoc();
-    case EUnary: return opLoc;
-    case ECast: return castval->getBeginLoc();
-    case ESubscript: return left->getBeginLoc();
-    case EInitList: return initStartLoc;
-    case EConstant: return constantLoc;
-    case ECondition: return cond->getBeginLoc();
-    case ECall: return callfunc->getBeginLoc();
-    case EString: return stringLoc;
-    case EMemberAccess: return obj->getBeginLoc();
-    case EArrToAddress: return arr3->getBeginLoc();
-    case EPostFix: return poperand->getBeginLoc();
-    case EBuiltinCall: return builtin_call_start_loc;
-    case EVoid: return voidStartLoc;
-    case EConstantArraySubstript: return casLoc;
-    case ECallCompilerBuiltinCall: return cbc_start_loc;
-    case ECallImplictFunction: return imt_start_loc;
-    }
-    llvm_unreachable("invalid Expr");
+    // walk the operands iteratively, binary chains may be very deep
+    const OpaqueExpr *e = this;
+    for (;;) {
+        if (e->ty->hasTag(TYPAREN))
+            return *e->getParenLLoc();
+        switch (e->k) {
+        case EBlockAddress: return e->block_loc_begin;
+        case ESizeof: return e->sizeof_loc_begin;
+        case EVar: return e->varLoc;
+        case EBin: e = e->lhs; continue;
+        case EUnary: return e->opLoc;
+        case ECast: e = e->castval; continue;
+        case ESubscript: e = e->left; continue;
+        case EInitList: return e->initStartLoc;
+        case EConstant: return e->constantLoc;
+        case ECondition: e = e->cond; continue;
+        case ECall: e = e->callfunc; continue;
+        case EString: return e->stringLoc;
+        case EMemberAccess: e = e->obj; continue;
+        case EArrToAddress: e = e->arr3; continue;
+        case EPostFix: e = e->poperand; continue;
+        case EBuiltinCall: return e->builtin_call_start_loc;
+        case EVoid: return e->voidStartLoc;
+        case EConstantArraySubstript: return e->casLoc;
+        case ECallCompilerBuiltinCall: return e->cbc_start_loc;
+        case ECallImplictFunction: return e->imt_start_loc;
+        }
+        llvm_unreachable("invalid Expr");
+    }
 }
 location_t OpaqueExpr::getEndLoc() const {
-    if (ty->hasTag(TYPAREN))
-        return *getParenRLoc();
-    switch (k) {
-    case EBlockAddress: return block_loc_begin + labelName->getKeyLength() - 1;
-    case ESizeof: return sizeof_loc_end;
-    case EInitList: return initEndLoc;
-    case EConstant: return constantEndLoc;
-    case EBin: return rhs->getEndLoc();
-    case EUnary: return uoperand->getEndLoc();
-    case ESubscript: return right->getEndLoc();
-    case EConstantArraySubstript: return casEndLoc;
-    case EString: return stringEndLoc;
-    case EVoid: return voidexpr->getEndLoc();
-    case ECast: return castval->getEndLoc();
-    case EVar: return varLoc + varName->getKeyLength() - 1;
-    case EMemberAccess: return memberEndLoc;
-    case EArrToAddress: return arr3->getEndLoc();
-    case ECondition: return cright->getEndLoc();
-    case ECall: return callEnd;
-    case EPostFix: return postFixEndLoc;
-    case EBuiltinCall: return builtin_call_start_loc + builtin_func_name->getKeyLength() - 1;
-    case ECallCompilerBuiltinCall: return cbc_end_loc;
-    case ECallImplictFunction: return imt_end_loc;
-    }
-    llvm_unreachable("invalid Expr");
+    // walk the operands iteratively, binary chains may be very deep
+    const OpaqueExpr *e = this;
+    for (;;) {
+        if (e->ty->hasTag(TYPAREN))
+            return *e->getParenRLoc();
+        switch (e->k) {
+        case EBlockAddress: return e->block_loc_begin + e->labelName->getKeyLength() - 1;
+        case ESizeof: return e->sizeof_loc_end;
+        case EInitList: return e->initEndLoc;
+        case EConstant: return e->constantEndLoc;
+        case EBin: e = e->rhs; continue;
+        case EUnary: e = e->uoperand; continue;
+        case ESubscript: e = e->right; continue;
+        case EConstantArraySubstript: return e->casEndLoc;
+        case EString: return e->stringEndLoc;
+        case EVoid: e = e->voidexpr; continue;
+        case ECast: e = e->castval; continue;
+        case EVar: return e->varLoc + e->varName->getKeyLength() - 1;
+        case EMemberAccess: return e->memberEndLoc;
+        case EArrToAddress: e = e->arr3; continue;
+        case ECondition: e = e->cright; continue;
+        case ECall: return e->callEnd;
+        case EPostFix: return e->postFixEndLoc;
+        case EBuiltinCall: return e->builtin_call_start_loc + e->builtin_func_name->getKeyLength() - 1;
+        case ECallCompilerBuiltinCall: return e->cbc_end_loc;
+        case ECallImplictFunction: return e->imt_end_loc;
+        }
+        llvm_unreachable("invalid Expr");
+    }
 }
 static constexpr uint64_t build_integer(IntegerKind kind, bool Signed) {
     const uint64_t log2size = kind.asLog2();
@@ -1391,15 +1624,21 @@ enum GetBuiltinTypeError: unsigned char {
 #include "xcc_context.cpp"
 #include "SourceMgr.cpp"
 #include "TextDiagnosticPrinter.cpp"
+#include "InlineAsm.cpp"
 #include "LLVMTypeConsumer.cpp"
+#include "CodeGenTBAA.cpp"
+#include "StmtVisitor.cpp"
 #include "codegen.cpp"
 #include "codegen_builtin.cpp"
 #include "lexer.cpp"
 #include "output.cpp"
-#include "StmtVisitor.cpp"
 #include "parser.cpp"
 #include "lexerDefinition.cpp"
 #include "CompilerInstance.cpp"
+#include "ParallelCompilation.cpp"
+#if !WINDOWS
+#include "CompileServer.cpp"
+#endif
 #include "interpreter/interpreter.cpp"
 #ifdef XCC_TOOLCHAIN
 #include "toolchains/ToolChain.cpp"
@@ -104,6 +104,12 @@ template <unsigned long long n> static constexpr inline unsigned long long cstrl
 #define CC_SITCH_RANGE_UNROLL_MAX 64
 #endif
 
+// The minimum size in bytes of a block-scoped local that gets llvm.lifetime.start/end markers,
+// smaller objects are usually promoted to registers.
+#ifndef CC_LIFETIME_MIN_SIZE
+#define CC_LIFETIME_MIN_SIZE 32
+#endif
+
 #ifndef CC_PRINT_CDECL
 #define CC_PRINT_CDECL 1
 #endif
@@ -35,6 +35,8 @@ struct xcc_context {
         _wchar = isWChar_tSigned() ? (getWCharLog2() == 5 ? i32 : i16) : (getWCharLog2() == 5 ? u32 : u16);
         _long = getLongLog2() == 5 ? i32 : i64;
         _ulong = getLongLog2() == 5 ? u32 : u64;
+        _short = i16;
+        _ushort = u16;
         assert(getUCharLog2() == 5);
         _uchar = isUChar_tSigned() ? i32 : u32;
         _nullptr_t = getPointerType(v, TYNULLPTR);
@@ -427,7 +429,7 @@ struct xcc_context {
                 Ty = getArrayDecayedType(Ty);
             ArgTypes.push_back(Param(nullptr, Ty));
         }
-        CType F = TNEW(FunctionType){.ret = ResType, .params = ArgTypes, .isVarArg = false};
+        CType F = TNEW(FunctionType){.ret = ResType, .params = ArgTypes, .isVarArg = TypeStr[0] == '.'};
         F->setKind(TYFUNCTION);
         return F;
     }
@@ -572,6 +574,53 @@ struct xcc_context {
         (void)memcpy(mem, src, size);
         return mem;
     }
+    // copy the null-terminated encoded string into the arena
+    template <typename T> [[nodiscard]] const StringLiteralData *createStringLiteral(ArrayRef<T> elements) {
+        assert(!elements.empty() && elements.back() == 0 && "string literal must be null terminated");
+        const size_t Size = elements.size() * sizeof(T);
+        StringLiteralData *S = new (getAllocator()) StringLiteralData{
+            .data = reinterpret_cast<const char *>(new_memcpy(Size, elements.data())),
+            .numElements = static_cast<uint32_t>(elements.size()),
+            .charSizeInBits = static_cast<uint8_t>(sizeof(T) * 8)};
+        return S;
+    }
+    [[nodiscard]] const StringLiteralData *createStringLiteral(StringRef s) {
+        return createStringLiteral(ArrayRef<char>(s.data(), s.size()));
+    }
+    // copy the packed elements of an array initializer into the arena, `bytes` holds the elements of all runs
+    [[nodiscard]] const PackedArrayData *createPackedArray(uint8_t elementSize, ArrayRef<PackedArrayData::Run> runs, StringRef bytes) {
+        PackedArrayData::Run *R = getAllocator().Allocate<PackedArrayData::Run>(runs.size());
+        std::uninitialized_copy(runs.begin(), runs.end(), R);
+        return new (getAllocator()) PackedArrayData{
+            .data = bytes.empty() ? nullptr : reinterpret_cast<const char *>(new_memcpy(bytes.size(), bytes.data())),
+            .runs = R,
+            .numRuns = static_cast<uint32_t>(runs.size()),
+            .elementSize = elementSize};
+    }
+    // front-end constants(see ConstantValue): wide integers and floating numbers keep their words on the heap, so they
+    // are destroyed with the arena
+    template <typename T, typename V> [[nodiscard]] const T *createNumberConstant(V &&value) {
+        if (value.needsCleanup())
+            return getAllocator().createWithDestructor<T>(std::forward<V>(value));
+        return new (getAllocator()) T(std::forward<V>(value));
+    }
+    [[nodiscard]] const IntConstant *createIntConstant(APInt V) { return createNumberConstant<IntConstant>(std::move(V)); }
+    [[nodiscard]] const FloatConstant *createFloatConstant(APFloat V) { return createNumberConstant<FloatConstant>(std::move(V)); }
+    [[nodiscard]] const PointerConstant *createPointerConstant(APInt address) {
+        return createNumberConstant<PointerConstant>(std::move(address));
+    }
+    [[nodiscard]] const ComplexConstant *createComplexConstant(const ConstantValue *real, const ConstantValue *imag) {
+        return new (getAllocator()) ComplexConstant(real, imag);
+    }
+    [[nodiscard]] const VectorConstant *createVectorConstant(ArrayRef<const ConstantValue *> elements) {
+        const ConstantValue **E = getAllocator().Allocate<const ConstantValue *>(elements.size());
+        std::uninitialized_copy(elements.begin(), elements.end(), E);
+        return new (getAllocator()) VectorConstant(E, static_cast<uint32_t>(elements.size()));
+    }
+    [[nodiscard]] const UndefConstant *getUndefConstant(bool isPoison = false) {
+        static const UndefConstant undef{false}, poison{true};
+        return isPoison ? &poison : &undef;
+    }
     [[nodiscard]] CType fromLLVMType(const llvm::Type *Ty) {
         switch (Ty->getTypeID()) {
         case llvm::Type::HalfTyID: return getFPHalf();
@@ -9,15 +9,13 @@ struct xstring {
         size_t _length, _capacity;
         char _data[0];
     } *p;
-    void free() const { std::free(reinterpret_cast<void *>(this->p)); };
-    static xstring get() {
-        xstring res;
-        size_t init_size = 15;
-        res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + init_size));
-        res.p->_length = 0;
-        res.p->_capacity = init_size;
-        return res;
-    }
+    // the capacity of a frozen string: the buffer is in an arena, it cannot grow and is never freed
+    static constexpr size_t frozen_capacity = size_t(-1);
+    void free() const {
+        if (p && !is_frozen())
+            std::free(reinterpret_cast<void *>(this->p));
+    };
+    static xstring get() { return get_with_capacity(15); }
     static xstring get_from_pointer(void *ptr) {
         xstring res;
         res.p = reinterpret_cast<_xstring_impl*>(ptr);
@@ -25,11 +23,8 @@ struct xstring {
     }
     static xstring get_empty() { return xstring{.p = nullptr}; }
     static xstring get_from_char(char c) {
-        xstring res;
-        size_t init_size = 15;
-        res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + init_size));
+        xstring res = get();
         res.p->_length = 1;
-        res.p->_capacity = init_size;
         res.p->_data[0] = c;
         return res;
     }
@@ -51,7 +46,7 @@ struct xstring {
         xstring res;
         size_t len = std::strlen(s);
         res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + len));
-        res.p->_length = 0;
+        res.p->_length = len;
         res.p->_capacity = len;
         memcpy(reinterpret_cast<void *>(&res.p->_data), reinterpret_cast<const void *>(s), len);
         return res;
@@ -60,7 +55,7 @@ struct xstring {
         xstring res;
         size_t len = s.size();
         res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + len));
-        res.p->_length = 0;
+        res.p->_length = len;
         res.p->_capacity = len;
         memcpy(reinterpret_cast<void *>(&res.p->_data), s.data(), len);
         return res;
@@ -69,7 +64,7 @@ struct xstring {
         xstring res;
         size_t len = s.size();
         res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + len));
-        res.p->_length = 0;
+        res.p->_length = len;
         res.p->_capacity = len;
         memcpy(reinterpret_cast<void *>(&res.p->_data), s.data(), len);
         return res;
@@ -79,7 +74,7 @@ struct xstring {
         xstring res;
         size_t len = s.size();
         res.p = reinterpret_cast<_xstring_impl *>(llvm::safe_malloc(sizeof(_xstring_impl) + len));
-        res.p->_length = 0;
+        res.p->_length = len;
         res.p->_capacity = len;
         memcpy(reinterpret_cast<void *>(&res.p->_data), s.data(), len);
         return res;
@@ -93,7 +88,7 @@ struct xstring {
     size_t size() const { return p->_length; }
     size_t &msize() { return p->_length; }
     size_t length() const { return p->_length; }
-    size_t size_in_bytes() const { return p->_length * sizeof(_xstring_impl); }
+    size_t size_in_bytes() const { return p->_length; }
     size_t capacity() const { return p->_capacity; }
     // return maybe not null-termiated string
     const char *data() const { return p->_data; }
@@ -117,24 +112,34 @@ struct xstring {
         assert(Index < p->_length && "Index too large!");
         return p->_data[Index];
     }
-    void add(char c) {
-        if (p->_length >= p->_capacity) {
-            ++p->_capacity;
-            p->_capacity *= 3;
-            p->_capacity /= 2;
+    // a frozen copy of `s` in the arena, for AST payloads which never change after they are built.
+    // free() does nothing on a frozen string, and it cannot grow.
+    static xstring get_frozen(StringRef s, ArenaAllocator &A) {
+        xstring res;
+        res.p = reinterpret_cast<_xstring_impl *>(A.Allocate(sizeof(_xstring_impl) + s.size(), alignof(_xstring_impl)));
+        res.p->_length = s.size();
+        res.p->_capacity = frozen_capacity;
+        memcpy(res.p->_data, s.data(), s.size());
+        return res;
+    }
+    bool is_frozen() const { return p->_capacity == frozen_capacity; }
+    // make room for `required` chars, growing at least 1.5x so that any sequence of appends is amortized O(1)
+    void reserve(size_t required) {
+        assert(!is_frozen() && "a frozen xstring cannot grow");
+        if (required > p->_capacity) {
+            p->_capacity = std::max(required, p->_capacity + p->_capacity / 2 + 1);
             p = reinterpret_cast<_xstring_impl *>(llvm::safe_realloc(p, sizeof(_xstring_impl) + p->_capacity));
         }
+    }
+    void add(char c) {
+        reserve(p->_length + 1);
         p->_data[p->_length++] = c;
     }
     void add(StringRef s) {
         size_t len = s.size();
-        size_t after = len + p->_length;
-        if (after > p->_capacity) {
-            p->_capacity += len;
-            p = reinterpret_cast<_xstring_impl *>(llvm::safe_realloc(p, sizeof(_xstring_impl) + p->_capacity));
-        }
+        reserve(p->_length + len);
         memcpy(p->_data + p->_length, s.data(), len);
-        p->_length = after;
+        p->_length += len;
     }
     void add(const char *s) {
         size_t len = strlen(s);
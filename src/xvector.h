@@ -8,6 +8,15 @@ struct xvectorBase {
     static void *realloc_buffer(void *origin, size_t Bytes) {
         return llvm::safe_realloc(origin, Bytes);
     }
+    // the capacity of a frozen vector: the buffer is in an arena, it cannot grow and is never freed
+    static constexpr size_t frozen_capacity = size_t(-1);
+    // most vectors in the AST(call arguments, member indexes, parameters) have 1-4 elements
+    static constexpr size_t small_capacity = 4;
+    // the capacity after growing a vector to hold at least `required` elements: at least 1.5x, so that any sequence of
+    // appends is amortized O(1)
+    static size_t grow_capacity(size_t capacity, size_t required) {
+        return std::max(required, capacity + capacity / 2 + 1);
+    }
 };
 template <typename T> struct xvector: public xvectorBase {
     struct _xvector_impl {
@@ -15,15 +24,11 @@ template <typename T> struct xvector: public xvectorBase {
         T _data[0];
     } *p;
     using p_xvector_impl = _xvector_impl *;
-    void free() { destroy_buffer(p); };
-    static xvector<T> get() {
-        xvector<T> res;
-        size_t init_size = 15;
-        res.p = reinterpret_cast<p_xvector_impl>(allocate_buffer(sizeof(_xvector_impl) + init_size * sizeof(T)));
-        res.p->_length = 0;
-        res.p->_capacity = init_size;
-        return res;
-    }
+    void free() {
+        if (p && !is_frozen())
+            destroy_buffer(p);
+    };
+    static xvector<T> get() { return get_with_capacity(small_capacity); }
     static xvector<T> get_empty() {
         return get_with_capacity(0);
     }
@@ -63,11 +68,30 @@ template <typename T> struct xvector: public xvectorBase {
         res.p->_capacity = length;
         return res;
     }
+    // a frozen copy of `elems` in the arena, for AST payloads which never change after they are built.
+    // free() does nothing on a frozen vector, and it cannot grow.
+    static xvector<T> get_frozen(ArrayRef<T> elems, ArenaAllocator &A) {
+        xvector<T> res;
+        res.p = reinterpret_cast<p_xvector_impl>(A.Allocate(sizeof(_xvector_impl) + elems.size() * sizeof(T), alignof(_xvector_impl)));
+        res.p->_length = elems.size();
+        res.p->_capacity = frozen_capacity;
+        std::uninitialized_copy(elems.begin(), elems.end(), res.p->_data);
+        return res;
+    }
+    // move the elements into a frozen vector in the arena, and release the heap buffer
+    xvector<T> freeze(ArenaAllocator &A) {
+        if (is_frozen())
+            return *this;
+        xvector<T> res = get_frozen(*this, A);
+        free();
+        return res;
+    }
+    bool is_frozen() const { return p->_capacity == frozen_capacity; }
     void clear() { p->_length = 0; }
     size_t size() const { return p->_length; }
     size_t &msize() { return p->_length; }
     size_t length() const { return p->_length; }
-    size_t size_in_bytes() const { return p->_length * sizeof(_xvector_impl) * sizeof(T); }
+    size_t size_in_bytes() const { return p->_length * sizeof(T); }
     size_t capacity() const { return p->_capacity; }
     const T *data() const { return p->_data; }
     T *data() { return p->_data; }
@@ -77,13 +101,13 @@ template <typename T> struct xvector: public xvectorBase {
         pop_back();
     }
     const T *find(const T &elem) const {
-        for (const T &it = begin(); it != end(); ++it) {
+        for (const T *it = begin(); it != end(); ++it) {
             if (*it == elem)
-                return &it;
+                return it;
         }
         return nullptr;
     }
-    T *find(const T &elem) { return const_cast<const xvector<T>>(*this)->find(elem); }
+    T *find(const T &elem) { return const_cast<T *>(static_cast<const xvector<T> &>(*this).find(elem)); }
     T operator[](size_t Index) const {
         assert(Index < p->_length && "Index too large!");
         return p->_data[Index];
@@ -92,27 +116,28 @@ template <typename T> struct xvector: public xvectorBase {
         assert(Index < p->_length && "Index too large!");
         return p->_data[Index];
     }
-    void grow() {
-        if (p->_length >= p->_capacity) {
-            ++p->_capacity;
-            p->_capacity *= 3;
-            p->_capacity /= 2;
+    // make room for `required` elements
+    void reserve(size_t required) {
+        assert(!is_frozen() && "a frozen xvector cannot grow");
+        if (required > p->_capacity) {
+            p->_capacity = grow_capacity(p->_capacity, required);
             p = reinterpret_cast<p_xvector_impl>(
                 realloc_buffer(p, sizeof(_xvector_impl) + p->_capacity * sizeof(T)));
         }
     }
-    void append(const void *src, size_t num) {
-        auto Pos = end();
+    void grow() { reserve(p->_length + 1); }
+    // append `num` elements copied from `src`
+    void append(const T *src, size_t num) {
+        reserve(p->_length + num);
+        std::uninitialized_copy(src, src + num, end());
         p->_length += num;
-        grow();
-        memcpy(Pos, src, num);
     }
+    void append(ArrayRef<T> elems) { append(elems.data(), elems.size()); }
+    // append `num` copies of `c`
     void append(const T &c, size_t num) {
-        auto Ptr = p->_data + p->_length;
+        reserve(p->_length + num);
+        std::uninitialized_fill_n(end(), num, c);
         p->_length += num;
-        grow();
-        for (size_t i = 0; i < num; ++i)
-            Ptr[i] = c;
     }
     void push_back(const T &c) {
         grow();
@@ -0,0 +1,55 @@
+/*
+GNU and C23 attributes on functions, `xcc -O0 -emit-llvm`:
+
+    define internal i32 @add(i32 %0, i32 %1) #1          ; always_inline: no noinline/optnone even at -O0
+    define dso_local i32 @slow_path(i32 %0) #2            ; noinline cold
+    define dso_local i32 @hot_loop(ptr %0, i32 %1) #3     ; hot
+    define dso_local i32 @flat(i32 %0)                    ; flatten: every call is `call ... #4`(alwaysinline)
+    declare i32 @lookup(ptr nonnull, i32, ptr nonnull) #5 ; pure, nonnull(1, 3)
+    declare i32 @square(i32) #6                           ; const
+    declare noalias ptr @xalloc(i64)                      ; malloc
+    declare void @fatal(ptr) #7                           ; noreturn
+    define dso_local void @f16() #0 align 16             ; aligned(16)
+
+    attributes #1 = { alwaysinline inlinehint nounwind }
+    attributes #2 = { cold noinline nounwind optnone }
+    attributes #3 = { hot noinline nounwind optnone }
+    attributes #4 = { alwaysinline }
+    attributes #5 = { nounwind readonly }
+    attributes #6 = { nounwind readnone }
+    attributes #7 = { noreturn nounwind }
+
+unknown attributes are diagnosed and ignored:
+
+    warning: unknown attribute 'not_an_attribute' ignored
+    warning: unknown attribute 'thing' ignored
+*/
+static inline __attribute__((always_inline)) int add(int a, int b) { return a + b; }
+
+__attribute__((noinline, cold)) int slow_path(int x) { return x * 3; }
+
+[[gnu::hot]] int hot_loop(const int *p, int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s = add(s, p[i]);
+    return s;
+}
+
+__attribute__((flatten)) int flat(int x) { return add(x, slow_path(x)); }
+
+int lookup(const char *key, int len, const int *table) __attribute__((pure, nonnull(1, 3)));
+[[gnu::const]] int square(int);
+void *xalloc(unsigned long) __attribute__((__malloc__));
+__attribute__((noreturn)) void fatal(const char *msg);
+
+void f16(void) __attribute__((aligned(16)));
+void f16(void) {}
+
+__attribute__((not_an_attribute)) int g(void);
+[[vendor::thing]] int h(void);
+
+int use(const char *key, const int *table, int x) {
+    if (x < 0)
+        fatal(key);
+    return lookup(key, x, table) + square(x) + (xalloc(x) != 0);
+}
@@ -0,0 +1,38 @@
+/*
+attributes on global variables and functions that control the symbol, `xcc -O0 -emit-llvm`:
+
+    @buffer = common dso_local global [100 x i8] zeroinitializer, align 64
+    @config = dso_local global i32 1, section ".rodata.config", align 4
+    @counter = weak dso_local global i32 0, align 4
+    @keep = internal global i32 42, align 4
+    @hidden_var = common hidden global i32 0, align 4
+    @maybe = extern_weak global i32, align 4
+    @real_impl_alias = alias i32 (i32), ptr @real_impl
+    @llvm.used = appending global [1 x ptr] [ptr @keep], section "llvm.metadata"
+
+    define weak dso_local i32 @default_handler(i32 %0)
+    define hidden i32 @internal_api(i32 %0)
+
+a local variable keeps its alignment:
+
+    alloca [16 x i8], align 32
+*/
+char buffer[100] __attribute__((aligned(64)));
+__attribute__((section(".rodata.config"))) int config = 1;
+__attribute__((weak)) int counter;
+static int keep __attribute__((used)) = 42;
+__attribute__((visibility("hidden"))) int hidden_var;
+extern int maybe __attribute__((weak));
+
+int real_impl(int x) { return x + maybe; }
+int real_impl_alias(int) __attribute__((alias("real_impl")));
+
+__attribute__((weak)) int default_handler(int sig) { return sig; }
+__attribute__((visibility("hidden"))) int internal_api(int x) { return real_impl_alias(x); }
+
+int local(void) {
+    __attribute__((unused)) int unused_var;
+    char buf[16] __attribute__((aligned(32)));
+    buf[0] = 1;
+    return buf[0];
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# generate struct-walking loops whose loop-invariant loads are hoisted only with type-based alias analysis;
+# the same file is compiled with -fstrict-aliasing and -fno-strict-aliasing
+# usage: python3 gen_aliasing.py [N] [ITERATIONS] > bench/aliasing.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 4096
+ITERATIONS = int(sys.argv[2]) if len(sys.argv) > 2 else 20000
+
+print(f"""int printf(const char *, ...);
+long clock(void);
+
+#define N {N}
+#define ITERATIONS {ITERATIONS}
+
+struct vec {{ float x, y, z; }};
+struct body {{ struct vec pos, vel; float mass; int id; }};
+struct world {{ struct body *bodies; int n; float dt; float gravity; }};
+struct histogram {{ float *buckets; int nbuckets; int shift; }};
+
+static struct body bodies[N];
+static long ticks[N];
+static float buckets[256];
+static short samples[N];
+
+static void report(const char *name, long start, double sink) {{
+    printf("%-28s %8.3f s  (%g)\\n", name, (double)(clock() - start) / 1000000, sink);
+}}
+
+// w->n, w->dt, w->gravity and w->bodies are reloaded after every store unless TBAA proves the stores cannot modify them
+__attribute__((noinline)) void integrate(struct world *w, long *t) {{
+    for (int i = 0; i < w->n; ++i) {{
+        w->bodies[i].vel.y -= w->gravity * w->dt;
+        w->bodies[i].pos.x += w->bodies[i].vel.x * w->dt;
+        w->bodies[i].pos.y += w->bodies[i].vel.y * w->dt;
+        t[i] += 1;
+    }}
+}}
+
+// a float store may alias h->nbuckets and h->shift(both int) without TBAA; an unsigned store always may
+__attribute__((noinline)) void fill(struct histogram *h, const short *s, int n) {{
+    for (int i = 0; i < n; ++i)
+        h->buckets[((unsigned)s[i] >> h->shift) & (h->nbuckets - 1)] += 1.0f;
+}}
+
+// the float sum cannot be kept in a register if a long store may modify it
+__attribute__((noinline)) float energy(const struct world *w, long *t, float *sum) {{
+    for (int i = 0; i < w->n; ++i) {{
+        *sum += w->bodies[i].mass * w->bodies[i].vel.y * w->bodies[i].vel.y;
+        t[i] = w->bodies[i].id;
+    }}
+    return *sum;
+}}
+
+int main(void) {{
+    struct world w = {{bodies, N, 0.001f, 9.8f}};
+    struct histogram h = {{buckets, 256, 4}};
+    for (int i = 0; i < N; ++i) {{
+        bodies[i].vel.x = (float)(i % 7);
+        bodies[i].mass = 1.0f + (float)(i % 3);
+        bodies[i].id = i;
+        samples[i] = (short)(i * 37);
+    }}
+    long start = clock();
+    for (int k = 0; k < ITERATIONS; ++k)
+        integrate(&w, ticks);
+    report("integrate", start, bodies[N - 1].pos.y);
+    start = clock();
+    for (int k = 0; k < ITERATIONS; ++k)
+        fill(&h, samples, N);
+    report("histogram", start, buckets[3]);
+    start = clock();
+    float sum = 0;
+    for (int k = 0; k < ITERATIONS; ++k)
+        energy(&w, ticks, &sum);
+    report("energy", start, sum);
+    return 0;
+}}""")
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# generate a contention microbenchmark of atomic memory orders: the same kernels with explicit relaxed/acquire/release orders and with seq_cst
+# usage: python3 gen_atomics.py [N] [THREADS] > bench/atomics.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000000
+THREADS = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+
+print(f"""typedef unsigned long size_t;
+typedef unsigned long pthread_t;
+int printf(const char *, ...);
+long clock(void);
+int pthread_create(pthread_t *, const void *, void *(*)(void *), void *);
+int pthread_join(pthread_t, void **);
+
+#define N {N}UL
+#define THREADS {THREADS}
+enum {{ relaxed, consume, acquire, release, acq_rel, seq_cst }};
+
+static long counter;
+static int lock;
+static long shared;
+// a single-producer single-consumer ring
+static unsigned long ring[1024], ring_head, ring_tail;
+
+static void run(const char *name, void *(*fn)(void *), int threads) {{
+    pthread_t t[THREADS];
+    long start = clock();
+    for (int i = 0; i < threads; ++i)
+        pthread_create(&t[i], 0, fn, (void *)(long)i);
+    for (int i = 0; i < threads; ++i)
+        pthread_join(t[i], 0);
+    printf("%-34s %8.3f s cpu  (%ld)\\n", name, (double)(clock() - start) / 1000000, counter + shared);
+    counter = shared = 0;
+    ring_head = ring_tail = 0;
+}}""")
+
+for name, order, acq, rel in (("relaxed", "relaxed", "acquire", "release"), ("seq_cst", "seq_cst", "seq_cst", "seq_cst")):
+    print(f"""
+// reference counting: increments that need no ordering
+static void *refcount_{name}(void *arg) {{
+    for (unsigned long i = 0; i < N; ++i)
+        __atomic_fetch_add(&counter, 1, {order});
+    return 0;
+}}
+
+// a spin lock: acquire on lock, release on unlock
+static void *spinlock_{name}(void *arg) {{
+    for (unsigned long i = 0; i < N / 4; ++i) {{
+        int expected = 0;
+        while (!__atomic_compare_exchange_n(&lock, &expected, 1, 1, {acq}, relaxed))
+            expected = 0;
+        ++shared;
+        __atomic_store_n(&lock, 0, {rel});
+    }}
+    return 0;
+}}
+
+// a single-producer single-consumer queue: thread 0 produces, thread 1 consumes
+static void *spsc_{name}(void *arg) {{
+    if (arg == 0) {{
+        for (unsigned long i = 0; i < N; ++i) {{
+            unsigned long h = __atomic_load_n(&ring_head, relaxed);
+            while (h - __atomic_load_n(&ring_tail, {acq}) == 1024)
+                ;
+            ring[h & 1023] = i;
+            __atomic_store_n(&ring_head, h + 1, {rel});
+        }}
+    }} else {{
+        long sum = 0;
+        for (unsigned long i = 0; i < N; ++i) {{
+            unsigned long t = __atomic_load_n(&ring_tail, relaxed);
+            while (__atomic_load_n(&ring_head, {acq}) == t)
+                ;
+            sum += ring[t & 1023];
+            __atomic_store_n(&ring_tail, t + 1, {rel});
+        }}
+        __atomic_fetch_add(&counter, sum, relaxed);
+    }}
+    return 0;
+}}""")
+
+print("\nint main(void) {")
+for kernel, threads in (("refcount", "THREADS"), ("spinlock", "THREADS"), ("spsc", "2")):
+    for name, label in (("relaxed", "explicit orders"), ("seq_cst", "seq_cst")):
+        print(f'    run("{kernel} ({label})", {kernel}_{name}, {threads});')
+print("    return 0;\n}")
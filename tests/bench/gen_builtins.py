@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# generate a microbenchmark of the builtins lowered to LLVM intrinsics against their libcall fallbacks(libgcc and libc)
+# usage: python3 gen_builtins.py [N] > bench/builtins.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 100000000
+
+print(f"""typedef unsigned long size_t;
+int printf(const char *, ...);
+long clock(void);
+void *memcpy(void *, const void *, size_t);
+int __popcountdi2(long);
+int __clzdi2(long);
+unsigned long __bswapdi2(unsigned long);
+
+#define N {N}UL
+static void *(*volatile memcpy_ptr)(void *, const void *, size_t) = memcpy;
+static struct {{ long a[4]; }} src[16], dst[16];
+
+static void report(const char *name, long start, unsigned long sink) {{
+    printf("%-28s %8.3f s  (%lu)\\n", name, (double)(clock() - start) / 1000000, sink);
+}}""")
+
+kernels = [
+    ("popcount", "s += __builtin_popcountl(i * 0x9E3779B97F4A7C15UL);", "s += __popcountdi2(i * 0x9E3779B97F4A7C15UL);"),
+    ("clz", "s += __builtin_clzl(i | 1);", "s += __clzdi2(i | 1);"),
+    ("bswap", "s += __builtin_bswap64(i);", "s += __bswapdi2(i);"),
+    ("memcpy 32 bytes", "__builtin_memcpy(&dst[i & 15], &src[(i + 1) & 15], sizeof(dst[0])); s += dst[i & 15].a[0];",
+                        "memcpy_ptr(&dst[i & 15], &src[(i + 1) & 15], sizeof(dst[0])); s += dst[i & 15].a[0];"),
+    ("mul overflow", "unsigned long r; s += __builtin_umull_overflow(i, s | 3, &r) ? 1 : r;",
+                     "unsigned long r = i * (s | 3); s += i && r / i != (s | 3) ? 1 : r;"),
+]
+for name, builtin, fallback in kernels:
+    ident = name.split()[0]
+    for kind, body in (("builtin", builtin), ("libcall", fallback)):
+        print(f"""
+static unsigned long {ident}_{kind}(void) {{
+    unsigned long s = 0;
+    for (unsigned long i = 0; i < N; ++i) {{
+        {body}
+    }}
+    return s;
+}}""")
+
+print("\nint main(void) {\n    long start;")
+for name, _, _ in kernels:
+    ident = name.split()[0]
+    for kind in ("builtin", "libcall"):
+        print(f'    start = clock();\n    report("{name} ({kind})", start, {ident}_{kind}());')
+print("    return 0;\n}")
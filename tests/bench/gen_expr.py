@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+# generate expression-dense C code(big constant tables and math kernels) for benchmarking the parser
+# usage: python3 gen_expr.py [N] > expr.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+# constant table: every element is folded by the parser
+print("static const unsigned table[] = {")
+for i in range(N):
+    print(f"    ({i} * 3 + 1) << 2 | ({i} & 0xff) ^ {i} % 7 - ({i} >> 1),")
+print("};")
+
+# math kernels: long binary chains of non-constant operands
+for k in range(N // 100):
+    print(f"double kernel{k}(double a, double b, double c, int i, int j) {{")
+    print("    return " + " + ".join(f"a * b - c / {n + 1}.0" for n in range(50)) + ";")
+    print("}")
+    print(f"int predicate{k}(int i, int j, int k) {{")
+    print("    return " + " && ".join(f"(i + {n} < j || j * {n} >= k)" for n in range(50)) + ";")
+    print("}")
+
+# deep left-leaning chain
+print("int chain(int a) {")
+print("    return " + " + ".join("a" for _ in range(N)) + ";")
+print("}")
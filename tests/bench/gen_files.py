@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+# generate many small translation units that include a common header, for benchmarking multi-file compilation
+# usage: python3 gen_files.py [N] [directory]
+import os
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+out = sys.argv[2] if len(sys.argv) > 2 else "bench/files"
+os.makedirs(out, exist_ok=True)
+
+with open(os.path.join(out, "common.h"), "w") as f:
+    f.write("#ifndef COMMON_H\n#define COMMON_H\n")
+    f.write("struct point { int x, y; };\n")
+    for i in range(200):
+        f.write(f"#define K{i} {i * 7 % 101}\n")
+        f.write(f"int shared_{i}(int a, struct point p);\n")
+    f.write("#endif\n")
+
+for i in range(N):
+    with open(os.path.join(out, f"f{i}.c"), "w") as f:
+        f.write('#include "common.h"\n')
+        f.write(f"static int table_{i}[] = {{K{i % 200}, K{(i + 1) % 200}, {i}}};\n")
+        f.write(f"int func_{i}(int a, struct point p) {{\n")
+        f.write(f"    int s = a * {i % 13 + 1} + p.x - p.y;\n")
+        f.write(f"    for (int k = 0; k < 3; ++k)\n")
+        f.write(f"        s += table_{i}[k] ^ (s >> {i % 5 + 1});\n")
+        f.write(f"    return s + shared_{i % 200}(a, p);\n")
+        f.write("}\n")
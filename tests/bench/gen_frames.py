@@ -0,0 +1,20 @@
+#!/usr/bin/env python3
+# generate functions with many disjoint block-scoped buffers(per-case buffers in a switch, sequential blocks, loop bodies),
+# the stack frames are compared with and without lifetime markers
+# usage: python3 gen_frames.py [FUNCTIONS] > bench/frames.c
+import sys
+
+FUNCTIONS = int(sys.argv[1]) if len(sys.argv) > 1 else 200
+
+print("int fill(char *buf, int n);")
+for f in range(FUNCTIONS):
+    cases = 4 + f % 13
+    size = 256 << (f % 5)
+    print(f"\nint handler{f}(int op) {{\n    int r = 0;\n    switch (op) {{")
+    for c in range(cases):
+        print(f"    case {c}: {{\n        char buf[{size}];\n        r = fill(buf, {c});\n        break;\n    }}")
+    print("    }")
+    for b in range(f % 4):
+        print(f"    {{\n        char tmp{b}[{size * 2}];\n        r += fill(tmp{b}, r);\n    }}")
+    print(f"    for (int i = 0; i < op; ++i) {{\n        char line[{size}];\n        r += fill(line, i);\n    }}")
+    print("    return r;\n}")
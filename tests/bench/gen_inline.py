@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# generate hot loops over chains of small static helpers, which are only fast if the helpers are inlined;
+# the file is compiled at -O2 and at -Os, and the `optsize` variant(every function under `#pragma GCC optimize("Os")`,
+# what -O2 used to emit) at -O2
+# a struct is assigned the result of a call instead of being initialized with it, which xcc does not accept yet
+# usage: python3 gen_inline.py [KERNELS] [DEPTH] [ITERATIONS] [optsize] > bench/inline.c
+import sys
+
+KERNELS = int(sys.argv[1]) if len(sys.argv) > 1 else 8
+DEPTH = int(sys.argv[2]) if len(sys.argv) > 2 else 6
+ITERATIONS = int(sys.argv[3]) if len(sys.argv) > 3 else 2000
+OPTSIZE = len(sys.argv) > 4 and sys.argv[4] == "optsize"
+
+print("""int printf(const char *, ...);
+long clock(void);
+""")
+if OPTSIZE:
+    print('#pragma GCC optimize("Os")\n')
+
+print(f"""#define N 4096
+#define ITERATIONS {ITERATIONS}
+
+struct vec {{ float x, y, z; }};
+
+static struct vec points[N];
+static float out[N];
+
+static void report(const char *name, long start, double sink) {{
+    printf("%-12s %8.3f s  (%g)\\n", name, (double)(clock() - start) / 1000000, sink);
+}}
+
+static float clampf(float v, float lo, float hi) {{ return v < lo ? lo : v > hi ? hi : v; }}
+static float dot(struct vec a, struct vec b) {{ return a.x * b.x + a.y * b.y + a.z * b.z; }}
+static struct vec scale(struct vec a, float s) {{
+    struct vec r = {{a.x * s, a.y * s, a.z * s}};
+    return r;
+}}
+static struct vec add(struct vec a, struct vec b) {{
+    struct vec r = {{a.x + b.x, a.y + b.y, a.z + b.z}};
+    return r;
+}}""")
+
+for k in range(KERNELS):
+    print(f"\nstatic struct vec k{k}_stage0(struct vec v) {{ return scale(v, {1.0 + k * 0.01:.2f}f); }}")
+    for d in range(1, DEPTH + 1):
+        print(f"""static struct vec k{k}_stage{d}(struct vec v) {{
+    struct vec w;
+    w = k{k}_stage{d - 1}(v);
+    float t = clampf(dot(w, v) * {0.5 + d * 0.05:.2f}f, -{d + 1}.0f, {d + 1}.0f);
+    struct vec u = {{w.y - t, w.z + t, w.x * {0.9 - d * 0.01:.2f}f}};
+    return add(scale(u, 0.5f), scale(w, 0.5f));
+}}""")
+    print(f"""__attribute__((noinline)) void kernel{k}(void) {{
+    for (int i = 0; i < N; ++i) {{
+        struct vec r;
+        r = k{k}_stage{DEPTH}(points[i]);
+        out[i] += r.x + r.y + r.z;
+    }}
+}}""")
+
+print("""
+int main(void) {
+    for (int i = 0; i < N; ++i) {
+        points[i].x = (float)(i % 17) * 0.25f;
+        points[i].y = (float)(i % 5) - 2.0f;
+        points[i].z = (float)(i % 11) * 0.125f;
+    }
+    long start = clock();
+    for (int n = 0; n < ITERATIONS; ++n) {""")
+for k in range(KERNELS):
+    print(f"        kernel{k}();")
+print("""    }
+    report("kernels", start, out[N - 1]);
+    return 0;
+}""")
@@ -0,0 +1,21 @@
+#!/usr/bin/env python3
+# generate array-heavy C code(sizeof, _Alignof, pointer arithmetic and subscripts) for benchmarking type layout queries
+# usage: python3 gen_layout.py [N] > layout.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+print("typedef double mat[4][4][4];")
+print("typedef mat mats[8][8];")
+
+# constant sizes: every one is folded by the parser
+print("static const unsigned long sizes[] = {")
+for i in range(N):
+    print(f"    sizeof(mats) * {i} + _Alignof(mat) + sizeof(int[{i % 64 + 1}][3]) - sizeof(mat[2]),")
+print("};")
+
+# pointer arithmetic on pointers to arrays scales by the size of the array
+for k in range(N // 100):
+    print(f"double walk{k}(mat *p, mats *q, int i) {{")
+    print("    return " + " + ".join(f"(*(p + i + {n}))[1][2][3] * (*(q + {n}))[i][1][0][0][{n % 4}]" for n in range(50)) + ";")
+    print("}")
@@ -0,0 +1,25 @@
+#!/usr/bin/env python3
+# generate lvalue-dense C code(variable references, member accesses, dereferences and constant variables) for measuring
+# the arena memory of expressions: benchParser prints the bytes allocated, the number of lvalues is printed to stderr
+# usage: python3 gen_lvalues.py [N] > lvalues.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+print("struct point { int x, y; };")
+print("struct line { struct point a, b; const int id; };")
+print("static const int K = 3;")
+
+lvalues = 0
+for k in range(N // 50):
+    print(f"int walk{k}(struct line *l, struct point p, int *q, int i) {{")
+    print("    const int c = i * K;")
+    print("    int s = 0;")
+    for n in range(10):
+        # 16 lvalues: s, l, l->a, l->a.x, l, l->b, l->b.y, p, p.x, q, *q, q, q[n], i, c and K
+        print(f"    s += l->a.x + l->b.y + p.x + *q + q[{n}] + i + c + K;")
+        lvalues += 16
+    print("    return s;")
+    print("}")
+
+print(f"{lvalues} lvalue expressions", file=sys.stderr)
@@ -0,0 +1,17 @@
+#!/usr/bin/env python3
+# generate huge switch statements(state machines with many cases and GNU case ranges) for benchmarking case validation
+# usage: python3 gen_switch.py [N] > switch.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+print("int state_machine(int state, int c) {")
+print("    switch (state) {")
+# cases are emitted out of order, mixed with ranges
+for i in range(N):
+    v = (i * 7919) % N * 4
+    print(f"    case {v}: return {i};")
+    print(f"    case {v + 1} ... {v + 3}: return c + {i};")
+print("    default: return -1;")
+print("    }")
+print("}")
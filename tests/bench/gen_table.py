@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+# generate big lookup tables and sparse designated initializers for benchmarking array initializers
+# usage: python3 gen_table.py [N] > table.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 100000
+
+# dense tables: one constant per element
+print("static const unsigned char crc_bytes[] = {")
+for i in range(0, N, 16):
+    print("    " + ", ".join(str((i + j) * 31 % 256) for j in range(16)) + ",")
+print("};")
+print("static const int squares[] = {")
+for i in range(0, N, 8):
+    print("    " + ", ".join(f"{(i + j) % 46340} * {(i + j) % 46340}" for j in range(8)) + ",")
+print("};")
+print("static const double weights[] = {")
+for i in range(0, N, 8):
+    print("    " + ", ".join(f"{(i + j) / 7:.6f}" for j in range(8)) + ",")
+print("};")
+
+# sparse tables: a few designated elements in a huge array
+print(f"static int sparse[{N * 100}] = {{")
+for i in range(0, N * 100, 997):
+    print(f"    [{i}] = {i % 1000}, {i % 7},")
+print("};")
+
+print("int lookup(int i) {")
+print(f"    return crc_bytes[i % {N}] + squares[i % {N}] + (int)weights[i % {N}] + sparse[i];")
+print("}")
@@ -0,0 +1,19 @@
+#!/usr/bin/env python3
+# generate a file with many declarations(like a big header) and many undeclared identifiers(like a missing include)
+# for benchmarking typo correction
+# usage: python3 gen_typos.py [N] > typos.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+for i in range(N):
+    print(f"int library_function_{i}(int);")
+    print(f"extern int library_variable_{i};")
+
+print("int user(int x) {")
+for i in range(N // 10):
+    # close to a declared name, and far from any declared name
+    print(f"    x += libary_function_{i * 7 % N}(x);")
+    print(f"    x += missing_header_symbol_{i};")
+print("    return x;")
+print("}")
@@ -0,0 +1,17 @@
+#!/usr/bin/env python3
+# generate warning-heavy C code(unused variables, parameters and expression results) for benchmarking diagnostics
+# usage: python3 gen_warnings.py [N] > warnings.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+# every expansion warns at the same spelling location
+print("#define TOUCH(x) ((x) + 1)")
+for i in range(N):
+    print(f"int f{i}(int a{i}, int b{i}) {{")
+    print(f"    int unused{i};")
+    print(f"    int assigned{i} = a{i};")
+    print(f"    a{i} * 2;")
+    print(f"    TOUCH(b{i});")
+    print(f"    return b{i};")
+    print("}")
@@ -0,0 +1,25 @@
+#!/usr/bin/env python3
+# generate wide structs(thousands of members) and code accessing them for benchmarking member lookup
+# usage: python3 gen_wide.py [N] > wide.c
+import sys
+
+N = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+
+print("struct packet {")
+for i in range(N):
+    print(f"    int f{i};")
+    if i % 100 == 0:
+        print(f"    union {{ int u{i}; unsigned v{i}; }};")
+print("};")
+
+# designated initializers
+print("struct packet init = {")
+for i in range(0, N, 3):
+    print(f"    .f{i} = {i},")
+print("};")
+
+# member access
+for k in range(N // 100):
+    print(f"int sum{k}(struct packet *p) {{")
+    print("    return " + " + ".join(f"p->f{(k * 7 + n * 13) % N} + init.u{(n * 100) % N}" for n in range(50)) + ";")
+    print("}")
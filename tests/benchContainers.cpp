@@ -0,0 +1,105 @@
+// microbenchmarks of xvector/xstring against llvm::SmallVector/llvm::SmallString
+// usage: ./benchContainers [N]
+#include "../src/xcc.h"
+#include <chrono>
+#include <llvm/Support/InitLLVM.h>
+
+template <typename F> static void bench(const char *name, unsigned rounds, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (unsigned i = 0; i < rounds; ++i)
+        sink += f(i);
+    const auto end = std::chrono::steady_clock::now();
+    fprintf(stderr, "%-40s %10.3f ms (%zu)\n", name, std::chrono::duration<double, std::milli>(end - start).count(), sink);
+}
+
+int main(int argc_, const char **argv_) {
+    llvm::InitLLVM trace(argc_, argv_);
+    const unsigned N = argc_ > 1 ? (unsigned)atoi(argv_[1]) : 1000000;
+    using xcc::xvector;
+    using xcc::xstring;
+
+    // the common AST case: a few elements
+    bench("xvector<void*> push_back x3", N, [](unsigned i) {
+        xvector<void *> v = xvector<void *>::get();
+        for (unsigned j = 0; j < 3; ++j)
+            v.push_back(reinterpret_cast<void *>(uintptr_t(i + j)));
+        size_t r = v.size();
+        v.free();
+        return r;
+    });
+    bench("SmallVector<void*, 4> push_back x3", N, [](unsigned i) {
+        llvm::SmallVector<void *, 4> v;
+        for (unsigned j = 0; j < 3; ++j)
+            v.push_back(reinterpret_cast<void *>(uintptr_t(i + j)));
+        return v.size();
+    });
+    {
+        xcc::ArenaAllocator A;
+        bench("xvector<void*> frozen x3", N, [&A](unsigned i) {
+            void *elems[3] = {reinterpret_cast<void *>(uintptr_t(i)), nullptr, nullptr};
+            return xvector<void *>::get_frozen(elems, A).size();
+        });
+    }
+
+    // long vectors
+    bench("xvector<unsigned> push_back x1000", N / 1000, [](unsigned i) {
+        xvector<unsigned> v = xvector<unsigned>::get();
+        for (unsigned j = 0; j < 1000; ++j)
+            v.push_back(i + j);
+        size_t r = v.size();
+        v.free();
+        return r;
+    });
+    bench("SmallVector<unsigned, 4> push_back x1000", N / 1000, [](unsigned i) {
+        llvm::SmallVector<unsigned, 4> v;
+        for (unsigned j = 0; j < 1000; ++j)
+            v.push_back(i + j);
+        return v.size();
+    });
+    bench("xvector<unsigned> append 100 x100", N / 1000, [](unsigned i) {
+        xvector<unsigned> v = xvector<unsigned>::get();
+        for (unsigned j = 0; j < 100; ++j)
+            v.append(i, 100);
+        size_t r = v.size();
+        v.free();
+        return r;
+    });
+    bench("SmallVector<unsigned, 4> append 100 x100", N / 1000, [](unsigned i) {
+        llvm::SmallVector<unsigned, 4> v;
+        for (unsigned j = 0; j < 100; ++j)
+            v.append(100, i);
+        return v.size();
+    });
+
+    // strings built from many small pieces
+    bench("xstring add(StringRef) x1000", N / 1000, [](unsigned) {
+        xstring s = xstring::get();
+        for (unsigned j = 0; j < 1000; ++j)
+            s.add(llvm::StringRef("token "));
+        size_t r = s.size();
+        s.free();
+        return r;
+    });
+    bench("SmallString<32> += x1000", N / 1000, [](unsigned) {
+        llvm::SmallString<32> s;
+        for (unsigned j = 0; j < 1000; ++j)
+            s += "token ";
+        return s.size();
+    });
+    bench("xstring add(char) x1000", N / 1000, [](unsigned) {
+        xstring s = xstring::get();
+        for (unsigned j = 0; j < 1000; ++j)
+            s.add('x');
+        size_t r = s.size();
+        s.free();
+        return r;
+    });
+    bench("SmallString<32> push_back x1000", N / 1000, [](unsigned) {
+        llvm::SmallString<32> s;
+        for (unsigned j = 0; j < 1000; ++j)
+            s.push_back('x');
+        return s.size();
+    });
+    return 0;
+}
@@ -0,0 +1,21 @@
+// benchmark the parser: measure the wall time of parsing (preprocessing, lexing, parsing and constant folding)
+// usage: ./benchParser [options] bench/expr.c
+// the timings are printed to stdout, diagnostics to stderr
+#include <chrono>
+#include "common.h"
+
+    printer.setBuffered();
+
+    xcc::TranslationUnit TU;
+
+    const auto start = std::chrono::steady_clock::now();
+    parser.run(TU);
+    const auto end = std::chrono::steady_clock::now();
+
+    engine.finalize();
+
+    printf("parse: %.3f ms\n", std::chrono::duration<double, std::milli>(end - start).count());
+    printf("arena: %zu bytes\n", ctx.getAllocator().getBytesAllocated());
+
+    return engine.getNumErrors() != 0;
+}
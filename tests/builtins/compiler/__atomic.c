@@ -0,0 +1,94 @@
+// the __atomic_* and __c11_atomic_* builtins use the memory order they are given, constant orders map to exact orderings:
+//   0 relaxed => monotonic, 1 consume and 2 acquire => acquire, 3 release, 4 acq_rel, 5 seq_cst
+// orders that are invalid for the operation(e.g. a release load) are warned about and become seq_cst.
+enum { relaxed, consume, acquire, release, acq_rel, seq_cst };
+
+struct node { struct node *next; int value; };
+
+long counter;
+_Atomic(unsigned) flags;
+struct node *_Atomic head;
+
+long bump(void) {
+    // %1 = atomicrmw add ptr @counter, i64 1 monotonic, align 8
+    return __atomic_fetch_add(&counter, 1, relaxed);
+}
+
+long bump_and_get(void) {
+    // %1 = atomicrmw add ptr @counter, i64 1 acq_rel, align 8
+    // %2 = add i64 %1, 1
+    return __atomic_add_fetch(&counter, 1, acq_rel);
+}
+
+long read_counter(void) {
+    // %1 = load atomic i64, ptr @counter acquire, align 8
+    return __atomic_load_n(&counter, acquire);
+}
+
+void publish(long v) {
+    // store atomic i64 %0, ptr @counter release, align 8
+    __atomic_store_n(&counter, v, release);
+}
+
+unsigned set_flag(unsigned bit) {
+    // %2 = atomicrmw or ptr @flags, i32 %1 release, align 4
+    return __c11_atomic_fetch_or(&flags, bit, release);
+}
+
+void push(struct node *n) {
+    // %3 = load ptr, ptr %2, align 8
+    // %4 = cmpxchg weak ptr @head, ptr %3, ptr %0 release monotonic, align 8
+    // %5 = extractvalue { ptr, i1 } %4, 0
+    // %6 = extractvalue { ptr, i1 } %4, 1
+    // br i1 %6, label %8, label %7        ; on failure the current value is stored to n->next
+    n->next = __atomic_load_n(&head, relaxed);
+    while (!__c11_atomic_compare_exchange_weak(&head, &n->next, n, release, relaxed))
+        ;
+}
+
+int try_lock(int *lock) {
+    int expected = 0;
+    // cmpxchg ptr %0, i32 %3, i32 1 acquire monotonic, align 4
+    return __atomic_compare_exchange_n(lock, &expected, 1, 0, acquire, relaxed);
+}
+
+void unlock(int *lock) {
+    // store atomic i32 0, ptr %0 release, align 4
+    __atomic_store_n(lock, 0, release);
+}
+
+void fences(void) {
+    // fence acquire
+    __atomic_thread_fence(acquire);
+    // fence syncscope("singlethread") seq_cst
+    __atomic_signal_fence(seq_cst);
+    // a relaxed fence emits nothing
+    __atomic_thread_fence(relaxed);
+}
+
+long load_with(int order) {
+    // a runtime order is a switch, relaxed is the default:
+    //   switch i32 %0, label %2 [
+    //     i32 1, label %4
+    //     i32 2, label %4
+    //     i32 5, label %6
+    //   ]
+    //   %3 = load atomic i64, ptr @counter monotonic, align 8
+    //   %5 = load atomic i64, ptr @counter acquire, align 8
+    //   %7 = load atomic i64, ptr @counter seq_cst, align 8
+    //   %9 = phi i64 [ %3, %2 ], [ %5, %4 ], [ %7, %6 ]
+    return __atomic_load_n(&counter, order);
+}
+
+struct node *next_slot(struct node *_Atomic *p) {
+    // C11 pointer arithmetic is scaled by the size of the pointee:
+    //   %3 = atomicrmw add ptr %0, i64 16 seq_cst, align 8
+    //   %4 = inttoptr i64 %3 to ptr
+    return __c11_atomic_fetch_add(p, 1, seq_cst);
+}
+
+long bad_order(void) {
+    // warning: memory order argument to atomic operation is invalid
+    // %1 = load atomic i64, ptr @counter seq_cst, align 8
+    return __atomic_load_n(&counter, release);
+}
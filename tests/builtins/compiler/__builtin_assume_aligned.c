@@ -0,0 +1,12 @@
+float sum(const float *p, int n) {
+    // call void @llvm.assume(i1 true) [ "align"(ptr %0, i64 64) ]
+    const float *a = __builtin_assume_aligned(p, 64);
+    float s = 0;
+    for (int i = 0; i < n; ++i)
+        s += a[i];
+    return s;
+}
+void *skip_header(void *p) {
+    // call void @llvm.assume(i1 true) [ "align"(ptr %0, i64 16, i64 8) ]
+    return __builtin_assume_aligned(p, 16, 8);
+}
@@ -0,0 +1,25 @@
+// the result is undefined for zero, so the intrinsics are called with is_zero_poison = true
+int do_clz(unsigned a) {
+    // %2 = call i32 @llvm.ctlz.i32(i32 %1, i1 true)
+    return __builtin_clz(a);
+}
+int do_ctzll(unsigned long long a) {
+    // %2 = call i64 @llvm.cttz.i64(i64 %1, i1 true)
+    // %3 = trunc i64 %2 to i32
+    return __builtin_ctzll(a);
+}
+int do_clzs(unsigned short a) {
+    // %2 = call i16 @llvm.ctlz.i16(i16 %1, i1 true)
+    // %3 = zext i16 %2 to i32
+    return __builtin_clzs(a);
+}
+int do_popcountl(unsigned long a) {
+    // %2 = call i64 @llvm.ctpop.i64(i64 %1)
+    return __builtin_popcountl(a);
+}
+
+// folded by the front-end
+int a = __builtin_clz(1); // 31
+int b = __builtin_ctz(0x100); // 8
+int c = __builtin_clzs(0xFF); // 8
+int d = __builtin_popcountll(-1LL); // 64
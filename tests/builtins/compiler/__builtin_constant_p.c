@@ -0,0 +1,25 @@
+int folded = __builtin_constant_p(1 + 2); // 1
+
+int is_constant(int x) {
+    // %1 = call i1 @llvm.is.constant.i32(i32 %0)
+    // %2 = zext i1 %1 to i32
+    return __builtin_constant_p(x);
+}
+
+int side_effects(int x, volatile int *v) {
+    // each __builtin_constant_p is 0 without evaluating its argument: x is not incremented, f is not called and *v is
+    // not read, so this returns x
+    int f(void);
+    return x + __builtin_constant_p(x++) + __builtin_constant_p(f()) + __builtin_constant_p(*v);
+}
+
+int sign(int x) {
+    if (x > 0)
+        return 1;
+    if (x < 0)
+        return -1;
+    if (x == 0)
+        return 0;
+    // unreachable
+    __builtin_unreachable();
+}
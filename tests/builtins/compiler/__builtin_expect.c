@@ -0,0 +1,20 @@
+// at -O1 and above __builtin_expect is llvm.expect, LowerExpectIntrinsic turns it into branch weights:
+//   br i1 %cmp, label %error, label %ok, !prof !0
+//   !0 = !{!"branch_weights", i32 1, i32 2000}
+// at -O0 the argument is returned as is.
+extern int handle_error(int);
+
+int parse(int len) {
+    // %2 = call i64 @llvm.expect.i64(i64 %1, i64 0)
+    if (__builtin_expect(len < 0, 0))
+        return handle_error(len);
+    return len * 2;
+}
+
+int retry(int n) {
+    // %2 = call i64 @llvm.expect.with.probability.i64(i64 %1, i64 1, double 9.000000e-01)
+    // the branch weights are in the ratio 9:1
+    if (__builtin_expect_with_probability(n > 3, 1, 0.9))
+        return n;
+    return handle_error(n);
+}
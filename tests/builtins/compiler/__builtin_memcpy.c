@@ -0,0 +1,28 @@
+struct S { int a[8]; };
+
+void copy_small(struct S *dst, const struct S *src) {
+    // known size up to 64 bytes: always expanded inline
+    // call void @llvm.memcpy.inline.p0.p0.i64(ptr align 4 %0, ptr align 4 %1, i64 32, i1 false)
+    __builtin_memcpy(dst, src, 8 * sizeof(int));
+}
+void *copy_big(char *dst, const char *src) {
+    // call void @llvm.memcpy.p0.p0.i64(ptr align 1 %0, ptr align 1 %1, i64 4096, i1 false)
+    return __builtin_memcpy(dst, src, 4096);
+}
+void *copy_n(void *dst, const void *src, unsigned long n) {
+    // call void @llvm.memcpy.p0.p0.i64(ptr align 1 %0, ptr align 1 %1, i64 %2, i1 false)
+    return __builtin_memcpy(dst, src, n);
+}
+void copy_inline(long *dst, const long *src) {
+    // call void @llvm.memcpy.inline.p0.p0.i64(ptr align 8 %0, ptr align 8 %1, i64 128, i1 false)
+    __builtin_memcpy_inline(dst, src, 128);
+}
+void *clear(int *p, int c) {
+    // %3 = trunc i32 %1 to i8
+    // call void @llvm.memset.inline.p0.i64(ptr align 4 %0, i8 %3, i64 64, i1 false)
+    return __builtin_memset(p, c, 16 * sizeof(int));
+}
+void *clear_big(char *p) {
+    // call void @llvm.memset.p0.i64(ptr align 1 %0, i8 0, i64 4096, i1 false)
+    return __builtin_memset(p, 0, 4096);
+}
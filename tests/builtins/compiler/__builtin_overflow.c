@@ -0,0 +1,24 @@
+int add(int a, int b, int *res) {
+    // %4 = call { i32, i1 } @llvm.sadd.with.overflow.i32(i32 %0, i32 %1)
+    // %5 = extractvalue { i32, i1 } %4, 0
+    // %6 = extractvalue { i32, i1 } %4, 1
+    // store i32 %5, ptr %2, align 4
+    return __builtin_add_overflow(a, b, res);
+}
+int umul(unsigned long a, unsigned long b, unsigned long *res) {
+    // call { i64, i1 } @llvm.umul.with.overflow.i64(i64 %0, i64 %1)
+    return __builtin_umull_overflow(a, b, res);
+}
+int mixed(int a, unsigned b, short *res) {
+    // operands are extended to a type that can hold both: i33
+    // %5 = sext i32 %0 to i33
+    // %6 = zext i32 %1 to i33
+    // %7 = call { i33, i1 } @llvm.ssub.with.overflow.i33(i33 %5, i33 %6)
+    // the result does not fit in short if truncating it changes the value
+    // %10 = trunc i33 %8 to i16
+    // %11 = sext i16 %10 to i33
+    // %12 = icmp ne i33 %11, %8
+    // %13 = or i1 %9, %12
+    // store i16 %10, ptr %2, align 2
+    return __builtin_sub_overflow(a, b, res);
+}
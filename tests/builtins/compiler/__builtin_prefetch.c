@@ -0,0 +1,11 @@
+long walk(long *p, int n) {
+    long s = 0;
+    for (int i = 0; i < n; ++i) {
+        // call void @llvm.prefetch.p0(ptr %6, i32 0, i32 3, i32 1)
+        __builtin_prefetch(p + i + 16);
+        // call void @llvm.prefetch.p0(ptr %9, i32 1, i32 0, i32 1)
+        __builtin_prefetch(p + i + 32, 1, 0);
+        s += p[i];
+    }
+    return s;
+}
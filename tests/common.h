@@ -21,9 +21,6 @@ int main(int argc_, const char **argv_)
     // init args
     llvm::ArrayRef<const char*> argv(argv_, argv_ + argc_);
     
-    // register targets
-    llvm::InitializeAllTargets();
-
     // create the Driver
     xcc::driver::Driver theDriver(engine);
 
@@ -41,11 +38,7 @@ int main(int argc_, const char **argv_)
     if (theDriver.BuildCompilation(argv, options, SM, ret))
         return ret;
 
-    llvm::InitializeAllAsmParsers();
-    llvm::InitializeAllAsmPrinters();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllDisassemblers();
-
+    // registers the selected LLVM target only
     options.createTarget(engine);
 
     SM.setTrigraphsEnabled(options.trigraphs);
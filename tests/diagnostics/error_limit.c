@@ -0,0 +1,6 @@
+// xcc -fsyntax-only -ferror-limit=2: two errors, then the fatal "too many errors emitted, stopping now", nothing after
+int f(int, int, int, int);
+
+int test() {
+	return f(a, b, c, d); // error: use of undeclared identifier 'a' and 'b'
+}
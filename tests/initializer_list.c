@@ -10,7 +10,7 @@ char arr5[] = "12345";
 
 char arr6[256] = {[10] = 1, [13] = 1};
 
-// char arr7[] = {[0 ... 100] = 10, [200 ... 300] = 20};
+char arr7[] = {[0 ... 100] = 10, [200 ... 300] = 20};
 
 char arr8[200] = {[20] = '?', '~', '!', [30 ... 40] = '"' };
 
@@ -0,0 +1,79 @@
+/*
+GNU extended asm, `xcc -O1 -emit-llvm` for x86_64-linux-gnu:
+
+    rdtsc:      call { i32, i32 } asm sideeffect "rdtsc", "=a,=d,~{dirflag},~{fpsr},~{flags}"() #N
+    cpu_relax:  call void asm sideeffect "pause", "~{memory},~{dirflag},~{fpsr},~{flags}"() #N
+    barrier:    call void asm sideeffect "", "~{memory},~{dirflag},~{fpsr},~{flags}"() #N
+    cpuid:      call { i32, i32, i32, i32 } asm sideeffect "cpuid", "=a,=b,=c,=d,0,2,~{dirflag},~{fpsr},~{flags}"(i32 %0, i32 0)
+    add_to:     call i32 asm "addl ${1}, ${0}", "=r,r,0,~{dirflag},~{fpsr},~{flags}"(i32 %1, i32 %0) #R   ; '+r' becomes a tied input
+    bswap:      call i32 asm "bswap ${0:k}", "=r,0,~{dirflag},~{fpsr},~{flags}"(i32 %0) #R               ; named operand, %k modifier
+    load_once:  call i32 asm "movl ${1}, ${0}", "=r,*m,~{dirflag},~{fpsr},~{flags}"(ptr elementtype(i32) %0) #O
+    is_zero:    callbr void asm sideeffect "testl ${0}, ${0}; jz ${1:l}", "r,i,~{dirflag},~{fpsr},~{flags}"(i32 %0, ptr blockaddress(@is_zero, %zero))
+                        to label %fallthrough [label %zero]             ; LLVM 15: a blockaddress operand per label
+
+    attributes #N = { nounwind }
+    attributes #R = { nounwind readnone }   ; memory(none) with a newer LLVM
+    attributes #O = { nounwind readonly }   ; memory(read)
+
+and `xcc -O1 -S`:
+
+    rdtsc:      rdtsc; shlq $32, %rdx; orq %rdx, %rax
+    cpu_relax:  pause
+    is_zero:    testl %edi, %edi; jz .LBB?_?
+
+the asm string uses GCC's syntax: `%%` is a single '%', `$` is a literal '$', `%=` is a number unique to each asm:
+
+    percent_and_dollar: "movl $$1, %eax; movl %eax, ${0}", "=r,~{eax},~{cc},~{dirflag},~{fpsr},~{flags}"
+    unique_labels:      "test ${0}, ${0}\0A\09jz .Lskip${:uid}\0A.Lskip${:uid}:", "=r,0,~{dirflag},~{fpsr},~{flags}"
+*/
+typedef unsigned long long u64;
+
+u64 rdtsc(void) {
+    unsigned lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((u64)hi << 32) | lo;
+}
+
+void cpu_relax(void) { asm volatile("pause" ::: "memory"); }
+
+void barrier(void) { asm("" ::: "memory"); }
+
+void cpuid(unsigned leaf, unsigned regs[4]) {
+    asm volatile("cpuid" : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3]) : "0"(leaf), "2"(0));
+}
+
+int add_to(int x, int y) {
+    asm("addl %1, %0" : "+r"(x) : "r"(y));
+    return x;
+}
+
+unsigned bswap(unsigned v) {
+    asm("bswap %k[v]" : [v] "=r"(v) : "0"(v));
+    return v;
+}
+
+int load_once(const int *p) {
+    int v;
+    asm("movl %1, %0" : "=r"(v) : "m"(*p));
+    return v;
+}
+
+int is_zero(int x) {
+    asm goto("testl %0, %0; jz %l[zero]" : : "r"(x) : : zero);
+    return 0;
+zero:
+    return 1;
+}
+
+int percent_and_dollar(void) {
+    int r;
+    asm("movl $1, %%eax; movl %%eax, %0" : "=r"(r) : : "eax", "cc");
+    return r;
+}
+
+int unique_labels(int x) {
+    asm("test %0, %0\n\tjz .Lskip%=\n.Lskip%=:" : "+r"(x));
+    return x;
+}
+
+__asm__(".globl module_level_symbol\n.set module_level_symbol, 0");
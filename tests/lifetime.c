@@ -0,0 +1,70 @@
+/*
+lifetime markers for block-scoped locals, `xcc -O1 -emit-llvm` for x86_64-linux-gnu(none with -O0 or -disable-lifetime-markers):
+
+    dispatch:    call void @llvm.lifetime.start.p0(i64 4096, ptr %buf)     ; in each case
+                 call void @llvm.lifetime.end.p0(i64 4096, ptr %buf)       ; before the `break`, which leaves the block
+    loop_body:   start and end in every iteration
+    small:       nothing for locals smaller than CC_LIFETIME_MIN_SIZE(32 bytes)
+    bypassed:    nothing for `tmp`, the goto jumps over its declaration into its scope
+
+and `xcc -O2 -S`: the 4 buffers of `dispatch` share one stack slot, the frame is about 4 KiB instead of 16 KiB:
+
+    dispatch:    subq $4104, %rsp
+*/
+int fill(char *buf, int n);
+
+int dispatch(int op) {
+    int r = 0;
+    switch (op) {
+    case 0: {
+        char buf[4096];
+        r = fill(buf, sizeof(buf));
+        break;
+    }
+    case 1: {
+        char buf[4096];
+        r = fill(buf, 1);
+        break;
+    }
+    case 2: {
+        char buf[4096];
+        r = fill(buf, 2);
+        break;
+    }
+    default: {
+        char buf[4096];
+        if (fill(buf, 3) < 0)
+            return -1;
+        r = fill(buf, 4);
+    }
+    }
+    return r;
+}
+
+int loop_body(int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        char line[256];
+        s += fill(line, i);
+    }
+    return s;
+}
+
+int small(void) {
+    {
+        int pair[2];
+        fill((char *)pair, 8);
+    }
+    return 0;
+}
+
+int bypassed(int x) {
+    if (x)
+        goto inside;
+    {
+        char tmp[128];
+        fill(tmp, 0);
+inside:
+        return fill(tmp, x);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+[[likely]] and [[unlikely]] before the statement of a branch set the weights of its conditional jump,
+the same weights as LowerExpectIntrinsic uses for __builtin_expect:
+
+    br i1 %3, label %4, label %6, !prof !0
+    !0 = !{!"branch_weights", i32 1, i32 2000}
+    !1 = !{!"branch_weights", i32 2000, i32 1}
+
+with -O2 -S the cold blocks are moved after the hot path:
+
+    check:
+        testl   %edi, %edi
+        js      .LBB0_2
+        leal    (%rdi,%rdi), %eax
+        retq
+    .LBB0_2:
+        jmp     handle_error
+*/
+extern int handle_error(int);
+
+int check(int len) {
+    if (len < 0) [[unlikely]] // !0
+        return handle_error(len);
+    return len * 2;
+}
+
+int check_else(int len) {
+    if (len >= 0)
+        return len * 2;
+    else [[unlikely]] // !1: the true edge is likely
+        return handle_error(len);
+}
+
+int sum(const int *p, int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i) [[likely]] // !1
+        s += p[i];
+    while (s > 1000) [[clang::unlikely]] // !0
+        s -= 1000;
+    return s;
+}
@@ -0,0 +1,16 @@
+/*
+constant operands of '&&' and '||' are folded, the result is always 0 or 1,
+the other operand is still evaluated if it has side effects:
+
+    `x || 1` is 1, `x && 0` is 0, `x || 0` and `x && 1` are `x != 0`
+    `f() || 1` calls f(), then the result is 1
+
+`test(5)` is 1111 and increments `calls` twice
+*/
+int calls;
+
+int f() { return ++calls; }
+
+int test(int x) {
+    return (x || 1) * 1000 + (x || 0) * 100 + (x && 1) * 10 + (x && 0) + (f() || 1) + (f() && 0);
+}
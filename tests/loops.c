@@ -0,0 +1,27 @@
+/*
+for and do-while loops, `xcc -O0 -emit-llvm`:
+
+    for:      the condition, the body, then the increment(the target of 'continue'), and back to the condition
+    do-while: the body, then the condition(the target of 'continue'), which branches back to the body
+
+`sum_odd(10)` is 25, `count_down(3)` is 3 and `count_down(0)` is 1(the body runs once)
+*/
+int sum_odd(int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i % 2 == 0)
+            continue; // still increments i
+        s += i;
+    }
+    return s;
+}
+
+int count_down(int n) {
+    int runs = 0;
+    do {
+        ++runs;
+        if (n == 2)
+            continue; // jumps to the condition
+    } while (--n > 0);
+    return runs;
+}
@@ -39,13 +39,17 @@ std::string xcc_getLinkerPath() {
     return "gcc"; // if not found, fall back to gcc
 }
 
-int xcc_link_gcc(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName) {
+// link `objFileName` to the executable `outputFile`, or the linker's default(a.out) if it is empty
+int xcc_link_gcc(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName, llvm::StringRef outputFile) {
     std::string errorMsg;
     bool failed = false;
     std::string linker = xcc_getLinkerPath();
+    llvm::SmallVector<llvm::StringRef, 4> args = {llvm::StringRef(linker), objFileName};
+    if (!outputFile.empty())
+        args.append({"-o", outputFile});
     int status = llvm::sys::ExecuteAndWait(
         linker,
-        {llvm::StringRef(linker), objFileName},
+        args,
         llvm::None,
         {},
         0,
@@ -64,9 +68,11 @@ int xcc_link_gcc(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName) {
     return CC_EXIT_SUCCESS;
 }
 
-int xcc_link(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName, const llvm::Triple &theTriple) {
+int xcc_link(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName, llvm::StringRef outputFile, const llvm::Triple &theTriple) {
 #ifdef CC_HAS_LLD
     llvm::SmallVector<const char *> args = {"ld.lld", objFileName.data()};
+    if (!outputFile.empty())
+        args.append({"-o", outputFile.data()});
     bool status;
     // ld.lld (Unix), ld64.lld (macOS), lld-link (Windows), wasm-ld (WebAssembly)
     if (theTriple.isOSCygMing()) { /* isWindowsGNUEnvironment or isWindowsCygwinEnvironment */
@@ -91,7 +97,7 @@ int xcc_link(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName, const ll
         status = lld::wasm::link(args, llvm::outs(), llvm::errs(), false, false);
     } else {
         dbgprint("linking: fallback to GCC\n");
-        return xcc_link_gcc(Diags, objFileName);
+        return xcc_link_gcc(Diags, objFileName, outputFile);
     }
     if (status)
         return CC_EXIT_SUCCESS;
@@ -99,44 +105,44 @@ int xcc_link(xcc::DiagnosticHelper &Diags, llvm::StringRef objFileName, const ll
     return CC_EXIT_FAILURE;
 #else
     dbgprint("linking: GCC\n");
-    return xcc_link_gcc(Diags, objFileName);
+    return xcc_link_gcc(Diags, objFileName, outputFile);
 #endif
 }
 
-int main(int argc_, const char **argv_)
+// compile with the command line `argv`, diagnostics are printed to `ErrOS`.
+// `cache` is the file cache of a compile server, which is kept between compilations, or nullptr.
+static int xcc_main(llvm::ArrayRef<const char *> argv, llvm::raw_ostream &ErrOS, xcc::SharedFileCache *cache)
 {
-    assert(argc_ > 0 && "no program name!");
-    assert(argv_ && "NULL argv!");
+    // the objects of this compilation(SourceMgr, Options, LLVMContext, parser and code generator), destroyed after the
+    // printer below, which may still refer to the SourceMgr
+    xcc::CompilerInstance CI;
 
     // create a DiagnosticsEngine for diagnostics
     xcc::DiagnosticsEngine engine;
 
-    // make our text printer that print to stderr
-    xcc::TextDiagnosticPrinter printer(llvm::errs()); 
+    // make our text printer that print to `ErrOS`
+    xcc::TextDiagnosticPrinter printer(ErrOS); 
 
     // add the printer to engine
     engine.addConsumer(&printer);
 
-    // create xcc_context
-    xcc::xcc_context ctx;
+    // write diagnostics in large chunks, warning-heavy inputs are dominated by printing otherwise
+    printer.setBuffered();
 
-    // create a crash report info
-    XInitLLVM crashReport(engine, argc_, argv_);
-
-    // init args
-    llvm::ArrayRef<const char *> argv(argv_, size_t(argc_));
-    
-    // register targets
-    llvm::InitializeAllTargets();
+    // the engine outlives CI, which must not delete it
+    CI.setSharedDiags(engine);
 
     // create the Driver
     xcc::driver::Driver theDriver(engine);
 
     // XCC options
-    xcc::Options options;
+    xcc::Options &options = CI.createOptions();
 
     // create SourceMgr for mangement source files
-    xcc::SourceMgr SM(engine);
+    xcc::SourceMgr &SM = CI.createSourceManager();
+
+    if (cache)
+        SM.setSharedFileCache(cache);
 
     // set SourceMgr to the printer for printing source lines
     printer.setSourceMgr(&SM);
@@ -149,7 +155,7 @@ int main(int argc_, const char **argv_)
     const auto &Args = theDriver.getArgs();
 
     if (options.TimeTrace) {
-        llvm::timeTraceProfilerInitialize(options.TimeTraceGranularity, argv_[0]);
+        llvm::timeTraceProfilerInitialize(options.TimeTraceGranularity, argv[0]);
     }
 
     //auto tos = std::make_shared<xcc::TargetOptions>();
@@ -164,41 +170,68 @@ int main(int argc_, const char **argv_)
     //    printf("%s(%s)\n", it.Name, it.Type);
     //}
 
-    llvm::InitializeAllAsmParsers();
-    llvm::InitializeAllAsmPrinters();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllDisassemblers();
-
-    // create LLVMContext - this will delete all modules when it deleted(dtor)
-    auto llvmcontext = std::make_unique<llvm::LLVMContext>();
-
-    llvmcontext->setDiscardValueNames(true);
-
-    llvmcontext->setOpaquePointers(true);
-    // set our DiagnosticHandler
-    llvmcontext->setDiagnosticHandler(std::make_unique<xcc::XCCDiagnosticHandler>()); 
-    
+    // raw tokens: the directives are not run, so neither the target nor the parser are created
     if (Args.hasArg(OPT_dump_raw_tokens)) {
         auto &OS = llvm::errs();
-        xcc::Lexer lexer(SM, nullptr, ctx, engine);
+        xcc::xcc_context context(options.DL, options.triple);
+        xcc::Lexer lexer(SM, context);
+        lexer.setLexRawMode(true);
         xcc::TokenV tok;
         do {
             tok = lexer.lexAndLoc();
             tok.dump(OS);
             OS << '\n';
         } while (tok.tok != xcc::TEOF);
-        return CC_EXIT_SUCCESS;
+        return xcc_exit(CC_EXIT_SUCCESS);
     }
 
-    // preparing target information and ready for code generation to LLVM IR
-    xcc::IRGen ig(ctx, engine, SM, *llvmcontext, options);
+    // several input files: compile each of them separately with -j threads, then stop(linking is not supported here yet)
+    if (options.inputFiles.size() > 1) {
+        if (!Args.hasArg(OPT_c) && !Args.hasArg(OPT_S) && !Args.hasArg(OPT_fsyntax_only) &&
+            !Args.hasArg(OPT_emit_llvm) && !Args.hasArg(OPT_emit_llvm_bc)) {
+            theDriver.error("linking multiple input files is not supported, use -c");
+            return xcc_exit(CC_EXIT_FAILURE);
+        }
+        if (!options.outputFile.empty() && !Args.hasArg(OPT_fsyntax_only)) {
+            theDriver.error("cannot specify -o when generating multiple output files");
+            return xcc_exit(CC_EXIT_FAILURE);
+        }
+        using Compilation = xcc::ParallelCompilation;
+        Compilation::OutputKind kind = Compilation::Output_Object;
+        if (Args.hasArg(OPT_fsyntax_only))
+            kind = Compilation::Output_None;
+        else if (Args.hasArg(OPT_emit_llvm_bc))
+            kind = Compilation::Output_Bitcode;
+        else if (Args.hasArg(OPT_emit_llvm))
+            kind = Compilation::Output_LLVM;
+        else if (Args.hasArg(OPT_S))
+            kind = Compilation::Output_Assembly;
+        xcc::ParallelCompilation C(engine, options, SM, cache);
+        const bool ok = C.run(kind);
+        engine.finalize();
+        return xcc_exit(ok ? CC_EXIT_SUCCESS : CC_EXIT_FAILURE);
+    }
+
+    // create LLVMContext - this will delete all modules when it deleted(dtor)
+    llvm::LLVMContext &llvmcontext = CI.createLLVMContext();
+
+    llvmcontext.setDiscardValueNames(true);
+
+    llvmcontext.setOpaquePointers(true);
+    // set our DiagnosticHandler
+    llvmcontext.setDiagnosticHandler(std::make_unique<xcc::XCCDiagnosticHandler>()); 
+    
+    // look up the target and create the TargetMachine(the xcc_context needs its DataLayout), this registers only the
+    // selected LLVM backend
+    options.createTarget(engine);
 
-    xcc::LLVMTypeConsumer type_cache(ctx, *llvmcontext, options.g);
+    // Options does not own the TargetMachine
+    const std::unique_ptr<llvm::TargetMachine> machine{options.machine};
 
-    ig.setTypeConsumer(type_cache);
+    // create parser, and prepare target information for code generation to LLVM IR
+    xcc::Parser &parser = CI.createParser();
 
-    // create parser
-    xcc::Parser parser(SM, ig, engine, ctx, type_cache);
+    CI.createCodeGen();
 
     if (Args.hasArg(OPT_dump_tokens)) {
         auto &OS = llvm::errs();
@@ -213,7 +246,9 @@ int main(int argc_, const char **argv_)
     // now, parsing source files ...
     xcc::TranslationUnit TU;
 
-    parser.run(TU);
+    CI.Parse(TU);
+
+    engine.finalize();
 
     if (engine.getNumErrors())
         return xcc_exit(CC_EXIT_FAILURE);
@@ -246,7 +281,7 @@ int main(int argc_, const char **argv_)
     if (Args.hasArg(OPT_fsyntax_only))
         return xcc_exit(CC_EXIT_SUCCESS);
 
-    std::unique_ptr<llvm::Module> llvmModule{ig.run(TU, type_cache)};
+    std::unique_ptr<llvm::Module> llvmModule = CI.CodeGen(TU);
 
     if (Args.hasArg(OPT_emit_codegen_only)) 
         return xcc_exit(CC_EXIT_SUCCESS);
@@ -259,21 +294,19 @@ int main(int argc_, const char **argv_)
 
     // Build ASTs then convert to LLVM, emit .bc file
     if (Args.hasArg(OPT_emit_llvm_bc)) {
-        std::string outputFileName = options.mainFileName.str();
-        outputFileName += ".bc";
+        std::string outputFileName = options.getOutputFileName(options.mainFileName, ".bc");
         llvm::raw_fd_ostream OS(outputFileName, EC, llvm::sys::fs::CD_CreateAlways, llvm::sys::fs::FA_Write, llvm::sys::fs::OF_None);
         if (EC)
             goto CC_ERROR;
         dbgprint("bitcode writting to %s\n", outputFileName.c_str());
-        llvm::WriteBitcodeToFile(*ig.module, OS);
+        llvm::WriteBitcodeToFile(*llvmModule, OS);
         OS.close();
         return xcc_exit(CC_EXIT_SUCCESS);
     }
 
     // Use the LLVM representation for assembler and object files
     if (Args.hasArg(OPT_emit_llvm)) {
-        std::string outputFileName = options.mainFileName.str();
-        outputFileName += ".ll";
+        std::string outputFileName = options.getOutputFileName(options.mainFileName, ".ll");
         llvm::raw_fd_ostream OS(outputFileName, EC, llvm::sys::fs::CD_CreateAlways, llvm::sys::fs::FA_Write, llvm::sys::fs::OF_None);
         if (EC)
             goto CC_ERROR;
@@ -286,15 +319,18 @@ int main(int argc_, const char **argv_)
     {   // default - emit object file and linkning, or emit assembly
         xcc::driver::ToolChain TC(theDriver, options.triple, Args);
         bool assembly = Args.hasArg(OPT_S);
-        std::string outputFileName = options.mainFileName.str();
-        outputFileName += assembly ?  ".s" : ".o";
+        // when linking, -o names the executable, and the object file is named after the input
+        bool linking = !assembly && !Args.hasArg(OPT_c);
+        std::string outputFileName = linking ? (llvm::sys::path::stem(options.mainFileName) + ".o").str()
+                                             : options.getOutputFileName(options.mainFileName, assembly ? ".s" : ".o");
         llvm::raw_fd_ostream OS(outputFileName, EC, llvm::sys::fs::CD_CreateAlways, llvm::sys::fs::FA_Write, llvm::sys::fs::OF_None);
         dbgprint("creating object file: %s\n", outputFileName.data());
         if (EC)
             goto CC_ERROR;
 
+        options.initializeEmitter();
         llvm::legacy::PassManager pass;
-        ig.machine->addPassesToEmitFile(pass, OS, nullptr, assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile);
+        machine->addPassesToEmitFile(pass, OS, nullptr, assembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_ObjectFile);
         pass.run(*llvmModule);
 
         OS.close();
@@ -303,15 +339,58 @@ int main(int argc_, const char **argv_)
             return xcc_exit(CC_EXIT_SUCCESS);
 
         // Only run preprocess, compile, and assemble steps
-        if (Args.hasArg(OPT_C))
+        if (!linking)
             return xcc_exit(CC_EXIT_SUCCESS);
 
         // the final phase - linking
         dbgprint("xcc_link(%s)\n", outputFileName.data());
-        return xcc_exit(xcc_link(theDriver, outputFileName, options.triple));
+        return xcc_exit(xcc_link(theDriver, outputFileName, options.outputFile, options.triple));
     }
 
 CC_ERROR:
     SM.error("cannot open output for writting: %R", EC.message());
     return xcc_exit(CC_EXIT_FAILURE);
 }
+
+int main(int argc_, const char **argv_)
+{
+    assert(argc_ > 0 && "no program name!");
+    assert(argv_ && "NULL argv!");
+
+    // create a DiagnosticsEngine for the errors outside of a compilation
+    xcc::DiagnosticsEngine engine;
+
+    xcc::TextDiagnosticPrinter printer(llvm::errs());
+
+    engine.addConsumer(&printer);
+
+    std::string socketPath;
+
+    // thin client: forward the command line to a compile server, nothing else is initialized
+    if (argc_ > 1 && xcc::CompileServer::matchSocketOption(argv_[1], "--client", socketPath)) {
+        llvm::SmallVector<const char *, 32> args(argv_, argv_ + argc_);
+        args.erase(args.begin() + 1);
+        xcc::DiagnosticHelper Diags(engine);
+        return xcc::runCompileClient(Diags, socketPath, args);
+    }
+
+    // create a crash report info
+    XInitLLVM crashReport(engine, argc_, argv_);
+
+    // init args
+    llvm::ArrayRef<const char *> argv(argv_, size_t(argc_));
+
+    // targets are registered on demand(see Options::createTarget), a server keeps them between compilations
+
+    // compile server: keep the targets and the file cache warm, and compile for the clients
+    for (const char *arg : argv.slice(1)) {
+        if (xcc::CompileServer::matchSocketOption(arg, "--server", socketPath)) {
+            xcc::CompileServer server(engine, socketPath);
+            return server.run([](llvm::ArrayRef<const char *> argv, llvm::raw_ostream &ErrOS, xcc::SharedFileCache &cache) {
+                return xcc_main(argv, ErrOS, &cache);
+            });
+        }
+    }
+
+    return xcc_main(argv, llvm::errs(), nullptr);
+}
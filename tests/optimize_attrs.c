@@ -0,0 +1,38 @@
+/*
+per-function optimization attributes, `xcc -O2 -march=haswell -emit-llvm` for x86_64-linux-gnu:
+
+    define i32 @plain(i32 %0) #P            ; attributes #P = { nounwind "target-cpu"="haswell" }
+    define i32 @hot_path(i32 %0) #H         ; { hot nounwind "target-cpu"="haswell" }
+    define void @cold_path() #C             ; { cold minsize nounwind optsize "target-cpu"="haswell" }
+    define i32 @small(i32 %0) #S            ; { nounwind optsize "target-cpu"="haswell" }
+    define i32 @tiny(i32 %0) #T             ; { minsize nounwind optsize "target-cpu"="haswell" }
+    define i32 @debug_me(i32 %0) #D         ; { noinline nounwind optnone "target-cpu"="haswell" }
+    define i32 @pragma_fast(i32 %0) #P      ; `#pragma GCC optimize("O3")`, no optsize
+    define i32 @pragma_size(i32 %0) #S      ; `#pragma GCC optimize("Os")` between push_options and pop_options
+    define i32 @after_pop(i32 %0) #P
+
+at -Os every function has optsize but hot_path, and -mtune=znver3 -target-feature +avx2 add "tune-cpu"="znver3" and
+"target-features"="+avx2" to every function, declarations included
+*/
+int plain(int x) { return x * 3; }
+
+__attribute__((hot)) int hot_path(int x) { return x + 1; }
+
+__attribute__((cold)) void cold_path(void) {}
+
+__attribute__((optimize("Os"))) int small(int x) { return x - 1; }
+
+__attribute__((optimize("-Oz"))) int tiny(int x) { return x ^ 1; }
+
+__attribute__((optimize(0))) int debug_me(int x) { return x; }
+
+#pragma GCC optimize("O3")
+int pragma_fast(int x) { return x << 1; }
+#pragma GCC reset_options
+
+#pragma GCC push_options
+#pragma GCC optimize "Os"
+int pragma_size(int x) { return x >> 1; }
+#pragma GCC pop_options
+
+int after_pop(int x) { return x & 7; }
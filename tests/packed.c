@@ -0,0 +1,53 @@
+/*
+__attribute__((packed)) and __attribute__((aligned(N))) on struct types, `xcc -O0 -emit-llvm`:
+
+    %struct.Header = type <{ i8, i32, i16 }>    ; packed, sizeof is 7
+    %struct.Line = type { i32, [60 x i8] }      ; aligned(64), padded to a multiple of 64
+    %struct.Both = type <{ i8, i64, [7 x i8] }> ; packed and aligned(8)
+    %struct.Slot = type { i8, [63 x i8], %struct.Line } ; `line` is at offset 64, not 4
+
+    @h = common dso_local global %struct.Header zeroinitializer, align 8
+    @line = common dso_local global %struct.Line zeroinitializer, align 64
+    @both = common dso_local global %struct.Both zeroinitializer, align 8
+    @slot = common dso_local global %struct.Slot zeroinitializer, align 64
+
+members are loaded and stored with the alignment of their offset in the object, not the alignment of their type:
+
+    get_len:    load i32, ptr %len, align 1                 ; offset 1 of a packed struct
+    set_crc:    store i16 %c, ptr %crc, align 1             ; offset 5
+    both_x:     load i64, ptr getelementptr inbounds (%struct.Both, ptr @both, i64 0, i32 1), align 1
+    line_value: load i32, ptr %value, align 4               ; not packed: the alignment of int
+    make:       store i8 1, .., align 1; store i32 %n, .., align 1; store i16 2, .., align 1
+    slot_value: getelementptr inbounds %struct.Slot, ptr %s, i64 0, i32 2  ; the padding is element 1
+*/
+struct __attribute__((packed)) Header {
+    char tag;
+    int len;
+    short crc;
+};
+struct Line {
+    int value;
+} __attribute__((aligned(64)));
+struct Both {
+    char c;
+    long x;
+} __attribute__((packed, aligned(8)));
+
+struct Header h;
+struct Line line;
+struct Both both;
+
+int get_len(struct Header *h) { return h->len; }
+void set_crc(struct Header *h, short c) { h->crc = c; }
+long both_x(void) { return both.x; }
+int line_value(struct Line *l) { return l->value; }
+struct Header make(int n) {
+    struct Header r = {1, n, 2};
+    return r;
+}
+struct Slot {
+    char tag;
+    struct Line line;
+};
+struct Slot slot;
+int slot_value(struct Slot *s) { return s->line.value; }
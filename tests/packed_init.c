@@ -0,0 +1,26 @@
+/*
+array initializers of integer and floating types are packed by the front-end,
+a global array is one ConstantDataArray of the declared type, sparse or not
+
+@table = global [8 x i16] [i16 1, i16 2, i16 4, i16 8, i16 16, i16 32, i16 64, i16 128], align 2
+@f = global [4 x float] [float 5.000000e-01, float 1.000000e+00, float 0.000000e+00, float 2.000000e+00], align 4
+@sparse = global [1000000 x i32] [i32 0, ... i32 0, i32 2, i32 3, i32 0, ... i32 0, i32 1], align 4
+@override = global [4 x i8] c"\02\03\00\00", align 1
+@zero = global [16 x double] zeroinitializer, align 8
+@ranges = global [8 x i8] c"\07\07\07\07\00\00\09\09", align 1
+
+local arrays: dense data is copied from a private constant with llvm.memcpy,
+sparse data is cleared with llvm.memset and only the runs are stored
+*/
+short table[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+float f[] = {0.5f, 1, [3] = 2.0};
+int sparse[1000000] = {[999999] = 1, [10] = 2, 3};
+char override[4] = {[0] = 1, [0] = 2, 3};
+double zero[16] = {};
+char ranges[] = {[0 ... 3] = 7, [6 ... 7] = 9};
+
+int lookup(int i, int x) {
+	int dense[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	int holes[4096] = {[100] = 1, 2, 3, [4000] = 4, [4001] = x};
+	return dense[i & 7] + holes[i];
+}
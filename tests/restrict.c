@@ -0,0 +1,39 @@
+/*
+restrict-qualified pointers, `xcc -O1 -emit-llvm` for x86_64-linux-gnu:
+
+    define void @axpy(i32 %0, float %1, ptr noalias %2, ptr noalias readonly %3)
+    declare void @copy_ext(ptr, ptr, i64)                  ; a prototype: no attributes
+
+the restrict parameters and the restrict locals at the top level of the body get their own alias scope:
+
+    sum_pairs:  call void @llvm.experimental.noalias.scope.decl(metadata !N)       ; one per restrict pointer
+                load float, ptr %.., !alias.scope !A, !noalias !B                  ; through `a`
+                store float %.., ptr %.., !alias.scope !C, !noalias !D             ; through `out`
+    rebased:    no scope, `p` is incremented in the function, `q` alone is disjoint from nothing
+
+and `xcc -O2 -emit-llvm`: the loops of axpy and sum_pairs are vectorized without runtime alias checks
+(`vector.body`, but no `vector.memcheck`).
+*/
+typedef unsigned long size_t;
+
+void axpy(int n, float a, float *restrict y, const float *restrict x) {
+    for (int i = 0; i < n; ++i)
+        y[i] += a * x[i];
+}
+
+void copy_ext(void *restrict dst, const void *restrict src, size_t n);
+
+void sum_pairs(float *buf, const float *src, int n) {
+    float *restrict out = buf;
+    const float *restrict a = src;
+    const float *restrict b = src + n;
+    for (int i = 0; i < n; ++i)
+        out[i] = a[i] + b[i];
+}
+
+int rebased(int *restrict p, int *restrict q, int n) {
+    int s = 0;
+    for (int i = 0; i < n; ++i)
+        s += *p++ + q[i];
+    return s;
+}
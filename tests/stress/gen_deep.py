@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+# generate pathological-depth inputs that must compile in linear time and bounded stack
+# usage: python3 gen_deep.py <kind> [N] > out.c
+# kinds:
+#   add     - int f(int a0, ...) { return a0 + a1 + ... + aN; }
+#   mixed   - a left-leaning chain mixing + - * / & | ^ << >> and comparisons
+#   elseif  - an if/else if ladder with N branches
+#   const   - a constant chain 1 + 2 + ... + N(folded by the parser)
+import sys
+
+kind = sys.argv[1] if len(sys.argv) > 1 else "add"
+N = int(sys.argv[2]) if len(sys.argv) > 2 else 100000
+
+if kind == "add":
+    print("int f(int a) {")
+    print("    return " + " + ".join(f"a" for _ in range(N)) + ";")
+    print("}")
+elif kind == "mixed":
+    ops = ["+", "-", "*", "/", "&", "|", "^", "<<", ">>", "<", "=="]
+    print("unsigned f(unsigned a, unsigned b) {")
+    print("    return a " + " ".join(f"{ops[i % len(ops)]} {'a' if i & 1 else 'b'}" for i in range(N)) + ";")
+    print("}")
+elif kind == "elseif":
+    print("int f(int x) {")
+    print("    int r = 0;")
+    print(f"    if (x == 0) r = 0;")
+    for i in range(1, N):
+        print(f"    else if (x == {i}) r = {i * 7};")
+    print("    else r = -1;")
+    print("    return r;")
+    print("}")
+elif kind == "const":
+    print("int x = " + " + ".join(str(i) for i in range(N)) + ";")
+else:
+    sys.exit(f"unknown kind: {kind}")
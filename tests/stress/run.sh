@@ -0,0 +1,12 @@
+#!/bin/sh
+# compile pathological-depth inputs with a small stack(1 MiB), each must finish quickly
+# usage: make testCodeGen && sh stress/run.sh [N]
+N=${1:-100000}
+ulimit -s 1024
+for kind in add mixed elseif const; do
+    python3 stress/gen_deep.py $kind $N > stress/$kind.c || exit 1
+    start=$(date +%s%N)
+    ./codegen stress/$kind.c || { echo "FAILED: $kind"; exit 1; }
+    end=$(date +%s%N)
+    echo "$kind(N=$N): $(( (end - start) / 1000000 )) ms"
+done
@@ -0,0 +1,139 @@
+// stress the concurrent mode of DiagnosticsEngine: many threads emit diagnostics into per-job queues,
+// then the queues are flushed in a deterministic order.
+// usage: ./stressDiagnostics [threads] [diagnostics per job]
+#include "../src/xcc.h"
+#include <chrono>
+#include <thread>
+#include <llvm/Support/InitLLVM.h>
+
+// remember the order of the diagnostics
+struct RecordingConsumer : public xcc::DiagnosticConsumer {
+    uint64_t hash = 0;
+    size_t count = 0;
+    void HandleDiagnostic(const xcc::Diagnostic &Diag) override {
+        xcc::DiagnosticConsumer::HandleDiagnostic(Diag);
+        llvm::SmallString<64> Str;
+        Diag.FormatDiagnostic(Str);
+        hash = llvm::hash_combine(hash, Diag.loc, Diag.level, llvm::StringRef(Str));
+        ++count;
+    }
+};
+static constexpr unsigned numJobs = 64;
+// every 8th diagnostic is an error with a note, the locations are not in order
+static void runJob(xcc::DiagnosticsEngine &engine, unsigned job, unsigned N) {
+    xcc::DiagnosticHelper helper(engine);
+    for (unsigned i = 0; i < N; ++i) {
+        const xcc::location_t loc = 1 + (i * 7919U) % N;
+        if (i % 8 == 0) {
+            helper.type_error(loc, "job %u: invalid operands (%u)", job, i);
+            helper.note(loc, "job %u: declared here", job);
+        } else {
+            helper.warning(loc, "job %u: value %u is unused", job, i);
+        }
+    }
+}
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+// run `numJobs` jobs on `numThreads` threads, returns the hash of the flushed diagnostics.
+// the jobs use the same locations, which must not be merged by the default deduplication
+static uint64_t runConcurrent(unsigned numThreads, unsigned N) {
+    xcc::DiagnosticsEngine engine;
+    RecordingConsumer consumer;
+    engine.addConsumer(&consumer);
+    std::atomic<unsigned> nextJob{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&] {
+            for (unsigned job; (job = nextJob.fetch_add(1)) < numJobs;) {
+                xcc::DiagnosticsEngine::JobScope scope(engine, job);
+                runJob(engine, job, N);
+            }
+        });
+    }
+    for (std::thread &T : threads)
+        T.join();
+    const double emitTime = elapsed(start);
+    const unsigned expectedErrors = numJobs * ((N + 7) / 8);
+    if (engine.getNumErrors() != expectedErrors) {
+        fprintf(stderr, "FAILED: %u queued errors, expected %u\n", engine.getNumErrors(), expectedErrors);
+        exit(1);
+    }
+    const auto flushStart = std::chrono::steady_clock::now();
+    engine.flushJobs();
+    const double flushTime = elapsed(flushStart);
+    if (consumer.getNumErrors() != expectedErrors || engine.getNumErrors() != expectedErrors) {
+        fprintf(stderr, "FAILED: %u errors after flush, expected %u\n", consumer.getNumErrors(), expectedErrors);
+        exit(1);
+    }
+    fprintf(stderr, "%3u threads: emit %10.3f ms, flush %10.3f ms (%zu diagnostics)\n", numThreads, emitTime, flushTime, consumer.count);
+    return consumer.hash;
+}
+
+// queued diagnostics are deduplicated and summarized by their own format, within their job
+static void checkFiltering() {
+    xcc::DiagnosticsEngine engine;
+    RecordingConsumer consumer;
+    engine.addConsumer(&consumer);
+    xcc::DiagnosticHelper helper(engine);
+    {
+        xcc::DiagnosticsEngine::JobScope scope(engine, 0);
+        helper.warning(5, "variable %u is unused", 1U);
+        helper.warning(5, "comparison of %u is always true", 2U); // another diagnostic at the same location
+        helper.warning(5, "variable %u is unused", 1U);           // a repeat: dropped
+    }
+    {
+        xcc::DiagnosticsEngine::JobScope scope(engine, 1);
+        helper.warning(5, "variable %u is unused", 1U); // the same location in another job(file)
+    }
+    engine.flushJobs();
+    if (consumer.count != 3) {
+        fprintf(stderr, "FAILED: %zu diagnostics after deduplication, expected 3\n", consumer.count);
+        exit(1);
+    }
+    xcc::DiagnosticsEngine summary;
+    RecordingConsumer summaryConsumer;
+    summary.addConsumer(&summaryConsumer);
+    summary.SummaryMode = true;
+    xcc::DiagnosticHelper summaryHelper(summary);
+    {
+        xcc::DiagnosticsEngine::JobScope scope(summary, 0);
+        summaryHelper.warning(1, "variable %u is unused", 1U);
+        summaryHelper.warning(2, "comparison of %u is always true", 2U);
+        summaryHelper.warning(3, "variable %u is unused", 3U); // a repeat of the first kind
+    }
+    summary.flushJobs();
+    if (summaryConsumer.count != 2) {
+        fprintf(stderr, "FAILED: %zu diagnostics in summary mode, expected 2\n", summaryConsumer.count);
+        exit(1);
+    }
+}
+
+int main(int argc_, const char **argv_) {
+    llvm::InitLLVM trace(argc_, argv_);
+    const unsigned maxThreads = argc_ > 1 ? (unsigned)atoi(argv_[1]) : 4 * std::max(1U, std::thread::hardware_concurrency());
+    const unsigned N = argc_ > 2 ? (unsigned)atoi(argv_[2]) : 20000;
+
+    // baseline: the same diagnostics from one thread, straight to the consumer
+    {
+        xcc::DiagnosticsEngine engine;
+        engine.Dedup = xcc::Dedup_None;
+        RecordingConsumer consumer;
+        engine.addConsumer(&consumer);
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned job = 0; job < numJobs; ++job)
+            runJob(engine, job, N);
+        fprintf(stderr, "direct:      emit %10.3f ms (%zu diagnostics)\n", elapsed(start), consumer.count);
+    }
+    checkFiltering();
+    const uint64_t expected = runConcurrent(1, N);
+    for (unsigned numThreads = 2; numThreads <= maxThreads; numThreads *= 2) {
+        if (runConcurrent(numThreads, N) != expected) {
+            fprintf(stderr, "FAILED: the output with %u threads differs from the output with 1 thread\n", numThreads);
+            return 1;
+        }
+    }
+    fprintf(stderr, "PASSED: the output does not depend on the number of threads\n");
+    return 0;
+}
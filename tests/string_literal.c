@@ -0,0 +1,18 @@
+/*
+string literals are kept as encoded bytes by the front-end, IRGen creates the constants
+
+@.cstr = private unnamed_addr constant [6 x i8] c"hello\00", align 1
+@.cstr.1 = private unnamed_addr constant [3 x i16] [i16 104, i16 105, i16 0], align 2
+@.cstr.2 = private unnamed_addr constant [3 x i32] [i32 104, i32 105, i32 0], align 4
+@buf = global [6 x i8] c"hello\00", align 1
+@empty = global [1 x i8] zeroinitializer, align 1
+@c = global i8 101, align 1
+*/
+
+const char *s1 = "hello";
+const char *s2 = "hello"; // uniqued with s1
+const unsigned short *u16 = u"hi";
+const unsigned int *u32 = U"hi";
+char buf[] = "hello";
+char empty[] = "";
+char c = "hello"[1];
@@ -0,0 +1,20 @@
+/*
+records with many members are indexed by name(members of anonymous structs/unions included),
+the only expected diagnostic is:
+
+error: duplicate member 'm3'     (in the anonymous union inside `struct Wide`)
+*/
+struct Wide {
+	int m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15, m16;
+	union {
+		int m3;
+		int u1;
+	};
+	int last;
+};
+
+struct Wide w = {.m16 = 7, .u1 = 1, .last = 2};
+
+int get(struct Wide *p) {
+	return p->m16 + p->u1 + w.last;
+}
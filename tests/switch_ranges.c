@@ -0,0 +1,16 @@
+/*
+signed case ranges are not empty, ranges and cases are compared by value(not by order in the source):
+
+error: duplicate (or overlapping) case value 5 in range (3 - 6)     (at `case 5`)
+note: previous case defined here                                     (at `case 3 ... 6`)
+*/
+int classify(int c) {
+	switch (c) {
+	case -3 ... -1: return -1;
+	case 0: return 0;
+	case 3 ... 6: return 1;
+	case 10 ... 20: return 2;
+	case 5: return 3;
+	}
+	return 4;
+}
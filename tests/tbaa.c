@@ -0,0 +1,64 @@
+/*
+type-based alias analysis, `xcc -O1 -emit-llvm` for x86_64-linux-gnu(no !tbaa with -O0 or -fno-strict-aliasing):
+
+    !0 = !{!"Simple C/C++ TBAA"}
+    !1 = !{!"omnipotent char", !0, i64 0}
+    !2 = !{!"int", !1, i64 0}              ; also `unsigned int` and `enum color`(compatible with its underlying type)
+    !3 = !{!"float", !1, i64 0}
+    !4 = !{!"any pointer", !1, i64 0}
+    !5 = !{!"vec", !3, i64 0, !3, i64 4, !3, i64 8}
+    !6 = !{!"body", !5, i64 0, !5, i64 12, !3, i64 24, !2, i64 28, !4, i64 32}
+
+    scalar accesses:      load i32, ptr %p, !tbaa !{!2, !2, i64 0}
+    `*c` and `*i` in `enum_vs_int`: both tagged !{!2, !2, i64 0}, so the store to `*i` may modify `*c`
+    char accesses:        store i8 .., !tbaa !{!1, !1, i64 0}
+    `b->vel.y`:           load float, ptr .., !tbaa !{!6, !3, i64 16}    ; the outermost struct and the offset of the member
+    `u->i`(a union):      store i32 .., !tbaa !{!1, !1, i64 0}           ; may alias anything
+
+with -O2, the loads of `w->n`, `w->dt` and `w->bodies` in `integrate` are hoisted out of the loop: the `long` stores through
+`ticks` cannot modify an int, a float or a pointer, and the float stores to `b->pos.x` are members of `struct body`, not of
+`struct world`.
+*/
+struct vec {
+    float x, y, z;
+};
+struct body {
+    struct vec pos, vel;
+    float mass;
+    int id;
+    struct body *next;
+};
+struct world {
+    struct body *bodies;
+    int n;
+    float dt;
+};
+enum color { RED, GREEN, BLUE };
+union pun {
+    int i;
+    float f;
+};
+
+int get_int(int *p) { return *p; }
+unsigned get_unsigned(unsigned *p) { return *p; }
+void set_char(char *p) { *p = 0; }
+float vel_y(struct body *b) { return b->vel.y; }
+void set_mass(struct body *b, float m) { b->mass = m; }
+// an enum and its compatible integer type alias: `*c` is reloaded after the store to `*i`
+enum color enum_vs_int(enum color *c, int *i) {
+    *c = GREEN;
+    *i = 2;
+    return *c;
+}
+int pun(union pun *u, float f) {
+    u->f = f;
+    return u->i;
+}
+
+void integrate(struct world *w, long *ticks) {
+    for (int i = 0; i < w->n; ++i) {
+        struct body *b = &w->bodies[i];
+        b->pos.x += b->vel.x * w->dt;
+        ticks[i] += 1;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+GCC vector extensions, `xcc -O2 -S` for x86_64-linux-gnu:
+
+    axpy:       mulps %xmm1, %xmm0; addps %xmm2, %xmm0              ; fmul/fadd <4 x float>
+    scale:      shufps $0, %xmm1, %xmm1; mulps %xmm1, %xmm0         ; the scalar is splatted(insertelement + shufflevector)
+    less:       pcmpgtd %xmm0, %xmm1                                ; icmp slt <4 x i32>, sext to <4 x i32>: -1 or 0 per element
+    hsum:       shufps $85, %xmm0, %xmm1; addss %xmm1, %xmm0        ; v[0] + v[1] is extractelement
+    reverse:    shufps $27, %xmm0, %xmm0                            ; __builtin_shufflevector(v, v, 3, 2, 1, 0)
+    to_float:   cvtdq2ps %xmm0, %xmm0                               ; __builtin_convertvector is sitofp <4 x i32> to <4 x float>
+    axpy8:      vmulps %ymm1, %ymm0, %ymm0; vaddps %ymm2, %ymm0, %ymm0 with -march=haswell, two mulps/addps pairs with SSE
+
+the masks of comparisons are vectors of signed integers as wide as the elements, in `xcc -O0 -emit-llvm`:
+
+    less:       %cmp = icmp slt <4 x i32> %a, %b
+                %mask = sext <4 x i1> %cmp to <4 x i32>
+    lessf:      %cmp = fcmp olt <4 x float> %a, %b
+                %mask = sext <4 x i1> %cmp to <4 x i32>             ; v4sf compares to v4si
+    less_bytes: %cmp = icmp ult <16 x i8> %a, %b
+                %mask = sext <16 x i1> %cmp to <16 x i8>
+
+`ramp` is `<4 x i32> <i32 0, i32 1, i32 2, i32 3>`, and `lanes` stores the vector built by insertelement from
+zeroinitializer
+*/
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+typedef float v8sf __attribute__((vector_size(32)));
+typedef char v16qi __attribute__((vector_size(16)));
+typedef unsigned char v16qu __attribute__((vector_size(16)));
+
+v4sf axpy(v4sf a, v4sf x, v4sf y) { return a * x + y; }
+
+v4sf scale(v4sf v, float s) { return v * s; }
+
+v4si less(v4si a, v4si b) { return a < b; }
+
+v4si lessf(v4sf a, v4sf b) { return a < b; }
+
+v16qi less_bytes(v16qu a, v16qu b) { return a < b; }
+
+float hsum(v4sf v) { return v[0] + v[1]; }
+
+v4sf reverse(v4sf v) { return __builtin_shufflevector(v, v, 3, 2, 1, 0); }
+
+v4sf to_float(v4si v) { return __builtin_convertvector(v, v4sf); }
+
+v8sf axpy8(v8sf a, v8sf x, v8sf y) { return a * x + y; }
+
+v4si ramp(void) {
+    v4si r = {0, 1, 2, 3};
+    return r;
+}
+
+void lanes(v4sf *out, float x, float y) {
+    v4sf v = {x, y};
+    v[3] = x * y;
+    *out = v;
+}